@@ -21,7 +21,11 @@
 #include    <string.h>
 #include    <stdio.h>
 #include    "cmsis_os.h"
+#include    "stm32f4xx.h"               /* __LDREXW(), __STREXW()             */
+#include    "board.h"
 #include    "ProfiBUS_DP.h"
+#include    "metrics.h"
+#include    "trace.h"
 
 /**********************************************************************************************************/
 /** @addtogroup PROFIBUS_DP
@@ -35,6 +39,8 @@
 #define PBDP_EVENT_ERR      (0x1u << 0)             /* PBDP Event error                 */
 #define PBDP_EVENT_IDLE     (0x1u << 1)             /* PBDP Event Recv Idle char        */
 #define PBDP_EVENT_CPLT     (0x1u << 2)             /* PBDP Event Transmission complete */
+#define PBDP_EVENT_RESP     (0x1u << 3)             /* PBDP Event Response started      */
+#define PBDP_EVENT_SLOT     (0x1u << 4)             /* PBDP Event Slot time out         */
 
 #define PBDP_FRAME_SD1      (0x10)
 #define PBDP_FRAME_SD1L     (1 + (3) + 1 + 1)
@@ -49,6 +55,21 @@
 #define PBDP_FRAME_ED       (0x16)
 
 #define PBDP_RX_BUF_LEN     (1024)
+#define PBDP_RX_REL_LEN     (16)                    /* Cycles of rx_sem released kept   */
+
+#define PBDP_RETRY_MAX      (8)                     /* Max of max_retry_limit           */
+
+#define PBDP_CHAR_BITS      (11)                    /* Bits of a UART char              */
+
+#define PBDP_TSYN           (33)                    /* Synchronization time(bits)       */
+#define PBDP_TSM(tset, tqui)        (2 + 2 * (tset) + (tqui))
+#define PBDP_TID(tsm, tsdr)         ((PBDP_TSYN + (tsm) > (tsdr)) ? (PBDP_TSYN + (tsm)) : (tsdr))
+#define PBDP_TIMING_DEF(baud, tsl, min_tsdr, max_tsdr, tset, tqui)                                  \
+                            {   (baud), (tsl), (min_tsdr), (max_tsdr), PBDP_TSYN,                   \
+                                PBDP_TID(PBDP_TSM(tset, tqui), min_tsdr),   /* Tid1 */              \
+                                PBDP_TID(PBDP_TSM(tset, tqui), max_tsdr),   /* Tid2 */              \
+                                (tset), (tqui)                                                      \
+                            }
 
 
 /**********************************************************************************************************/
@@ -59,7 +80,7 @@
 
 #define QUEUE_TYPE(type, len)   /* ж, (type)Ԫ, (len)Ԫ鳤,Ϊ(2 ^ n)    */ \
                                 struct                        /* (len)ֵó(2 ^ 15)            */ \
-                                {   ##type      elem[##len];  /* (type)Ϊ, <char[8]>      */ \
+                                {   type        elem[len];    /* (type)Ϊ, <char[8]>      */ \
                                     uint16_t    head, tail;   /* head --- ͷ, tail --- β           */ \
                                 }
 #define QUEUE_INIT(queue)       /* ʼ                                                               */ \
@@ -101,7 +122,11 @@ typedef struct {    /*------------- PBDP Information (Run-Time) ----------------
 
     uint16_t                                tx_num;     /* Total number of transmit buffer  */
     uint16_t                                tx_cnt;     /* Number of data transmitted       */
-    uint16_t                                tx_chk;     /* Number of data check             */
+    uint16_t                                tx_chk;     /* Number of data check, or idle bits before send */
+    uint16_t                                tx_sdn;     /* Last frame sent is a SDN request */
+    uint16_t                                tx_tsl;     /* Slot time(bits) of the request   */
+    uint16_t                                rx_tsl;     /* Slot time(bits) of the response waiting  */
+    uint16_t                                rx_resp;    /* Receiving the response of the request    */
     const uint8_t                          *tx_buf;     /* Buffer of transmit               */
     osThreadId                              tx_sig;     /* OS Signal flags of transmit      */
     osMutexId                               tx_mut;     /* OS Mutex of transmit             */
@@ -109,15 +134,22 @@ typedef struct {    /*------------- PBDP Information (Run-Time) ----------------
     osSemaphoreId                           rx_sem;     /* OS Semaphore of Received ED      */
     osMutexId                               rx_mut;     /* OS Mutex of Receive              */
     int                                     rx_enb;     /* Receive Enable(1)/Disable(0)     */
+    int                                     rx_ovr;     /* Chars lost in the frame being received   */
     QUEUE_TYPE(uint8_t, PBDP_RX_BUF_LEN)    rx_que;     /* Receive Data Circular Queue      */
+    QUEUE_TYPE(uint32_t, PBDP_RX_REL_LEN)   rx_rel;     /* Cycles of rx_sem released by ISR */
 
-    uint32_t                                rxd_cnt;    /* Counter of UART received data    */
-    uint32_t                                txd_cnt;    /* Counter of UART transmit data    */
-    uint32_t                                err_evt;    /* Counter of UART Error event      */
-    uint32_t                                err_ovr;    /* Counter of Queue Overrun error   */
-    uint32_t                                err_chk;    /* Counter of transmit check error  */
 } PBDP_INFO;
 
+typedef struct {    /*------------- PBDP Bus analytics (Run-Time), by UART callbacks --------*/
+    uint32_t                                start;      /* Timestamp(us) of the frame start */
+    uint16_t                                idx;        /* Index of the char in the frame   */
+    uint8_t                                 sd;         /* SD of the frame                  */
+    uint8_t                                 da;         /* DA of the frame                  */
+    uint8_t                                 req;        /* The frame is a request with reply*/
+    uint8_t                                 rsv[3];
+    PBDP_BUS_STAT                           stat;       /* Cumulative counters              */
+} PBDP_BUS;
+
 #define PBDP_IDLE_CNT_CLR()     { /*if( PBDP_Info.tx_sig ) {                             */ \
                                   /*    osSignalClear(PBDP_Info.tx_sig, PBDP_EVENT_IDLE);*/ \
                                   /*}                                                    */ \
@@ -131,27 +163,42 @@ typedef struct {    /*------------- PBDP Information (Run-Time) ----------------
                                         osSignalSet(PBDP_Info.tx_sig, evt);                 \
                                     }                                                       \
                                 }
+#define PBDP_US2BITS(us)        ( ((us) < 0x10000) ? (((us) * (PBDP_Tim->baud / 100)) / 10000) : (0xFFFFFF) )
+
+#define PBDP_SLOT_RESP()        {   if( PBDP_Info.rx_tsl ) {                                \
+                                        PBDP_Info.rx_tsl = 0;                               \
+                                        PBDP_TX_SIG_SEND(PBDP_EVENT_RESP);                  \
+                                    }                                                       \
+                                }
 #define PBDP_RX_QUE_PUSH(val)   {   if( PBDP_Info.rx_enb ) {                                \
                                         if(!QUEUE_FULL(PBDP_Info.rx_que) ) {                \
                                             QUEUE_PUSH(PBDP_Info.rx_que) = (val);           \
                                         } else {                                            \
                                             PBDP_DBG_OVR_INC();                             \
                                         }                                                   \
+                                        if( (val) == PBDP_FRAME_ED ) {                      \
+                                            PBDP_Info.rx_ovr = 0;   /* Next frame */        \
+                                        }                                                   \
                                     }                                                       \
                                 }
+#define PBDP_RX_SEM_RELEASE()   {   if(!QUEUE_FULL(PBDP_Info.rx_rel) ) {                \
+                                        QUEUE_PUSH(PBDP_Info.rx_rel) = bsp_cycles();        \
+                                    }                                                       \
+                                    osSemaphoreRelease(PBDP_Info.rx_sem);                   \
+                                }
 #define PBDP_ENTER_RECV_STA()   (PBDP_UART_DsDEN(), PBDP_Info.tx_num = 0, PBDP_Info.tx_buf = NULL)
                                 //{ if(PBDP_Info.tx_num != 0) PBDP_Info.tx_buf = NULL; }
 
-#define PBDP_DBG_RXD_INIT()     ( PBDP_Info.rxd_cnt = 0 )
-#define PBDP_DBG_RXD_INC()      ( PBDP_Info.rxd_cnt++   )
-#define PBDP_DBG_TXD_INIT()     ( PBDP_Info.txd_cnt = 0 )
-#define PBDP_DBG_TXD_INC()      ( PBDP_Info.txd_cnt++   )
-#define PBDP_DBG_ERR_INIT()     ( PBDP_Info.err_evt = 0 )
-#define PBDP_DBG_ERR_INC()      ( PBDP_Info.err_evt++   )
-#define PBDP_DBG_OVR_INIT()     ( PBDP_Info.err_ovr = 0 )
-#define PBDP_DBG_OVR_INC()      ( PBDP_Info.err_ovr++   )
-#define PBDP_DBG_CHK_INIT()     ( PBDP_Info.err_chk = 0 )
-#define PBDP_DBG_CHK_INC()      ( PBDP_Info.err_chk++   )
+#define PBDP_DBG_RXD_INC()      METRICS_INC(uart_rx_chars)      /* Counters in the metrics registry */
+#define PBDP_DBG_TXD_INC()      METRICS_INC(uart_tx_chars)
+#define PBDP_DBG_ERR_INC()      METRICS_INC(uart_err_events)
+#define PBDP_DBG_OVR_INC()      {   METRICS_INC(uart_rx_overruns);                      \
+                                    if( !PBDP_Info.rx_ovr ) {                               \
+                                        PBDP_Info.rx_ovr = 1;   /* Once a frame */          \
+                                        METRICS_INC(uart_rx_ovr_frames);                    \
+                                    }                                                       \
+                                }
+#define PBDP_DBG_CHK_INC()      METRICS_INC(uart_tx_checks)
 
 /**********************************************************************************************************/
 /** @}
@@ -164,6 +211,22 @@ static osMutexDef    (PBDP_tx_mut);                     /* PBDP Mutex definition
 static osMutexDef    (PBDP_rx_mut);                     /* PBDP Mutex definition            */
 static osSemaphoreDef(PBDP_rx_sem);                     /* PBDP Semaphore definition        */
 
+static const PBDP_TIMING    PBDP_Timing[] = {           /* Bus parameters of the baud rates, in bits    */
+    /*                  Baud rate   Tslot   minTsdr maxTsdr Tset    Tqui    */
+    PBDP_TIMING_DEF(    9600,       100,    11,     60,     1,      0   ),
+    PBDP_TIMING_DEF(    19200,      100,    11,     60,     1,      0   ),
+    PBDP_TIMING_DEF(    45450,      640,    11,     400,    95,     0   ),
+    PBDP_TIMING_DEF(    93750,      100,    11,     60,     1,      0   ),
+    PBDP_TIMING_DEF(    187500,     100,    11,     60,     1,      0   ),
+    PBDP_TIMING_DEF(    500000,     200,    11,     100,    1,      0   ),
+    PBDP_TIMING_DEF(    1500000,    300,    11,     150,    1,      0   ),
+};
+static const PBDP_TIMING   *PBDP_Tim = &PBDP_Timing[4]; /* Bus parameters in use, 187.5 kbit/s default  */
+static uint8_t              PBDP_Retry = 0;             /* max_retry_limit of requests not replied      */
+static PBDP_SLOT            PBDP_Slot[PBDP_STATION_NUM];/* Slot time supervision of the stations        */
+static PBDP_BUS             PBDP_Bus;                   /* Bus analytics                                */
+static PBDP_STAMP           PBDP_Stamp;                 /* Timestamps of the last request with reply    */
+
 /**********************************************************************************************************/
 /** @}
 *** @addtogroup                 PROFIBUS_DP_Private_Functions
@@ -177,41 +240,6 @@ static osSemaphoreDef(PBDP_rx_sem);                     /* PBDP Semaphore defini
 // }
 
 
-/**********************************************************************************************************/
-/** @brief      Get PorfiBUS_DP statistic information
-***
-*** @param[out] buff    Output statistic information string
-*** @param[in]  size    size of buff(in bytes)
-***
-*** @return     (< 0)Error. (other)number of output char, not counting the terminating null char
-***********************************************************************************************************/
-#if 0
-int PBDP_Statc(char* buff, int size)
-{
-    int n, m;
-
-    if( (buff == NULL) || (size == 0) )  { return( 0 );        }
-
-    n = snprintf( buff, size,
-                  "DP Rx: %u(Frame) %u(Byte)\r\n"
-                  "DP Tx: %u(Frame) %u(Byte)\r\n"
-                  "DP Over Run ERR: %u\r\n"
-                  "DP CHK(TxD) ERR: %u\r\n",
-                  PBDP_Info.rxf_cnt, PBDP_Info.rxd_cnt,
-                  PBDP_Info.txf_cnt, PBDP_Info.txd_cnt,
-                  PBDP_Info.err_ovr,
-                  PBDP_Info.err_chk
-                );
-    if( n < 0 ) /**********************/ { return( n );        }
-    if( n >= size ) /******************/ { return( size - 1 ); }
-
-    m = PBDP_UART_Statc(&(buff[n]), size - n);
-    if( m < 0 ) /**********************/ { return( n );        }
-    if( m >= (size - n) ) /************/ { return( size - 1 ); }
-    else /*****************************/ { return( m + n );    }
-}
-#endif
-
 /**********************************************************************************************************/
 /** @brief      PorfiBUS_DP Initialize
 ***
@@ -220,6 +248,14 @@ int PBDP_Statc(char* buff, int size)
 
 void PBDP_Init(uint32_t baud)
 {
+    int     i;
+
+    for(i = 0;  i < (int)(sizeof(PBDP_Timing) / sizeof(PBDP_Timing[0]));  i++) {
+        if( PBDP_Timing[i].baud == baud ) {
+            PBDP_Tim = &PBDP_Timing[i];                         /* Bus parameters of the baud rate  */
+        }
+    }
+
     PBDP_Info.idl_cnt = 0;      /* PBDP Information Initialize  */
     PBDP_Info.tx_sig  = NULL;
     PBDP_Info.tx_mut  = osMutexCreate(osMutex(PBDP_tx_mut));
@@ -227,16 +263,20 @@ void PBDP_Init(uint32_t baud)
     PBDP_Info.tx_num  = 0;
     PBDP_Info.tx_cnt  = 0;
     PBDP_Info.tx_chk  = 0;
+    PBDP_Info.tx_sdn  = 0;
+    PBDP_Info.tx_tsl  = 0;
+    PBDP_Info.rx_tsl  = 0;
+
+    memset(&PBDP_Bus, 0, sizeof(PBDP_Bus));                     /* Bus analytics Initialize     */
+    PBDP_Bus.stat.gap_w = (PBDP_Tim->tsl + (PBDP_GAP_BINS - 2)) / (PBDP_GAP_BINS - 1);
+    for(i = 0;  i < PBDP_MASTER_NUM;  i++) {
+        PBDP_Bus.stat.trr[i].addr = 0xFF;
+    }
     PBDP_Info.rx_sem  = osSemaphoreCreate(osSemaphore(PBDP_rx_sem), 0);
     PBDP_Info.rx_mut  = osMutexCreate(osMutex(PBDP_rx_mut));
     PBDP_Info.rx_enb  = 0;
     QUEUE_INIT(PBDP_Info.rx_que);
-
-    PBDP_DBG_RXD_INIT();
-    PBDP_DBG_TXD_INIT();
-    PBDP_DBG_ERR_INIT();
-    PBDP_DBG_OVR_INIT();
-    PBDP_DBG_CHK_INIT();
+    QUEUE_INIT(PBDP_Info.rx_rel);
 
     if( (PBDP_Info.tx_mut == NULL) || (PBDP_Info.rx_sem == NULL) || (PBDP_Info.rx_mut == NULL) ) {
         printf("[ProfiBUS DP] Initialize Failed!\r\n");
@@ -244,6 +284,202 @@ void PBDP_Init(uint32_t baud)
 
     PBDP_UART_Init(baud);       /* UART Initialize              */
     printf("[ProfiBUS DP] Initialize Succeed! Baud rate: %u.\r\n", baud);
+    printf( "[ProfiBUS DP] Tslot %u, Tsdr %u-%u, Tsyn %u, Tid1 %u, Tid2 %u(bits) of %u.\r\n",
+            PBDP_Tim->tsl, PBDP_Tim->min_tsdr, PBDP_Tim->max_tsdr, PBDP_Tim->tsyn,
+            PBDP_Tim->tid1, PBDP_Tim->tid2, PBDP_Tim->baud );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Get PorfiBUS_DP bus parameters of the baud rate in use
+***
+*** @return     Pointer to the bus parameters, in bits
+***********************************************************************************************************/
+
+const PBDP_TIMING* PBDP_GetTiming(void)
+{
+    return( PBDP_Tim );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Get PorfiBUS_DP bus analytics
+***
+*** @return     Pointer to the cumulative counters, updated in the UART interrupt. The reader gets the
+***             values of a time window by the difference of two readings, and clears (trr[].max),
+***             with the interrupts masked.
+***********************************************************************************************************/
+
+PBDP_BUS_STAT* PBDP_GetBusStat(void)
+{
+    return( &PBDP_Bus.stat );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Get PorfiBUS_DP timestamps of the last request with reply
+***
+*** @return     Pointer to the timestamps, updated in the UART interrupt. (tx_start)(tx_end) are of the
+***             last try, (rx_start)(rx_end) are valid after PBDP_Send() returned the request sent.
+***********************************************************************************************************/
+
+const PBDP_STAMP* PBDP_GetStamp(void)
+{
+    return( &PBDP_Stamp );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Increase a counter of the slot time supervision lock-free, as metrics_add(): the threads
+***             sending to the same station count without the transmitter locked.
+***
+*** @param[in]  cnt     Counter of PBDP_Slot[]
+***********************************************************************************************************/
+
+static void PBDP_SlotInc(uint32_t *cnt)
+{
+    uint32_t    v;
+
+    do {
+        v = __LDREXW(cnt);
+    } while( __STREXW(v + 1, cnt) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Get PorfiBUS_DP slot time supervision of a station
+***
+*** @param[in]  da      Station address, 0 ~ (PBDP_STATION_NUM - 1)
+***
+*** @return     Pointer to the counters of the station, updated by PBDP_Send(). NULL for invalid address.
+***********************************************************************************************************/
+
+const PBDP_SLOT* PBDP_GetSlot(int da)
+{
+    return( ((da < 0) || (da >= PBDP_STATION_NUM)) ? (NULL) : (&PBDP_Slot[da]) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Update bus analytics by a char on the bus, called in the UART interrupt.
+***
+*** @param[in]  ch      UART char, received or echo of transmit
+*** @param[in]  idle    Bus was idle before the char
+***********************************************************************************************************/
+
+static void PBDP_BusChar(int ch, int idle)
+{
+    PBDP_TRR   *trr;
+    uint32_t    now, bits;
+    int         i;
+
+    now  = bsp_timestamp();
+    bits = PBDP_US2BITS(now - PBDP_Bus.stat.last);
+    PBDP_Bus.stat.last = now;
+    PBDP_Bus.stat.chars++;
+
+    if( idle || (bits >= (2 * PBDP_CHAR_BITS)) ) {              /* Start of frame                   */
+        if( PBDP_Bus.req ) {                                    /* Gap of the request and response  */
+            bits = (bits > PBDP_CHAR_BITS) ? (bits - PBDP_CHAR_BITS) : (0);
+            i    = bits / PBDP_Bus.stat.gap_w;
+            PBDP_Bus.stat.gap[ (i < (PBDP_GAP_BINS - 1)) ? (i) : (PBDP_GAP_BINS - 1) ]++;
+        }
+        PBDP_Bus.stat.frames++;
+        PBDP_Bus.start = now;
+        PBDP_Bus.idx   = 0;
+        PBDP_Bus.sd    = (uint8_t)ch;
+        PBDP_Bus.req   = 0;
+        return;
+    }
+
+    PBDP_Bus.idx++;
+    switch( PBDP_Bus.sd ) {
+    case PBDP_FRAME_SD1:
+    case PBDP_FRAME_SD3:
+        if( PBDP_Bus.idx == 1 ) {  PBDP_Bus.da = (uint8_t)(ch & 0x7F);  }
+        if( PBDP_Bus.idx == 3 ) {  goto BUS_FC;  }
+        break;
+    case PBDP_FRAME_SD2:
+        if( PBDP_Bus.idx == 4 ) {  PBDP_Bus.da = (uint8_t)(ch & 0x7F);  }
+        if( PBDP_Bus.idx == 6 ) {  goto BUS_FC;  }
+        break;
+    case PBDP_FRAME_SD4:
+        if( PBDP_Bus.idx != 2 ) {  break;  }
+        for(i = 0;  i < PBDP_MASTER_NUM;  i++) {                /* Token rotation of the master(SA) */
+            trr = &PBDP_Bus.stat.trr[i];
+            if( trr->addr == (ch & 0x7F) ) {
+                trr->cnt += 1;
+                trr->sum += PBDP_Bus.start - trr->last;
+                trr->max  = ((PBDP_Bus.start - trr->last) > trr->max) ? (PBDP_Bus.start - trr->last) : (trr->max);
+                trr->last = PBDP_Bus.start;
+                break;
+            }
+            if( trr->addr == 0xFF ) {
+                trr->last = PBDP_Bus.start;                     /* First token of the master        */
+                trr->addr = (uint8_t)(ch & 0x7F);
+                break;
+            }
+        }
+        break;
+    BUS_FC:
+        PBDP_Bus.req = (ch & 0x40) && !(((ch & 0x4F) == 0x44) || ((ch & 0x4F) == 0x46)) && (PBDP_Bus.da != 127);
+        break;
+    }
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Set PorfiBUS_DP max retry of the requests not replied within slot time
+***
+*** @param[in]  limit   max_retry_limit, (0)No retry
+***********************************************************************************************************/
+
+void PBDP_SetRetry(uint8_t limit)
+{
+    PBDP_Retry = (limit > PBDP_RETRY_MAX) ? (PBDP_RETRY_MAX) : (limit);
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Get PorfiBUS_DP slot time supervision statistic of the stations
+***
+*** @param[out] buff    Output statistic information string
+*** @param[in]  size    size of buff(in bytes)
+***
+*** @return     (< 0)Error. (other)number of output char, not counting the terminating null char
+***********************************************************************************************************/
+
+int PBDP_SlotStatc(char *buff, int size)
+{
+    int     i, n, m;
+
+    if( (buff == NULL) || (size <= 0) )  { return( 0 );        }
+
+    n = snprintf(buff, size, "Slot: %u(bits) Retry: %u", PBDP_Tim->tsl, PBDP_Retry);
+    for(i = 0;  (i < PBDP_STATION_NUM) && (n >= 0) && (n < size);  i++) {
+        if( (PBDP_Slot[i].retry == 0) && (PBDP_Slot[i].fail == 0) ) {
+            continue;                                           /* Station always replied           */
+        }
+        m = snprintf( &buff[n], size - n, ", [%d] %u/%u/%u(REQ/RETRY/FAIL)",
+                      i, PBDP_Slot[i].req, PBDP_Slot[i].retry, PBDP_Slot[i].fail );
+        if( m < 0 ) /******************/ { break;              }
+        n += m;
+    }
+    if( n < 0 ) /**********************/ { return( n );        }
+    if( n >= size ) /******************/ { return( size - 1 ); }
+    return( n );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Get PorfiBUS_DP counter of Receive Queue Overrun error
+***
+*** @return     Counter of the frames with chars lost by Receive Queue Overrun
+***********************************************************************************************************/
+
+uint32_t PBDP_GetOverrun(void)
+{
+    return( METRICS_GET(uart_rx_ovr_frames) );
 }
 
 
@@ -256,6 +492,21 @@ void PBDP_Init(uint32_t baud)
 ***********************************************************************************************************/
 
 int PBDP_Recv(uint8_t buff[260])
+{
+    return( PBDP_RecvWait(buff, osWaitForever) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      PorfiBUS_DP data Receive with timeout
+***
+*** @param[out] buff        Buffer of Recv data
+*** @param[in]  millisec    Timeout of waiting for the frame, osWaitForever for no timeout
+***
+*** @return     Length of Received data, 0 if timeout
+***********************************************************************************************************/
+
+int PBDP_RecvWait(uint8_t buff[260], uint32_t millisec)
 {
 #   define  PBDP_FRAME_COPY_TO_OUT_BUF(size)    for( rx_len = 0;  rx_len < size;  rx_len++ ) {               \
                                                     buff[rx_len]     = QUEUE_GET(PBDP_Info.rx_que, rx_len);  \
@@ -275,12 +526,18 @@ int PBDP_Recv(uint8_t buff[260])
 #   define  GOTO_RET(ret)   { result = ret;  goto RECV_RET; }
 #   define  GOTO_DEL(ret)   { result = ret;  goto RECV_DEL; }
 
-    int         rx_len,  result;
+    int         rx_len,  result,  timed = 0;
+    uint32_t    rel = 0;
 
     if( buff == NULL ) /*************************************/ { return( -1 ); }
     if( osOK != osMutexWait(PBDP_Info.rx_mut, osWaitForever) ) { return( -1 ); }/* osMutexWait Error        */
     PBDP_Info.rx_enb = 1;                                                       /* Receive Enable           */
-    if( osSemaphoreWait(PBDP_Info.rx_sem, osWaitForever) <= 0) { GOTO_RET(-2); }/* Waiting for Received ED  */
+    if( (result = osSemaphoreWait(PBDP_Info.rx_sem, millisec)) <= 0 ) {         /* Waiting for Received ED  */
+        GOTO_RET( (result == 0) ? (0) : (-2) );                                 /* Timeout or Error         */
+    }
+    if( !QUEUE_EMPTY(PBDP_Info.rx_rel) ) {                                      /* Released with the cycles */
+        rel = QUEUE_POP(PBDP_Info.rx_rel);  timed = 1;
+    }
 
     while(1) {
         if(  (rx_len = QUEUE_SIZE(PBDP_Info.rx_que)) <= 0 ) {    GOTO_RET(-3); }/* Receiver Queue is empty  */
@@ -338,6 +595,12 @@ int PBDP_Recv(uint8_t buff[260])
     }       /* End while(1) */
 
     RECV_RET:  if( osOK != osMutexRelease(PBDP_Info.rx_mut) ) { return( -1 ); } /* osMutexRelease Error     */
+    if( timed && (result > 0) ) {
+        METRICS_HIST(lat_dp_wakeup, bsp_cycles() - rel);                        /* ISR to thread wakeup     */
+    }
+    if( result > 0 ) {
+        TRACE(TRACE_SUB_PBDP, TRACE_PBDP_RECV, result);
+    }
     return( result );
 }
 
@@ -353,71 +616,108 @@ int PBDP_Recv(uint8_t buff[260])
 
 int PBDP_Send(const uint8_t *buff, int len)
 {
+    return( PBDP_SendRetry(buff, len, PBDP_Retry) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      PorfiBUS_DP data Send with max retry of the request not replied within slot time
+***
+*** @param[in]  buff    Pointer to Send data
+*** @param[in]  len     Length  of Send data
+*** @param[in]  limit   max_retry_limit, (0)No retry
+***
+*** @return     Length of Send data, (-7)No response within slot time
+***********************************************************************************************************/
+
+int PBDP_SendRetry(const uint8_t *buff, int len, int limit)
+{
+#   define  PBDP_FC_IS_SDN(fc)  ((((fc) & 0x4F) == 0x44) || (((fc) & 0x4F) == 0x46))
+
     static int  g_count = 0;
-    int         cnt;
+    int         cnt, fc, da, retry;
+    uint16_t    tsl;
+    uint32_t    sig, cyc;
     osEvent     evt;
 
     if( (buff == NULL) || (len <= 0) ) /********************/   return( -1 );
-    switch( buff[0] ) {
-    case PBDP_FRAME_SD1:  cnt = (buff[3] & 0x40) ? (3) : (1);   break;
-    case PBDP_FRAME_SD2:  cnt = (buff[6] & 0x40) ? (3) : (1);   break;
-    case PBDP_FRAME_SD3:  cnt = (buff[3] & 0x40) ? (3) : (1);   break;
-    case PBDP_FRAME_SD4:  cnt = 3; /************************/   break;
-    case PBDP_FRAME_SC:   cnt = 1; /************************/   break;
+    switch( buff[0] ) {                                         /* Function code, (-1)Token or SC   */
+    case PBDP_FRAME_SD1:  fc = (len > 3) ? (buff[3]) : (0);     da = (len > 1) ? (buff[1]) : (0);   break;
+    case PBDP_FRAME_SD2:  fc = (len > 6) ? (buff[6]) : (0);     da = (len > 4) ? (buff[4]) : (0);   break;
+    case PBDP_FRAME_SD3:  fc = (len > 3) ? (buff[3]) : (0);     da = (len > 1) ? (buff[1]) : (0);   break;
+    case PBDP_FRAME_SD4:  fc = -1; /************************/   da = 0; /*********************/     break;
+    case PBDP_FRAME_SC:   fc = -1; /************************/   da = 0; /*********************/     break;
     default: /**********************************************/   return( -1 );
     }
+    da &= 0x7F;                                                 /* Without the extension bit        */
+    if( (fc < 0) ? (buff[0] == PBDP_FRAME_SC) : !(fc & 0x40) ) {
+        cnt = PBDP_Tim->min_tsdr;                               /* Response: idle of min Tsdr       */
+    } else {
+        cnt = (PBDP_Info.tx_sdn) ? (PBDP_Tim->tid2)             /* Request or token: idle of Tid2   */
+                                 : (PBDP_Tim->tid1);            /* after SDN, Tid1 after the others */
+    }
+    if( (fc >= 0) && (fc & 0x40) && !PBDP_FC_IS_SDN(fc) && (da != 127) ) {
+        tsl = PBDP_Tim->tsl;                                    /* Request with reply, supervised   */
+        PBDP_SlotInc(&PBDP_Slot[da].req);
+    } else {
+        tsl = 0;
+    }
   //cnt += g_count;// + (osKernelSysTick() & 0x01);
-
-    if( osOK != osMutexWait(PBDP_Info.tx_mut, osWaitForever) )  return( -2 );   /* osMutexWait Error    */
-    {
-        PBDP_UART_DsIRQ();                                          /* UART Interrupt Request Disable   */
-        PBDP_Info.tx_sig = osThreadGetId();
-        PBDP_Info.tx_num = 0;                                       /* Enable to Enter the Send status  */
-        PBDP_Info.tx_buf = buff;                                    /* Pointer to transmit buffer       */
-        PBDP_Info.tx_cnt = len;                                     /* Total of transmit buffer         */
-        PBDP_Info.tx_chk = cnt;                                     /* PBDP synchronization period      */
-        PBDP_UART_EnIRQ();                                          /* USART Interrupt Request Enable   */
-
-//      while( 1 ) {
-//          if( osEventSignal != (evt = osSignalWait(0, osWaitForever)).status )  continue;
-//          if( PBDP_EVENT_IDLE != evt.value.signals )  continue;   /* Waiting for PBDP_EVENT_IDLE      */
-//          if( PBDP_Info.tx_num != 0 )  break;
-//      }
-        evt = osSignalWait(0, osWaitForever);                       /* Waiting for UART Event           */
-
-        PBDP_UART_DsIRQ();                                          /* UART Interrupt Request Disable   */
-        PBDP_Info.tx_num = 0;
-        PBDP_Info.tx_cnt = 0;
-        PBDP_Info.tx_chk = 0;
-        PBDP_Info.tx_buf = NULL;
-        PBDP_Info.tx_sig = NULL;
-        PBDP_UART_EnIRQ();                                          /* USART Interrupt Request Enable   */
+    TRACE_BEGIN(TRACE_SUB_PBDP, TRACE_PBDP_SEND, len);
+
+    for(retry = 0;  ;  retry++) {
+        cyc = bsp_cycles();
+        if( osOK != osMutexWait(PBDP_Info.tx_mut, osWaitForever) )  return( -2 );   /* osMutexWait Error    */
+        METRICS_HIST(lat_dp_txq, bsp_cycles() - cyc);           /* Transmitter used by other threads*/
+        {
+            PBDP_UART_DsIRQ();                                      /* UART Interrupt Request Disable   */
+            PBDP_Info.tx_sig = osThreadGetId();
+            PBDP_Info.tx_num = 0;                                   /* Enable to Enter the Send status  */
+            PBDP_Info.tx_buf = buff;                                /* Pointer to transmit buffer       */
+            PBDP_Info.tx_cnt = len;                                 /* Total of transmit buffer         */
+            PBDP_Info.tx_chk = cnt;                                 /* Idle bits before transmit        */
+            PBDP_Info.tx_tsl = tsl;                                 /* Slot time after transmit         */
+            PBDP_UART_EnIRQ();                                      /* USART Interrupt Request Enable   */
+
+    //      while( 1 ) {
+    //          if( osEventSignal != (evt = osSignalWait(0, osWaitForever)).status )  continue;
+    //          if( PBDP_EVENT_IDLE != evt.value.signals )  continue;   /* Waiting for PBDP_EVENT_IDLE      */
+    //          if( PBDP_Info.tx_num != 0 )  break;
+    //      }
+            cyc = bsp_cycles();
+            evt = osSignalWait(0, osWaitForever);                   /* Waiting for UART Event           */
+            sig = (osEventSignal == evt.status) ? (evt.value.signals) : (0);
+            if( tsl && (sig == PBDP_EVENT_CPLT) ) {                 /* Waiting for Response or Slot time*/
+                evt  = osSignalWait(0, (tsl * 1000u) / PBDP_Tim->baud + 2);
+                sig |= (osEventSignal == evt.status) ? (evt.value.signals) : (PBDP_EVENT_SLOT);
+            }
+            METRICS_HIST(lat_dp_send, bsp_cycles() - cyc);
+
+            PBDP_UART_DsIRQ();                                      /* UART Interrupt Request Disable   */
+            PBDP_Info.tx_num = 0;
+            PBDP_Info.tx_cnt = 0;
+            PBDP_Info.tx_chk = 0;
+            PBDP_Info.tx_tsl = 0;
+            PBDP_Info.rx_tsl = 0;
+            PBDP_Info.tx_buf = NULL;
+            osSignalClear(PBDP_Info.tx_sig, PBDP_EVENT_RESP | PBDP_EVENT_SLOT);
+            PBDP_Info.tx_sig = NULL;
+            PBDP_UART_EnIRQ();                                      /* USART Interrupt Request Enable   */
+        }
+        if( osOK != osMutexRelease(PBDP_Info.tx_mut) )  return( -2 );           /* osMutexRelease Error */
+        if( !(sig & PBDP_EVENT_SLOT) || (retry >= limit) )  break;              /* Replied or no retry  */
+        PBDP_SlotInc(&PBDP_Slot[da].retry);
+        TRACE(TRACE_SUB_PBDP, TRACE_PBDP_RETRY, da);
     }
-    if( osOK != osMutexRelease(PBDP_Info.tx_mut) )  return( -2 );               /* osMutexRelease Error */
 
-    if( osEventSignal != evt.status )/***********/ { len = -3; goto TX_ERR; }   /* osSignalWait Error   */
-    if( evt.value.signals & PBDP_EVENT_ERR )/****/ { len = -4; goto TX_ERR; }
-    if( evt.value.signals & PBDP_EVENT_IDLE )/***/ { len = -5; goto TX_ERR; }
-    if( evt.value.signals != PBDP_EVENT_CPLT )/**/ { len = -6; goto TX_ERR; }
+    if( sig == 0 )/******************************/ { len = -3; goto TX_ERR; }   /* osSignalWait Error   */
+    if( sig & PBDP_EVENT_ERR )/******************/ { len = -4; goto TX_ERR; }
+    if( sig & PBDP_EVENT_IDLE )/*****************/ { len = -5; goto TX_ERR; }
+    if( sig & PBDP_EVENT_SLOT ) {  PBDP_SlotInc(&PBDP_Slot[da].fail);  len = -7; goto TX_ERR; }/* No response       */
+    if( (sig & ~PBDP_EVENT_RESP) != PBDP_EVENT_CPLT ) {  len = -6; goto TX_ERR; }
+    PBDP_Info.tx_sdn = (fc >= 0) && PBDP_FC_IS_SDN(fc);                         /* No reply to SDN      */
     TX_ERR:  g_count = (len <= 0) ? (0) : ((g_count + 1) % 4);
-    //  if( len <= 0 ) {
-    //      printf(   "[ProfiBUS DP] Send invalid data: "
-    //                "*0x%04X* 0x%02X 0x%02X 0x%02X 0x%02X 0x%02X 0x%02X 0x%02X 0x%02X\r\n"
-    //                "              buff: 0x%02X 0x%02X 0x%02X 0x%02X 0x%02X 0x%02X 0x%02X\r\n"
-    //                "              ERR: %d\r\n"
-    //              , (int)(g_EvtIRQ.head % 1024)
-    //              , (int)(g_EvtIRQ.elem[ (g_EvtIRQ.head + (-8)) % __Q_LEN(g_EvtIRQ) ] & 0xFF)
-    //              , (int)(g_EvtIRQ.elem[ (g_EvtIRQ.head + (-7)) % __Q_LEN(g_EvtIRQ) ] & 0xFF)
-    //              , (int)(g_EvtIRQ.elem[ (g_EvtIRQ.head + (-6)) % __Q_LEN(g_EvtIRQ) ] & 0xFF)
-    //              , (int)(g_EvtIRQ.elem[ (g_EvtIRQ.head + (-5)) % __Q_LEN(g_EvtIRQ) ] & 0xFF)
-    //              , (int)(g_EvtIRQ.elem[ (g_EvtIRQ.head + (-4)) % __Q_LEN(g_EvtIRQ) ] & 0xFF)
-    //              , (int)(g_EvtIRQ.elem[ (g_EvtIRQ.head + (-3)) % __Q_LEN(g_EvtIRQ) ] & 0xFF)
-    //              , (int)(g_EvtIRQ.elem[ (g_EvtIRQ.head + (-2)) % __Q_LEN(g_EvtIRQ) ] & 0xFF)
-    //              , (int)(g_EvtIRQ.elem[ (g_EvtIRQ.head + (-1)) % __Q_LEN(g_EvtIRQ) ] & 0xFF)
-    //              , (int)buff[0], (int)buff[1], (int)buff[2], (int)buff[3], (int)buff[4], (int)buff[5], (int)buff[6]
-    //              , len
-    //            );
-    //  }
+    TRACE_FINISH(TRACE_SUB_PBDP, TRACE_PBDP_SEND, len);
     return( len );
 }
 
@@ -430,9 +730,16 @@ int PBDP_Send(const uint8_t *buff, int len)
 
 void PBDP_UART_RecvCB(int ch)
 {
+    PBDP_BusChar(ch & 0xFF, PBDP_Info.idl_cnt);                 /* Bus analytics                        */
     PBDP_IDLE_CNT_CLR();                                        /* Clear Counter of Received IDLE ------*/
 
     if( PBDP_Info.tx_buf == NULL ) {    /*------ Recving -----------------------------------------------*/
+        if( PBDP_Info.rx_tsl ) {
+            PBDP_Stamp.rx_start = PBDP_Bus.stat.last;           /* First char of the response           */
+            PBDP_Stamp.rx_sd    = (uint8_t)ch;
+            PBDP_Info.rx_resp   = 1;
+        }
+        PBDP_SLOT_RESP();                                       /* Response started within Slot time    */
         goto RECV_RECV;
     } else if( PBDP_Info.tx_num != 0 ) {/*------ Sending -----------------------------------------------*/
         if( (ch & 0xFF) != PBDP_Info.tx_buf[PBDP_Info.tx_chk++] ) {
@@ -441,13 +748,18 @@ void PBDP_UART_RecvCB(int ch)
             PBDP_DBG_CHK_INC();
         }
         if( PBDP_Info.tx_chk == PBDP_Info.tx_num ) {
+            PBDP_Stamp.tx_end = PBDP_Bus.stat.last;             /* Last char of the request             */
             PBDP_ENTER_RECV_STA();                              /* Enter the Receive status             */
+            PBDP_Info.rx_tsl = PBDP_Info.tx_tsl;                /* Start the Slot time supervision      */
             PBDP_TX_SIG_SEND(PBDP_EVENT_CPLT);                  /* Transmission complete                */
         }
     } else {                            /*------ PreSend(Recving) --------------------------------------*/
         RECV_RECV: PBDP_RX_QUE_PUSH(ch & 0xFF);                 /* Insert to Receiver queue             */
+        if( PBDP_Info.rx_resp ) {
+            PBDP_Stamp.rx_end = PBDP_Bus.stat.last;             /* Last char of the response so far     */
+        }
         if( PBDP_FRAME_ED == (ch & 0xFF) ) {
-            osSemaphoreRelease(PBDP_Info.rx_sem);               /* Increase count of Received ED        */
+            PBDP_RX_SEM_RELEASE();                              /* Increase count of Received ED        */
         }
         PBDP_DBG_RXD_INC();
     }
@@ -492,26 +804,32 @@ void PBDP_UART_EventCB(int event)
         PBDP_IDLE_CNT_CLR();                                    /* Clear Counter of Received IDLE   */
         PBDP_DBG_ERR_INC();
         if( PBDP_Info.tx_buf == NULL ) {    /*------ Recving ---------------------------------------*/
+            PBDP_SLOT_RESP();                                   /* Response(invalid) within Slot time*/
             goto ERROR_RECV;
         } else if( PBDP_Info.tx_num != 0 ) {/*------ Sending ---------------------------------------*/
             PBDP_ENTER_RECV_STA();                              /* Enter the Receive status         */
             PBDP_TX_SIG_SEND(PBDP_EVENT_ERR);                   /* Set the signal flags             */
         } else {                            /*------ PreSend(Recving) ------------------------------*/
             ERROR_RECV: PBDP_RX_QUE_PUSH(PBDP_FRAME_ED);        /* Insert to Receiver queue         */
-            osSemaphoreRelease(PBDP_Info.rx_sem);               /* Increase Counter of Received ED  */
+            PBDP_RX_SEM_RELEASE();                              /* Increase Counter of Received ED  */
         }
     }
 
     if( event & PBDP_EVENT_IDLE ) { /*-------------- PBDP Event Recv Idle char ---------------------*/
         PBDP_IDLE_CNT_INC();                                    /* Increase Counter of Received IDLE*/
         if( PBDP_Info.tx_buf == NULL ) {    /*------ Recving ---------------------------------------*/
+            if( PBDP_Info.rx_tsl && (PBDP_UART_IdleWait(PBDP_Info.rx_tsl) == 0) ) {
+                PBDP_Info.rx_tsl = 0;
+                PBDP_TX_SIG_SEND(PBDP_EVENT_SLOT);              /* No response within Slot time     */
+            }
             goto IDLE_RECV;
         } else if( PBDP_Info.tx_num != 0 ) {/*------ Sending ---------------------------------------*/
             PBDP_ENTER_RECV_STA();                              /* Enter the Receive status         */
 //          PBDP_TX_SIG_SEND(PBDP_EVENT_IDLE);                  /* Set the signal flags             */
             PBDP_TX_SIG_SEND(PBDP_EVENT_ERR);                   /* Set the signal flags             */
         } else {                            /*------ PreSend(Recving) ------------------------------*/
-            if( PBDP_Info.tx_cnt && PBDP_Info.tx_chk && (PBDP_Info.tx_chk <= PBDP_Info.idl_cnt) ) {
+            if( PBDP_Info.tx_cnt && PBDP_Info.tx_chk && (PBDP_UART_IdleWait(PBDP_Info.tx_chk) == 0) ) {
+                PBDP_Stamp.tx_start = bsp_timestamp();          /* First char of the request        */
                 PBDP_UART_EnDEN();                              /* UART RS485 DE-Pin Enable         */
                 PBDP_Info.tx_num = PBDP_Info.tx_cnt;
                 PBDP_Info.tx_cnt = 0;
@@ -519,8 +837,9 @@ void PBDP_UART_EventCB(int event)
                 PBDP_UART_EnTXE();                              /* UART TXE interrupt Enable        */
             }
             IDLE_RECV: if( PBDP_Info.idl_cnt == 1 ) {
+                PBDP_Info.rx_resp = 0;                          /* End of the response              */
                 PBDP_RX_QUE_PUSH(PBDP_FRAME_ED);                /* Insert to Receiver queue         */
-                osSemaphoreRelease(PBDP_Info.rx_sem);           /* Increase Counter of Received ED  */
+                PBDP_RX_SEM_RELEASE();                          /* Increase Counter of Received ED  */
             }
         }                                   /*------ End if( PBDP_Info.tx_buf == NULL ) ------------*/
     }
@@ -532,48 +851,45 @@ void PBDP_UART_EventCB(int event)
 
 
 /**********************************************************************************************************/
+#ifndef PBDP_UART_SIM                       /* UART driver, or the simulated line of Host/sim_rs485.c   */
 #include    <stdint.h>
 #include    "stm32f4xx.h"
 #include    "ProfiBUS_DP.h"
+#include    "metrics.h"
+#include    "trace.h"
+#include    "isrprof.h"
 
-#ifdef  NDEBUG
-#define PBDP_DBG_EVT_INIT()
-#define PBDP_DBG_EVT_PUSH(m)
-#define PBDP_DBG_ERR_PE_INC()
-#define PBDP_DBG_ERR_FE_INC()
-#define PBDP_DBG_ERR_NE_INC()
-#define PBDP_DBG_ERR_ORE_INC()
-#else
-static QUEUE_TYPE(uint8_t, 1024)      g_EvtIRQ;
-static uint32_t                       g_errstats[4] = {0, 0, 0, 0};
-#define PBDP_DBG_EVT_INIT()         ( QUEUE_INIT(g_EvtIRQ) )
-#define PBDP_DBG_EVT_PUSH(m)        ( QUEUE_PUSH(g_EvtIRQ) = m )
-#define PBDP_DBG_ERR_PE_INC()       ( g_errstats[0]++ )
-#define PBDP_DBG_ERR_FE_INC()       ( g_errstats[1]++ )
-#define PBDP_DBG_ERR_NE_INC()       ( g_errstats[2]++ )
-#define PBDP_DBG_ERR_ORE_INC()      ( g_errstats[3]++ )
-#endif
+#define PBDP_DBG_EVT_PUSH(m, arg)   TRACE(TRACE_SUB_UART, m, arg)   /* Events in all the builds     */
+#define PBDP_DBG_ERR_PE_INC()       METRICS_INC(uart_err_pe)        /* Counters in all the builds   */
+#define PBDP_DBG_ERR_FE_INC()       METRICS_INC(uart_err_fe)
+#define PBDP_DBG_ERR_NE_INC()       METRICS_INC(uart_err_ne)
+#define PBDP_DBG_ERR_ORE_INC()      METRICS_INC(uart_err_ore)
 
 #define PBDP_UART_IDEL_LED_TURN()   (  (GPIOB->ODR   & (0x1u << 1*14))  /* Turn of UART Idel Status LED */ \
                                      ? (GPIOB->BSRRH = (0x1u << 1*14))  /* PB14                         */ \
                                      : (GPIOB->BSRRL = (0x1u << 1*14))                                     \
                                     )
-#define PBDP_UART_IDEL_CHK_EN()     ( TIM3->CR1 |=  TIM_CR1_CEN,        /* Enable Timer3 Counter        */ \
-                                      TIM3->SR   = ~TIM_SR_UIF,                                            \
-                                      TIM3->EGR |=  TIM_EGR_UG                                             \
+#define PBDP_UART_IDEL_CHK_EN()     ( g_IdleBits = PBDP_UART_CHAR_BITS, /* Idle of the IDLE char        */ \
+                                      TIM3->ARR  =  PBDP_UART_IDLE_BITS - 1,                               \
+                                      TIM3->CR1 |=  TIM_CR1_CEN,        /* Enable Timer3 Counter        */ \
+                                      TIM3->EGR |=  TIM_EGR_UG,                                            \
+                                      TIM3->SR   = ~(TIM_SR_UIF | TIM_SR_TIF)                              \
                                     )
 #define PBDP_UART_IDEL_CHK_DS()     ( TIM3->CR1 &= ~TIM_CR1_CEN,        /* Disable Timer3 Counter       */ \
                                       TIM3->SR   = ~TIM_SR_UIF                                             \
                                     )
 
+#define PBDP_UART_CHAR_BITS         (11)    /* Bits of a UART char, the USART IDLE flag set after it    */
+#define PBDP_UART_IDLE_BITS         (11)    /* Period of TIM3 idle check(bits) if no transmit waiting   */
+
+static uint32_t     g_IdleBits;             /* Idle bits of the bus at the last TIM3 update             */
+
 /**
   * @brief      UART Initialize
   * @param[in]  BaudRate    UART BaudRate
   */
 void PBDP_UART_Init(uint32_t BaudRate)
 {
-    PBDP_DBG_EVT_INIT();
-
     /*------------------------------------------ Init TxD(PC6) and RxD(PC7) --------------------------------*/
     MODIFY_REG(RCC->AHB1ENR,   0                                /* Enable GPIOC clock                       */
                            ,   RCC_AHB1ENR_GPIOCEN);
@@ -655,10 +971,11 @@ void PBDP_UART_Init(uint32_t BaudRate)
     /*------------------------------------------ Init Timer 3 ----------------------------------------------*/
     MODIFY_REG(RCC->APB1ENR,   0                                /* Enable Timer 3 clock                     */
                            ,   RCC_APB1ENR_TIM3EN);
-    MODIFY_REG(TIM3->ARR,      0xFFFF                           /* Auto-reload value                        */
-                        ,      (((HAL_RCC_GetPCLK1Freq() * (11 + 1) + (BaudRate / 2)) / BaudRate) - 1));
-    MODIFY_REG(TIM3->PSC,      0xFFFF
-                        ,      1);                              /* Prescaler value                          */
+    MODIFY_REG(TIM3->ARR,      0xFFFF                           /* Auto-reload value: PBDP_UART_IDLE_BITS   */
+                        ,      PBDP_UART_IDLE_BITS - 1);
+    MODIFY_REG(TIM3->PSC,      0xFFFF                           /* Prescaler value: 1 bit time per count,   */
+                        ,      (((HAL_RCC_GetPCLK1Freq() * 2 + (BaudRate / 2)) / BaudRate) - 1));
+                                                                /* TIM3 clock is (2 x PCLK1)                */
     MODIFY_REG(TIM3->CR1,      0xFFFF, 0
                           /*   TIM_CR1_CKD   */                 /* Clock division: 00                       */
                           /* | TIM_CR1_ARPE  */                 /* Auto-reload preload disable              */
@@ -696,6 +1013,27 @@ void PBDP_UART_Init(uint32_t BaudRate)
     NVIC_EnableIRQ(TIM3_IRQn);                                  /* Enable the Timer 3 global Interrupt      */
 }
 
+/**
+  * @brief      Wait for the bus idle before transmit, called in the UART or Timer interrupt only
+  * @param[in]  bits    Idle bits needed since the last char on the bus
+  * @return     (0)Bus is idle of (bits), (other)Bits to wait, TIM3 update at the end of the bits
+  */
+int PBDP_UART_IdleWait(uint32_t bits)
+{
+    uint32_t    arr;
+
+    if( (g_IdleBits + TIM3->CNT) >= bits ) {
+        return( 0 );
+    }
+    arr = bits - g_IdleBits;                    /* Counts to the end of the idle bits       */
+    TIM3->ARR = (arr > 0x10000) ? (0xFFFF) : (arr - 1);
+    if( TIM3->CNT >= TIM3->ARR ) {              /* Bus was idle of (bits) while writing ARR */
+        TIM3->ARR = PBDP_UART_IDLE_BITS - 1;
+        return( 0 );
+    }
+    return( bits - (g_IdleBits + TIM3->CNT) );
+}
+
 /**
   * @brief  UART RS485 DE-Pin Enable
   */
@@ -752,54 +1090,59 @@ void PBDP_UART_DsIRQ(void)
   */
 void USART6_IRQHandler(void)
 {
-    uint32_t    tmp1;
+    uint32_t    tmp1, start, src = 0;
     int32_t     tmp3;
 
+    start = ISRPROF_BEGIN();
     if( ((tmp3 = 0, tmp1 = USART6->SR) & USART_SR_RXNE) && (USART6->CR1 & USART_CR1_RXNEIE) ) {
         PBDP_UART_IDEL_CHK_DS();
         if( tmp1 & USART_SR_PE ) {              /* USART parity error interrupt occurred    */
-            PBDP_DBG_EVT_PUSH(1);
+            PBDP_DBG_EVT_PUSH(TRACE_UART_PE, tmp1);
             PBDP_DBG_ERR_PE_INC();
             PBDP_UART_EventCB(PBDP_EVENT_ERR);
             tmp3 = USART6->SR;  tmp3 = USART6->DR;  // Clear flag
             tmp3 = 1;
         }
         if( tmp1 & USART_SR_FE ) {              /* USART frame error interrupt occurred     */
-            PBDP_DBG_EVT_PUSH(2);
+            PBDP_DBG_EVT_PUSH(TRACE_UART_FE, tmp1);
             PBDP_DBG_ERR_FE_INC();
             PBDP_UART_EventCB(PBDP_EVENT_ERR);
             tmp3 = USART6->SR;  tmp3 = USART6->DR;  // Clear flag
             tmp3 = 1;
         }
         if( tmp1 & USART_SR_NE ) {              /* USART noise error interrupt occurred     */
-            PBDP_DBG_EVT_PUSH(3);
+            PBDP_DBG_EVT_PUSH(TRACE_UART_NE, tmp1);
             PBDP_DBG_ERR_NE_INC();
             PBDP_UART_EventCB(PBDP_EVENT_ERR);
             tmp3 = USART6->SR;  tmp3 = USART6->DR;  // Clear flag
             tmp3 = 1;
         }
         if( tmp1 & USART_SR_ORE ) {             /* USART Over-Run error interrupt occurred  */
-            PBDP_DBG_EVT_PUSH(4);
+            PBDP_DBG_EVT_PUSH(TRACE_UART_ORE, tmp1);
             PBDP_DBG_ERR_ORE_INC();
             PBDP_UART_EventCB(PBDP_EVENT_ERR);
             tmp3 = USART6->SR;  tmp3 = USART6->DR;  // Clear flag
             tmp3 = 1;
         }
+        src |= (tmp3 == 0) ? ISRPROF_BIT(ISRPROF_SRC_RXNE) : ISRPROF_BIT(ISRPROF_SRC_ERR);
         if( tmp3 == 0 ) {                       /* USART Receive data register not empty    */
-            PBDP_DBG_EVT_PUSH(8);
-            PBDP_UART_RecvCB(USART6->DR);
+            tmp3 = USART6->DR;
+            PBDP_DBG_EVT_PUSH(TRACE_UART_RXNE, tmp3);
+            PBDP_UART_RecvCB(tmp3);
         }
     }
 
     if( (tmp1 & USART_SR_TXE) && (USART6->CR1 & USART_CR1_TXEIE) ) {
         PBDP_UART_IDEL_CHK_DS();                /* USART Transmit data register empty       */
-        PBDP_DBG_EVT_PUSH(7);
+        PBDP_DBG_EVT_PUSH(TRACE_UART_TXE, tmp1);
+        src |= ISRPROF_BIT(ISRPROF_SRC_TXE);
         if( ((tmp3 = PBDP_UART_SendCB()) & (~0xFFu)) == 0 ) { USART6->DR = tmp3 & 0xFF; }
     }
 
     if( (tmp1 & USART_SR_TC) && (USART6->CR1 & USART_CR1_TCIE) ) {
       //PBDP_UART_IDEL_CHK_EN();                /* USART Transmission complete              */
-        PBDP_DBG_EVT_PUSH(6);
+        PBDP_DBG_EVT_PUSH(TRACE_UART_TC, tmp1);
+        src |= ISRPROF_BIT(ISRPROF_SRC_TC);
         PBDP_UART_EventCB(PBDP_EVENT_CPLT);
         WRITE_REG(USART6->SR, ~USART_SR_TC);    // Clear flag
     }
@@ -807,10 +1150,12 @@ void USART6_IRQHandler(void)
     if( (tmp1 & USART_SR_IDLE) && (USART6->CR1 & USART_CR1_IDLEIE) ) {
         PBDP_UART_IDEL_CHK_EN();                /* USART line IDLE occurred    (Clear flag) */
         PBDP_UART_IDEL_LED_TURN();
-        PBDP_DBG_EVT_PUSH(5);
+        PBDP_DBG_EVT_PUSH(TRACE_UART_IDLE, tmp1);
+        src |= ISRPROF_BIT(ISRPROF_SRC_IDLE);
         PBDP_UART_EventCB(PBDP_EVENT_IDLE);
         tmp3 = USART6->SR;  tmp3 = USART6->DR;  // Clear flag
     }
+    ISRPROF_END(src, start);
 }
 
 /**
@@ -818,15 +1163,25 @@ void USART6_IRQHandler(void)
   */
 void TIM3_IRQHandler(void)
 {
+    uint32_t    start = ISRPROF_BEGIN();
+
     if( READ_BIT(TIM3->SR, TIM_SR_UIF) && READ_BIT(TIM3->DIER, TIM_DIER_UIE) ) {
-        if( READ_BIT(GPIOC->IDR, 0x1u << (1*8)) ) {
+        WRITE_REG(TIM3->SR, ~TIM_SR_UIF);   // Clear interrupt flag
+        if( READ_BIT(TIM3->SR, TIM_SR_TIF) ) {
+            WRITE_REG(TIM3->SR, ~TIM_SR_TIF);
+            g_IdleBits = 0;                 // Edge on TI1 since the last update, the bus is not idle
+            TIM3->ARR  = PBDP_UART_IDLE_BITS - 1;
+        } else if( READ_BIT(GPIOC->IDR, 0x1u << (1*8)) ) {
+            g_IdleBits += TIM3->ARR + 1;
+            TIM3->ARR   = PBDP_UART_IDLE_BITS - 1;
             PBDP_UART_IDEL_LED_TURN();      // TIM3_CH3(PC8)
-            PBDP_DBG_EVT_PUSH(9);
+            PBDP_DBG_EVT_PUSH(TRACE_UART_TIM, g_IdleBits);
             PBDP_UART_EventCB(PBDP_EVENT_IDLE);
         }
-        WRITE_REG(TIM3->SR, ~TIM_SR_UIF);   // Clear interrupt flag
+        ISRPROF_END(ISRPROF_BIT(ISRPROF_SRC_TIM), start);
     }
 }
+#endif  /* PBDP_UART_SIM */
 
 /*****************************  END OF FILE  **************************************************************/
 /** @}
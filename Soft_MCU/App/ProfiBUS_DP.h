@@ -31,6 +31,63 @@ extern  "C"
 #define PBDP_EVENT_IDLE     (0x1u << 1)             /* PBDP Event Recv Idle char        */
 #define PBDP_EVENT_TRCP     (0x1u << 2)             /* PBDP Event Transmission complete */
 
+#define PBDP_GAP_BINS       16                      /* Bins of request to response gap histogram*/
+#define PBDP_MASTER_NUM     4                       /* Max number of masters of token rotation  */
+#define PBDP_STATION_NUM    128                     /* Number of station address                */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 PROFIBUS_DP_Exported_Types
+*** @{
+***********************************************************************************************************/
+
+typedef struct {    /*------------- Bus parameters of a baud rate, in bits ------------------------*/
+    uint32_t                    baud;       /* Baud rate                        */
+    uint16_t                    tsl;        /* Slot time                        */
+    uint16_t                    min_tsdr;   /* Min station delay of responders  */
+    uint16_t                    max_tsdr;   /* Max station delay of responders  */
+    uint16_t                    tsyn;       /* Synchronization time             */
+    uint16_t                    tid1;       /* Idle time after the reply        */
+    uint16_t                    tid2;       /* Idle time after SDN              */
+    uint16_t                    tset;       /* Setup time                       */
+    uint16_t                    tqui;       /* Quiet time of the modulator      */
+} PBDP_TIMING;
+
+typedef struct {    /*------------- Token rotation of a master ----------------------------------*/
+    uint8_t                     addr;       /* Address of the master, 0xFF for not used */
+    uint8_t                     rsv[3];     /* Reserved                         */
+    uint32_t                    last;       /* Timestamp(us) of the last token  */
+    uint32_t                    cnt;        /* Counter of token rotations       */
+    uint32_t                    sum;        /* Sum of token rotation time(us)   */
+    uint32_t                    max;        /* Max token rotation time(us), cleared by the reader   */
+} PBDP_TRR;
+
+typedef struct {    /*------------- Bus analytics, cumulative counters ------------------------------*/
+    uint32_t                    last;       /* Timestamp(us) of the last char   */
+    uint32_t                    frames;     /* Counter of frames on the bus     */
+    uint32_t                    chars;      /* Counter of chars on the bus      */
+    uint16_t                    gap_w;      /* Bits of a gap bin, the last bin for (>= Tslot)   */
+    uint16_t                    rsv;        /* Reserved                         */
+    uint32_t                    gap[PBDP_GAP_BINS];     /* Request to response gap histogram    */
+    PBDP_TRR                    trr[PBDP_MASTER_NUM];   /* Token rotation of the masters        */
+} PBDP_BUS_STAT;
+
+typedef struct {    /*------------- Timestamps(us) of the last request with reply ---------------------*/
+    uint32_t                    tx_start;   /* First char of the request sent   */
+    uint32_t                    tx_end;     /* Last char of the request sent    */
+    uint32_t                    rx_start;   /* First char of the response       */
+    uint32_t                    rx_end;     /* Last char of the response        */
+    uint8_t                     rx_sd;      /* First char of the response, SD or SC */
+    uint8_t                     rsv[3];     /* Reserved                         */
+} PBDP_STAMP;
+
+typedef struct {    /*------------- Slot time supervision of a station ------------------------------*/
+    uint32_t                    req;        /* Counter of requests with reply   */
+    uint32_t                    retry;      /* Counter of retries               */
+    uint32_t                    fail;       /* Counter of requests not replied  */
+} PBDP_SLOT;
+
 
 /**********************************************************************************************************/
 /** @}
@@ -39,10 +96,18 @@ extern  "C"
 ***********************************************************************************************************/
 
 /* ProfiBUS DP User function */
-extern int  PBDP_Statc(char* buff, int size);
 extern void PBDP_Init(uint32_t baud);
 extern int  PBDP_Recv(uint8_t buff[260]);
+extern int  PBDP_RecvWait(uint8_t buff[260], uint32_t millisec);
 extern int  PBDP_Send(const uint8_t *buff, int len);
+extern int  PBDP_SendRetry(const uint8_t *buff, int len, int limit);
+extern uint32_t PBDP_GetOverrun(void);
+extern const PBDP_TIMING* PBDP_GetTiming(void);
+extern void PBDP_SetRetry(uint8_t limit);
+extern int  PBDP_SlotStatc(char *buff, int size);
+extern PBDP_BUS_STAT* PBDP_GetBusStat(void);
+extern const PBDP_STAMP* PBDP_GetStamp(void);
+extern const PBDP_SLOT* PBDP_GetSlot(int da);
 
 /* ProfiBUS DP Uart callback function */
 extern void PBDP_UART_RecvCB(int ch);
@@ -57,6 +122,7 @@ extern void PBDP_UART_EnTXE(void);
 extern void PBDP_UART_DsTXE(void);
 extern void PBDP_UART_EnIRQ(void);
 extern void PBDP_UART_DsIRQ(void);
+extern int  PBDP_UART_IdleWait(uint32_t bits);
 
 /*****************************  END OF FILE  **************************************************************/
 /** @}
@@ -0,0 +1,561 @@
+/**********************************************************************************************************/
+/** @file     backlog.c
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    Store-and-forward backlog of ProfiBUS_DP frames across Ethernet LinkDown.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************/
+
+#include    <stdint.h>
+#include    <stdio.h>
+#include    <string.h>
+#include    <assert.h>
+
+#include    "cmsis_os.h"                /* CMSIS RTOS definitions             */
+#include    "rl_fs.h"                   /* FileSystem definitions             */
+
+#include    "cfg.h"
+#include    "board.h"
+#include    "net_user.h"
+#include    "profiler.h"
+#include    "backlog.h"
+
+
+/**********************************************************************************************************/
+/** @addtogroup BACKLOG
+*** @{
+*** @addtogroup BACKLOG_Pravate
+*** @{
+*** @addtogroup                 BACKLOG_Private_Constants
+*** @{
+***********************************************************************************************************/
+
+#define BACKLOG_RAM_LEN     (16 * 1024)                             /* must be (2 ^ n)                  */
+#define BACKLOG_FRAME_MAX   (256 + 16)                              /* Max length of a stored DP frame  */
+#define BACKLOG_BURST       8                                       /* Max frames replayed in a burst   */
+#define BACKLOG_SPILL_AT    (BACKLOG_RAM_LEN / 4)                   /* RAM ring used to start a spill   */
+#define BACKLOG_SEG_NUM     4                                       /* Segment files of the spill       */
+#define BACKLOG_FILE        "F0:backlog%u.dat"                      /* Segment file on NOR Flash        */
+#define BACKLOG_LINK_POLL   100                                     /* Wait for LinkUp(ms)              */
+#define BACKLOG_SIG_SPILL   (0x1u << 0)                             /* Signal of RAM ring need spill    */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 BACKLOG_Private_Types
+*** @{
+***********************************************************************************************************/
+
+typedef struct {    /*------------- Header of a stored frame, followed by the frame ---------------*/
+    uint16_t                    len;        /* Length of the DP frame           */
+    uint8_t                     act;        /* Action of the filter rules, ref: DP_FILTER_ACT.idx */
+    uint8_t                     rsv;        /* Reserved                         */
+    uint32_t                    seq;        /* Sequence number of the DP frame  */
+    uint32_t                    stamp;      /* Timestamp of the DP frame(us)    */
+    uint32_t                    tick;       /* os_time when stored, retention   */
+} BACKLOG_REC;
+
+typedef struct {    /*------------- Backlog Information (Run-Time) --------------------------------
+                    -- (head) and the replay by thread_dp2net only, the spill by thread_backlog ---
+                    -- only, the others under (mutex). The frames [tail, head) being spilled are ---
+                    -- neither popped nor dropped from the RAM ring while (spilling) --------------*/
+    int                         enable;     /* Backlog enable                   */
+    int                         policy;     /* On overflow (0)Drop oldest, (1)Drop newest   */
+    volatile int                nor;        /* Spill to NOR Flash enable        */
+    uint32_t                    retain;     /* Retention(ms), (0)No limit       */
+    uint32_t                    interval;   /* Replay interval(us)              */
+    uint32_t                    seg_max;    /* Max size of a segment file(Byte) */
+    osThreadId                  tid;        /* Thread of the spill              */
+    osMutexId                   mutex;
+
+    uint32_t                    head;       /* RAM ring head(free running)      */
+    uint32_t                    tail;       /* RAM ring tail(free running)      */
+    uint32_t                    ram_frm;    /* Frames in RAM ring               */
+    volatile int                spilling;   /* RAM ring [tail, head) being spilled  */
+    uint32_t                    seg_rd;     /* Segment replayed, the oldest(free running)   */
+    uint32_t                    seg_wr;     /* Segment spilled to, the newest(free running) */
+    uint32_t                    seg_len[BACKLOG_SEG_NUM];   /* Length of segment files  */
+    uint32_t                    seg_frm[BACKLOG_SEG_NUM];   /* Frames in segment files  */
+    FILE                       *file;       /* Segment file opened for replay   */
+    uint32_t                    file_pos;   /* Replay position of segment file  */
+    uint32_t                    file_frm;   /* Frames in segment files          */
+    uint32_t                    last;       /* bsp_timestamp() of last replay   */
+
+    uint32_t                    stored;     /* Counter of frames stored         */
+    uint32_t                    replayed;   /* Counter of frames replayed       */
+    uint32_t                    spilled;    /* Counter of frames spilled to NOR */
+    uint32_t                    drop_old;   /* Counter of oldest frames dropped */
+    uint32_t                    drop_new;   /* Counter of newest frames dropped */
+    uint32_t                    expired;    /* Counter of frames out of retention   */
+} BACKLOG_INFO;
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 BACKLOG_Private_Prototypes
+*** @{
+***********************************************************************************************************/
+
+static void thread_backlog(void const *arg);
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 BACKLOG_Private_Variables
+*** @{
+***********************************************************************************************************/
+
+static BACKLOG_INFO         g_Backlog;
+static uint8_t              g_BacklogRam[BACKLOG_RAM_LEN];
+static osMutexDef           (backlog_mut);
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 BACKLOG_Private_Functions
+*** @{
+***********************************************************************************************************/
+/** @brief      Copy data into or out of the RAM ring.
+***
+*** @param[in]  pos     Position in the RAM ring(free running)
+*** @param[in]  data    Pointer to the data
+*** @param[in]  len     Length  of the data
+***********************************************************************************************************/
+
+static void backlog_ram_put(uint32_t pos, const void *data, uint32_t len)
+{
+    const uint8_t  *p = (const uint8_t*)data;
+
+    while( len-- > 0 ) {
+        g_BacklogRam[(pos++) % BACKLOG_RAM_LEN] = *p++;
+    }
+}
+
+static void backlog_ram_get(uint32_t pos, void *data, uint32_t len)
+{
+    uint8_t        *p = (uint8_t*)data;
+
+    while( len-- > 0 ) {
+        *p++ = g_BacklogRam[(pos++) % BACKLOG_RAM_LEN];
+    }
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Get the file name of a segment.
+***
+*** @param[out] name    Buffer of the file name, 20 chars at least
+*** @param[in]  seg     Segment(free running)
+***********************************************************************************************************/
+
+static void backlog_seg_name(char *name, uint32_t seg)
+{
+    sprintf(name, BACKLOG_FILE, (unsigned)(seg % BACKLOG_SEG_NUM));
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Drop the oldest segment, the frames not replayed are counted as the oldest dropped. The
+***             file is deleted when the segment is reused, ref: backlog_spill(). Called with (mutex).
+***********************************************************************************************************/
+
+static void backlog_seg_drop(void)
+{
+    uint32_t    rd = g_Backlog.seg_rd % BACKLOG_SEG_NUM;
+
+    if( g_Backlog.file != NULL ) {
+        fclose(g_Backlog.file);
+        g_Backlog.file = NULL;
+    }
+    g_Backlog.drop_old += g_Backlog.seg_frm[rd];
+    g_Backlog.file_frm -= g_Backlog.seg_frm[rd];
+    g_Backlog.seg_frm[rd] = 0;
+    g_Backlog.seg_len[rd] = 0;
+    g_Backlog.file_pos    = 0;
+    if( g_Backlog.seg_rd == g_Backlog.seg_wr ) {
+        g_Backlog.seg_wr++;                             // The only segment, rewritten from the start
+    }
+    g_Backlog.seg_rd++;
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Spill all frames of the RAM ring to the newest segment file, by thread_backlog only.
+***
+***             The frames are written without (mutex), thread_dp2net neither pops nor drops them from
+***             the RAM ring while (spilling). A new segment is started when the newest is full or being
+***             replayed; if all the segments are in use, the oldest segment is dropped by the policy
+***             OLDEST, or the spill waits for the replay by the policy NEWEST.
+***********************************************************************************************************/
+
+static void backlog_spill(void)
+{
+    FILE       *fp;
+    char        name[24];
+    uint32_t    tail, head, frm, wr, pos, n;
+    int         fresh;
+
+    osMutexWait(g_Backlog.mutex, osWaitForever);
+    tail = g_Backlog.tail;
+    head = g_Backlog.head;
+    frm  = g_Backlog.ram_frm;
+    wr   = g_Backlog.seg_wr % BACKLOG_SEG_NUM;
+    if( !g_Backlog.nor || (frm == 0) ) {
+        osMutexRelease(g_Backlog.mutex);
+        return;
+    }
+    if(   ((g_Backlog.seg_len[wr] + (head - tail)) > g_Backlog.seg_max)
+       || ((g_Backlog.file != NULL) && (g_Backlog.seg_rd == g_Backlog.seg_wr)) ) {
+        if( (g_Backlog.seg_wr - g_Backlog.seg_rd) >= (BACKLOG_SEG_NUM - 1) ) {
+            if( g_Backlog.policy ) {                    // All the segments in use
+                osMutexRelease(g_Backlog.mutex);        // NEWEST: dropped by backlog_push() when full
+                return;
+            }
+            backlog_seg_drop();                         // OLDEST: drop the head of the files
+        }
+        g_Backlog.seg_wr++;
+        wr = g_Backlog.seg_wr % BACKLOG_SEG_NUM;
+        g_Backlog.seg_len[wr] = 0;
+        g_Backlog.seg_frm[wr] = 0;
+    }
+    fresh = (g_Backlog.seg_len[wr] == 0);
+    g_Backlog.spilling = 1;
+    osMutexRelease(g_Backlog.mutex);
+
+    backlog_seg_name(name, g_Backlog.seg_wr);
+    if( (fp = fopen(name, fresh ? "wb" : "ab")) == NULL ) {
+        goto SPILL_ERR;
+    }
+    for(pos = tail;  pos != head;  pos += n) {
+        n = BACKLOG_RAM_LEN - (pos % BACKLOG_RAM_LEN);
+        n = ((head - pos) < n) ? (head - pos) : (n);
+        if( fwrite(&g_BacklogRam[pos % BACKLOG_RAM_LEN], 1, n, fp) != n ) {
+            fclose(fp);                                 // The tail of the file is ignored,
+            goto SPILL_ERR;                             //   only seg_len bytes are replayed
+        }
+    }
+    fclose(fp);
+
+    osMutexWait(g_Backlog.mutex, osWaitForever);
+    g_Backlog.seg_len[wr] += head - tail;
+    g_Backlog.seg_frm[wr] += frm;
+    g_Backlog.file_frm    += frm;
+    g_Backlog.spilled     += frm;
+    g_Backlog.tail         = head;
+    g_Backlog.ram_frm     -= frm;
+    g_Backlog.spilling     = 0;
+    osMutexRelease(g_Backlog.mutex);
+    return;
+
+  SPILL_ERR:
+    g_Backlog.nor      = 0;
+    g_Backlog.spilling = 0;
+    printf("[BACKLOG] Write %s failed, spill disabled!\r\n", name);
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Thread of the spill to NOR Flash, at low priority off the path of thread_dp2net.
+***********************************************************************************************************/
+
+static void thread_backlog(void const *arg)
+{
+    (void)arg;
+    for(; ;) {
+        osSignalWait(BACKLOG_SIG_SPILL, osWaitForever);
+        backlog_spill();
+    }
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Pop the oldest frame, from the segment files first and then the RAM ring.
+***
+*** @param[out] buff    Buffer of the DP frame, BACKLOG_FRAME_MAX bytes
+*** @param[out] rec     Header of the DP frame
+***
+*** @return     Length of the DP frame, (0)Backlog is empty or the oldest frames being spilled.
+***********************************************************************************************************/
+
+static int backlog_pop(uint8_t *buff, BACKLOG_REC *rec)
+{
+    char        name[24];
+    uint32_t    rd;
+    int         len = 0;
+
+    osMutexWait(g_Backlog.mutex, osWaitForever);
+    rd = g_Backlog.seg_rd % BACKLOG_SEG_NUM;
+    while( (g_Backlog.file_frm > 0) && (g_Backlog.seg_frm[rd] == 0) ) {
+        g_Backlog.seg_rd++;                             // Segments replayed or dropped
+        rd = g_Backlog.seg_rd % BACKLOG_SEG_NUM;
+    }
+    if( (g_Backlog.file_frm > 0) && !(g_Backlog.spilling && (g_Backlog.seg_rd == g_Backlog.seg_wr)) ) {
+        if( g_Backlog.file == NULL ) {
+            backlog_seg_name(name, g_Backlog.seg_rd);
+            if(   ((g_Backlog.file = fopen(name, "rb")) == NULL)
+               || (fseek(g_Backlog.file, g_Backlog.file_pos, SEEK_SET) != 0) ) {
+                goto FILE_ERR;
+            }
+        }
+        if(   (fread(rec, 1, sizeof(*rec), g_Backlog.file) != sizeof(*rec))
+           || (rec->len == 0) || (rec->len > BACKLOG_FRAME_MAX)
+           || (fread(buff, 1, rec->len, g_Backlog.file) != rec->len) ) {
+            goto FILE_ERR;
+        }
+        g_Backlog.file_pos += sizeof(*rec) + rec->len;
+        g_Backlog.file_frm--;
+        if( --g_Backlog.seg_frm[rd] == 0 ) {            // Segment replayed, deleted when reused
+            fclose(g_Backlog.file);
+            g_Backlog.file        = NULL;
+            g_Backlog.file_pos    = 0;
+            g_Backlog.seg_len[rd] = 0;
+            if( g_Backlog.seg_rd != g_Backlog.seg_wr ) {
+                g_Backlog.seg_rd++;
+            }
+        }
+        len = rec->len;
+        goto POP_RET;
+
+      FILE_ERR:
+        printf("[BACKLOG] Read segment %u failed, %u frames lost!\r\n", rd, g_Backlog.seg_frm[rd]);
+        backlog_seg_drop();
+    }
+
+    if( (g_Backlog.file_frm == 0) && (g_Backlog.ram_frm > 0) && !g_Backlog.spilling ) {
+        backlog_ram_get(g_Backlog.tail, rec, sizeof(*rec));
+        backlog_ram_get(g_Backlog.tail + sizeof(*rec), buff, rec->len);
+        g_Backlog.tail += sizeof(*rec) + rec->len;
+        g_Backlog.ram_frm--;
+        len = rec->len;
+    }
+  POP_RET:
+    osMutexRelease(g_Backlog.mutex);
+    return( len );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Initialize the backlog from the config file.
+***********************************************************************************************************/
+
+void backlog_init(void)
+{
+    static osThreadDef(thread_backlog, osPriorityLow, 1, 0);
+    char        name[24];
+    uint32_t    rate;
+    int         i;
+
+    memset(&g_Backlog, 0, sizeof(g_Backlog));
+    if( !(g_Backlog.enable = cfg_get_backlog()) ) {
+        return;
+    }
+    g_Backlog.policy  = cfg_get_backlog_policy();
+    g_Backlog.nor     = cfg_get_backlog_nor();
+    g_Backlog.seg_max = cfg_get_backlog_nor_max() / BACKLOG_SEG_NUM;
+    g_Backlog.seg_max = (g_Backlog.seg_max > BACKLOG_RAM_LEN) ? (g_Backlog.seg_max) : (BACKLOG_RAM_LEN);
+    g_Backlog.retain  = cfg_get_backlog_retain() * 1000;
+    rate              = cfg_get_backlog_rate();
+    g_Backlog.interval= 1000000 / ((rate > 0) ? (rate) : (1));
+    g_Backlog.mutex   = osMutexCreate(osMutex(backlog_mut));
+    if( g_Backlog.nor ) {
+        for(i = 0;  i < BACKLOG_SEG_NUM;  i++) {        // Retention of the last boot is unknown
+            backlog_seg_name(name, i);
+            fdelete(name, NULL);
+        }
+        if( (g_Backlog.tid = osThreadCreate(osThread(thread_backlog), NULL)) == NULL ) {
+            printf("[BACKLOG] Create spill thread failed, spill disabled!\r\n");
+            g_Backlog.nor = 0;
+        }
+        profiler_name(g_Backlog.tid, "backlog");
+    }
+    printf( "[BACKLOG] Enabled, RAM: %u(Byte), NOR: %u x %u(Byte), Retain: %u(s), Rate: %u(Frame/s), Drop: %s\r\n"
+          , BACKLOG_RAM_LEN, g_Backlog.nor ? BACKLOG_SEG_NUM : 0, g_Backlog.seg_max, g_Backlog.retain / 1000, rate
+          , g_Backlog.policy ? "NEWEST" : "OLDEST"
+          );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Store a ProfiBUS_DP frame while Ethernet LinkDown.
+***
+***             With the spill to NOR Flash, the RAM ring is spilled by thread_backlog once BACKLOG_SPILL_AT
+***             bytes are used, and the overflow policy is applied to the segment files; a frame finding
+***             the RAM ring full meanwhile is dropped as the newest. Without the spill, the newest frame
+***             (this one) or the oldest frames of the RAM ring are dropped by the overflow policy.
+***
+*** @param[in]  buff    Pointer to the DP frame
+*** @param[in]  len     Length  of the DP frame
+*** @param[in]  seq     Sequence number of the DP frame
+*** @param[in]  stamp   Timestamp of the DP frame, ref: bsp_timestamp()
+*** @param[in]  act     Action of the filter rules when received, ref: DP_FILTER_ACT.idx
+***
+*** @return     (< 0)Frame not stored, backlog disabled or full, (other)Succeed.
+***********************************************************************************************************/
+
+int backlog_push(const uint8_t *buff, int len, uint32_t seq, uint32_t stamp, int act)
+{
+    extern volatile uint32_t    os_time;            // only for Keil RTX
+    BACKLOG_REC                 rec;
+    uint32_t                    need;
+
+    if( !g_Backlog.enable || (len <= 0) || (len > BACKLOG_FRAME_MAX) ) {
+        return( -1 );
+    }
+    need = sizeof(rec) + len;
+    osMutexWait(g_Backlog.mutex, osWaitForever);
+    while( (BACKLOG_RAM_LEN - (g_Backlog.head - g_Backlog.tail)) < need ) {
+        if( g_Backlog.policy || g_Backlog.nor ) {
+            g_Backlog.drop_new++;
+            osMutexRelease(g_Backlog.mutex);
+            return( -1 );                               // Drop the newest frame
+        }
+        backlog_ram_get(g_Backlog.tail, &rec, sizeof(rec));
+        g_Backlog.tail += sizeof(rec) + rec.len;        // Drop the oldest frame
+        g_Backlog.ram_frm--;
+        g_Backlog.drop_old++;
+    }
+
+    rec.len   = (uint16_t)len;
+    rec.act   = (uint8_t)act;
+    rec.rsv   = 0;
+    rec.seq   = seq;
+    rec.stamp = stamp;
+    rec.tick  = os_time;
+    backlog_ram_put(g_Backlog.head, &rec, sizeof(rec));
+    backlog_ram_put(g_Backlog.head + sizeof(rec), buff, len);
+    g_Backlog.head += need;
+    g_Backlog.ram_frm++;
+    g_Backlog.stored++;
+    osMutexRelease(g_Backlog.mutex);
+
+    if( g_Backlog.nor && !g_Backlog.spilling && ((g_Backlog.head - g_Backlog.tail) >= BACKLOG_SPILL_AT) ) {
+        osSignalSet(g_Backlog.tid, BACKLOG_SIG_SPILL);
+    }
+    return( 0 );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Get the next stored frame to replay, paced at the replay rate of config file.
+***
+*** @param[out] buff    Buffer of the DP frame, (256 + 16) bytes
+*** @param[out] seq     Sequence number of the DP frame
+*** @param[out] stamp   Timestamp of the DP frame, ref: bsp_timestamp()
+*** @param[out] act     Action of the filter rules when received, ref: DP_FILTER_ACT.idx
+***
+*** @return     Length of the DP frame, (0)Backlog is empty, not the time to replay, or BACKLOG_BURST frames
+***             out of retention discarded, the rest from the next call.
+***********************************************************************************************************/
+
+int backlog_replay(uint8_t *buff, uint32_t *seq, uint32_t *stamp, int *act)
+{
+    extern volatile uint32_t    os_time;            // only for Keil RTX
+    BACKLOG_REC                 rec;
+    uint32_t                    now, last;
+    int                         len, n;
+
+    if( backlog_count() == 0 ) {
+        return( 0 );
+    }
+    now = bsp_timestamp();
+    if( (now - g_Backlog.last) < g_Backlog.interval ) {
+        return( 0 );                                    // Not the time to replay
+    }
+    last = g_Backlog.last;
+    if( (now - g_Backlog.last) > (BACKLOG_BURST * g_Backlog.interval) ) {
+        g_Backlog.last = now;                           // Idle for a while, no burst more than BACKLOG_BURST
+    } else {
+        g_Backlog.last += g_Backlog.interval;
+    }
+
+    for(n = 0;  (n < BACKLOG_BURST) && ((len = backlog_pop(buff, &rec)) > 0);  n++) {
+        if( (g_Backlog.retain != 0) && ((os_time - rec.tick) > g_Backlog.retain) ) {
+            g_Backlog.expired++;                        // Out of retention
+            len = 0;
+            continue;
+        }
+        *seq   = rec.seq;
+        *stamp = rec.stamp;
+        *act   = rec.act;
+        g_Backlog.replayed++;
+        break;
+    }
+    if( len <= 0 ) {
+        g_Backlog.last = last;                          // Nothing replayed, the rest expired from the next call
+    }
+
+    if( backlog_count() == 0 ) {
+        printf( "[BACKLOG] Replay done. Stored: %u, Replayed: %u, Spilled: %u, "
+                "Drop oldest: %u, Drop newest: %u, Expired: %u\r\n"
+              , g_Backlog.stored,   g_Backlog.replayed, g_Backlog.spilled
+              , g_Backlog.drop_old, g_Backlog.drop_new, g_Backlog.expired
+              );
+    }
+    return( (len > 0) ? (len) : (0) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Get the time to wait for the next replay, the receive timeout of thread_dp2net.
+***
+*** @return     Time(ms), (osWaitForever)Backlog is empty, (BACKLOG_LINK_POLL)Ethernet LinkDown.
+***********************************************************************************************************/
+
+uint32_t backlog_wait(void)
+{
+    uint32_t    past;
+
+    if( backlog_count() == 0 ) {
+        return( osWaitForever );
+    }
+    if( !eth_linkstatus_get() ) {
+        return( BACKLOG_LINK_POLL );                    // Nothing to replay until LinkUp
+    }
+    past = bsp_timestamp() - g_Backlog.last;
+    if( past >= g_Backlog.interval ) {
+        return( 1 );
+    }
+    return( (g_Backlog.interval - past + 999) / 1000 );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Get the number of frames in the backlog.
+***
+*** @return     Number of frames in RAM ring and spill file.
+***********************************************************************************************************/
+
+uint32_t backlog_count(void)
+{
+    return( g_Backlog.ram_frm + g_Backlog.file_frm );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Get the number of stored frames lost, dropped as the oldest or out of retention.
+***
+***             The newest frames dropped are not counted, backlog_push() returns failed for them.
+***
+*** @return     Number of stored frames lost.
+***********************************************************************************************************/
+
+uint32_t backlog_lost(void)
+{
+    return( g_Backlog.drop_old + g_Backlog.expired );
+}
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+*** @}
+***********************************************************************************************************/
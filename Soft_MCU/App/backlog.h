@@ -0,0 +1,46 @@
+/**********************************************************************************************************/
+/** @file     backlog.h
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    Store-and-forward backlog of ProfiBUS_DP frames across Ethernet LinkDown.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************/
+#ifndef __BACKLOG_H___20261018_143020
+#define __BACKLOG_H___20261018_143020
+#ifdef  __cplusplus
+extern  "C"
+{
+#endif
+/**********************************************************************************************************/
+/** @addtogroup BACKLOG
+*** @{
+*** @addtogroup                 BACKLOG_Exported_Functions
+*** @{
+***********************************************************************************************************/
+
+extern void     backlog_init(void);
+extern int      backlog_push(const uint8_t *buff, int len, uint32_t seq, uint32_t stamp, int act);
+extern int      backlog_replay(uint8_t *buff, uint32_t *seq, uint32_t *stamp, int *act);
+extern uint32_t backlog_wait(void);
+extern uint32_t backlog_count(void);
+extern uint32_t backlog_lost(void);
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+*****/
+#ifdef  __cplusplus
+}
+#endif
+#endif
+/**********************************************************************************************************/
@@ -0,0 +1,348 @@
+/**********************************************************************************************************/
+/** @file     busmon.c
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    ProfiBUS_DP bus analytics in one-second windows, UDP status port.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************/
+
+#include    <stdint.h>
+#include    <stdio.h>
+#include    <string.h>
+
+#include    "stm32f4xx.h"               /* PRIMASK                            */
+#include    "cmsis_os.h"                /* CMSIS RTOS definitions             */
+#include    "rl_net.h"                  /* Network definitions                */
+
+#include    "cfg.h"
+#include    "ProfiBUS_DP.h"
+#include    "busmon.h"
+#include    "livelist.h"
+#include    "latency.h"
+#include    "netiod.h"
+#include    "metrics.h"
+#include    "profiler.h"
+#include    "isrprof.h"
+
+
+/**********************************************************************************************************/
+/** @addtogroup BUSMON
+*** @{
+*** @addtogroup BUSMON_Pravate
+*** @{
+*** @addtogroup                 BUSMON_Private_Constants
+*** @{
+***********************************************************************************************************/
+
+#define BUSMON_CHAR_BITS    11                      /* Bits of a UART char                      */
+#define BUSMON_PERIOD       1000                    /* Length of a window(ms)                   */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 BUSMON_Private_Types
+*** @{
+***********************************************************************************************************/
+
+typedef struct {    /*------------- Bus analytics (Run-Time) ----------------------------------------
+                    -- (win)(head) written by the timer callback only, (head) free running --------*/
+    uint16_t                    port;       /* UDP status port, (0)Disabled     */
+    uint32_t                    tick;       /* os_time at the end of last window*/
+    PBDP_BUS_STAT               last;       /* Counters at the end of last window   */
+    BUSMON_WIN                  win[BUSMON_WIN_NUM];
+    volatile uint32_t           head;       /* Number of windows                */
+} BUSMON_INFO;
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 BUSMON_Private_Variables
+*** @{
+***********************************************************************************************************/
+
+extern volatile uint32_t    os_time;        /* only for Keil RTX                */
+
+static BUSMON_INFO          g_Busmon;
+static void busmon_roll(void const *arg);                   /* prototype for timer callback     */
+static osTimerDef(busmon_roll, busmon_roll);                /* Timer of closing the window      */
+static char                 g_BusmonBuf[BUSMON_UDP_MAX];    /* Buffer of UDP status request/reply   */
+static uint32_t             g_BusmonSnap[METRICS_SLOT_NUM]; /* Snapshot of the metrics in the reply */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 BUSMON_Private_Prototypes
+*** @{
+***********************************************************************************************************/
+
+static void thread_busmon(void const *arg);
+extern int  bridge_statc(char *buff, int size);             /* main.c                           */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 BUSMON_Private_Functions
+*** @{
+***********************************************************************************************************/
+/** @brief      Initialize bus analytics, the UDP status port only if enabled in the config file.
+***********************************************************************************************************/
+
+void busmon_init(void)
+{
+    static osThreadDef(thread_busmon, osPriorityBelowNormal, 1, 0);
+    osTimerId   timer;
+    osThreadId  tid = NULL;
+
+    memcpy(&g_Busmon.last, PBDP_GetBusStat(), sizeof(g_Busmon.last));
+    g_Busmon.tick = os_time;
+    g_Busmon.port = cfg_get_stat_port();
+
+    if(   ((timer = osTimerCreate(osTimer(busmon_roll), osTimerPeriodic, NULL)) == NULL)
+       || (osTimerStart(timer, BUSMON_PERIOD) != osOK) ) {
+        printf("[BUSMON] Initialize Failed!\r\n");
+        return;
+    }
+    if( (g_Busmon.port != 0) && ((tid = osThreadCreate(osThread(thread_busmon), NULL)) == NULL) ) {
+        printf("[BUSMON] Initialize Failed!\r\n");
+    }
+    profiler_name(tid, "busmon");
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Timer callback, close the window of the last second.
+***********************************************************************************************************/
+
+static void busmon_roll(void const *arg)
+{
+    static PBDP_BUS_STAT    cur;                    /* Counters at the end of the window    */
+    PBDP_BUS_STAT          *bus = PBDP_GetBusStat();
+    BUSMON_WIN             *win = &g_Busmon.win[g_Busmon.head % BUSMON_WIN_NUM];
+    uint32_t                now, total, gap, cnt, primask;
+    int                     i;
+
+    (void)arg;
+    primask = __get_PRIMASK();
+    __disable_irq();                                    // Consistent with the UART interrupt
+    memcpy(&cur, bus, sizeof(cur));
+    for(i = 0;  i < PBDP_MASTER_NUM;  i++) {
+        bus->trr[i].max = 0;                            // Max of the next window
+    }
+    __set_PRIMASK(primask);
+
+    now        = os_time;
+    win->tick  = now;
+    win->ms    = now - g_Busmon.tick;
+    win->frames= cur.frames - g_Busmon.last.frames;
+    win->busy  = (cur.chars - g_Busmon.last.chars) * BUSMON_CHAR_BITS;
+    total      = ((PBDP_GetTiming()->baud / 10) * win->ms) / 100;
+    win->idle  = (total > win->busy) ? (total - win->busy) : (0);
+    for(i = 0;  i < PBDP_GAP_BINS;  i++) {
+        gap          = cur.gap[i] - g_Busmon.last.gap[i];
+        win->gap[i]  = (gap > 0xFFFF) ? (0xFFFF) : ((uint16_t)gap);
+    }
+    for(i = 0;  i < PBDP_MASTER_NUM;  i++) {
+        cnt               = cur.trr[i].cnt - g_Busmon.last.trr[i].cnt;
+        win->trr[i].addr  = cur.trr[i].addr;
+        win->trr[i].cnt   = (cnt > 0xFFFF) ? (0xFFFF) : ((uint16_t)cnt);
+        win->trr[i].avg   = (cnt == 0) ? (0) : ((cur.trr[i].sum - g_Busmon.last.trr[i].sum) / cnt);
+        win->trr[i].max   = cur.trr[i].max;
+    }
+    memcpy(&g_Busmon.last, &cur, sizeof(g_Busmon.last));
+    g_Busmon.tick = now;
+    g_Busmon.head++;
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Get a window of bus analytics.
+***
+*** @param[in]  age     Age of the window, (0)The last second, (1)The second before, ...
+*** @param[out] win     Window of bus analytics
+***
+*** @return     (0)No such window, (other)Succeed.
+***********************************************************************************************************/
+
+int busmon_window(int age, BUSMON_WIN *win)
+{
+    uint32_t    head = g_Busmon.head;
+
+    if( (age < 0) || (age >= (BUSMON_WIN_NUM - 1)) || ((uint32_t)age >= head) ) {
+        return( 0 );                                    // The oldest window may be written by the timer
+    }
+    memcpy(win, &g_Busmon.win[(head - 1 - age) % BUSMON_WIN_NUM], sizeof(*win));
+    return( 1 );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Get bus analytics of the last window and the average of all windows.
+***
+*** @param[out] buff    Output statistic information string
+*** @param[in]  size    size of buff(in bytes)
+***
+*** @return     (< 0)Error. (other)number of output char, not counting the terminating null char
+***********************************************************************************************************/
+
+int busmon_statc(char *buff, int size)
+{
+    BUSMON_WIN  win;
+    uint32_t    frames = 0, busy = 0, idle = 0, ms = 0, gap[PBDP_GAP_BINS];
+    uint32_t    trr_cnt[PBDP_MASTER_NUM], trr_sum[PBDP_MASTER_NUM], trr_max[PBDP_MASTER_NUM];
+    int         age, i, n, m;
+
+    if( (buff == NULL) || (size <= 0) )  { return( 0 );        }
+
+    memset(gap,     0, sizeof(gap));
+    memset(trr_cnt, 0, sizeof(trr_cnt));
+    memset(trr_sum, 0, sizeof(trr_sum));
+    memset(trr_max, 0, sizeof(trr_max));
+    for(age = 0;  busmon_window(age, &win);  age++) {
+        frames += win.frames;  busy += win.busy;  idle += win.idle;  ms += win.ms;
+        for(i = 0;  i < PBDP_GAP_BINS;  i++) {
+            gap[i] += win.gap[i];
+        }
+        for(i = 0;  i < PBDP_MASTER_NUM;  i++) {
+            trr_cnt[i] += win.trr[i].cnt;
+            trr_sum[i] += win.trr[i].cnt * win.trr[i].avg;
+            trr_max[i]  = (win.trr[i].max > trr_max[i]) ? (win.trr[i].max) : (trr_max[i]);
+        }
+    }
+    if( !busmon_window(0, &win) ) {
+        return( snprintf(buff, size, "Bus: no window yet\r\n") );
+    }
+
+    n = snprintf( buff, size,
+                  "Bus: %u(bit/s), Gap bin: %u(bits)\r\n"
+                  "Last %u(ms): %u(Frame) Busy %u Idle %u(bits) %u%%\r\n"
+                  "Last %u(s): %u(Frame/s) Busy %u%%\r\n"
+                  "Gap:",
+                  PBDP_GetTiming()->baud, PBDP_GetBusStat()->gap_w,
+                  win.ms, win.frames, win.busy, win.idle,
+                  ((win.busy + win.idle) == 0) ? 0 : ((win.busy * 100) / (win.busy + win.idle)),
+                  age, (ms == 0) ? 0 : ((frames * 1000) / ms),
+                  ((busy + idle) < 100) ? 0 : (busy / ((busy + idle) / 100))
+                );
+    for(i = 0;  (i < PBDP_GAP_BINS) && (n >= 0) && (n < size);  i++) {
+        if( (m = snprintf(&buff[n], size - n, " %u", gap[i])) < 0 ) { break; }
+        n += m;
+    }
+    for(i = 0;  (i < PBDP_MASTER_NUM) && (n >= 0) && (n < size);  i++) {
+        if( win.trr[i].addr == 0xFF ) {
+            continue;                                   // Master not used
+        }
+        m = snprintf( &buff[n], size - n, "\r\nTRR[%u]: %u/%u(us) Last, %u/%u(us) Avg/Max",
+                      win.trr[i].addr, win.trr[i].avg, win.trr[i].max,
+                      (trr_cnt[i] == 0) ? 0 : (trr_sum[i] / trr_cnt[i]), trr_max[i] );
+        if( m < 0 ) /******************/ { break;              }
+        n += m;
+    }
+    if( (n >= 0) && (n < size) ) {
+        if( (m = snprintf(&buff[n], size - n, "\r\n")) > 0 ) { n += m; }
+    }
+    if( n < 0 ) /**********************/ { return( n );        }
+    if( n >= size ) /******************/ { return( size - 1 ); }
+    return( n );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Thread of UDP status port
+***********************************************************************************************************/
+
+static void thread_busmon(void const *arg)
+{
+    struct sockaddr_in  addr;
+    int                 alen;
+    int                 sock;
+    int                 len;
+    int                 n;
+
+    (void)arg;
+    osDelay(5000);
+
+    printf("[BUSMON] Status port start, ");
+    if( (sock = socket(AF_INET, SOCK_DGRAM, 0)) < 0 ) {
+        printf("malloc socket failed!\r\n");
+        return;
+    }
+    addr.sin_family      = PF_INET;
+    addr.sin_port        = htons(g_Busmon.port);
+    addr.sin_addr.s_addr = INADDR_ANY;
+    if( bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0 ) {
+        printf("bind socket failed!\r\n");
+        closesocket(sock);
+        return;
+    } else {
+        printf("UDP Port: %d\r\n", g_Busmon.port);
+    }
+
+    for(; ;)
+    {
+        alen = sizeof(addr);
+        if( (len = recvfrom(sock, g_BusmonBuf, sizeof(g_BusmonBuf), 0, (struct sockaddr*)&addr, &alen)) <= 0 ) {
+            continue;                                   // Network_IP Recv Failed
+        }
+        if( (len >= BUSMON_ISR_LEN) && (memcmp(g_BusmonBuf, BUSMON_ISR, BUSMON_ISR_LEN) == 0) ) {
+            if( (len >= (BUSMON_ISR_LEN + 3)) && (memcmp(&g_BusmonBuf[BUSMON_ISR_LEN], " ON", 3) == 0) ) {
+                isrprof_enable(1);
+            } else if( (len >= (BUSMON_ISR_LEN + 4)) && (memcmp(&g_BusmonBuf[BUSMON_ISR_LEN], " OFF", 4) == 0) ) {
+                isrprof_enable(0);
+            }
+            if( (len = isrprof_statc(g_BusmonBuf, sizeof(g_BusmonBuf))) > 0 ) {
+                sendto(sock, g_BusmonBuf, len, 0, (struct sockaddr*)&addr, sizeof(addr));
+            }
+            continue;                                   // ISR profile only
+        }
+        if( (len >= BUSMON_DP_LEN) && (memcmp(g_BusmonBuf, BUSMON_DP, BUSMON_DP_LEN) == 0) ) {
+            if( (len = bridge_statc(g_BusmonBuf, sizeof(g_BusmonBuf))) > 0 ) {
+                sendto(sock, g_BusmonBuf, len, 0, (struct sockaddr*)&addr, sizeof(addr));
+            }
+            continue;                                   // Status of the bridge only
+        }
+        if( (len >= BUSMON_METRICS_LEN) && (memcmp(g_BusmonBuf, BUSMON_METRICS, BUSMON_METRICS_LEN) == 0) ) {
+            if( (len = metrics_statc(g_BusmonBuf, sizeof(g_BusmonBuf), g_BusmonSnap)) > 0 ) {
+                sendto(sock, g_BusmonBuf, len, 0, (struct sockaddr*)&addr, sizeof(addr));
+            }
+            continue;                                   // Registry of the metrics only
+        }
+        if( (len >= BUSMON_RESET_LEN) && (memcmp(g_BusmonBuf, BUSMON_RESET, BUSMON_RESET_LEN) == 0) ) {
+            for(n = 0;  metrics_desc(n) != NULL;  n++) {
+                if( metrics_desc(n)->type == METRICS_TYPE_HIST ) {
+                    metrics_reset(n);                   // Latency histograms from now on
+                }
+            }
+        }
+        if( (len = busmon_statc(g_BusmonBuf, sizeof(g_BusmonBuf))) < 0 ) {
+            continue;
+        }
+        if( (n = livelist_statc(&g_BusmonBuf[len], sizeof(g_BusmonBuf) - len)) > 0 ) {
+            len += n;                                   // Live list after the bus analytics
+        }
+        if( (n = latency_statc(&g_BusmonBuf[len], sizeof(g_BusmonBuf) - len)) > 0 ) {
+            len += n;                                   // Latency of the bridge
+        }
+        if( (n = netiod_statc(&g_BusmonBuf[len], sizeof(g_BusmonBuf) - len)) > 0 ) {
+            len += n;                                   // NetIO sessions
+        }
+        if( len > 0 ) {
+            sendto(sock, g_BusmonBuf, len, 0, (struct sockaddr*)&addr, sizeof(addr));
+        }
+    }
+}
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+*** @}
+***********************************************************************************************************/
@@ -0,0 +1,96 @@
+/**********************************************************************************************************/
+/** @file     busmon.h
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    ProfiBUS_DP bus analytics in one-second windows, UDP status port.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************/
+#ifndef __BUSMON_H___20261018_190215
+#define __BUSMON_H___20261018_190215
+#ifdef  __cplusplus
+extern  "C"
+{
+#endif
+/**********************************************************************************************************/
+/** @addtogroup BUSMON
+*** @{
+*** @addtogroup                 BUSMON_Exported_Constants
+*** @{
+***********************************************************************************************************/
+
+/*  UDP status port "[Tunnel]  STAT_PORT": any datagram to the port is replied by busmon_statc(), the
+ *  text of the last window and the average of all windows kept, followed by livelist_statc(),
+ *  latency_statc() and netiod_statc(). A reply is one datagram of BUSMON_UDP_MAX bytes at most.
+ *  A datagram starting with BUSMON_METRICS is replied by metrics_statc() only.
+ *  A datagram starting with BUSMON_RESET resets the histograms of the metrics before the reply.
+ *  A datagram starting with BUSMON_ISR, "ISR ON", "ISR OFF" or "ISR", switches the profile of the
+ *  ProfiBUS_DP interrupts, and is replied by isrprof_statc() only.
+ *  A datagram starting with BUSMON_DP is replied by bridge_statc() of main.c only, the counters of
+ *  the delta encoder, DP diagnosis, DPV1, process image and slot time supervision.
+ */
+#define BUSMON_WIN_NUM      60                      /* Number of one-second windows kept        */
+#define BUSMON_UDP_MAX      1472                    /* Max length of a reply, one ETH frame     */
+#define BUSMON_RESET        "RESET"                 /* Request of resetting the histograms      */
+#define BUSMON_RESET_LEN    5
+#define BUSMON_ISR          "ISR"                   /* Request of the interrupt profile         */
+#define BUSMON_ISR_LEN      3
+#define BUSMON_DP           "DP"                    /* Request of the status of the bridge      */
+#define BUSMON_DP_LEN       2
+#define BUSMON_METRICS      "METRICS"               /* Request of the registry of the metrics   */
+#define BUSMON_METRICS_LEN  7
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 BUSMON_Exported_Types
+*** @{
+***********************************************************************************************************/
+
+typedef struct {    /*------------- Token rotation of a master in a window --------------------------*/
+    uint8_t                     addr;       /* Address of the master, 0xFF for not used */
+    uint8_t                     rsv;        /* Reserved                         */
+    uint16_t                    cnt;        /* Number of token rotations        */
+    uint32_t                    avg;        /* Average token rotation time(us)  */
+    uint32_t                    max;        /* Max token rotation time(us)      */
+} BUSMON_TRR;
+
+typedef struct {    /*------------- One-second window of bus analytics ------------------------------*/
+    uint32_t                    tick;       /* os_time at the end of the window */
+    uint32_t                    ms;         /* Length of the window(ms)         */
+    uint32_t                    frames;     /* Number of frames on the bus      */
+    uint32_t                    busy;       /* Busy bits of the bus             */
+    uint32_t                    idle;       /* Idle bits of the bus             */
+    uint16_t                    gap[PBDP_GAP_BINS];     /* Request to response gap histogram    */
+    BUSMON_TRR                  trr[PBDP_MASTER_NUM];   /* Token rotation of the masters        */
+} BUSMON_WIN;
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 BUSMON_Exported_Functions
+*** @{
+***********************************************************************************************************/
+
+extern void busmon_init(void);
+extern int  busmon_window(int age, BUSMON_WIN *win);
+extern int  busmon_statc(char *buff, int size);
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+*****/
+#ifdef  __cplusplus
+}
+#endif
+#endif
+/**********************************************************************************************************/
@@ -85,6 +85,56 @@ void cfg_reset(void)
             "\n"
             "[ProfiBUS]\n"
             "BAUD     = 187500        ;\n"
+            "RETRY    = 0             ;Max retry of requests not replied within slot time\n"
+            "\n"
+            "[Tunnel]\n"
+            "TCP      = N             ;TCP tunnel server \"Y\" or \"N\"\n"
+            "TCP_PORT = 18356         ;\n"
+            "FLUSH_SZ = 1024          ;TCP flush batching size(Byte)\n"
+            "FLUSH_MS = 5             ;TCP flush batching time(ms)\n"
+            "SEQ_HDR  = N             ;UDP sequence header \"Y\" or \"N\"\n"
+            "MCAST    = 0.0.0.0       ;UDP multicast group, \"0.0.0.0\" for broadcast\n"
+            "MCAST_TTL= 1             ;UDP multicast TTL\n"
+            "DELTA    = N             ;Delta encoding of DP frames \"Y\" or \"N\"\n"
+            "DELTA_FULL = 100         ;Full frame every N frames of a station\n"
+            "STAT_PORT= 18357         ;UDP status port of bus analytics, 0 for disabled\n"
+            "\n"
+            "[Backlog]\n"
+            "ENABLE   = N             ;Store-and-forward on ETH LinkDown \"Y\" or \"N\"\n"
+            "RETAIN   = 600           ;Retention of stored frames(s), 0 for no limit\n"
+            "POLICY   = OLDEST        ;Drop on overflow \"OLDEST\" or \"NEWEST\"\n"
+            "RATE     = 500           ;Replay rate(frames/s)\n"
+            "NOR      = N             ;Spill to NOR Flash file \"Y\" or \"N\"\n"
+            "NOR_MAX  = 262144        ;Max size of the spill file(Byte)\n"
+            "\n"
+            "[Filter]\n"
+            "DEFAULT  = FWD           ;Action of frames not matched\n"
+            ";RULE1   = SD=SD4 ACT=DROP\n"
+            ";RULE2   = SA=3-10 DSAP=60 ACT=ROUTE:192.168.0.20:18355\n"
+            "\n"
+            "[Diag]\n"
+            "ENABLE   = N             ;Slave diagnostics cache, only changes forwarded \"Y\" or \"N\"\n"
+            "\n"
+            "[DPV1]\n"
+            "PORT     = 18358         ;UDP port of MSAC1 Read/Write service, 0 for disabled\n"
+            "SA       = 1             ;Address of the class 1 master of the slaves\n"
+            "TIMEOUT  = 1000          ;Max time of a Read/Write service(ms)\n"
+            "\n"
+            "[Layout]\n"
+            ";SLAVE1  = 3 SIEM8027.GSD 1,4,4\n"
+            "\n"
+            "[Scan]\n"
+            "ENABLE   = N             ;Live-list scan of unused addresses \"Y\" or \"N\"\n"
+            "SA       = 0             ;Address of the gateway on the bus, must be unused\n"
+            "INTERVAL = 100           ;Min interval of scan requests(ms)\n"
+            "IDLE     = 20            ;Min bus idle time before a scan request(ms)\n"
+            "\n"
+            "[Metrics]\n"
+            "STATIONS = N             ;Per-station counters in metrics.cgx \"Y\" or \"N\"\n"
+            "\n"
+            "[Trace]\n"
+            "PORT     = 18359         ;TCP port of the event trace, 0 for disabled\n"
+            "MASK     = 0             ;Subsystems traced from boot, 0 for stopped\n"
             "\n"
            );
     fclose(fini);
@@ -265,6 +315,335 @@ void cfg_set_baudrate(uint32_t baud)
 }
 
 
+/**********************************************************************************************************/
+/** @brief      Read ProfiBUS-DP max retry of requests not replied within slot time from config file.
+***********************************************************************************************************/
+
+uint8_t cfg_get_retry_limit(void)
+{
+    return( (uint8_t)iniparser_getint(g_CfgDic, "ProfiBUS:RETRY", 0) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Read TCP tunnel server enable or disable from config file.
+***********************************************************************************************************/
+
+int cfg_get_tcp_tunnel(void)
+{
+    return( iniparser_getboolean(g_CfgDic, "Tunnel:TCP", 0) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Read TCP tunnel server port from config file.
+***********************************************************************************************************/
+
+uint16_t cfg_get_tcp_port(void)
+{
+    return( (uint16_t)iniparser_getint(g_CfgDic, "Tunnel:TCP_PORT", 18356) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Read TCP tunnel flush batching size(in bytes) from config file.
+***********************************************************************************************************/
+
+uint32_t cfg_get_flush_size(void)
+{
+    return( iniparser_getlongint(g_CfgDic, "Tunnel:FLUSH_SZ", 1024) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Read TCP tunnel flush batching time(in ms) from config file.
+***********************************************************************************************************/
+
+uint32_t cfg_get_flush_time(void)
+{
+    return( iniparser_getlongint(g_CfgDic, "Tunnel:FLUSH_MS", 5) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Read UDP sequence header enable or disable from config file.
+***********************************************************************************************************/
+
+int cfg_get_seq_header(void)
+{
+    return( iniparser_getboolean(g_CfgDic, "Tunnel:SEQ_HDR", 0) );
+}
+
+
+
+/**********************************************************************************************************/
+/** @brief      Read UDP multicast group from config file.
+***********************************************************************************************************/
+
+const char* cfg_get_mcast(void)
+{
+    return( iniparser_getstring(g_CfgDic, "Tunnel:MCAST", "0.0.0.0") );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Read UDP multicast TTL from config file.
+***********************************************************************************************************/
+
+uint8_t cfg_get_mcast_ttl(void)
+{
+    return( (uint8_t)iniparser_getint(g_CfgDic, "Tunnel:MCAST_TTL", 1) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Read delta encoding of DP frames enable or disable from config file.
+***********************************************************************************************************/
+
+int cfg_get_delta(void)
+{
+    return( iniparser_getboolean(g_CfgDic, "Tunnel:DELTA", 0) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Read delta encoding full frame interval(in frames of a station) from config file.
+***********************************************************************************************************/
+
+uint16_t cfg_get_delta_full(void)
+{
+    return( (uint16_t)iniparser_getint(g_CfgDic, "Tunnel:DELTA_FULL", 100) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Read UDP status port of bus analytics from config file, (0)Disabled.
+***********************************************************************************************************/
+
+uint16_t cfg_get_stat_port(void)
+{
+    return( (uint16_t)iniparser_getint(g_CfgDic, "Tunnel:STAT_PORT", 18357) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Read store-and-forward backlog enable or disable from config file.
+***********************************************************************************************************/
+
+int cfg_get_backlog(void)
+{
+    return( iniparser_getboolean(g_CfgDic, "Backlog:ENABLE", 0) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Read backlog retention(in seconds) from config file.
+***********************************************************************************************************/
+
+uint32_t cfg_get_backlog_retain(void)
+{
+    return( iniparser_getlongint(g_CfgDic, "Backlog:RETAIN", 600) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Read backlog overflow policy from config file.
+***
+*** @return     1 if drop the newest frame on overflow, 0 if drop the oldest one.
+***********************************************************************************************************/
+
+int cfg_get_backlog_policy(void)
+{
+    const char* pol = iniparser_getstring(g_CfgDic, "Backlog:POLICY", "OLDEST");
+
+    return( (pol[0] == 'N') || (pol[0] == 'n') );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Read backlog replay rate(in frames/s) from config file.
+***********************************************************************************************************/
+
+uint32_t cfg_get_backlog_rate(void)
+{
+    return( iniparser_getlongint(g_CfgDic, "Backlog:RATE", 500) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Read backlog spill to NOR Flash enable or disable from config file.
+***********************************************************************************************************/
+
+int cfg_get_backlog_nor(void)
+{
+    return( iniparser_getboolean(g_CfgDic, "Backlog:NOR", 0) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Read max size(in bytes) of the backlog spill file from config file.
+***********************************************************************************************************/
+
+uint32_t cfg_get_backlog_nor_max(void)
+{
+    return( iniparser_getlongint(g_CfgDic, "Backlog:NOR_MAX", 262144) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Read action of the frames not matched by filter rules from config file.
+***********************************************************************************************************/
+
+const char* cfg_get_filter_default(void)
+{
+    return( iniparser_getstring(g_CfgDic, "Filter:DEFAULT", "FWD") );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Read a filter rule from config file.
+***
+*** @param[in]  n       Number of the rule, "[Filter]  RULEn"
+***
+*** @return     String of the rule, NULL if not exist.
+***********************************************************************************************************/
+
+const char* cfg_get_filter_rule(int n)
+{
+    char    entry[32];
+
+    sprintf(entry, "Filter:RULE%d", n);
+    return( iniparser_getstring(g_CfgDic, entry, NULL) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Read a slave of the layout table from config file.
+***
+*** @param[in]  n       Number of the slave, "[Layout]  SLAVEn"
+***
+*** @return     String of the slave, NULL if not exist.
+***********************************************************************************************************/
+
+const char* cfg_get_layout_slave(int n)
+{
+    char    entry[32];
+
+    sprintf(entry, "Layout:SLAVE%d", n);
+    return( iniparser_getstring(g_CfgDic, entry, NULL) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Read slave diagnostics cache enable or disable from config file.
+***********************************************************************************************************/
+
+int cfg_get_diag(void)
+{
+    return( iniparser_getboolean(g_CfgDic, "Diag:ENABLE", 0) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Read UDP port of the DP-V1 MSAC1 service from config file.
+***********************************************************************************************************/
+
+uint16_t cfg_get_dpv1_port(void)
+{
+    return( (uint16_t)iniparser_getint(g_CfgDic, "DPV1:PORT", 18358) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Read address of the class 1 master, the SA of MSAC1 requests, from config file.
+***********************************************************************************************************/
+
+uint8_t cfg_get_dpv1_sa(void)
+{
+    return( (uint8_t)iniparser_getint(g_CfgDic, "DPV1:SA", 1) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Read max time of a MSAC1 service(in ms) from config file.
+***********************************************************************************************************/
+
+uint32_t cfg_get_dpv1_timeout(void)
+{
+    return( iniparser_getlongint(g_CfgDic, "DPV1:TIMEOUT", 1000) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Read live-list scan enable or disable from config file.
+***********************************************************************************************************/
+
+int cfg_get_scan(void)
+{
+    return( iniparser_getboolean(g_CfgDic, "Scan:ENABLE", 0) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Read address of the gateway on the bus, the SA of scan requests, from config file.
+***********************************************************************************************************/
+
+uint8_t cfg_get_scan_sa(void)
+{
+    return( (uint8_t)iniparser_getint(g_CfgDic, "Scan:SA", 0) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Read min interval of scan requests(in ms) from config file.
+***********************************************************************************************************/
+
+uint32_t cfg_get_scan_interval(void)
+{
+    return( iniparser_getlongint(g_CfgDic, "Scan:INTERVAL", 100) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Read min bus idle time before a scan request(in ms) from config file.
+***********************************************************************************************************/
+
+uint32_t cfg_get_scan_idle(void)
+{
+    return( iniparser_getlongint(g_CfgDic, "Scan:IDLE", 20) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Read per-station counters in metrics.cgx enable or disable from config file.
+***********************************************************************************************************/
+
+int cfg_get_metrics_stations(void)
+{
+    return( iniparser_getboolean(g_CfgDic, "Metrics:STATIONS", 0) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Read TCP port of the event trace from config file, 0 for disabled.
+***********************************************************************************************************/
+
+uint16_t cfg_get_trace_port(void)
+{
+    return( (uint16_t)iniparser_getint(g_CfgDic, "Trace:PORT", 18359) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Read subsystems traced from boot from config file, 0 for stopped.
+***********************************************************************************************************/
+
+uint32_t cfg_get_trace_mask(void)
+{
+    return( (uint32_t)iniparser_getint(g_CfgDic, "Trace:MASK", 0) );
+}
+
+
 /*****************************  END OF FILE  **************************************************************/
 /** @}
 *** @}
@@ -51,6 +51,46 @@ void        cfg_set_macaddr(const char* macaddr);
 
 uint32_t    cfg_get_baudrate(void);
 void        cfg_set_baudrate(uint32_t baud);
+uint8_t     cfg_get_retry_limit(void);
+
+int         cfg_get_tcp_tunnel(void);
+uint16_t    cfg_get_tcp_port(void);
+uint32_t    cfg_get_flush_size(void);
+uint32_t    cfg_get_flush_time(void);
+int         cfg_get_seq_header(void);
+const char* cfg_get_mcast(void);
+uint8_t     cfg_get_mcast_ttl(void);
+int         cfg_get_delta(void);
+uint16_t    cfg_get_delta_full(void);
+uint16_t    cfg_get_stat_port(void);
+
+int         cfg_get_backlog(void);
+uint32_t    cfg_get_backlog_retain(void);
+int         cfg_get_backlog_policy(void);
+uint32_t    cfg_get_backlog_rate(void);
+int         cfg_get_backlog_nor(void);
+uint32_t    cfg_get_backlog_nor_max(void);
+
+const char* cfg_get_filter_default(void);
+const char* cfg_get_filter_rule(int n);
+
+const char* cfg_get_layout_slave(int n);
+
+int         cfg_get_diag(void);
+
+uint16_t    cfg_get_dpv1_port(void);
+uint8_t     cfg_get_dpv1_sa(void);
+uint32_t    cfg_get_dpv1_timeout(void);
+
+int         cfg_get_scan(void);
+uint8_t     cfg_get_scan_sa(void);
+uint32_t    cfg_get_scan_interval(void);
+uint32_t    cfg_get_scan_idle(void);
+
+int         cfg_get_metrics_stations(void);
+
+uint16_t    cfg_get_trace_port(void);
+uint32_t    cfg_get_trace_mask(void);
 
 
 /*****************************  END OF FILE  **************************************************************/
@@ -0,0 +1,332 @@
+/**********************************************************************************************************/
+/** @file     dp_delta.c
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    Delta encoding of repeated ProfiBUS_DP frames, portable C for the gateway and the host.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************/
+
+#include    <stdint.h>
+#include    <stdio.h>
+#include    <string.h>
+
+#include    "dp_delta.h"
+
+
+/**********************************************************************************************************/
+/** @addtogroup DP_DELTA
+*** @{
+*** @addtogroup DP_DELTA_Pravate
+*** @{
+*** @addtogroup                 DP_DELTA_Private_Constants
+*** @{
+***********************************************************************************************************/
+
+#define DP_DELTA_PROBE      4                       /* Slots probed for a key                   */
+#define DP_DELTA_GAP        2                       /* Equal bytes merged into a XOR run        */
+#define DP_DELTA_RUN_MAX    255                     /* Max length of a XOR run                  */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 DP_DELTA_Private_Functions
+*** @{
+***********************************************************************************************************/
+/** @brief      Get the (DA, SA, SD) key of a DP frame.
+***
+*** @param[in]  in      Pointer to the DP frame
+*** @param[in]  len     Length  of the DP frame
+*** @param[out] key     DA, SA, SD of the DP frame
+***
+*** @return     (0)No key, SD4, SC or invalid frame, (other)Succeed.
+***********************************************************************************************************/
+
+static int dp_delta_key(const uint8_t *in, int len, uint8_t key[3])
+{
+    switch( in[0] ) {
+    case 0x10:              /* SD1: SD DA SA FC FCS ED          */
+    case 0xA2:              /* SD3: SD DA SA FC DATA(8) FCS ED  */
+        if( len < 3 ) {  return( 0 );  }
+        key[0] = in[1];  key[1] = in[2];
+        break;
+    case 0x68:              /* SD2: SD LE LEr SD DA SA FC DATA FCS ED   */
+        if( len < 6 ) {  return( 0 );  }
+        key[0] = in[4];  key[1] = in[5];
+        break;
+    default:
+        return( 0 );
+    }
+    key[2] = in[0];
+    return( 1 );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Find the reference slot of a key, or a slot to be replaced by the key.
+***
+*** @param[in]  ctx     Encoder context
+*** @param[in]  key     DA, SA, SD of the DP frame
+***
+*** @return     Index of the reference slot.
+***********************************************************************************************************/
+
+static int dp_delta_slot(const DP_DELTA_CTX *ctx, const uint8_t key[3])
+{
+    int     hash, idx, i;
+
+    hash = ((key[0] * 31) + (key[1] * 7) + key[2]) & (DP_DELTA_REF_NUM - 1);
+    for(i = 0;  i < DP_DELTA_PROBE;  i++) {
+        idx = (hash + i) & (DP_DELTA_REF_NUM - 1);
+        if( !ctx->ref[idx].valid || !memcmp(ctx->ref[idx].key, key, 3) ) {
+            return( idx );
+        }
+    }
+    return( hash );                                     // Replace the first slot probed
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Initialize a context of encoder or decoder.
+***
+*** @param[out] ctx         Context
+*** @param[in]  full_every  Encoder sends FULL record every N records of a slot, (0)Only on request
+***********************************************************************************************************/
+
+void dp_delta_init(DP_DELTA_CTX *ctx, uint16_t full_every)
+{
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->full_every = full_every;
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Request FULL records of all slots, may be called by other thread than the encoder.
+***
+*** @param[in]  ctx     Encoder context
+***********************************************************************************************************/
+
+void dp_delta_request(DP_DELTA_CTX *ctx)
+{
+    ctx->req = 1;
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Encode a DP frame.
+***
+*** @param[in]  ctx     Encoder context
+*** @param[in]  in      Pointer to the DP frame
+*** @param[in]  len     Length  of the DP frame
+*** @param[out] out     Buffer of the record, (DP_DELTA_HDR_LEN + len) bytes
+***
+*** @return     Length of the record.
+***********************************************************************************************************/
+
+int dp_delta_encode(DP_DELTA_CTX *ctx, const uint8_t *in, int len, uint8_t *out)
+{
+    DP_DELTA_REF   *ref;
+    uint8_t         key[3];
+    int             o, i, j, end, slot;
+
+    if( ctx->req ) {
+        ctx->req = 0;
+        for(i = 0;  i < DP_DELTA_REF_NUM;  i++) {
+            ctx->ref[i].valid = 0;                      // FULL record on next frame of the slot
+        }
+    }
+    ctx->frames    += 1;
+    ctx->raw_bytes += len;
+
+    if( (len > DP_DELTA_FRAME_MAX) || !dp_delta_key(in, len, key) ) {
+        out[0] = DP_DELTA_FULL;                         // FULL record without reference
+        out[1] = DP_DELTA_NOREF;
+        out[2] = 0;
+        memcpy(&out[DP_DELTA_HDR_LEN], in, len);
+        ctx->full       += 1;
+        ctx->wire_bytes += DP_DELTA_HDR_LEN + len;
+        return( DP_DELTA_HDR_LEN + len );
+    }
+    slot = dp_delta_slot(ctx, key);
+    ref  = &ctx->ref[slot];
+
+    o = DP_DELTA_HDR_LEN;
+    if(   ref->valid && !memcmp(ref->key, key, 3) && (ref->len == len)
+       && ((ctx->full_every == 0) || (ref->cnt < ctx->full_every)) ) {
+        for(i = 0;  (i < len) && (o < (DP_DELTA_HDR_LEN + len));  i = end) {
+            if( in[i] == ref->frame[i] ) {
+                end = i + 1;
+                continue;                               // Not a XOR run
+            }
+            for(end = i + 1, j = i + 1;  (j < len) && ((j - i) < DP_DELTA_RUN_MAX);  j++) {
+                if( in[j] != ref->frame[j] ) {
+                    end = j + 1;                        // Bytes in the XOR run
+                } else if( (j + 1 - end) > DP_DELTA_GAP ) {
+                    break;                              // End of the XOR run
+                }
+            }
+            if( (o + 2 + (end - i)) >= (DP_DELTA_HDR_LEN + len) ) {
+                o = DP_DELTA_HDR_LEN + len;             // Not shorter than FULL record
+                break;
+            }
+            out[o++] = (uint8_t)i;
+            out[o++] = (uint8_t)(end - i);
+            for(j = i;  j < end;  j++) {
+                out[o++] = in[j] ^ ref->frame[j];
+            }
+        }
+        if( o < (DP_DELTA_HDR_LEN + len) ) {
+            memcpy(ref->frame, in, len);
+            out[0] = DP_DELTA_XOR;
+            out[1] = (uint8_t)slot;
+            out[2] = ++ref->gen;
+            ref->cnt        += 1;
+            ctx->delta      += 1;
+            ctx->wire_bytes += o;
+            return( o );
+        }
+    }
+
+    ref->valid = 1;                                     // FULL record, new reference of the slot
+    memcpy(ref->key, key, 3);
+    memcpy(ref->frame, in, len);
+    ref->len = (uint16_t)len;
+    ref->cnt = 0;
+    out[0] = DP_DELTA_FULL;
+    out[1] = (uint8_t)slot;
+    out[2] = ++ref->gen;
+    memcpy(&out[DP_DELTA_HDR_LEN], in, len);
+    ctx->full       += 1;
+    ctx->wire_bytes += DP_DELTA_HDR_LEN + len;
+    return( DP_DELTA_HDR_LEN + len );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Decode a record to the DP frame.
+***
+*** @param[in]  ctx     Decoder context
+*** @param[in]  in      Pointer to the record, or the raw DP frame
+*** @param[in]  len     Length  of the record
+*** @param[out] out     Buffer of the DP frame, (len) bytes for the raw DP frame or FULL record, or
+***                     DP_DELTA_FRAME_MAX bytes for the XOR record
+***
+*** @return     (< 0)Invalid record, or reference lost and a FULL record of the slot is needed,
+***             (other)Length of the DP frame.
+***********************************************************************************************************/
+
+int dp_delta_decode(DP_DELTA_CTX *ctx, const uint8_t *in, int len, uint8_t *out)
+{
+    DP_DELTA_REF   *ref;
+    int             i, j, off, cnt;
+
+    if( len <= 0 ) {
+        return( -1 );
+    }
+    if( (in[0] != DP_DELTA_FULL) && (in[0] != DP_DELTA_XOR) ) {
+        memcpy(out, in, len);                           // Raw DP frame
+        ctx->frames     += 1;
+        ctx->raw_bytes  += len;
+        ctx->wire_bytes += len;
+        return( len );
+    }
+    if( len < DP_DELTA_HDR_LEN ) {
+        ctx->err++;
+        return( -1 );
+    }
+    ctx->wire_bytes += len;
+
+    if( in[1] == DP_DELTA_NOREF ) {
+        if( in[0] != DP_DELTA_FULL ) {
+            ctx->err++;
+            return( -1 );
+        }
+        len -= DP_DELTA_HDR_LEN;
+        memcpy(out, &in[DP_DELTA_HDR_LEN], len);
+    } else if( in[1] >= DP_DELTA_REF_NUM ) {
+        ctx->err++;
+        return( -1 );
+    } else if( in[0] == DP_DELTA_FULL ) {
+        ref = &ctx->ref[in[1]];
+        len -= DP_DELTA_HDR_LEN;
+        if( len > DP_DELTA_FRAME_MAX ) {
+            ctx->err++;
+            return( -1 );
+        }
+        memcpy(ref->frame, &in[DP_DELTA_HDR_LEN], len);
+        memcpy(out, ref->frame, len);
+        ref->valid = 1;
+        ref->gen   = in[2];
+        ref->len   = (uint16_t)len;
+        ctx->full += 1;
+    } else {
+        ref = &ctx->ref[in[1]];
+        if( !ref->valid || (in[2] != (uint8_t)(ref->gen + 1)) ) {
+            ref->valid = 0;                             // Reference lost, wait for FULL record
+            ctx->err++;
+            return( -2 );
+        }
+        for(i = DP_DELTA_HDR_LEN;  i < len;  i += 2 + cnt) {
+            off = in[i];
+            cnt = ((i + 1) < len) ? (in[i + 1]) : (0);
+            if( (cnt == 0) || ((i + 2 + cnt) > len) || ((off + cnt) > ref->len) ) {
+                ref->valid = 0;                         // Invalid XOR run
+                ctx->err++;
+                return( -1 );
+            }
+            for(j = 0;  j < cnt;  j++) {
+                ref->frame[off + j] ^= in[i + 2 + j];
+            }
+        }
+        ref->gen    = in[2];
+        len         = ref->len;
+        memcpy(out, ref->frame, len);
+        ctx->delta += 1;
+    }
+    ctx->frames    += 1;
+    ctx->raw_bytes += len;
+    return( len );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Get statistic information of a context.
+***
+*** @param[in]  ctx     Context
+*** @param[out] buff    Output statistic information string
+*** @param[in]  size    size of buff(in bytes)
+***
+*** @return     (< 0)Error. (other)number of output char, not counting the terminating null char
+***********************************************************************************************************/
+
+int dp_delta_statc(const DP_DELTA_CTX *ctx, char *buff, int size)
+{
+    int     n;
+
+    if( (buff == NULL) || (size <= 0) )  { return( 0 );        }
+
+    n = snprintf( buff, size,
+                  "Delta: %u(Frame) %u(FULL) %u(XOR) %u(ERR), Raw: %u(Byte), Wire: %u(Byte) %u.%02u(Byte/Frame)",
+                  ctx->frames, ctx->full, ctx->delta, ctx->err, ctx->raw_bytes, ctx->wire_bytes,
+                  (ctx->frames == 0) ? 0 : (ctx->wire_bytes / ctx->frames),
+                  (ctx->frames == 0) ? 0 : (((ctx->wire_bytes % ctx->frames) * 100) / ctx->frames)
+                );
+    if( n < 0 ) /**********************/ { return( n );        }
+    if( n >= size ) /******************/ { return( size - 1 ); }
+    return( n );
+}
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+*** @}
+***********************************************************************************************************/
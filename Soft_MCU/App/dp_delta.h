@@ -0,0 +1,113 @@
+/**********************************************************************************************************/
+/** @file     dp_delta.h
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    Delta encoding of repeated ProfiBUS_DP frames, portable C for the gateway and the host.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************/
+#ifndef __DP_DELTA_H___20261018_153210
+#define __DP_DELTA_H___20261018_153210
+#ifdef  __cplusplus
+extern  "C"
+{
+#endif
+/**********************************************************************************************************/
+/** @addtogroup DP_DELTA
+*** @{
+*** @addtogroup                 DP_DELTA_Exported_Constants
+*** @{
+***********************************************************************************************************/
+
+/*  Encoded record, replaces the DP frame in the UDP datagram or the TCP tunnel record:
+ *
+ *      +------------+-----+-----+------------------------------------------------------+
+ *      | TYPE       | REF | GEN | Payload                                              |
+ *      +------------+-----+-----+------------------------------------------------------+
+ *      | FULL(0xF0) |     |     | DP frame                                             |
+ *      | XOR (0xF1) |     |     | { OFFSET(1) | COUNT(1) | XOR data(COUNT) } ...      |
+ *      +------------+-----+-----+------------------------------------------------------+
+ *
+ *  REF       --- reference slot of the (DA, SA, SD) key, DP_DELTA_NOREF for the frames without key.
+ *  GEN       --- generation of the reference slot, increased by each record of the slot. A XOR record
+ *                is decoded only if GEN is next to the generation of the slot in the decoder, otherwise
+ *                a record is lost and the decoder waits for the next FULL record of the slot.
+ *  XOR       --- the DP frame is the frame of reference slot, XOR the runs. The length is the same.
+ *
+ *  A single byte DP_DELTA_REQ from the host requests FULL records of all slots. The other first byte
+ *  is a start delimiter of the raw DP frame or DP_DIAG_EVT(dp_diag.h), passed through by the decoder.
+ *
+ *  The records broadcast by a peer gateway are decoded by thread_net2dp before PBDP_Send(), for one
+ *  peer at a time. After a change of the peer or a record lost, the records of a slot are dropped
+ *  until its next FULL record, so the peer needs "[Tunnel] DELTA_FULL" other than 0.
+ */
+#define DP_DELTA_FULL       (0xF0)                  /* Record type: full DP frame               */
+#define DP_DELTA_XOR        (0xF1)                  /* Record type: XOR runs against reference  */
+#define DP_DELTA_REQ        (0xF2)                  /* Request of FULL records, from the host   */
+#define DP_DELTA_NOREF      (0xFF)                  /* REF of the DP frame without reference    */
+#define DP_DELTA_HDR_LEN    (1 + 1 + 1)             /* Length of record header                  */
+#define DP_DELTA_REF_NUM    32                      /* Number of reference slots, (2 ^ n)       */
+#define DP_DELTA_FRAME_MAX  256                     /* Max length of DP frame with reference    */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 DP_DELTA_Exported_Types
+*** @{
+***********************************************************************************************************/
+
+typedef struct {    /*------------- Reference slot of a (DA, SA, SD) key --------------------------*/
+    uint8_t                     valid;      /* Slot is valid                    */
+    uint8_t                     key[3];     /* DA, SA, SD of the DP frame       */
+    uint8_t                     gen;        /* Generation of the slot           */
+    uint8_t                     rsv;        /* Reserved                         */
+    uint16_t                    cnt;        /* XOR records since the last FULL  */
+    uint16_t                    len;        /* Length of the reference frame    */
+    uint8_t                     frame[DP_DELTA_FRAME_MAX];
+} DP_DELTA_REF;
+
+typedef struct {    /*------------- Encoder or decoder context --------------------------------------
+                    -- (req) may be set by other thread, the others by the owner only --------------*/
+    DP_DELTA_REF                ref[DP_DELTA_REF_NUM];
+    uint16_t                    full_every; /* FULL record every N records of a slot, (0)Never  */
+    volatile uint8_t            req;        /* FULL records of all slots requested  */
+
+    uint32_t                    frames;     /* Counter of frames                */
+    uint32_t                    full;       /* Counter of FULL records          */
+    uint32_t                    delta;      /* Counter of XOR records           */
+    uint32_t                    raw_bytes;  /* Counter of bytes of DP frames    */
+    uint32_t                    wire_bytes; /* Counter of bytes of records      */
+    uint32_t                    err;        /* Counter of records not decoded   */
+} DP_DELTA_CTX;
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 DP_DELTA_Exported_Functions
+*** @{
+***********************************************************************************************************/
+
+extern void dp_delta_init(DP_DELTA_CTX *ctx, uint16_t full_every);
+extern void dp_delta_request(DP_DELTA_CTX *ctx);
+extern int  dp_delta_encode(DP_DELTA_CTX *ctx, const uint8_t *in, int len, uint8_t *out);
+extern int  dp_delta_decode(DP_DELTA_CTX *ctx, const uint8_t *in, int len, uint8_t *out);
+extern int  dp_delta_statc(const DP_DELTA_CTX *ctx, char *buff, int size);
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+*****/
+#ifdef  __cplusplus
+}
+#endif
+#endif
+/**********************************************************************************************************/
@@ -0,0 +1,223 @@
+/**********************************************************************************************************/
+/** @file     dp_diag.c
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    ProfiBUS_DP slave diagnostics cache, change events instead of the repeated responses.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************/
+
+#include    <stdint.h>
+#include    <stdio.h>
+#include    <string.h>
+
+#include    "cfg.h"
+#include    "crc.h"
+#include    "dp_diag.h"
+
+
+/**********************************************************************************************************/
+/** @addtogroup DP_DIAG
+*** @{
+*** @addtogroup DP_DIAG_Pravate
+*** @{
+*** @addtogroup                 DP_DIAG_Private_Constants
+*** @{
+***********************************************************************************************************/
+
+#define DP_DIAG_SAP_DIAG    60                      /* SAP of Slave_Diag                        */
+#define DP_DIAG_SAP_MASTER  62                      /* SAP of the master requesting diagnostics */
+#define DP_DIAG_DATA_MIN    6                       /* Status(3), Master_Add, Ident_Number(2)   */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 DP_DIAG_Private_Types
+*** @{
+***********************************************************************************************************/
+
+typedef struct {    /*------------- Slave diagnostics cache (Run-Time) ------------------------------
+                    -- (req) may be set by other thread, the others by thread_dp2net only ----------*/
+    int                         enable;     /* Diagnostics cache enable         */
+    volatile uint8_t            req;        /* Events of all stations requested */
+    uint32_t                    resp;       /* Counter of Slave_Diag responses  */
+    uint32_t                    evt;        /* Counter of change events         */
+    DP_DIAG_STN                 stn[DP_DIAG_STN_NUM];
+} DP_DIAG_INFO;
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 DP_DIAG_Private_Variables
+*** @{
+***********************************************************************************************************/
+
+extern volatile uint32_t    os_time;        /* only for Keil RTX                */
+
+static DP_DIAG_INFO         g_Diag;
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 DP_DIAG_Private_Functions
+*** @{
+***********************************************************************************************************/
+/** @brief      Initialize the slave diagnostics cache from the config file.
+***********************************************************************************************************/
+
+void dp_diag_init(void)
+{
+    memset(&g_Diag, 0, sizeof(g_Diag));
+    g_Diag.enable = cfg_get_diag();
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Request the events of all stations, may be called by other thread than thread_dp2net.
+***********************************************************************************************************/
+
+void dp_diag_request(void)
+{
+    g_Diag.req = 1;
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Cache a Slave_Diag response, and replace it by the change event.
+***
+*** @param[in]  buff    Pointer to the DP frame, replaced by the event record if changed
+*** @param[in]  len     Length  of the DP frame
+***
+*** @return     (< 0)Not a Slave_Diag response or cache disabled, forward the frame as is,
+***             (0)Diagnostics not changed, not forwarded, (other)Length of the event record.
+***********************************************************************************************************/
+
+int dp_diag_frame(uint8_t *buff, int len)
+{
+    DP_DIAG_STN    *stn;
+    const uint8_t  *data;
+    uint16_t        ident, crc;
+    int             addr, dlen, elen, chg, i;
+
+    if(   !g_Diag.enable || (len < 9) || (buff[0] != 0x68)
+       || (buff[6] & 0x40) || !(buff[4] & 0x80) || !(buff[5] & 0x80)    /* Response with SAPs   */
+       || ((buff[7] & 0x3F) != DP_DIAG_SAP_MASTER) || ((buff[8] & 0x3F) != DP_DIAG_SAP_DIAG) ) {
+        return( -1 );
+    }
+    dlen = buff[1] - 5;                                 // LE: DA SA FC DSAP SSAP DATA
+    if( (dlen < DP_DIAG_DATA_MIN) || (len < (buff[1] + 6)) ) {
+        return( -1 );
+    }
+    if( g_Diag.req ) {
+        g_Diag.req = 0;
+        for(i = 0;  i < DP_DIAG_STN_NUM;  i++) {
+            g_Diag.stn[i].valid = 0;                    // Event on next response of the station
+        }
+    }
+    if( (addr = buff[5] & 0x7F) >= DP_DIAG_STN_NUM ) {
+        return( -1 );
+    }
+    stn   = &g_Diag.stn[addr];
+    data  = &buff[9];
+    elen  = dlen - DP_DIAG_DATA_MIN;
+    ident = (uint16_t)((data[4] << 8) | data[5]);
+    crc   = crc16_ccitt(CRC16_CCITT_INIT, &data[DP_DIAG_DATA_MIN], elen);
+    g_Diag.resp++;
+    stn->resp++;
+
+    chg = 0;
+    if( !stn->valid || memcmp(stn->st, data, 3) ) {
+        chg |= DP_DIAG_CHG_ST;
+    }
+    if( !stn->valid || (stn->ext_len != elen) || (stn->ext_crc != crc) ) {
+        chg |= DP_DIAG_CHG_EXT;
+    }
+    if( !stn->valid ) {
+        chg = DP_DIAG_CHG_ST | DP_DIAG_CHG_EXT;
+    }
+    stn->master = data[3];
+    stn->ident  = ident;
+    if( chg == 0 ) {
+        return( 0 );
+    }
+
+    stn->valid   = 1;
+    memcpy(stn->st, data, 3);
+    stn->ext_len = (uint8_t)elen;
+    stn->ext_crc = crc;
+    memcpy(stn->ext, &data[DP_DIAG_DATA_MIN], (elen < DP_DIAG_EXT_KEEP) ? elen : DP_DIAG_EXT_KEEP);
+    stn->chg++;
+    stn->tick    = os_time;
+    g_Diag.evt++;
+
+    elen = (chg & DP_DIAG_CHG_EXT) ? (elen) : (0);      // The record is shorter than the frame,
+    memmove(&buff[DP_DIAG_HDR_LEN], &data[DP_DIAG_DATA_MIN], elen);     // built in place
+    buff[8] = (uint8_t)(ident);
+    buff[7] = (uint8_t)(ident >> 8);
+    buff[6] = stn->master;                              // Data overwritten, from the cache
+    buff[3] = stn->st[0];  buff[4] = stn->st[1];  buff[5] = stn->st[2];
+    buff[2] = (uint8_t)chg;
+    buff[1] = (uint8_t)addr;
+    buff[0] = DP_DIAG_EVT;
+    return( DP_DIAG_HDR_LEN + elen );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Get the latest diagnostics of a slave.
+***
+*** @param[in]  addr    Address of the slave
+*** @param[out] stn     Latest diagnostics of the slave
+***
+*** @return     (0)No diagnostics received, (other)Succeed.
+***********************************************************************************************************/
+
+int dp_diag_station(int addr, DP_DIAG_STN *stn)
+{
+    if( (addr < 0) || (addr >= DP_DIAG_STN_NUM) || !g_Diag.stn[addr].valid ) {
+        return( 0 );
+    }
+    memcpy(stn, &g_Diag.stn[addr], sizeof(*stn));
+    return( 1 );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Get statistic information of the slave diagnostics cache.
+***
+*** @param[out] buff    Output statistic information string
+*** @param[in]  size    size of buff(in bytes)
+***
+*** @return     (< 0)Error. (other)number of output char, not counting the terminating null char
+***********************************************************************************************************/
+
+int dp_diag_statc(char *buff, int size)
+{
+    int     n, num, i;
+
+    if( (buff == NULL) || (size <= 0) )  { return( 0 );        }
+
+    for(num = 0, i = 0;  i < DP_DIAG_STN_NUM;  i++) {
+        num += g_Diag.stn[i].valid;
+    }
+    n = snprintf( buff, size, "Diag: %s, %u(Slave) %u(Resp) %u(Event)",
+                  g_Diag.enable ? "ON" : "OFF", num, g_Diag.resp, g_Diag.evt );
+    if( n < 0 ) /**********************/ { return( n );        }
+    if( n >= size ) /******************/ { return( size - 1 ); }
+    return( n );
+}
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+*** @}
+***********************************************************************************************************/
@@ -0,0 +1,95 @@
+/**********************************************************************************************************/
+/** @file     dp_diag.h
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    ProfiBUS_DP slave diagnostics cache, change events instead of the repeated responses.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************/
+#ifndef __DP_DIAG_H___20261018_203317
+#define __DP_DIAG_H___20261018_203317
+#ifdef  __cplusplus
+extern  "C"
+{
+#endif
+/**********************************************************************************************************/
+/** @addtogroup DP_DIAG
+*** @{
+*** @addtogroup                 DP_DIAG_Exported_Constants
+*** @{
+***********************************************************************************************************/
+
+/*  With "[Diag]  ENABLE = Y", a Slave_Diag response (SD2, DSAP 62, SSAP 60) is cached per station and
+ *  replaced by the event record below only if the status bytes or the ext-diag changed, the unchanged
+ *  responses are not forwarded. The record is forwarded in place of the DP frame:
+ *
+ *      +------------+------+-----+-----+-----+-----+--------+----------+--------------------------+
+ *      | DIAG(0xF3) | ADDR | CHG | ST1 | ST2 | ST3 | MASTER | IDENT(2) | EXT-DIAG, if CHG bit1    |
+ *      +------------+------+-----+-----+-----+-----+--------+----------+--------------------------+
+ *
+ *  ADDR      --- address of the slave.
+ *  CHG       --- bit0: Station_status_1~3 changed, bit1: ext-diag changed and included, both set for
+ *                the first response of the station.
+ *  IDENT     --- Ident_Number of the slave, network byte order.
+ *
+ *  DP_DELTA_REQ from the host requests the event of the next response of all stations, as the first.
+ */
+#define DP_DIAG_EVT         (0xF3)                  /* Record type: slave diagnostics event     */
+#define DP_DIAG_HDR_LEN     (1 + 1 + 1 + 3 + 1 + 2) /* Length of the event without ext-diag     */
+#define DP_DIAG_CHG_ST      (0x01)                  /* CHG: status bytes changed                */
+#define DP_DIAG_CHG_EXT     (0x02)                  /* CHG: ext-diag changed                    */
+
+#define DP_DIAG_STN_NUM     127                     /* Addresses 0 ~ 126                        */
+#define DP_DIAG_EXT_KEEP    16                      /* Ext-diag bytes kept in the cache         */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 DP_DIAG_Exported_Types
+*** @{
+***********************************************************************************************************/
+
+typedef struct {    /*------------- Latest diagnostics of a slave -------------------------------*/
+    uint8_t                     valid;      /* Diagnostics received             */
+    uint8_t                     st[3];      /* Station_status_1~3               */
+    uint8_t                     master;     /* Diag.Master_Add                  */
+    uint8_t                     ext_len;    /* Length of ext-diag               */
+    uint16_t                    ident;      /* Ident_Number                     */
+    uint16_t                    ext_crc;    /* CRC16 of ext-diag                */
+    uint16_t                    chg;        /* Counter of change events         */
+    uint32_t                    resp;       /* Counter of responses             */
+    uint32_t                    tick;       /* os_time of the last change       */
+    uint8_t                     ext[DP_DIAG_EXT_KEEP];  /* Head of ext-diag     */
+} DP_DIAG_STN;
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 DP_DIAG_Exported_Functions
+*** @{
+***********************************************************************************************************/
+
+extern void dp_diag_init(void);
+extern void dp_diag_request(void);
+extern int  dp_diag_frame(uint8_t *buff, int len);
+extern int  dp_diag_station(int addr, DP_DIAG_STN *stn);
+extern int  dp_diag_statc(char *buff, int size);
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+*****/
+#ifdef  __cplusplus
+}
+#endif
+#endif
+/**********************************************************************************************************/
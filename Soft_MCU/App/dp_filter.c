@@ -0,0 +1,428 @@
+/**********************************************************************************************************/
+/** @file     dp_filter.c
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    ProfiBUS_DP frame filter and routing rules, compiled to the lookup tables.
+***
+***           Each field has a table indexed by the value of the field, each item is a bit mask of the
+***           rules matched by the value. A frame is evaluated by ANDing the items of all fields, the
+***           lowest bit set is the first rule matched. Constant time whatever the number of rules.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************/
+
+#include    <stdint.h>
+#include    <stdio.h>
+#include    <stdlib.h>
+#include    <string.h>
+#include    <ctype.h>
+
+#include    "rl_net.h"                  /* Network definitions                */
+
+#include    "cfg.h"
+#include    "dp_filter.h"
+
+
+/**********************************************************************************************************/
+/** @addtogroup DP_FILTER
+*** @{
+*** @addtogroup DP_FILTER_Pravate
+*** @{
+*** @addtogroup                 DP_FILTER_Private_Constants
+*** @{
+***********************************************************************************************************/
+
+#define DP_FILTER_PORT      18355                   /* Default UDP port of ROUTE, PORT_NET2DP   */
+#define DP_FILTER_DEFAULT   DP_FILTER_RULE_MAX      /* Index of the DEFAULT action              */
+#define DP_FILTER_NIL_SAP   64                      /* Value of DSAP/SSAP: no SAP               */
+#define DP_FILTER_NIL_ADDR  128                     /* Value of DA/SA: SC frame                 */
+#define DP_FILTER_NIL_FC    256                     /* Value of FC: SD4 or SC frame             */
+
+enum {              /*------------- Fields and offsets of the lookup tables -----------------------*/
+    FIELD_SD = 0, FIELD_DA, FIELD_SA, FIELD_FC, FIELD_DSAP, FIELD_SSAP, FIELD_LEN, FIELD_NUM
+};
+#define TAB_SD              0
+#define TAB_DA              (TAB_SD   + 5)
+#define TAB_SA              (TAB_DA   + DP_FILTER_NIL_ADDR + 1)
+#define TAB_FC              (TAB_SA   + DP_FILTER_NIL_ADDR + 1)
+#define TAB_DSAP            (TAB_FC   + DP_FILTER_NIL_FC   + 1)
+#define TAB_SSAP            (TAB_DSAP + DP_FILTER_NIL_SAP  + 1)
+#define TAB_LEN             (TAB_SSAP + DP_FILTER_NIL_SAP  + 1)
+#define TAB_SIZE            (TAB_LEN  + 256)
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 DP_FILTER_Private_Variables
+*** @{
+***********************************************************************************************************/
+
+static const struct {
+    const char             *name;           /* Name of the field in the rule    */
+    uint16_t                offset;         /* Offset of the lookup table       */
+    uint16_t                size;           /* Size   of the lookup table       */
+} g_FilterField[FIELD_NUM] = {
+    { "SD",   TAB_SD,   5                          },
+    { "DA",   TAB_DA,   DP_FILTER_NIL_ADDR + 1     },
+    { "SA",   TAB_SA,   DP_FILTER_NIL_ADDR + 1     },
+    { "FC",   TAB_FC,   DP_FILTER_NIL_FC   + 1     },
+    { "DSAP", TAB_DSAP, DP_FILTER_NIL_SAP  + 1     },
+    { "SSAP", TAB_SSAP, DP_FILTER_NIL_SAP  + 1     },
+    { "LEN",  TAB_LEN,  256                        },
+};
+
+static int                  g_FilterNum;                            /* Number of rules compiled     */
+static uint64_t             g_FilterTab[TAB_SIZE];                  /* Lookup tables of all fields  */
+static DP_FILTER_ACT        g_FilterAct[DP_FILTER_RULE_MAX + 1];    /* Actions of rules and DEFAULT */
+static uint32_t             g_FilterHit[DP_FILTER_RULE_MAX + 1];    /* Counters of rules and DEFAULT*/
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 DP_FILTER_Private_Functions
+*** @{
+***********************************************************************************************************/
+/** @brief      Get the index of the lowest bit set.
+***********************************************************************************************************/
+
+static __inline int dp_filter_lsb(uint64_t mask)
+{
+    uint32_t    lo = (uint32_t)mask;
+    uint32_t    hi = (uint32_t)(mask >> 32);
+
+#if defined(__CC_ARM)
+    return( (lo != 0) ? (__clz(__rbit(lo))) : (32 + __clz(__rbit(hi))) );
+#else
+    return( (lo != 0) ? (__builtin_ctz(lo)) : (32 + __builtin_ctz(hi)) );
+#endif
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Parse the action of a rule.
+***
+*** @param[in]  str     String of the action, in upper case
+*** @param[out] act     Action
+***
+*** @return     (< 0)Invalid action, (other)Succeed.
+***********************************************************************************************************/
+
+static int dp_filter_action(const char *str, DP_FILTER_ACT *act)
+{
+    char        ip[16];
+    const char *p;
+    size_t      n;
+
+    act->addr = 0;
+    act->port = 0;
+    if( !strcmp(str, "FWD") )    { act->act = DP_FILTER_FWD;    return( 0 ); }
+    if( !strcmp(str, "DROP") )   { act->act = DP_FILTER_DROP;   return( 0 ); }
+    if( !strcmp(str, "COUNT") )  { act->act = DP_FILTER_COUNT;  return( 0 ); }
+    if( strncmp(str, "ROUTE:", 6) != 0 ) {
+        return( -1 );
+    }
+    str += 6;                                           // ROUTE:ip[:port]
+    n    = ((p = strchr(str, ':')) != NULL) ? (size_t)(p - str) : strlen(str);
+    if( n >= sizeof(ip) ) {
+        return( -1 );
+    }
+    memcpy(ip, str, n);  ip[n] = '\0';
+    if( !ip4_aton(ip, (uint8_t*)&act->addr) ) {
+        return( -1 );
+    }
+    act->port = htons((p != NULL) ? (uint16_t)strtoul(p + 1, NULL, 0) : DP_FILTER_PORT);
+    act->act  = DP_FILTER_ROUTE;
+    return( 0 );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Parse the value of a field, and set the bit of rule in the lookup table.
+***
+*** @param[in]  field   Index of the field
+*** @param[in]  str     String of the value in upper case, "*", number, range or list
+*** @param[in]  bit     Bit of the rule
+***
+*** @return     (< 0)Invalid value, (other)Succeed.
+***********************************************************************************************************/
+
+static int dp_filter_value(int field, char *str, uint64_t bit)
+{
+    static const uint8_t    sd_code[5] = { 0x10, 0x68, 0xA2, 0xDC, 0xE5 };
+    static const char      *sd_name[5] = { "SD1", "SD2", "SD3", "SD4", "SC" };
+    uint64_t               *tab  = &g_FilterTab[g_FilterField[field].offset];
+    int                     size = g_FilterField[field].size;
+    unsigned long           lo, hi, lim;
+    char                   *item, *end;
+    int                     i;
+
+    for(i = 0;  i < size;  i++) {
+        tab[i] &= ~bit;                                 // Field given, not match any frame
+    }
+    if( !strcmp(str, "*") ) {
+        for(i = 0;  i < size;  i++) {
+            tab[i] |= bit;
+        }
+        return( 0 );
+    }
+
+    for(item = strtok(str, ",");  item != NULL;  item = strtok(NULL, ",")) {
+        if( field == FIELD_SD ) {
+            for(i = 0;  i < 5;  i++) {
+                if( !strcmp(item, sd_name[i]) || (strtoul(item, NULL, 0) == sd_code[i]) ) {
+                    break;
+                }
+            }
+            if( i >= 5 ) {
+                return( -1 );
+            }
+            tab[i] |= bit;
+            continue;
+        }
+        if( ((field == FIELD_DSAP) || (field == FIELD_SSAP)) && !strcmp(item, "NIL") ) {
+            tab[DP_FILTER_NIL_SAP] |= bit;
+            continue;
+        }
+        lo = hi = strtoul(item, &end, 0);
+        if( *end == '-' ) {
+            hi = strtoul(end + 1, &end, 0);
+        }
+        if( (end == item) || (*end != '\0') || (lo > hi) ) {
+            return( -1 );
+        }
+        lim = (field == FIELD_LEN) ? (size) : (size - 1);   // The last item is NIL, not a value
+        for(;  (lo <= hi) && (lo < lim);  lo++) {
+            tab[lo] |= bit;
+        }
+    }
+    return( 0 );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Compile a rule to the lookup tables.
+***
+*** @param[in]  idx     Index of the rule
+*** @param[in]  rule    String of the rule, case insensitive
+***
+*** @return     (< 0)Invalid rule, (other)Succeed.
+***********************************************************************************************************/
+
+static int dp_filter_compile(int idx, const char *rule)
+{
+    static char     line[128];
+    char           *tok, *val, *next;
+    uint64_t        bit = (uint64_t)1 << idx;
+    int             i, act = 0;
+
+    if( strlen(rule) >= sizeof(line) ) {
+        return( -1 );
+    }
+    for(i = 0;  rule[i] != '\0';  i++) {
+        line[i] = (char)toupper((unsigned char)rule[i]);
+    }
+    line[i] = '\0';
+    for(i = 0;  i < TAB_SIZE;  i++) {
+        g_FilterTab[i] |= bit;                          // Field not given, match any frame
+    }
+
+    for(tok = line;  *tok != '\0';  tok = next) {
+        while( isspace((unsigned char)*tok) ) {  tok++;  }
+        for(next = tok;  (*next != '\0') && !isspace((unsigned char)*next);  next++) {}
+        if( *next != '\0' ) {  *next++ = '\0';  }
+        if( *tok == '\0' ) {
+            break;
+        }
+        if( (val = strchr(tok, '=')) == NULL ) {
+            goto RULE_ERR;
+        }
+        *val++ = '\0';
+        if( !strcmp(tok, "ACT") ) {
+            if( dp_filter_action(val, &g_FilterAct[idx]) < 0 ) {
+                goto RULE_ERR;
+            }
+            act = 1;
+            continue;
+        }
+        for(i = 0;  (i < FIELD_NUM) && strcmp(tok, g_FilterField[i].name);  i++) {}
+        if( (i >= FIELD_NUM) || (dp_filter_value(i, val, bit) < 0) ) {
+            goto RULE_ERR;
+        }
+    }
+    if( act ) {
+        g_FilterAct[idx].idx = (uint8_t)idx;
+        return( 0 );
+    }
+
+  RULE_ERR:
+    for(i = 0;  i < TAB_SIZE;  i++) {
+        g_FilterTab[i] &= ~bit;                         // Rule never matched
+    }
+    return( -1 );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Initialize the filter, compile the rules of config file to the lookup tables.
+***********************************************************************************************************/
+
+void dp_filter_init(void)
+{
+    const char *rule;
+    char        def[32];
+    int         i;
+
+    memset(g_FilterTab, 0, sizeof(g_FilterTab));
+    memset(g_FilterHit, 0, sizeof(g_FilterHit));
+    g_FilterNum = 0;
+    rule = cfg_get_filter_default();
+    for(i = 0;  (rule[i] != '\0') && (i < (int)sizeof(def) - 1);  i++) {
+        def[i] = (char)toupper((unsigned char)rule[i]);
+    }
+    def[i] = '\0';
+    if( dp_filter_action(def, &g_FilterAct[DP_FILTER_DEFAULT]) < 0 ) {
+        g_FilterAct[DP_FILTER_DEFAULT].act = DP_FILTER_FWD;
+    }
+    g_FilterAct[DP_FILTER_DEFAULT].idx = DP_FILTER_DEFAULT;
+
+    for(i = 0;  i < DP_FILTER_RULE_MAX;  i++) {
+        if( (rule = cfg_get_filter_rule(i + 1)) == NULL ) {
+            continue;
+        }
+        if( dp_filter_compile(i, rule) < 0 ) {
+            printf("[FILTER] RULE%d invalid: %s\r\n", i + 1, rule);
+            continue;
+        }
+        g_FilterNum++;
+    }
+    if( g_FilterNum > 0 ) {
+        printf("[FILTER] %d rules compiled, lookup table: %u(Byte)\r\n", g_FilterNum, (unsigned)sizeof(g_FilterTab));
+    }
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Match a ProfiBUS_DP frame with the rules.
+***
+*** @param[in]  buff    Pointer to the DP frame, ref: PBDP_Recv()
+*** @param[in]  len     Length  of the DP frame
+***
+*** @return     Action of the first rule matched, or the DEFAULT action.
+***********************************************************************************************************/
+
+const DP_FILTER_ACT* dp_filter_match(const uint8_t *buff, int len)
+{
+    const uint8_t  *data = NULL;
+    int             sd, da, sa, fc, dsap, ssap, dlen = 0;
+    uint64_t        mask;
+
+    if( (g_FilterNum == 0) || (len <= 0) ) {
+        return( &g_FilterAct[DP_FILTER_DEFAULT] );
+    }
+    da = sa = DP_FILTER_NIL_ADDR;
+    fc = DP_FILTER_NIL_FC;
+    switch( buff[0] ) {
+    case 0x10:  if( len < 4 )  { goto NO_MATCH; }  sd = 0;  da = buff[1];  sa = buff[2];  fc = buff[3];
+                break;
+    case 0x68:  if( len < 7 )  { goto NO_MATCH; }  sd = 1;  da = buff[4];  sa = buff[5];  fc = buff[6];
+                data = &buff[7];  dlen = buff[1] - 3;
+                break;
+    case 0xA2:  if( len < 12 ) { goto NO_MATCH; }  sd = 2;  da = buff[1];  sa = buff[2];  fc = buff[3];
+                data = &buff[4];  dlen = 8;
+                break;
+    case 0xDC:  if( len < 3 )  { goto NO_MATCH; }  sd = 3;  da = buff[1];  sa = buff[2];
+                break;
+    case 0xE5:  sd = 4;
+                break;
+    default:    goto NO_MATCH;
+    }
+
+    dsap = ssap = DP_FILTER_NIL_SAP;                    // SAPs in the data unit, by extension bits
+    if( (data != NULL) && (da & 0x80) && (dlen > 0) ) {  dsap = *data++ & 0x3F;  dlen--;  }
+    if( (data != NULL) && (sa & 0x80) && (dlen > 0) ) {  ssap = *data   & 0x3F;           }
+    if( da != DP_FILTER_NIL_ADDR ) {  da &= 0x7F;  sa &= 0x7F;  }
+    if( len > 255 ) {  len = 255;  }
+
+    mask = g_FilterTab[TAB_SD + sd]     & g_FilterTab[TAB_DA + da]     & g_FilterTab[TAB_SA + sa]
+         & g_FilterTab[TAB_FC + fc]     & g_FilterTab[TAB_DSAP + dsap] & g_FilterTab[TAB_SSAP + ssap]
+         & g_FilterTab[TAB_LEN + len];
+    if( mask != 0 ) {
+        return( &g_FilterAct[dp_filter_lsb(mask)] );
+    }
+  NO_MATCH:
+    return( &g_FilterAct[DP_FILTER_DEFAULT] );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Get the action of a rule, for the frames stored with the index of the action.
+***
+*** @param[in]  idx     Index of the rule, DP_FILTER_RULE_MAX for DEFAULT, ref: DP_FILTER_ACT.idx
+***
+*** @return     Action of the rule, or the DEFAULT action for an invalid index.
+***********************************************************************************************************/
+
+const DP_FILTER_ACT* dp_filter_get(int idx)
+{
+    if( (idx < 0) || (idx > DP_FILTER_DEFAULT) ) {
+        idx = DP_FILTER_DEFAULT;
+    }
+    return( &g_FilterAct[idx] );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Count a frame by the rule of the action, DROP is not counted.
+***
+*** @param[in]  act     Action returned by dp_filter_match()
+***********************************************************************************************************/
+
+void dp_filter_count(const DP_FILTER_ACT *act)
+{
+    if( act->act != DP_FILTER_DROP ) {
+        g_FilterHit[act->idx]++;
+    }
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Get statistic information of the rules.
+***
+*** @param[out] buff    Output statistic information string
+*** @param[in]  size    size of buff(in bytes)
+***
+*** @return     (< 0)Error. (other)number of output char, not counting the terminating null char
+***********************************************************************************************************/
+
+int dp_filter_statc(char *buff, int size)
+{
+    int     i, n, m;
+
+    if( (buff == NULL) || (size <= 0) )  { return( 0 );        }
+
+    n = snprintf(buff, size, "Filter DEFAULT: %u", g_FilterHit[DP_FILTER_DEFAULT]);
+    for(i = 0;  (i < DP_FILTER_RULE_MAX) && (n >= 0) && (n < size);  i++) {
+        if( g_FilterHit[i] != 0 ) {
+            m  = snprintf(&buff[n], size - n, ", RULE%d: %u", i + 1, g_FilterHit[i]);
+            n  = (m < 0) ? (m) : (n + m);
+        }
+    }
+    if( n < 0 ) /**********************/ { return( n );        }
+    if( n >= size ) /******************/ { return( size - 1 ); }
+    return( n );
+}
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+*** @}
+***********************************************************************************************************/
@@ -0,0 +1,90 @@
+/**********************************************************************************************************/
+/** @file     dp_filter.h
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    ProfiBUS_DP frame filter and routing rules, compiled to the lookup tables.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************/
+#ifndef __DP_FILTER_H___20261018_163540
+#define __DP_FILTER_H___20261018_163540
+#ifdef  __cplusplus
+extern  "C"
+{
+#endif
+/**********************************************************************************************************/
+/** @addtogroup DP_FILTER
+*** @{
+*** @addtogroup                 DP_FILTER_Exported_Constants
+*** @{
+***********************************************************************************************************/
+
+/*  Rule of config file "[Filter]  RULEn = FIELD=VALUE ... ACT=ACTION", n = 1 ~ DP_FILTER_RULE_MAX.
+ *
+ *  FIELD     --- SD, DA, SA, FC, DSAP, SSAP or LEN, the field not given matches any frame.
+ *  VALUE     --- "*", number, range or list, such as "3", "0x5D", "3-10", "3,5,7-9".
+ *                SD  : SD1, SD2, SD3, SD4, SC or the start delimiter byte.
+ *                DA/SA without the extension bit, DSAP/SSAP "NIL" for no SAP(default SAP).
+ *                LEN : length of the frame received, ref: PBDP_Recv().
+ *  ACTION    --- FWD           : forward to all subscribers, UDP broadcast(multicast) and TCP tunnel.
+ *                ROUTE:ip[:port]: forward to the UDP subscriber only, not delta encoded.
+ *                COUNT         : not forward, counted by the rule only.
+ *                DROP          : not forward, not counted.
+ *
+ *  The first rule matched, in order of n, decides the action. "[Filter]  DEFAULT = ACTION" for the
+ *  frames not matched.
+ */
+#define DP_FILTER_RULE_MAX  64                      /* Max number of rules, bits of uint64_t    */
+
+#define DP_FILTER_DROP      0                       /* Action: not forward, not counted         */
+#define DP_FILTER_COUNT     1                       /* Action: not forward, counted only        */
+#define DP_FILTER_FWD       2                       /* Action: forward to all subscribers       */
+#define DP_FILTER_ROUTE     3                       /* Action: forward to the UDP subscriber    */
+
+#define DP_FILTER_PASS(a)   ((a)->act >= DP_FILTER_FWD)
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 DP_FILTER_Exported_Types
+*** @{
+***********************************************************************************************************/
+
+typedef struct {    /*------------- Action of a rule ----------------------------------------------*/
+    uint8_t                     act;        /* DP_FILTER_xxx                    */
+    uint8_t                     idx;        /* Index of rule, DP_FILTER_RULE_MAX for DEFAULT    */
+    uint16_t                    port;       /* UDP port of ROUTE, network byte order    */
+    uint32_t                    addr;       /* IP address of ROUTE, network byte order  */
+} DP_FILTER_ACT;
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 DP_FILTER_Exported_Functions
+*** @{
+***********************************************************************************************************/
+
+extern void                 dp_filter_init(void);
+extern const DP_FILTER_ACT* dp_filter_match(const uint8_t *buff, int len);
+extern const DP_FILTER_ACT* dp_filter_get(int idx);
+extern void                 dp_filter_count(const DP_FILTER_ACT *act);
+extern int                  dp_filter_statc(char *buff, int size);
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+*****/
+#ifdef  __cplusplus
+}
+#endif
+#endif
+/**********************************************************************************************************/
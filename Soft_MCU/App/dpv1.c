@@ -0,0 +1,394 @@
+/**********************************************************************************************************/
+/** @file     dpv1.c
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    ProfiBUS_DP-V1 MSAC1 acyclic Read/Write service of the gateway, UDP service port.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************/
+
+#include    <stdint.h>
+#include    <stdio.h>
+#include    <string.h>
+
+#include    "cmsis_os.h"                /* CMSIS RTOS definitions             */
+#include    "rl_net.h"                  /* Network definitions                */
+
+#include    "board.h"
+#include    "cfg.h"
+#include    "ProfiBUS_DP.h"
+#include    "dpv1.h"
+#include    "profiler.h"
+
+
+/**********************************************************************************************************/
+/** @addtogroup DPV1
+*** @{
+*** @addtogroup DPV1_Pravate
+*** @{
+*** @addtogroup                 DPV1_Private_Constants
+*** @{
+***********************************************************************************************************/
+
+#define DPV1_SAP            51                      /* SAP of MSAC1, both DSAP and SSAP         */
+#define DPV1_FC_REQ         0x4D                    /* FC: SRD with high priority, FCV = 0      */
+#define DPV1_FC_POLL        0x4C                    /* FC: SRD with low priority, FCV = 0       */
+#define DPV1_SIG_RESP       0x0001                  /* Signal of the response received          */
+#define DPV1_RESP_MS        20                      /* Response received after the first char   */
+#define DPV1_NONE           0xFF                    /* No request pending                       */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 DPV1_Private_Types
+*** @{
+***********************************************************************************************************/
+
+typedef struct {    /*------------- MSAC1 service (Run-Time) ----------------------------------------
+                    -- (rsp)(rsp_len)(pend) written by thread_dp2net while (pend) is set, the others
+                    -- by thread_dpv1 only ------------------------------------------------------*/
+    uint16_t                    port;       /* UDP service port, (0)Disabled    */
+    uint8_t                     sa;         /* Address of the class 1 master    */
+    uint8_t                     da;         /* Address of the slave served      */
+    volatile uint8_t            pend;       /* DA waiting for the response, DPV1_NONE for none  */
+    uint32_t                    timeout;    /* Max time of a service(ms)        */
+    osThreadId                  tid;        /* Thread of the service            */
+    volatile int                rsp_len;    /* Length of the response           */
+    uint8_t                     rsp[260];   /* Response of the slave            */
+    uint8_t                     frame[256]; /* Request or poll frame            */
+
+    uint32_t                    req;        /* Counter of service requests      */
+    uint32_t                    ok;         /* Counter of slave responses       */
+    uint32_t                    err;        /* Counter of error responses       */
+    uint32_t                    noresp;     /* Counter of no response           */
+    uint32_t                    tmo;        /* Counter of response not ready    */
+    uint32_t                    poll;       /* Counter of poll frames           */
+} DPV1_INFO;
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 DPV1_Private_Variables
+*** @{
+***********************************************************************************************************/
+
+extern volatile uint32_t    os_time;        /* only for Keil RTX                */
+
+static DPV1_INFO            g_Dpv1;
+static uint8_t              g_Dpv1Req[DPV1_REQ_HDR_LEN + DPV1_DATA_MAX + 16];   /* UDP request      */
+static uint8_t              g_Dpv1Rep[DPV1_REP_HDR_LEN + DPV1_DATA_MAX];        /* UDP reply        */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 DPV1_Private_Prototypes
+*** @{
+***********************************************************************************************************/
+
+static void thread_dpv1(void const *arg);
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 DPV1_Private_Functions
+*** @{
+***********************************************************************************************************/
+/** @brief      Initialize the MSAC1 service, only if enabled in the config file.
+***********************************************************************************************************/
+
+void dpv1_init(void)
+{
+    static osThreadDef(thread_dpv1, osPriorityBelowNormal, 1, 0);
+    osThreadId  tid = NULL;
+
+    g_Dpv1.port    = cfg_get_dpv1_port();
+    g_Dpv1.sa      = cfg_get_dpv1_sa() & 0x7F;
+    g_Dpv1.timeout = cfg_get_dpv1_timeout();
+    g_Dpv1.pend    = DPV1_NONE;
+
+    if( (g_Dpv1.port != 0) && ((tid = osThreadCreate(osThread(thread_dpv1), NULL)) == NULL) ) {
+        printf("[DPV1] Initialize Failed!\r\n");
+    }
+    profiler_name(tid, "dpv1");
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Take the response of the pending request from ProfiBUS_DP, called by thread_dp2net.
+***             Armed from PBDP_Send() returned to the response wait of dpv1_transact(), only the first
+***             frame received then is the response: the bus is not free before it ends, so an SC is
+***             taken as the response only as this frame.
+***
+*** @param[in]  buff    Pointer to the DP frame
+*** @param[in]  len     Length  of the DP frame
+***
+*** @return     (0)Forward the frame, (other)Response of the pending request, consumed.
+***********************************************************************************************************/
+
+int dpv1_frame(const uint8_t *buff, int len)
+{
+    int     pend = g_Dpv1.pend;
+
+    if( (pend == DPV1_NONE) || (len <= 0) || (g_Dpv1.rsp_len != 0) ) {
+        return( 0 );
+    }
+    g_Dpv1.pend = DPV1_NONE;                            // Disarmed by the first frame
+    switch( buff[0] ) {
+    case 0xE5:              /* SC: request received, response not ready     */
+        break;
+    case 0x10:              /* SD1: no data, response not ready             */
+        if(   (len < 4) || ((buff[1] & 0x7F) != g_Dpv1.sa) || ((buff[2] & 0x7F) != pend)
+           || (buff[3] & 0x40) ) {
+            return( 0 );
+        }
+        break;
+    case 0x68:              /* SD2: SD LE LEr SD DA SA FC DSAP SSAP DATA    */
+        if(   (len < 9) || ((buff[4] & 0x7F) != g_Dpv1.sa) || ((buff[5] & 0x7F) != pend)
+           || (buff[6] & 0x40) || ((buff[8] & 0x3F) != DPV1_SAP) ) {
+            return( 0 );
+        }
+        break;
+    default:
+        return( 0 );
+    }
+    len = (len > (int)sizeof(g_Dpv1.rsp)) ? ((int)sizeof(g_Dpv1.rsp)) : (len);
+    memcpy(g_Dpv1.rsp, buff, len);
+    g_Dpv1.rsp_len = len;
+    osSignalSet(g_Dpv1.tid, DPV1_SIG_RESP);
+    return( 1 );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Waiting for the bus idle of two slot times, between the cyclic polls.
+***
+*** @param[in]  end     os_time of the service timeout
+***
+*** @return     (0)Timeout, (other)Bus idle.
+***********************************************************************************************************/
+
+static int dpv1_idle(uint32_t end)
+{
+    const PBDP_TIMING  *tim = PBDP_GetTiming();
+    uint32_t            us  = (tim->tsl * 2000000u) / tim->baud;
+
+    while( (bsp_timestamp() - PBDP_GetBusStat()->last) < us ) {
+        if( (int32_t)(os_time - end) >= 0 ) {
+            return( 0 );
+        }
+        osDelay(1);
+    }
+    return( 1 );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Send a MSAC1 frame to the pending slave and wait for the response.
+***
+*** @param[in]  data    Pointer to MSAC1 data, NULL for the poll frame
+*** @param[in]  dlen    Length  of MSAC1 data
+*** @param[in]  end     os_time of the service timeout
+***
+*** @return     (< 0)Timeout, (0)No response, (other)Length of the response.
+***********************************************************************************************************/
+
+static int dpv1_transact(const uint8_t *data, int dlen, uint32_t end)
+{
+    uint8_t    *f = g_Dpv1.frame;
+    uint8_t     fcs;
+    int         le, i, sent;
+    osEvent     evt;
+    osPriority  prio;
+
+    le    = 5 + dlen;                                   // LE: DA SA FC DSAP SSAP DATA
+    f[0]  = 0x68;  f[1] = (uint8_t)le;  f[2] = (uint8_t)le;  f[3] = 0x68;
+    f[4]  = g_Dpv1.da   | 0x80;                         // With SAP extension
+    f[5]  = g_Dpv1.sa   | 0x80;
+    f[6]  = (data != NULL) ? (DPV1_FC_REQ) : (DPV1_FC_POLL);
+    f[7]  = DPV1_SAP;
+    f[8]  = DPV1_SAP;
+    if( dlen > 0 ) {
+        memcpy(&f[9], data, dlen);
+    }
+    for(fcs = 0, i = 4;  i < (4 + le);  i++) {
+        fcs += f[i];
+    }
+    f[4 + le] = fcs;
+    f[5 + le] = 0x16;
+
+    if( !dpv1_idle(end) ) {
+        return( -1 );
+    }
+    g_Dpv1.rsp_len = 0;
+    osSignalClear(g_Dpv1.tid, DPV1_SIG_RESP);
+    prio = osThreadGetPriority(g_Dpv1.tid);             // PBDP_Send() returns at the first char of the
+    osThreadSetPriority(g_Dpv1.tid, osPriorityAboveNormal);// response, armed before thread_dp2net gets it
+    sent = PBDP_Send(f, 6 + le);
+    if( sent == (6 + le) ) {
+        g_Dpv1.pend = g_Dpv1.da;
+    }
+    osThreadSetPriority(g_Dpv1.tid, prio);
+    if( sent != (6 + le) ) {
+        return( 0 );                                    // No response within slot time
+    }
+    evt = osSignalWait(DPV1_SIG_RESP, DPV1_RESP_MS);
+    g_Dpv1.pend = DPV1_NONE;
+    return( (evt.status == osEventSignal) ? (g_Dpv1.rsp_len) : (0) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Serve a Read or Write request of the host.
+***
+*** @param[in]  req     Request of the host
+*** @param[in]  len     Length of the request
+*** @param[out] rep     Reply to the host, DPV1_REP_HDR_LEN + DPV1_DATA_MAX bytes
+***
+*** @return     Length of the reply.
+***********************************************************************************************************/
+
+static int dpv1_service(const uint8_t *req, int len, uint8_t *rep)
+{
+    const uint8_t  *r = g_Dpv1.rsp;
+    uint8_t         data[4 + DPV1_DATA_MAX];
+    uint32_t        end;
+    int             dlen, rlen, ret, n;
+
+    rep[0] = req[0];  rep[1] = req[1];                  // TAG
+    memcpy(&rep[3], &req[2], DPV1_REQ_HDR_LEN - 2);     // FUNC ADDR SLOT INDEX LEN
+    rep[2] = DPV1_STAT_INVALID;
+    dlen   = req[6];
+    if(   ((req[2] != DPV1_FUNC_READ) && (req[2] != DPV1_FUNC_WRITE)) || (req[3] >= 127)
+       || (dlen > DPV1_DATA_MAX)
+       || (len != (DPV1_REQ_HDR_LEN + ((req[2] == DPV1_FUNC_WRITE) ? dlen : 0))) ) {
+        return( DPV1_REP_HDR_LEN );
+    }
+    g_Dpv1.req++;
+
+    memcpy(data, &req[2], 1);                           // Function
+    memcpy(&data[1], &req[4], 3);                       // Slot, Index, Length
+    memcpy(&data[4], &req[DPV1_REQ_HDR_LEN], len - DPV1_REQ_HDR_LEN);
+    end = os_time + g_Dpv1.timeout;
+
+    g_Dpv1.da = req[3];
+    ret = dpv1_transact(data, 4 + len - DPV1_REQ_HDR_LEN, end);
+    while( (ret > 0) && ((r[0] != 0x68) || (r[1] <= 5)) ) {
+        if( (int32_t)(os_time - end) >= 0 ) {
+            ret = -1;
+            break;
+        }
+        g_Dpv1.poll++;                                  // Response not ready, poll the slave
+        ret = dpv1_transact(NULL, 0, end);
+    }
+
+    if( ret <= 0 ) {
+        if( ret < 0 ) {  g_Dpv1.tmo++;     rep[2] = DPV1_STAT_TIMEOUT; }
+        else          {  g_Dpv1.noresp++;  rep[2] = DPV1_STAT_NORESP;  }
+        return( DPV1_REP_HDR_LEN );
+    }
+    rlen = r[1] - 5;                                    // MSAC1 data of the response
+    if( (ret < (r[1] + 4)) || (rlen < 4) || ((rlen - 4) > DPV1_DATA_MAX) ) {    // LE of SD2 up to 249
+        g_Dpv1.noresp++;
+        rep[2] = DPV1_STAT_NORESP;
+        return( DPV1_REP_HDR_LEN );
+    }
+    rep[2] = DPV1_STAT_OK;
+    rep[3] = r[9];
+    if( r[9] & DPV1_FUNC_ERR ) {
+        g_Dpv1.err++;                                   // Error_Decode, Error_Code_1, Error_Code_2
+        rep[7] = 3;
+        memcpy(&rep[DPV1_REP_HDR_LEN], &r[10], 3);
+        return( DPV1_REP_HDR_LEN + 3 );
+    }
+    g_Dpv1.ok++;
+    rep[5] = r[10];  rep[6] = r[11];
+    n      = (r[9] == DPV1_FUNC_READ) ? (rlen - 4) : (0);
+    n      = (n > r[12]) ? (r[12]) : (n);
+    rep[7] = (r[9] == DPV1_FUNC_READ) ? ((uint8_t)n) : (r[12]);
+    memcpy(&rep[DPV1_REP_HDR_LEN], &r[13], n);
+    return( DPV1_REP_HDR_LEN + n );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Get statistic information of the MSAC1 service.
+***
+*** @param[out] buff    Output statistic information string
+*** @param[in]  size    size of buff(in bytes)
+***
+*** @return     (< 0)Error. (other)number of output char, not counting the terminating null char
+***********************************************************************************************************/
+
+int dpv1_statc(char *buff, int size)
+{
+    int     n;
+
+    if( (buff == NULL) || (size <= 0) )  { return( 0 );        }
+
+    n = snprintf( buff, size, "DPV1: SA %u, %u(Req) %u(OK) %u(ERR) %u(No Resp) %u(Timeout) %u(Poll)",
+                  g_Dpv1.sa, g_Dpv1.req, g_Dpv1.ok, g_Dpv1.err, g_Dpv1.noresp, g_Dpv1.tmo, g_Dpv1.poll );
+    if( n < 0 ) /**********************/ { return( n );        }
+    if( n >= size ) /******************/ { return( size - 1 ); }
+    return( n );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Thread of UDP service port
+***********************************************************************************************************/
+
+static void thread_dpv1(void const *arg)
+{
+    struct sockaddr_in  addr;
+    int                 alen;
+    int                 sock;
+    int                 len;
+
+    (void)arg;
+    g_Dpv1.tid = osThreadGetId();
+    osDelay(5000);
+
+    printf("[DPV1] Service port start, ");
+    if( (sock = socket(AF_INET, SOCK_DGRAM, 0)) < 0 ) {
+        printf("malloc socket failed!\r\n");
+        return;
+    }
+    addr.sin_family      = PF_INET;
+    addr.sin_port        = htons(g_Dpv1.port);
+    addr.sin_addr.s_addr = INADDR_ANY;
+    if( bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0 ) {
+        printf("bind socket failed!\r\n");
+        closesocket(sock);
+        return;
+    } else {
+        printf("UDP Port: %d, SA: %d\r\n", g_Dpv1.port, g_Dpv1.sa);
+    }
+
+    for(; ;)
+    {
+        alen = sizeof(addr);
+        if( (len = recvfrom(sock, (char*)g_Dpv1Req, sizeof(g_Dpv1Req), 0, (struct sockaddr*)&addr, &alen)) <= 0 ) {
+            continue;                                   // Network_IP Recv Failed
+        }
+        if( len < DPV1_REQ_HDR_LEN ) {
+            continue;                                   // Network_IP Recv Invalid
+        }
+        len = dpv1_service(g_Dpv1Req, len, g_Dpv1Rep);
+        sendto(sock, (char*)g_Dpv1Rep, len, 0, (struct sockaddr*)&addr, sizeof(addr));
+    }
+}
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+*** @}
+***********************************************************************************************************/
@@ -0,0 +1,80 @@
+/**********************************************************************************************************/
+/** @file     dpv1.h
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    ProfiBUS_DP-V1 MSAC1 acyclic Read/Write service of the gateway, UDP service port.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************/
+#ifndef __DPV1_H___20261018_205422
+#define __DPV1_H___20261018_205422
+#ifdef  __cplusplus
+extern  "C"
+{
+#endif
+/**********************************************************************************************************/
+/** @addtogroup DPV1
+*** @{
+*** @addtogroup                 DPV1_Exported_Constants
+*** @{
+***********************************************************************************************************/
+
+/*  UDP service port "[DPV1]  PORT", one request per datagram and one reply for each (network byte order):
+ *
+ *      Request:  | TAG(2) | FUNC | ADDR | SLOT | INDEX | LEN | DATA(LEN), Write only    |
+ *      Reply:    | TAG(2) | STAT | FUNC | ADDR | SLOT | INDEX | LEN | DATA(LEN)        |
+ *
+ *  TAG       --- chosen by the host, returned in the reply.
+ *  FUNC      --- DPV1_FUNC_READ or DPV1_FUNC_WRITE, the reply has the function code of the slave
+ *                response, bit7 set for the error response.
+ *  LEN       --- length of the data to read or write. For the error response, DATA is Error_Decode,
+ *                Error_Code_1 and Error_Code_2.
+ *  STAT      --- DPV1_STAT_xxx.
+ *
+ *  The gateway sends MSAC1 request (DSAP 51, SSAP 51) with SA "[DPV1]  SA", the address of the class 1
+ *  master of the slave, and polls the slave until the response, each frame only after the bus is
+ *  idle for two slot times, between the cyclic polls. Frames are sent with FCV = 0, the FCB sequence
+ *  of the master is not disturbed.
+ */
+#define DPV1_FUNC_READ      (0x5E)                  /* Function: Read                           */
+#define DPV1_FUNC_WRITE     (0x5F)                  /* Function: Write                          */
+#define DPV1_FUNC_ERR       (0x80)                  /* Function bit of error response           */
+
+#define DPV1_STAT_OK        0                       /* Response of the slave in the reply       */
+#define DPV1_STAT_INVALID   1                       /* Invalid request                          */
+#define DPV1_STAT_NORESP    2                       /* No response of the slave                 */
+#define DPV1_STAT_TIMEOUT   3                       /* Response not ready within "[DPV1]  TIMEOUT"  */
+
+#define DPV1_REQ_HDR_LEN    (2 + 1 + 1 + 1 + 1 + 1) /* Length of request without data           */
+#define DPV1_REP_HDR_LEN    (DPV1_REQ_HDR_LEN + 1)  /* Length of reply without data             */
+#define DPV1_DATA_MAX       240                     /* Max length of data                       */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 DPV1_Exported_Functions
+*** @{
+***********************************************************************************************************/
+
+extern void dpv1_init(void);
+extern int  dpv1_frame(const uint8_t *buff, int len);
+extern int  dpv1_statc(char *buff, int size);
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+*****/
+#ifdef  __cplusplus
+}
+#endif
+#endif
+/**********************************************************************************************************/
@@ -0,0 +1,432 @@
+/**********************************************************************************************************/
+/** @file     gsd.c
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    GSD file parser and slave layout compiler, portable C for the gateway and the host.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************/
+
+#include    <stdint.h>
+#include    <stdio.h>
+#include    <stdlib.h>
+#include    <string.h>
+#include    <ctype.h>
+#include    <stddef.h>
+
+#include    "crc.h"
+#include    "gsd.h"
+
+
+/**********************************************************************************************************/
+/** @addtogroup GSD
+*** @{
+*** @addtogroup GSD_Pravate
+*** @{
+*** @addtogroup                 GSD_Private_Constants
+*** @{
+***********************************************************************************************************/
+
+#define GSD_LINE_MAX        1024                    /* Max length of a line with continuations  */
+#define GSD_CFG_MAX         244                     /* Max identifier bytes of a "Module"       */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 GSD_Private_Variables
+*** @{
+***********************************************************************************************************/
+
+static char                 g_GsdLine[GSD_LINE_MAX];    /* Logical line of GSD file         */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 GSD_Private_Functions
+*** @{
+***********************************************************************************************************/
+/** @brief      Read a logical line, joined the "\" continuations, without comment and blanks at end.
+***
+*** @param[in]  fp      GSD file
+*** @param[out] line    Number of the last physical line read
+***
+*** @return     (0)End of file, (other)Succeed.
+***********************************************************************************************************/
+
+static int gsd_getline(FILE *fp, uint16_t *line)
+{
+    char   *p = g_GsdLine;
+    int     n, quote = 0, i;
+
+    for(; ;) {
+        if( fgets(p, GSD_LINE_MAX - (int)(p - g_GsdLine), fp) == NULL ) {
+            return( p != g_GsdLine );
+        }
+        (*line)++;
+        for(i = 0;  p[i] != '\0';  i++) {               // Quotes continued over the "\"
+            if( p[i] == '"' ) {
+                quote = !quote;
+            } else if( (p[i] == ';') && !quote ) {
+                break;                                  // Comment to the end of line
+            }
+        }
+        for(n = i;  (n > 0) && isspace((unsigned char)p[n - 1]);  n--) {
+        }
+        p[n] = '\0';
+        if( (n == 0) || (p[n - 1] != '\\') ) {
+            return( 1 );
+        }
+        p += n - 1;                                     // Continuation, overwrite the "\"
+    }
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Match the keyword of a line, case insensitive.
+***
+*** @param[in]  line    Logical line
+*** @param[in]  key     Keyword
+***
+*** @return     NULL if not matched, or pointer to the value after "=".
+***********************************************************************************************************/
+
+static const char* gsd_keyword(const char *line, const char *key)
+{
+    while( isspace((unsigned char)*line) ) {
+        line++;
+    }
+    for(;  *key != '\0';  key++, line++) {
+        if( tolower((unsigned char)*line) != tolower((unsigned char)*key) ) {
+            return( NULL );
+        }
+    }
+    while( isspace((unsigned char)*line) ) {
+        line++;
+    }
+    return( (*line == '=') ? (line + 1) : (NULL) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Compute the I/O lengths of a "Module" from the identifier bytes.
+***
+*** @param[out] mod     "Module" of the GSD file
+*** @param[in]  cfg     Identifier bytes
+*** @param[in]  n       Number of identifier bytes
+***
+*** @return     (< 0)Invalid identifier, (0)Succeed.
+***********************************************************************************************************/
+
+static int gsd_module_cfg(GSD_FILE_MOD *mod, const uint8_t *cfg, int n)
+{
+    uint32_t    in = 0, out = 0, len;
+    int         i, b;
+
+    mod->cons = 0;
+    for(i = 0;  i < n;  ) {
+        b = cfg[i++];
+        if( b & 0x30 ) {                                // Compact format: CONS WORD IO(2) LEN-1(4)
+            len = ((b & 0x0F) + 1) * ((b & 0x40) ? 2 : 1);
+            if( b & 0x10 ) {  in  += len;  }
+            if( b & 0x20 ) {  out += len;  }
+            mod->cons |= (b & 0x80) ? 1 : 0;
+            continue;
+        }
+        if( (b & 0x0F) == 0x0F ) {                      // Special format: IO(2) 00 MANUF(4)
+            return( -1 );
+        }
+        if( b & 0x80 ) {                                // Output length byte: CONS WORD LEN-1(6)
+            if( i >= n ) {  return( -1 );  }
+            out       += ((cfg[i] & 0x3F) + 1) * ((cfg[i] & 0x40) ? 2 : 1);
+            mod->cons |= (cfg[i] & 0x80) ? 1 : 0;
+            i++;
+        }
+        if( b & 0x40 ) {                                // Input length byte after the output
+            if( i >= n ) {  return( -1 );  }
+            in        += ((cfg[i] & 0x3F) + 1) * ((cfg[i] & 0x40) ? 2 : 1);
+            mod->cons |= (cfg[i] & 0x80) ? 1 : 0;
+            i++;
+        }
+        i += b & 0x0F;                                  // Manufacturer specific data
+    }
+    if( (i != n) || (in > GSD_IO_MAX) || (out > GSD_IO_MAX) ) {
+        return( -1 );
+    }
+    mod->in_len  = (uint8_t)in;
+    mod->out_len = (uint8_t)out;
+    return( 0 );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Parse a "Module" line: "Module = "Name" 0x13, 0x23".
+***
+*** @param[out] mod     "Module" of the GSD file
+*** @param[in]  val     Value after "="
+***
+*** @return     (< 0)Invalid "Module", (0)Succeed.
+***********************************************************************************************************/
+
+static int gsd_module(GSD_FILE_MOD *mod, const char *val)
+{
+    uint8_t     cfg[GSD_CFG_MAX];
+    char       *end;
+    long        v;
+    int         n;
+
+    if( (val = strchr(val, '"')) == NULL ) /***/ { return( -1 ); }
+    if( (val = strchr(val + 1, '"')) == NULL ) { return( -1 ); }
+    for(n = 0, val++;  ;  n++) {
+        while( isspace((unsigned char)*val) || (*val == ',') ) {
+            val++;
+        }
+        if( *val == '\0' ) {
+            break;
+        }
+        v = strtol(val, &end, 0);
+        if( (end == val) || (v < 0) || (v > 0xFF) || (n >= GSD_CFG_MAX) ) {
+            return( -1 );
+        }
+        cfg[n] = (uint8_t)v;
+        val    = end;
+    }
+    return( gsd_module_cfg(mod, cfg, n) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Parse a GSD file, Ident_Number and the I/O lengths of the "Module"s.
+***
+*** @param[in]  fp      GSD file
+*** @param[out] gsd     GSD file parsed, (gsd->line) the line of the first error
+***
+*** @return     (< 0)Error, (other)Number of "Module".
+***********************************************************************************************************/
+
+int gsd_parse(FILE *fp, GSD_FILE *gsd)
+{
+    const char *val;
+    uint16_t    line = 0;
+
+    memset(gsd, 0, sizeof(*gsd));
+    while( gsd_getline(fp, &line) ) {
+        if( (val = gsd_keyword(g_GsdLine, "Ident_Number")) != NULL ) {
+            gsd->ident = (uint16_t)strtol(val, NULL, 0);
+        } else if( (val = gsd_keyword(g_GsdLine, "Module")) != NULL ) {
+            if( (gsd->mod_num >= GSD_FILE_MOD_MAX) || (gsd_module(&gsd->mod[gsd->mod_num], val) < 0) ) {
+                gsd->line = line;
+                return( -1 );
+            }
+            gsd->mod_num++;
+        }
+    }
+    return( gsd->mod_num );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Get the path of GSD file of a rule.
+***
+*** @param[in]  rule    Rule "ADDR FILE MODULE,MODULE,..."
+*** @param[out] path    Path of GSD file, on drive GSD_DRIVE if no drive given
+*** @param[in]  size    size of path(in bytes)
+***
+*** @return     (< 0)Invalid rule, (other)Offset of the module list in the rule.
+***********************************************************************************************************/
+
+int gsd_rule_file(const char *rule, char *path, int size)
+{
+    const char *p = rule, *file;
+    int         n;
+
+    while( isspace((unsigned char)*p) )  { p++; }      // ADDR
+    while( isdigit((unsigned char)*p) )  { p++; }
+    while( isspace((unsigned char)*p) )  { p++; }      // FILE
+    for(file = p;  (*p != '\0') && !isspace((unsigned char)*p);  p++) {
+    }
+    if( (p == file) || (file == rule) ) {
+        return( -1 );
+    }
+    n = snprintf( path, size, "%s%.*s", (memchr(file, ':', p - file) == NULL) ? GSD_DRIVE : "",
+                  (int)(p - file), file );
+    if( (n < 0) || (n >= size) ) {
+        return( -1 );
+    }
+    return( (int)(p - rule) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Initialize an empty layout table.
+***
+*** @param[out] tab     Layout table
+***********************************************************************************************************/
+
+void gsd_table_init(GSD_TABLE *tab)
+{
+    memset(tab, 0, sizeof(*tab));
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Add a slave of a rule to the layout table, the GSD file parsed.
+***
+*** @param[in]  tab     Layout table
+*** @param[in]  rule    Rule "ADDR FILE MODULE,MODULE,..."
+*** @param[out] gsd     Buffer of the GSD file parsed
+***
+*** @return     (-1)Invalid rule, (-2)GSD file not found, (-3)Invalid GSD file, (-4)Invalid module number,
+***             (-5)Table full, (-6)Inputs or outputs too long, (0)Succeed.
+***********************************************************************************************************/
+
+int gsd_table_add(GSD_TABLE *tab, const char *rule, GSD_FILE *gsd)
+{
+    GSD_SLAVE      *slv;
+    GSD_MODULE     *mod;
+    FILE           *fp;
+    char            path[64], *end;
+    const char     *p;
+    long            addr, k;
+    uint32_t        in = 0, out = 0;
+    int             ret, group = 0;
+
+    if( ((ret = gsd_rule_file(rule, path, sizeof(path))) < 0) ) {
+        return( -1 );
+    }
+    addr = strtol(rule, NULL, 10);
+    if( (addr < 0) || (addr >= 127) || (gsd_table_slave(tab, (int)addr) != NULL) ) {
+        return( -1 );
+    }
+    if( tab->slave_num >= GSD_SLAVE_MAX ) {
+        return( -5 );
+    }
+    if( (fp = fopen(path, "r")) == NULL ) {
+        return( -2 );
+    }
+    ret = (gsd_parse(fp, gsd) < 0) ? (-3) : (ret);
+    fclose(fp);
+    if( ret < 0 ) {
+        return( ret );
+    }
+
+    slv            = &tab->slave[tab->slave_num];
+    slv->addr      = (uint8_t)addr;
+    slv->ident     = gsd->ident;
+    slv->mod_first = tab->mod_num;
+    slv->mod_num   = 0;
+    for(p = &rule[ret];  ;  p = end) {
+        while( isspace((unsigned char)*p) || (*p == ',') ) {
+            p++;
+        }
+        if( *p == '\0' ) {
+            break;
+        }
+        k = strtol(p, &end, 10);
+        if( (end == p) || (k < 1) || (k > gsd->mod_num) ) {
+            ret = -4;
+            break;
+        }
+        if( (tab->mod_num >= GSD_MODULE_MAX) || (slv->mod_num >= 0xFF) ) {
+            ret = -5;
+            break;
+        }
+        mod          = &tab->mod[tab->mod_num];
+        mod->in_off  = (uint8_t)in;
+        mod->in_len  = gsd->mod[k - 1].in_len;
+        mod->out_off = (uint8_t)out;
+        mod->out_len = gsd->mod[k - 1].out_len;
+        mod->group   = gsd->mod[k - 1].cons ? (uint8_t)(group++) : GSD_GROUP_NONE;
+        in          += mod->in_len;
+        out         += mod->out_len;
+        if( (in > GSD_IO_MAX) || (out > GSD_IO_MAX) ) {
+            ret = -6;
+            break;
+        }
+        tab->mod_num++;
+        slv->mod_num++;
+    }
+    if( ret < 0 ) {
+        tab->mod_num = slv->mod_first;                  // Modules of the slave removed
+        return( ret );
+    }
+    slv->in_len  = (uint8_t)in;
+    slv->out_len = (uint8_t)out;
+    tab->slave_num++;                                   // Not counted until complete
+    return( 0 );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Seal the layout table with the stamp of the sources and CRC, ready to be stored.
+***
+*** @param[in]  tab     Layout table
+*** @param[in]  stamp   Stamp of the sources, rules and GSD files
+***********************************************************************************************************/
+
+void gsd_table_seal(GSD_TABLE *tab, uint32_t stamp)
+{
+    tab->magic = GSD_TABLE_MAGIC;
+    tab->stamp = stamp;
+    tab->crc   = (uint32_t)crc32_pkzip( CRC32_PKZIP_INIT, &tab->slave_num,
+                                        sizeof(*tab) - offsetof(GSD_TABLE, slave_num) ) ^ CRC32_PKZIP_XOROUT;
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Check a layout table loaded as is.
+***
+*** @param[in]  tab     Layout table
+*** @param[in]  stamp   Stamp of the sources, rules and GSD files
+***
+*** @return     (0)Invalid or out of date, (other)Valid.
+***********************************************************************************************************/
+
+int gsd_table_check(const GSD_TABLE *tab, uint32_t stamp)
+{
+    uint32_t    crc;
+
+    if(   (tab->magic != GSD_TABLE_MAGIC) || (tab->stamp != stamp)
+       || (tab->slave_num > GSD_SLAVE_MAX) || (tab->mod_num > GSD_MODULE_MAX) ) {
+        return( 0 );
+    }
+    crc = (uint32_t)crc32_pkzip( CRC32_PKZIP_INIT, &tab->slave_num,
+                                 sizeof(*tab) - offsetof(GSD_TABLE, slave_num) ) ^ CRC32_PKZIP_XOROUT;
+    return( crc == tab->crc );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Find a slave in the layout table.
+***
+*** @param[in]  tab     Layout table
+*** @param[in]  addr    Address of the slave
+***
+*** @return     NULL if not found, or the slave.
+***********************************************************************************************************/
+
+const GSD_SLAVE* gsd_table_slave(const GSD_TABLE *tab, int addr)
+{
+    int     i;
+
+    for(i = 0;  i < tab->slave_num;  i++) {
+        if( tab->slave[i].addr == addr ) {
+            return( &tab->slave[i] );
+        }
+    }
+    return( NULL );
+}
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+*** @}
+***********************************************************************************************************/
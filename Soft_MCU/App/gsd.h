@@ -0,0 +1,128 @@
+/**********************************************************************************************************/
+/** @file     gsd.h
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    GSD file parser and slave layout compiler, portable C for the gateway and the host.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************/
+#ifndef __GSD_H___20261018_210602
+#define __GSD_H___20261018_210602
+#include    <stdint.h>
+#include    <stdio.h>                   /* FILE                               */
+#ifdef  __cplusplus
+extern  "C"
+{
+#endif
+/**********************************************************************************************************/
+/** @addtogroup GSD
+*** @{
+*** @addtogroup                 GSD_Exported_Constants
+*** @{
+***********************************************************************************************************/
+
+/*  Slave of the layout table, "[Layout]  SLAVEn = ADDR FILE MODULE,MODULE,...", n = 1 ~ GSD_SLAVE_MAX:
+ *
+ *  ADDR      --- address of the slave.
+ *  FILE      --- GSD file of the slave, on drive F0: if no drive given.
+ *  MODULE    --- number of the "Module" in the GSD file, 1 for the first, in order of the slots.
+ *
+ *  The I/O lengths of a module are computed from the identifier bytes of the "Module" (compact and
+ *  special format). A module with the consistency bit set is a consistency group of its own, the
+ *  other modules are consistent in byte or word only, GSD_GROUP_NONE.
+ */
+#define GSD_SLAVE_MAX       32                      /* Max number of slaves in the table        */
+#define GSD_MODULE_MAX      256                     /* Max number of modules in the table       */
+#define GSD_FILE_MOD_MAX    128                     /* Max number of "Module" in a GSD file     */
+#define GSD_IO_MAX          244                     /* Max length of inputs or outputs of a slave   */
+#define GSD_GROUP_NONE      0xFF                    /* Module not in a consistency group        */
+
+#define GSD_TABLE_MAGIC     0x44534731              /* "GSD1", magic of the binary table        */
+
+#ifndef GSD_DRIVE
+#define GSD_DRIVE           "F0:"                   /* Drive of GSD files, "" for the host      */
+#endif
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 GSD_Exported_Types
+*** @{
+***********************************************************************************************************/
+
+typedef struct {    /*------------- "Module" of a GSD file --------------------------------------*/
+    uint8_t                     in_len;     /* Length of inputs(Byte)           */
+    uint8_t                     out_len;    /* Length of outputs(Byte)          */
+    uint8_t                     cons;       /* Consistency over the whole length    */
+    uint8_t                     rsv;        /* Reserved                         */
+} GSD_FILE_MOD;
+
+typedef struct {    /*------------- GSD file parsed -------------------------------------------------*/
+    uint16_t                    ident;      /* Ident_Number                     */
+    uint16_t                    mod_num;    /* Number of "Module"               */
+    uint16_t                    line;       /* Line of the first error, (0)No error */
+    uint16_t                    rsv;        /* Reserved                         */
+    GSD_FILE_MOD                mod[GSD_FILE_MOD_MAX];
+} GSD_FILE;
+
+typedef struct {    /*------------- Module of a slave in the table ------------------------------*/
+    uint8_t                     in_off;     /* Offset of inputs in the slave inputs     */
+    uint8_t                     in_len;     /* Length of inputs(Byte)           */
+    uint8_t                     out_off;    /* Offset of outputs in the slave outputs   */
+    uint8_t                     out_len;    /* Length of outputs(Byte)          */
+    uint8_t                     group;      /* Consistency group, GSD_GROUP_NONE for none   */
+    uint8_t                     rsv[3];     /* Reserved                         */
+} GSD_MODULE;
+
+typedef struct {    /*------------- Slave in the table ------------------------------------------*/
+    uint8_t                     addr;       /* Address of the slave             */
+    uint8_t                     mod_num;    /* Number of modules                */
+    uint16_t                    ident;      /* Ident_Number                     */
+    uint16_t                    mod_first;  /* Index of the first module in the table   */
+    uint8_t                     in_len;     /* Length of the slave inputs(Byte) */
+    uint8_t                     out_len;    /* Length of the slave outputs(Byte)*/
+} GSD_SLAVE;
+
+typedef struct {    /*------------- Binary layout table, stored as is -------------------------------*/
+    uint32_t                    magic;      /* GSD_TABLE_MAGIC                  */
+    uint32_t                    stamp;      /* Stamp of the sources, rules and GSD files    */
+    uint32_t                    crc;        /* CRC32 of the table after this field  */
+    uint16_t                    slave_num;  /* Number of slaves                 */
+    uint16_t                    mod_num;    /* Number of modules                */
+    GSD_SLAVE                   slave[GSD_SLAVE_MAX];
+    GSD_MODULE                  mod[GSD_MODULE_MAX];
+} GSD_TABLE;
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 GSD_Exported_Functions
+*** @{
+***********************************************************************************************************/
+
+extern int  gsd_parse(FILE *fp, GSD_FILE *gsd);
+extern int  gsd_rule_file(const char *rule, char *path, int size);
+extern void gsd_table_init(GSD_TABLE *tab);
+extern int  gsd_table_add(GSD_TABLE *tab, const char *rule, GSD_FILE *gsd);
+extern void gsd_table_seal(GSD_TABLE *tab, uint32_t stamp);
+extern int  gsd_table_check(const GSD_TABLE *tab, uint32_t stamp);
+extern const GSD_SLAVE* gsd_table_slave(const GSD_TABLE *tab, int addr);
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+*****/
+#ifdef  __cplusplus
+}
+#endif
+#endif
+/**********************************************************************************************************/
@@ -0,0 +1,216 @@
+/**********************************************************************************************************/
+/** @file     isrprof.c
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    Cycles of the ProfiBUS_DP interrupts by source, with the sequence of the worst case.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************/
+
+#include    <stdint.h>
+#include    <stdio.h>
+#include    <string.h>
+
+#include    "stm32f4xx.h"               /* PRIMASK, SystemCoreClock           */
+#include    "board.h"
+#include    "isrprof.h"
+
+
+/**********************************************************************************************************/
+/** @addtogroup ISRPROF
+*** @{
+*** @addtogroup ISRPROF_Pravate
+*** @{
+*** @addtogroup                 ISRPROF_Private_Types
+*** @{
+***********************************************************************************************************/
+
+typedef struct {    /*------------- ISR profile (Run-Time) ----------------------------------------
+                    -- by isrprof_end() only, USART6 and TIM3 of the same priority never nest -----*/
+    uint32_t                    since;      /* Timestamp(us) of switched on     */
+    uint32_t                    until;      /* Timestamp(us) of switched off    */
+    uint32_t                    head;       /* Interrupts of the sequence(free running) */
+    ISRPROF_EVT                 seq[ISRPROF_SEQ_LEN];
+    ISRPROF_SRC                 src[ISRPROF_SRC_NUM];
+} ISRPROF_INFO;
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 ISRPROF_Private_Variables
+*** @{
+***********************************************************************************************************/
+
+volatile int                g_IsrProfOn = 0;                /* Profile switched on              */
+
+static ISRPROF_INFO         g_IsrProf;
+static const char * const   g_IsrProfName[ISRPROF_SRC_NUM] = { "ERR", "RXNE", "TXE", "TC", "IDLE", "TIM" };
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 ISRPROF_Private_Functions
+*** @{
+***********************************************************************************************************/
+/** @brief      Switch the profile on or off, the statistics cleared when switched on.
+***
+*** @param[in]  on      (0)Off, (other)On
+***********************************************************************************************************/
+
+void isrprof_enable(int on)
+{
+    uint32_t    primask;
+    int         i;
+
+    if( !on ) {
+        if( g_IsrProfOn ) {
+            g_IsrProf.until = bsp_timestamp();
+            g_IsrProfOn     = 0;
+        }
+        return;
+    }
+    if( g_IsrProfOn ) {
+        return;
+    }
+    primask = __get_PRIMASK();
+    __disable_irq();
+    memset(&g_IsrProf, 0, sizeof(g_IsrProf));
+    for(i = 0;  i < ISRPROF_SRC_NUM;  i++) {
+        g_IsrProf.src[i].min = 0xFFFFFFFFu;
+    }
+    g_IsrProf.since = bsp_timestamp();
+    g_IsrProfOn     = 1;
+    __set_PRIMASK(primask);
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Count an interrupt at the exit, ref: ISRPROF_END().
+***
+*** @param[in]  mask    Sources served, bit (0x1 << ISRPROF_SRC_x)
+*** @param[in]  start   Cycles at the entry, ref: ISRPROF_BEGIN()
+***********************************************************************************************************/
+
+void isrprof_end(uint32_t mask, uint32_t start)
+{
+    uint32_t        cyc = bsp_cycles() - start;
+    ISRPROF_EVT    *evt;
+    ISRPROF_SRC    *src;
+    int             i;
+
+    for(i = 0;  (i < (ISRPROF_SRC_NUM - 1)) && !(mask & ISRPROF_BIT(i));  i++) {
+    }
+    evt         = &g_IsrProf.seq[g_IsrProf.head++ % ISRPROF_SEQ_LEN];
+    evt->start  = start;
+    evt->src    = (uint8_t)i;
+    evt->mask   = (uint8_t)mask;
+    evt->cycles = (uint16_t)((cyc < 0xFFFF) ? (cyc) : (0xFFFF));
+
+    src = &g_IsrProf.src[i];
+    src->cnt++;
+    src->sum += cyc;
+    if( cyc < src->min ) {
+        src->min = cyc;
+    }
+    if( cyc > src->max ) {                              // The worst case, with the interrupts before
+        src->max = cyc;
+        for(i = 0;  i < ISRPROF_SEQ_LEN;  i++) {
+            src->worst[i] = g_IsrProf.seq[(g_IsrProf.head + i) % ISRPROF_SEQ_LEN];
+        }
+    }
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Get the statistics of a source.
+***
+*** @param[in]  src     Source, ISRPROF_SRC_x
+*** @param[out] stat    Statistics of the source
+***
+*** @return     (0)No such source, (other)Succeed.
+***********************************************************************************************************/
+
+int isrprof_get(int src, ISRPROF_SRC *stat)
+{
+    uint32_t    primask;
+
+    if( (src < 0) || (src >= ISRPROF_SRC_NUM) ) {
+        return( 0 );
+    }
+    primask = __get_PRIMASK();
+    __disable_irq();                                    // A source copied only
+    memcpy(stat, &g_IsrProf.src[src], sizeof(*stat));
+    __set_PRIMASK(primask);
+    return( 1 );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Get the profile, "ON/OFF, load", min/mean/max of the sources, and the worst case sequences
+***             "cycles before the worst:source/cycles".
+***
+*** @param[out] buff    Output statistic information string
+*** @param[in]  size    size of buff(in bytes)
+***
+*** @return     (< 0)Error. (other)number of output char, not counting the terminating null char
+***********************************************************************************************************/
+
+int isrprof_statc(char *buff, int size)
+{
+    static ISRPROF_SRC  stat;
+    uint64_t            sum, span;
+    uint32_t            mhz = SystemCoreClock / 1000000;
+    int                 i, j, k, n, m;
+
+    if( (buff == NULL) || (size <= 0) )  { return( 0 );        }
+
+    for(sum = 0, i = 0;  i < ISRPROF_SRC_NUM;  i++) {
+        isrprof_get(i, &stat);
+        sum += stat.sum;
+    }
+    span = (uint64_t)((g_IsrProfOn ? bsp_timestamp() : g_IsrProf.until) - g_IsrProf.since) * mhz;
+    n = snprintf( buff, size, "ISR: %s, Load: %u.%02u%%(%u MHz)", g_IsrProfOn ? "ON" : "OFF",
+                  (unsigned)((span == 0) ? 0 : ((sum * 10000) / span) / 100),
+                  (unsigned)((span == 0) ? 0 : ((sum * 10000) / span) % 100), mhz );
+
+    for(i = 0;  (i < ISRPROF_SRC_NUM) && (n >= 0) && (n < size);  i++) {
+        isrprof_get(i, &stat);
+        if( stat.cnt == 0 ) {
+            continue;
+        }
+        m = snprintf( &buff[n], size - n, "\r\n  %-4s %u %u/%u/%u(Min/Mean/Max) Worst:", g_IsrProfName[i],
+                      stat.cnt, stat.min, (uint32_t)(stat.sum / stat.cnt), stat.max );
+        for(j = 0;  (j < ISRPROF_SEQ_LEN) && (m >= 0) && ((n + m) < size);  j++) {
+            if( stat.worst[j].mask == 0 ) {
+                continue;                               // Not the interrupts since switched on
+            }
+            k  = snprintf( &buff[n + m], size - n - m, " -%u:%s/%u",
+                           stat.worst[ISRPROF_SEQ_LEN - 1].start - stat.worst[j].start,
+                           g_IsrProfName[stat.worst[j].src], stat.worst[j].cycles );
+            m  = (k < 0) ? (k) : (m + k);
+        }
+        if( m < 0 ) /******************/ { break;              }
+        n += m;
+    }
+    if( (n >= 0) && (n < size) ) {
+        if( (m = snprintf(&buff[n], size - n, "\r\n")) > 0 ) { n += m; }
+    }
+    if( n < 0 ) /**********************/ { return( n );        }
+    if( n >= size ) /******************/ { return( size - 1 ); }
+    return( n );
+}
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+*** @}
+***********************************************************************************************************/
@@ -0,0 +1,108 @@
+/**********************************************************************************************************/
+/** @file     isrprof.h
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    Cycles of the ProfiBUS_DP interrupts by source, with the sequence of the worst case.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************/
+#ifndef __ISRPROF_H___20261019_003105
+#define __ISRPROF_H___20261019_003105
+#ifdef  __cplusplus
+extern  "C"
+{
+#endif
+/**********************************************************************************************************/
+/** @addtogroup ISRPROF
+*** @{
+*** @addtogroup                 ISRPROF_Exported_Constants
+*** @{
+***********************************************************************************************************/
+
+/*  The cycles from the entry to the exit of USART6_IRQHandler() and TIM3_IRQHandler(), ref:
+ *  bsp_cycles(), without the 12 cycles of the exception entry and the exit, and with the time of the
+ *  interrupts of higher priority. An interrupt served several sources is counted to the first of
+ *  them in the order of ISRPROF_SRC_x, all the sources are kept in the sequence.
+ *
+ *  The last ISRPROF_SEQ_LEN interrupts are kept, and copied to the source as its worst case when the
+ *  interrupt is the max of the source.
+ *
+ *  Off by default, switched at runtime by isrprof_enable(), the statistics cleared when switched on.
+ *  The cost while off is a test of g_IsrProfOn at the entry and the exit.
+ */
+#define ISRPROF_SRC_ERR     0                       /* USART PE, FE, NE or ORE                  */
+#define ISRPROF_SRC_RXNE    1                       /* USART char received                      */
+#define ISRPROF_SRC_TXE     2                       /* USART transmit data register empty       */
+#define ISRPROF_SRC_TC      3                       /* USART transmission complete              */
+#define ISRPROF_SRC_IDLE    4                       /* USART line idle                          */
+#define ISRPROF_SRC_TIM     5                       /* TIM3 update, bus idle check              */
+#define ISRPROF_SRC_NUM     6
+
+#define ISRPROF_SEQ_LEN     8                       /* Interrupts of the worst case sequence    */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 ISRPROF_Exported_Types
+*** @{
+***********************************************************************************************************/
+
+typedef struct {    /*------------- Interrupt of the sequence -------------------------------------*/
+    uint32_t                    start;      /* Cycles at the entry              */
+    uint8_t                     src;        /* Source counted to, ISRPROF_SRC_x */
+    uint8_t                     mask;       /* All the sources, bit (0x1 << ISRPROF_SRC_x)  */
+    uint16_t                    cycles;     /* Cycles of the interrupt, 0xFFFF for more */
+} ISRPROF_EVT;
+
+typedef struct {    /*------------- Statistics of a source ----------------------------------------*/
+    uint32_t                    cnt;        /* Counter of the interrupts        */
+    uint32_t                    min;        /* Min cycles                       */
+    uint32_t                    max;        /* Max cycles                       */
+    uint64_t                    sum;        /* Sum of cycles                    */
+    ISRPROF_EVT                 worst[ISRPROF_SEQ_LEN]; /* Sequence up to the max, oldest first */
+} ISRPROF_SRC;
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 ISRPROF_Exported_Macros
+*** @{
+***********************************************************************************************************/
+
+extern volatile int         g_IsrProfOn;
+
+#define ISRPROF_BIT(src)            (0x1u << (src))
+#define ISRPROF_BEGIN()             ( g_IsrProfOn ? bsp_cycles() : 0 )
+#define ISRPROF_END(mask, start)    ( (g_IsrProfOn && ((start) != 0) && ((mask) != 0))                  \
+                                      ? isrprof_end(mask, start) : (void)0 )
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 ISRPROF_Exported_Functions
+*** @{
+***********************************************************************************************************/
+
+extern void isrprof_enable(int on);
+extern void isrprof_end(uint32_t mask, uint32_t start);
+extern int  isrprof_get(int src, ISRPROF_SRC *stat);
+extern int  isrprof_statc(char *buff, int size);
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+*****/
+#ifdef  __cplusplus
+}
+#endif
+#endif
+/**********************************************************************************************************/
@@ -0,0 +1,280 @@
+/**********************************************************************************************************/
+/** @file     latency.c
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    Latency of the bridge by stages, from the host request to the slave response forwarded.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************/
+
+#include    <stdint.h>
+#include    <stdio.h>
+#include    <string.h>
+
+#include    "board.h"
+#include    "ProfiBUS_DP.h"
+#include    "latency.h"
+
+
+/**********************************************************************************************************/
+/** @addtogroup LATENCY
+*** @{
+*** @addtogroup LATENCY_Pravate
+*** @{
+*** @addtogroup                 LATENCY_Private_Constants
+*** @{
+***********************************************************************************************************/
+
+#define LATENCY_IDLE        0                       /* State: no request timed                  */
+#define LATENCY_QUEUED      1                       /* State: request waiting for the bus       */
+#define LATENCY_PENDING     2                       /* State: request sent, waiting for response*/
+#define LATENCY_MATCHED     3                       /* State: response received, not forwarded  */
+
+#define LATENCY_STAMP_NUM   7                       /* NET_RX ~ NET_TX                          */
+#define LATENCY_US_MAX      1000000                 /* Max latency of a stage(us), or discarded */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 LATENCY_Private_Types
+*** @{
+***********************************************************************************************************/
+
+typedef struct {    /*------------- Latency of the bridge (Run-Time) ------------------------------------
+                    -- (state) IDLE to QUEUED and PENDING by thread_net2dp, to MATCHED and IDLE -------
+                    -- by thread_dp2net ------------------------------------------------------------*/
+    volatile uint8_t            state;      /* LATENCY_xxx                      */
+    uint8_t                     da;         /* DA of the request                */
+    uint8_t                     sa;         /* SA of the request                */
+    uint8_t                     sd;         /* SD of the response on the bus   */
+    uint32_t                    stamp[LATENCY_STAMP_NUM];   /* Timestamps of the request(us)    */
+    uint32_t                    skip;       /* Requests with invalid timestamps */
+    LATENCY_STAGE               stage[LATENCY_STAGE_NUM];
+} LATENCY_INFO;
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 LATENCY_Private_Variables
+*** @{
+***********************************************************************************************************/
+
+static LATENCY_INFO         g_Latency;
+static const char * const   g_LatencyName[LATENCY_STAGE_NUM] = {
+    "Queue", "Tx", "Tsdr", "Resp", "Wake", "Fwd", "Total"
+};
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 LATENCY_Private_Functions
+*** @{
+***********************************************************************************************************/
+/** @brief      Time a request from the host, called by thread_net2dp before PBDP_Send(), the frames
+***             received are not matched until latency_sent().
+***
+*** @param[in]  buff    Pointer to the DP frame
+*** @param[in]  len     Length  of the DP frame
+*** @param[in]  stamp   Timestamp of the datagram received, ref: bsp_timestamp()
+***********************************************************************************************************/
+
+void latency_request(const uint8_t *buff, int len, uint32_t stamp)
+{
+    int     fc;
+
+    if( g_Latency.state != LATENCY_IDLE ) {
+        return;                                         // Last request not forwarded yet
+    }
+    if( (buff[0] == 0x10) && (len >= 4) ) {             // SD1: SD DA SA FC FCS ED
+        g_Latency.da = buff[1] & 0x7F;  g_Latency.sa = buff[2] & 0x7F;  fc = buff[3];
+    } else if( (buff[0] == 0x68) && (len >= 7) ) {      // SD2: SD LE LEr SD DA SA FC ...
+        g_Latency.da = buff[4] & 0x7F;  g_Latency.sa = buff[5] & 0x7F;  fc = buff[6];
+    } else {
+        return;                                         // SD3 with no reply, SD4, SC
+    }
+    if( !(fc & 0x40) || ((fc & 0x4F) == 0x44) || ((fc & 0x4F) == 0x46) || (g_Latency.da == 127) ) {
+        return;                                         // Not a request with reply
+    }
+    g_Latency.stamp[0] = stamp;
+    g_Latency.state    = LATENCY_QUEUED;
+}
+
+
+/**********************************************************************************************************/
+/** @brief      The request timed is sent and replied, called by thread_net2dp after PBDP_Send().
+***
+***             PBDP_Send() returns at the first char of the response, so the timestamps of the request and
+***             the SD of the response on the bus are its own, the first frame received after is matched.
+***********************************************************************************************************/
+
+void latency_sent(void)
+{
+    const PBDP_STAMP   *bus;
+
+    if( g_Latency.state != LATENCY_QUEUED ) {
+        return;
+    }
+    bus = PBDP_GetStamp();
+    g_Latency.stamp[1] = bus->tx_start;
+    g_Latency.stamp[2] = bus->tx_end;
+    g_Latency.stamp[3] = bus->rx_start;
+    g_Latency.sd       = bus->rx_sd;
+    g_Latency.state    = LATENCY_PENDING;
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Cancel the request timed, called by thread_net2dp if PBDP_Send() failed.
+***********************************************************************************************************/
+
+void latency_cancel(void)
+{
+    if( g_Latency.state == LATENCY_QUEUED ) {
+        g_Latency.state = LATENCY_IDLE;
+    }
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Match a frame received to the response of the request timed, called by thread_dp2net.
+***
+***             The first frame received after latency_sent() decides: the response has the SD seen on the
+***             bus after the request, the addresses of the request swapped, and the same first char, or
+***             the request is not timed. A SC of other traffic received before is never matched.
+***
+*** @param[in]  buff    Pointer to the DP frame
+*** @param[in]  len     Length  of the DP frame
+*** @param[in]  stamp   Timestamp of the DP frame, ref: bsp_timestamp()
+***
+*** @return     (0)Not the response, (1)Response of the request timed.
+***********************************************************************************************************/
+
+int latency_response(const uint8_t *buff, int len, uint32_t stamp)
+{
+    const PBDP_STAMP   *bus;
+
+    if( g_Latency.state != LATENCY_PENDING ) {
+        return( 0 );
+    }
+    bus = PBDP_GetStamp();
+    if( (len < 1) || (buff[0] != g_Latency.sd) || (bus->rx_start != g_Latency.stamp[3]) ) {
+        goto RESP_SKIP;                                 // Not the response, or another one on the bus
+    }
+    if( (buff[0] == 0x10) && (len >= 3) ) {             // SD1
+        if( ((buff[1] & 0x7F) != g_Latency.sa) || ((buff[2] & 0x7F) != g_Latency.da) )  goto RESP_SKIP;
+    } else if( (buff[0] == 0x68) && (len >= 6) ) {      // SD2
+        if( ((buff[4] & 0x7F) != g_Latency.sa) || ((buff[5] & 0x7F) != g_Latency.da) )  goto RESP_SKIP;
+    } else if( buff[0] != 0xE5 ) {
+        goto RESP_SKIP;                                 // Not SC, nor the response
+    }
+    g_Latency.stamp[4] = bus->rx_end;
+    g_Latency.stamp[5] = stamp;
+    g_Latency.state    = LATENCY_MATCHED;
+    return( 1 );
+
+    RESP_SKIP:  g_Latency.skip++;
+    g_Latency.state = LATENCY_IDLE;
+    return( 0 );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      End of the request timed, called by thread_dp2net after the response forwarded or not.
+***********************************************************************************************************/
+
+void latency_done(void)
+{
+    LATENCY_STAGE  *stg;
+    uint32_t        us[LATENCY_STAGE_NUM];
+    int             i;
+
+    if( g_Latency.state != LATENCY_MATCHED ) {
+        return;
+    }
+    g_Latency.stamp[6] = bsp_timestamp();
+    for(i = 0;  i < (LATENCY_STAMP_NUM - 1);  i++) {
+        us[i] = g_Latency.stamp[i + 1] - g_Latency.stamp[i];
+        if( us[i] >= LATENCY_US_MAX ) {
+            g_Latency.skip++;                           // Timestamps of other request on the bus
+            g_Latency.state = LATENCY_IDLE;
+            return;
+        }
+    }
+    us[LATENCY_TOTAL] = g_Latency.stamp[6] - g_Latency.stamp[0];
+    for(i = 0;  i < LATENCY_STAGE_NUM;  i++) {
+        stg       = &g_Latency.stage[i];
+        stg->min  = ((stg->cnt == 0) || (us[i] < stg->min)) ? (us[i]) : (stg->min);
+        stg->max  = (us[i] > stg->max) ? (us[i]) : (stg->max);
+        stg->sum += us[i];
+        stg->cnt += 1;
+    }
+    g_Latency.state = LATENCY_IDLE;
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Get latency of a stage.
+***
+*** @param[in]  idx     LATENCY_QUEUE ~ LATENCY_TOTAL
+*** @param[out] stage   Latency of the stage
+***
+*** @return     (0)No such stage, (other)Succeed.
+***********************************************************************************************************/
+
+int latency_stage(int idx, LATENCY_STAGE *stage)
+{
+    if( (idx < 0) || (idx >= LATENCY_STAGE_NUM) ) {
+        return( 0 );
+    }
+    memcpy(stage, &g_Latency.stage[idx], sizeof(*stage));
+    return( 1 );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Get the latency breakdown of the bridge.
+***
+*** @param[out] buff    Output statistic information string
+*** @param[in]  size    size of buff(in bytes)
+***
+*** @return     (< 0)Error. (other)number of output char, not counting the terminating null char
+***********************************************************************************************************/
+
+int latency_statc(char *buff, int size)
+{
+    LATENCY_STAGE   stg;
+    int             i, n, m;
+
+    if( (buff == NULL) || (size <= 0) )  { return( 0 );        }
+
+    n = snprintf( buff, size, "Latency: %u(Request) %u(Skip), Min/Avg/Max(us)",
+                  g_Latency.stage[LATENCY_TOTAL].cnt, g_Latency.skip );
+    for(i = 0;  (i < LATENCY_STAGE_NUM) && (n >= 0) && (n < size);  i++) {
+        latency_stage(i, &stg);
+        m = snprintf( &buff[n], size - n, "%s %s %u/%u/%u", (i == 0) ? (":") : (","), g_LatencyName[i],
+                      stg.min, (stg.cnt == 0) ? (0) : (stg.sum / stg.cnt), stg.max );
+        if( m < 0 ) /******************/ { break;              }
+        n += m;
+    }
+    if( (n >= 0) && (n < size) ) {
+        if( (m = snprintf(&buff[n], size - n, "\r\n")) > 0 ) { n += m; }
+    }
+    if( n < 0 ) /**********************/ { return( n );        }
+    if( n >= size ) /******************/ { return( size - 1 ); }
+    return( n );
+}
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+*** @}
+***********************************************************************************************************/
@@ -0,0 +1,91 @@
+/**********************************************************************************************************/
+/** @file     latency.h
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    Latency of the bridge by stages, from the host request to the slave response forwarded.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************/
+#ifndef __LATENCY_H___20261018_214520
+#define __LATENCY_H___20261018_214520
+#ifdef  __cplusplus
+extern  "C"
+{
+#endif
+/**********************************************************************************************************/
+/** @addtogroup LATENCY
+*** @{
+*** @addtogroup                 LATENCY_Exported_Constants
+*** @{
+***********************************************************************************************************/
+
+/*  A request with reply from the host to PORT_NET2DP is timed through the stages of the bridge:
+ *
+ *      NET_RX   --- thread_net2dp received the datagram
+ *      TX_START --- first char of the request sent, after the bus idle time, ref: PBDP_GetStamp()
+ *      TX_END   --- last char of the request sent
+ *      RX_START --- first char of the response
+ *      RX_END   --- last char of the response
+ *      DP_RX    --- thread_dp2net received the response frame
+ *      NET_TX   --- thread_dp2net handed the response over to the stack
+ *
+ *  One request is timed at a time, the requests while the response of the last one is not forwarded yet
+ *  are not timed. The response is the first frame received after PBDP_Send() returned the request sent,
+ *  the frames received while the request is waiting for the bus are not matched.
+ */
+#define LATENCY_QUEUE       0                       /* Stage: NET_RX   to TX_START              */
+#define LATENCY_TX          1                       /* Stage: TX_START to TX_END                */
+#define LATENCY_TSDR        2                       /* Stage: TX_END   to RX_START              */
+#define LATENCY_RESP        3                       /* Stage: RX_START to RX_END                */
+#define LATENCY_WAKE        4                       /* Stage: RX_END   to DP_RX                 */
+#define LATENCY_FWD         5                       /* Stage: DP_RX    to NET_TX                */
+#define LATENCY_TOTAL       6                       /* Stage: NET_RX   to NET_TX                */
+#define LATENCY_STAGE_NUM   7                       /* Number of stages                         */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 LATENCY_Exported_Types
+*** @{
+***********************************************************************************************************/
+
+typedef struct {    /*------------- Latency of a stage ------------------------------------------------*/
+    uint32_t                    cnt;        /* Number of requests timed         */
+    uint32_t                    sum;        /* Sum of latency(us)               */
+    uint32_t                    min;        /* Min latency(us)                  */
+    uint32_t                    max;        /* Max latency(us)                  */
+} LATENCY_STAGE;
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 LATENCY_Exported_Functions
+*** @{
+***********************************************************************************************************/
+
+extern void latency_request(const uint8_t *buff, int len, uint32_t stamp);
+extern void latency_sent(void);
+extern void latency_cancel(void);
+extern int  latency_response(const uint8_t *buff, int len, uint32_t stamp);
+extern void latency_done(void);
+extern int  latency_stage(int idx, LATENCY_STAGE *stage);
+extern int  latency_statc(char *buff, int size);
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+*****/
+#ifdef  __cplusplus
+}
+#endif
+#endif
+/**********************************************************************************************************/
@@ -0,0 +1,162 @@
+/**********************************************************************************************************/
+/** @file     layout.c
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    Slave layout table, compiled from GSD files once and loaded as is at boot.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************/
+
+#include    <stdint.h>
+#include    <stdio.h>
+#include    <string.h>
+
+#include    "rl_fs.h"                   /* FileSystem definitions             */
+
+#include    "cfg.h"
+#include    "crc.h"
+#include    "gsd.h"
+#include    "layout.h"
+
+
+/**********************************************************************************************************/
+/** @addtogroup LAYOUT
+*** @{
+*** @addtogroup LAYOUT_Pravate
+*** @{
+*** @addtogroup                 LAYOUT_Private_Variables
+*** @{
+***********************************************************************************************************/
+
+static GSD_TABLE            g_Layout;                   /* Layout table                     */
+static GSD_FILE             g_LayoutGsd;                /* GSD file parsed, while compiling */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 LAYOUT_Private_Functions
+*** @{
+***********************************************************************************************************/
+/** @brief      Stamp of the sources, the rules and the size and time of the GSD files.
+***********************************************************************************************************/
+
+static uint32_t layout_stamp(void)
+{
+    fsFileInfo  info;
+    const char *rule;
+    char        path[64];
+    uint32_t    crc = CRC32_PKZIP_INIT;
+    int         n;
+
+    for(n = 1;  n <= GSD_SLAVE_MAX;  n++) {
+        if( (rule = cfg_get_layout_slave(n)) == NULL ) {
+            continue;
+        }
+        crc = crc32_pkzip(crc, &n, sizeof(n));
+        crc = crc32_pkzip(crc, rule, strlen(rule));
+        memset(&info, 0, sizeof(info));
+        if( (gsd_rule_file(rule, path, sizeof(path)) >= 0) && (ffind(path, &info) == fsOK) ) {
+            crc = crc32_pkzip(crc, &info.size, sizeof(info.size));
+            crc = crc32_pkzip(crc, &info.time, sizeof(info.time));
+        }
+    }
+    return( (uint32_t)crc );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Load the layout table, compile it from the GSD files only if the sources changed.
+***********************************************************************************************************/
+
+void layout_init(void)
+{
+    const char *rule;
+    uint32_t    stamp = layout_stamp();
+    FILE       *fp;
+    int         n, ret;
+
+    if( (fp = fopen(LAYOUT_FILE, "rb")) != NULL ) {
+        n = fread(&g_Layout, 1, sizeof(g_Layout), fp);
+        fclose(fp);
+        if( (n == sizeof(g_Layout)) && gsd_table_check(&g_Layout, stamp) ) {
+            printf("[LAYOUT] %u slaves, %u modules loaded\r\n", g_Layout.slave_num, g_Layout.mod_num);
+            return;
+        }
+    }
+
+    gsd_table_init(&g_Layout);
+    for(n = 1;  n <= GSD_SLAVE_MAX;  n++) {
+        if( (rule = cfg_get_layout_slave(n)) == NULL ) {
+            continue;
+        }
+        if( (ret = gsd_table_add(&g_Layout, rule, &g_LayoutGsd)) < 0 ) {
+            printf("[LAYOUT] SLAVE%d invalid(%d), GSD line %u: %s\r\n", n, ret, g_LayoutGsd.line, rule);
+        }
+    }
+    gsd_table_seal(&g_Layout, stamp);
+    printf("[LAYOUT] %u slaves, %u modules compiled, table: %u(Byte)\r\n",
+           g_Layout.slave_num, g_Layout.mod_num, (unsigned)sizeof(g_Layout));
+
+    if(   ((fp = fopen(LAYOUT_FILE, "wb")) == NULL)
+       || (fwrite(&g_Layout, 1, sizeof(g_Layout), fp) != sizeof(g_Layout)) ) {
+        printf("[LAYOUT] Write %s failed!\r\n", LAYOUT_FILE);
+    }
+    if( fp != NULL ) {
+        fclose(fp);
+    }
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Get the layout table.
+***********************************************************************************************************/
+
+const GSD_TABLE* layout_get(void)
+{
+    return( &g_Layout );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Get the slaves of the layout table.
+***
+*** @param[out] buff    Output statistic information string
+*** @param[in]  size    size of buff(in bytes)
+***
+*** @return     (< 0)Error. (other)number of output char, not counting the terminating null char
+***********************************************************************************************************/
+
+int layout_statc(char *buff, int size)
+{
+    const GSD_SLAVE    *slv;
+    int                 i, n, m;
+
+    if( (buff == NULL) || (size <= 0) )  { return( 0 );        }
+
+    n = snprintf(buff, size, "Layout: %u(Slave) %u(Module)", g_Layout.slave_num, g_Layout.mod_num);
+    for(i = 0;  (i < g_Layout.slave_num) && (n >= 0) && (n < size);  i++) {
+        slv = &g_Layout.slave[i];
+        m   = snprintf( &buff[n], size - n, "\r\nSlave %u: ID 0x%04X, %u(Module) In %u Out %u(Byte)",
+                        slv->addr, slv->ident, slv->mod_num, slv->in_len, slv->out_len );
+        if( m < 0 ) /******************/ { break;              }
+        n += m;
+    }
+    if( n < 0 ) /**********************/ { return( n );        }
+    if( n >= size ) /******************/ { return( size - 1 ); }
+    return( n );
+}
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+*** @}
+***********************************************************************************************************/
@@ -0,0 +1,56 @@
+/**********************************************************************************************************/
+/** @file     layout.h
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    Slave layout table, compiled from GSD files once and loaded as is at boot.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************/
+#ifndef __LAYOUT_H___20261018_212930
+#define __LAYOUT_H___20261018_212930
+#ifdef  __cplusplus
+extern  "C"
+{
+#endif
+/**********************************************************************************************************/
+/** @addtogroup LAYOUT
+*** @{
+*** @addtogroup                 LAYOUT_Exported_Constants
+*** @{
+***********************************************************************************************************/
+
+/*  GSD files are uploaded to F0: (FTP), the slaves are given by "[Layout]  SLAVEn" (ref: gsd.h).
+ *  The table compiled is stored to LAYOUT_FILE, and loaded by a single read at boot while the stamp
+ *  of the rules and the size and time of the GSD files is unchanged, so the text is parsed only once.
+ */
+#define LAYOUT_FILE         "F0:layout.bin"         /* Binary layout table                      */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 LAYOUT_Exported_Functions
+*** @{
+***********************************************************************************************************/
+
+extern void             layout_init(void);
+extern const GSD_TABLE* layout_get(void);
+extern int              layout_statc(char *buff, int size);
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+*****/
+#ifdef  __cplusplus
+}
+#endif
+#endif
+/**********************************************************************************************************/
@@ -0,0 +1,407 @@
+/**********************************************************************************************************/
+/** @file     livelist.c
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    ProfiBUS_DP live list of stations, passive listening and background FDL_Status scan.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************/
+
+#include    <stdint.h>
+#include    <stdio.h>
+#include    <string.h>
+
+#include    "cmsis_os.h"                /* CMSIS RTOS definitions             */
+
+#include    "board.h"
+#include    "cfg.h"
+#include    "ProfiBUS_DP.h"
+#include    "livelist.h"
+#include    "profiler.h"
+
+
+/**********************************************************************************************************/
+/** @addtogroup LIVELIST
+*** @{
+*** @addtogroup LIVELIST_Pravate
+*** @{
+*** @addtogroup                 LIVELIST_Private_Constants
+*** @{
+***********************************************************************************************************/
+
+#define LIVELIST_QUIET      1000                    /* Not heard(ms) before scanned             */
+#define LIVELIST_TIMEOUT    10000                   /* Not heard(ms) before removed             */
+#define LIVELIST_FC_STATUS  0x49                    /* FC of FDL_Status request                 */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 LIVELIST_Private_Types
+*** @{
+***********************************************************************************************************/
+
+typedef struct {    /*------------- Live list (Run-Time) --------------------------------------------
+                    -- (stn.seen)(stn.heard)(stn.type) also written by thread_dp2net, the others and
+                    -- the events by thread_livelist only ----------------------------------------*/
+    int                         enable;     /* Scan enable                      */
+    uint8_t                     sa;         /* Address of the gateway, SA of scan requests  */
+    uint8_t                     next;       /* Next address to be scanned       */
+    uint8_t                     req_da;     /* DA of the last request, responder of SC  */
+    uint8_t                     rsv;        /* Reserved                         */
+    uint32_t                    interval;   /* Min interval of scan requests(ms)*/
+    uint32_t                    idle;       /* Min bus idle before a scan request(us)   */
+    uint32_t                    start;      /* os_time of the initialization    */
+    uint32_t                    req;        /* Counter of scan requests         */
+    uint32_t                    resp;       /* Counter of scan responses        */
+    uint32_t                    defer;      /* Counter of scans deferred, bus not idle  */
+    uint32_t                    cost_ms;    /* Transmit path held by the scan(ms)   */
+    uint32_t                    cost_us;    /* Remainder of cost_ms(us)         */
+    uint32_t                    ins;        /* Counter of insertion events      */
+    uint32_t                    rem;        /* Counter of removal events        */
+    LIVELIST_STN                stn[LIVELIST_ADDR_NUM];
+    LIVELIST_EVT                evt[LIVELIST_EVT_NUM];
+    volatile uint32_t           evt_head;   /* Number of events                 */
+} LIVELIST_INFO;
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 LIVELIST_Private_Variables
+*** @{
+***********************************************************************************************************/
+
+extern volatile uint32_t    os_time;        /* only for Keil RTX                */
+
+static LIVELIST_INFO        g_Live;
+static const char * const   g_LiveType[4] = { "Slave", "Master(not ready)", "Master(ready)", "Master(in ring)" };
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 LIVELIST_Private_Prototypes
+*** @{
+***********************************************************************************************************/
+
+static void thread_livelist(void const *arg);
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 LIVELIST_Private_Functions
+*** @{
+***********************************************************************************************************/
+/** @brief      Initialize the live list, the scan only if enabled in the config file.
+***********************************************************************************************************/
+
+void livelist_init(void)
+{
+    static osThreadDef(thread_livelist, osPriorityLow, 1, 0);
+    osThreadId  tid;
+    int         i;
+
+    for(i = 0;  i < LIVELIST_ADDR_NUM;  i++) {
+        g_Live.stn[i].type = LIVELIST_TYPE_UNKNOWN;
+    }
+    g_Live.enable   = cfg_get_scan();
+    g_Live.sa       = cfg_get_scan_sa() & 0x7F;
+    g_Live.req_da   = 0xFF;
+    g_Live.interval = cfg_get_scan_interval();
+    g_Live.idle     = cfg_get_scan_idle() * 1000;
+    g_Live.interval = (g_Live.interval < 10) ? (10) : (g_Live.interval);
+    g_Live.start    = os_time;
+
+    if( (tid = osThreadCreate(osThread(thread_livelist), NULL)) == NULL ) {
+        printf("[LIVE] Initialize Failed!\r\n");
+    }
+    profiler_name(tid, "livelist");
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Station heard on the bus.
+***
+*** @param[in]  addr    Address of the station
+*** @param[in]  type    LIVELIST_TYPE_xxx, LIVELIST_TYPE_UNKNOWN for the type not changed
+***********************************************************************************************************/
+
+static void livelist_heard(int addr, int type)
+{
+    LIVELIST_STN   *stn;
+
+    if( (addr < 0) || (addr >= LIVELIST_ADDR_NUM) ) {
+        return;
+    }
+    stn = &g_Live.stn[addr];
+    if( type != LIVELIST_TYPE_UNKNOWN ) {
+        stn->type = (uint8_t)type;
+    }
+    stn->seen  = os_time;
+    stn->heard = 1;
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Listen to a frame received from ProfiBUS_DP, called by thread_dp2net.
+***
+***             SA of a request or token is a master in the token ring, SA of a response tells the
+***             station type in FC bit5~4, and SC is the response of DA of the last request.
+***
+*** @param[in]  buff    Pointer to the DP frame
+*** @param[in]  len     Length  of the DP frame
+***
+*** @return     (0)Forward the frame, (other)Response to the scan, consumed.
+***********************************************************************************************************/
+
+int livelist_frame(const uint8_t *buff, int len)
+{
+    int     da, sa, fc;
+
+    if( (buff == NULL) || (len <= 0) ) {
+        return( 0 );
+    }
+    switch( buff[0] ) {
+    case 0x10:              /* SD1: SD DA SA FC FCS ED          */
+    case 0xA2:              /* SD3: SD DA SA FC DATA(8) FCS ED  */
+        if( len < 4 ) {  return( 0 );  }
+        da = buff[1];  sa = buff[2];  fc = buff[3];
+        break;
+    case 0x68:              /* SD2: SD LE LEr SD DA SA FC DATA FCS ED   */
+        if( len < 7 ) {  return( 0 );  }
+        da = buff[4];  sa = buff[5];  fc = buff[6];
+        break;
+    case 0xDC:              /* SD4: SD DA SA                    */
+        if( len >= 3 ) {
+            livelist_heard(buff[2] & 0x7F, LIVELIST_TYPE_MRING);
+        }
+        return( 0 );
+    case 0xE5:              /* SC                               */
+        livelist_heard(g_Live.req_da, LIVELIST_TYPE_UNKNOWN);
+        g_Live.req_da = 0xFF;
+        return( 0 );
+    default:
+        return( 0 );
+    }
+    da &= 0x7F;
+    sa &= 0x7F;
+    if( fc & 0x40 ) {
+        livelist_heard(sa, LIVELIST_TYPE_MRING);        // Request, the master holds the token
+        g_Live.req_da = (uint8_t)da;
+        return( 0 );
+    }
+    livelist_heard(sa, (fc >> 4) & 0x03);               // Response, Stn_Type in FC bit5~4
+    g_Live.req_da = 0xFF;
+    return( g_Live.enable && (da == g_Live.sa) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Record an insertion or removal event.
+***
+*** @param[in]  addr    Address of the station
+*** @param[in]  ins     (0)Removal, (1)Insertion
+***********************************************************************************************************/
+
+static void livelist_event_add(int addr, int ins)
+{
+    LIVELIST_STN   *stn = &g_Live.stn[addr];
+    LIVELIST_EVT   *evt = &g_Live.evt[g_Live.evt_head % LIVELIST_EVT_NUM];
+
+    stn->live = (uint8_t)ins;
+    evt->tick = os_time;
+    evt->addr = (uint8_t)addr;
+    evt->type = stn->type;
+    evt->ins  = (uint8_t)ins;
+    g_Live.evt_head++;
+    if( ins ) {  g_Live.ins++;  } else {  g_Live.rem++;  }
+
+    printf( "[LIVE] Station %d %s, %s\r\n", addr, ins ? "inserted" : "removed",
+            (stn->type < 4) ? g_LiveType[stn->type] : "Unknown" );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Scan an address not heard, if the bus is idle long enough.
+***********************************************************************************************************/
+
+static void livelist_scan(void)
+{
+    LIVELIST_STN   *stn;
+    uint8_t         frame[6];
+    uint32_t        now, t0;
+    int             addr, ret, i;
+
+    if( (bsp_timestamp() - PBDP_GetBusStat()->last) < g_Live.idle ) {
+        g_Live.defer++;
+        return;                                         // Bus not idle, try again next interval
+    }
+    now = os_time;
+    for(i = 0;  i < LIVELIST_ADDR_NUM;  i++) {
+        addr        = g_Live.next;
+        g_Live.next = (uint8_t)((g_Live.next + 1) % LIVELIST_ADDR_NUM);
+        stn         = &g_Live.stn[addr];
+        if( (addr != g_Live.sa) && !(stn->heard && ((now - stn->seen) < LIVELIST_QUIET)) ) {
+            break;                                      // Not heard recently
+        }
+    }
+    if( i >= LIVELIST_ADDR_NUM ) {
+        return;
+    }
+
+    frame[0] = 0x10;                                    // SD1: FDL_Status request
+    frame[1] = (uint8_t)addr;
+    frame[2] = g_Live.sa;
+    frame[3] = LIVELIST_FC_STATUS;
+    frame[4] = (uint8_t)(frame[1] + frame[2] + frame[3]);
+    frame[5] = 0x16;
+    t0  = bsp_timestamp();
+    ret = PBDP_SendRetry(frame, sizeof(frame), 0);
+    g_Live.cost_us += bsp_timestamp() - t0;
+    g_Live.cost_ms += g_Live.cost_us / 1000;
+    g_Live.cost_us %= 1000;
+    g_Live.req++;
+
+    if( ret > 0 ) {
+        g_Live.resp++;                                  // Type by the response in livelist_frame()
+        livelist_heard(addr, LIVELIST_TYPE_UNKNOWN);
+    } else if( ret == -7 ) {
+        stn->heard = 0;                                 // No response within slot time
+    }
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Thread of the live list, insertion and removal events and the scan.
+***********************************************************************************************************/
+
+static void thread_livelist(void const *arg)
+{
+    LIVELIST_STN   *stn;
+    uint32_t        now;
+    int             addr, live;
+
+    (void)arg;
+    osDelay(5000);
+    printf("[LIVE] Live list start, Scan: %s, SA: %d\r\n", g_Live.enable ? "ON" : "OFF", g_Live.sa);
+
+    for(; ;)
+    {
+        osDelay(g_Live.interval);
+        now = os_time;
+        for(addr = 0;  addr < LIVELIST_ADDR_NUM;  addr++) {
+            stn  = &g_Live.stn[addr];
+            live = stn->heard && ((now - stn->seen) < LIVELIST_TIMEOUT);
+            if( live != stn->live ) {
+                livelist_event_add(addr, live);
+            }
+        }
+        if( g_Live.enable ) {
+            livelist_scan();
+        }
+    }
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Get a station of the live list.
+***
+*** @param[in]  addr    Address of the station
+*** @param[out] stn     Station of the live list
+***
+*** @return     (0)No such station, (other)Succeed.
+***********************************************************************************************************/
+
+int livelist_station(int addr, LIVELIST_STN *stn)
+{
+    if( (addr < 0) || (addr >= LIVELIST_ADDR_NUM) ) {
+        return( 0 );
+    }
+    memcpy(stn, &g_Live.stn[addr], sizeof(*stn));
+    return( 1 );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Get an insertion or removal event.
+***
+*** @param[in]  age     Age of the event, (0)The last event, (1)The event before, ...
+*** @param[out] evt     Insertion or removal event
+***
+*** @return     (0)No such event, (other)Succeed.
+***********************************************************************************************************/
+
+int livelist_event(int age, LIVELIST_EVT *evt)
+{
+    uint32_t    head = g_Live.evt_head;
+
+    if( (age < 0) || (age >= (LIVELIST_EVT_NUM - 1)) || ((uint32_t)age >= head) ) {
+        return( 0 );                                    // The oldest event may be written by the thread
+    }
+    memcpy(evt, &g_Live.evt[(head - 1 - age) % LIVELIST_EVT_NUM], sizeof(*evt));
+    return( 1 );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Get the live list, the scan cost and the last events.
+***
+*** @param[out] buff    Output statistic information string
+*** @param[in]  size    size of buff(in bytes)
+***
+*** @return     (< 0)Error. (other)number of output char, not counting the terminating null char
+***********************************************************************************************************/
+
+int livelist_statc(char *buff, int size)
+{
+    static const char   type_c[4] = { 'S', 'N', 'R', 'M' };
+    LIVELIST_EVT        evt;
+    uint32_t            sec;
+    int                 addr, age, n, m;
+
+    if( (buff == NULL) || (size <= 0) )  { return( 0 );        }
+
+    sec = (os_time - g_Live.start) / 1000;
+    n = snprintf( buff, size,
+                  "Scan: %s SA %u, %u(Req) %u(Resp) %u(Defer), Cost: %u(ms) %u(ms/s)\r\n"
+                  "Live: %u(Ins) %u(Rem), S/N/R/M Slave/Master not ready/ready/in ring\r\n"
+                  "Station:",
+                  g_Live.enable ? "ON" : "OFF", g_Live.sa, g_Live.req, g_Live.resp, g_Live.defer,
+                  g_Live.cost_ms, (sec == 0) ? 0 : (g_Live.cost_ms / sec),
+                  g_Live.ins, g_Live.rem
+                );
+    for(addr = 0;  (addr < LIVELIST_ADDR_NUM) && (n >= 0) && (n < size);  addr++) {
+        if( !g_Live.stn[addr].live ) {
+            continue;
+        }
+        m = snprintf( &buff[n], size - n, " %u%c", addr,
+                      (g_Live.stn[addr].type < 4) ? type_c[g_Live.stn[addr].type] : '?' );
+        if( m < 0 ) /******************/ { break;              }
+        n += m;
+    }
+    for(age = 0;  livelist_event(age, &evt) && (n >= 0) && (n < size);  age++) {
+        m = snprintf( &buff[n], size - n, "\r\n%u(ms): %u %s", evt.tick, evt.addr,
+                      evt.ins ? "inserted" : "removed" );
+        if( m < 0 ) /******************/ { break;              }
+        n += m;
+    }
+    if( (n >= 0) && (n < size) ) {
+        if( (m = snprintf(&buff[n], size - n, "\r\n")) > 0 ) { n += m; }
+    }
+    if( n < 0 ) /**********************/ { return( n );        }
+    if( n >= size ) /******************/ { return( size - 1 ); }
+    return( n );
+}
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+*** @}
+***********************************************************************************************************/
@@ -0,0 +1,89 @@
+/**********************************************************************************************************/
+/** @file     livelist.h
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    ProfiBUS_DP live list of stations, passive listening and background FDL_Status scan.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************/
+#ifndef __LIVELIST_H___20261018_201148
+#define __LIVELIST_H___20261018_201148
+#ifdef  __cplusplus
+extern  "C"
+{
+#endif
+/**********************************************************************************************************/
+/** @addtogroup LIVELIST
+*** @{
+*** @addtogroup                 LIVELIST_Exported_Constants
+*** @{
+***********************************************************************************************************/
+
+/*  A station is live while it is heard on the bus, as the SA of a frame or the responder of SC, or replies
+ *  to FDL_Status(SD1, FC 0x49) of the scan. "[Scan]  ENABLE = Y" scans the addresses not heard, one request
+ *  every "INTERVAL" ms and only after the bus is idle for "IDLE" ms, so no token ring nor cyclic traffic
+ *  is running at that time. The responses to the scan are consumed by the gateway, not forwarded.
+ */
+#define LIVELIST_ADDR_NUM   127                     /* Addresses 0 ~ 126, 127 for broadcast     */
+#define LIVELIST_EVT_NUM    16                      /* Number of insertion/removal events kept  */
+
+#define LIVELIST_TYPE_SLAVE 0                       /* Slave station                            */
+#define LIVELIST_TYPE_MNRDY 1                       /* Master station not ready                 */
+#define LIVELIST_TYPE_MRDY  2                       /* Master station ready to enter token ring */
+#define LIVELIST_TYPE_MRING 3                       /* Master station in token ring             */
+#define LIVELIST_TYPE_UNKNOWN   0xFF                /* Type not known yet                       */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 LIVELIST_Exported_Types
+*** @{
+***********************************************************************************************************/
+
+typedef struct {    /*------------- Station of the live list ------------------------------------*/
+    uint8_t                     live;       /* (0)Not live, (1)Live             */
+    uint8_t                     type;       /* LIVELIST_TYPE_xxx                */
+    uint8_t                     heard;      /* Heard since the last removal     */
+    uint8_t                     rsv;        /* Reserved                         */
+    uint32_t                    seen;       /* os_time of the last heard        */
+} LIVELIST_STN;
+
+typedef struct {    /*------------- Insertion or removal event ----------------------------------*/
+    uint32_t                    tick;       /* os_time of the event             */
+    uint8_t                     addr;       /* Address of the station           */
+    uint8_t                     type;       /* LIVELIST_TYPE_xxx                */
+    uint8_t                     ins;        /* (0)Removal, (1)Insertion         */
+    uint8_t                     rsv;        /* Reserved                         */
+} LIVELIST_EVT;
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 LIVELIST_Exported_Functions
+*** @{
+***********************************************************************************************************/
+
+extern void livelist_init(void);
+extern int  livelist_frame(const uint8_t *buff, int len);
+extern int  livelist_station(int addr, LIVELIST_STN *stn);
+extern int  livelist_event(int age, LIVELIST_EVT *evt);
+extern int  livelist_statc(char *buff, int size);
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+*****/
+#ifdef  __cplusplus
+}
+#endif
+#endif
+/**********************************************************************************************************/
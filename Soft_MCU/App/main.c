@@ -29,7 +29,22 @@
 #include    "board.h"
 #include    "net_user.h"
 #include    "netiod.h"
+#include    "tunnel.h"
+#include    "backlog.h"
+#include    "dp_delta.h"
+#include    "dp_filter.h"
+#include    "dp_diag.h"
+#include    "gsd.h"
+#include    "layout.h"
+#include    "procimg.h"
+#include    "latency.h"
+#include    "metrics.h"
+#include    "profiler.h"
+#include    "trace.h"
 #include    "ProfiBUS_DP.h"
+#include    "busmon.h"
+#include    "livelist.h"
+#include    "dpv1.h"
 
 
 /**********************************************************************************************************/
@@ -69,6 +84,11 @@
 static void fs_init(const char *drive);
 static void thread_dp2net(void const *arg);
 static void thread_net2dp(void const *arg);
+static void dp2net_mcast(int sock);
+static void dp2net_send(int sock, struct sockaddr_in *addr, const DP_FILTER_ACT *act,
+                        uint8_t *buff, int len, uint32_t seq, uint32_t stamp);
+static int  net2dp_batch(const uint8_t *buff, int len, uint8_t *reply);
+static int  bridge_crlf(char *buff, int size, int n);
 
 
 /**********************************************************************************************************/
@@ -80,7 +100,14 @@ static void thread_net2dp(void const *arg);
 osThreadDef(thread_dp2net, osPriorityNormal, 1, 0);
 osThreadDef(thread_net2dp, osPriorityNormal, 1, 0);
 
-static uint32_t     g_statistic[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+static uint32_t     g_sequence;                             /* Sequence number of DP frames     */
+static uint32_t     g_routeseq[DP_FILTER_RULE_MAX + 1];     /* Sequence number of routed frames */
+static int          g_seqheader;                            /* UDP sequence header enable       */
+static uint32_t     g_mcast;                                /* UDP multicast group, (0)Broadcast*/
+static int          g_deltaenc;                             /* Delta encoding enable            */
+static DP_DELTA_CTX g_delta;                                /* Delta encoder of UDP datagrams   */
+static DP_DELTA_CTX g_peerdelta;                            /* Delta decoder of the peer gateway*/
+static uint32_t     g_peer;                                 /* IP address of the peer decoded   */
 
 
 /**********************************************************************************************************/
@@ -93,8 +120,11 @@ static uint32_t     g_statistic[8] = {0, 0, 0, 0, 0, 0, 0, 0};
 
 int main(void)
 {
+    osThreadId  tid;
+
     osThreadSetPriority(osThreadGetId(), osPriorityBelowNormal);
     board_init();                   osDelay(10);    /* Board Initialize                                 */
+    profiler_init();                                /* Profiler of the threads Initialize               */
     fs_init("F0:");                 osDelay(10);    /* File System Initialize: NOR or SPI Flash drive 0 */
     fs_init("M0:");                 osDelay(10);    /* File System Initialize: Memory Card drive 0      */
     fs_init("N0:");                 osDelay(10);    /* File System Initialize: NAND Flash drive 0       */
@@ -103,17 +133,33 @@ int main(void)
         printf("[Main] System setting reset to default!\r\n");
     }
     cfg_init("config.sys");         osDelay(10);
+    g_seqheader = cfg_get_seq_header();
+    g_deltaenc  = cfg_get_delta();
+    dp_delta_init(&g_delta, cfg_get_delta_full());
+    dp_filter_init();
+    dp_diag_init();
+    layout_init();
+    procimg_init();
+    trace_init();                                   /* Event trace Initialize                           */
     PBDP_Init(cfg_get_baudrate());  osDelay(10);    /* PorfiBUS_DP Initialize                           */
+    PBDP_SetRetry(cfg_get_retry_limit());
     net_init();                     osDelay(10);    /* Net Initialize                                   */
     netiod_init();                  osDelay(10);    /* NetIO Server Initialize                          */
+    tunnel_init();                  osDelay(10);    /* TCP Tunnel Server Initialize                     */
+    backlog_init();                 osDelay(10);    /* Store-and-forward Backlog Initialize             */
+    busmon_init();                  osDelay(10);    /* Bus analytics Initialize                         */
+    livelist_init();                osDelay(10);    /* Live list of stations Initialize                 */
+    dpv1_init();                    osDelay(10);    /* DP-V1 acyclic service Initialize                 */
 
-    if( osThreadCreate(osThread(thread_net2dp), NULL) == NULL ) {
+    if( (tid = osThreadCreate(osThread(thread_net2dp), NULL)) == NULL ) {
         printf("[Main] Initialize Failed!\r\n");    /* Create thread of Net to ProfiBUS_DP              */
     }
+    profiler_name(tid, "net2dp");
     osDelay(10);
-    if( osThreadCreate(osThread(thread_dp2net), NULL) == NULL ) {
+    if( (tid = osThreadCreate(osThread(thread_dp2net), NULL)) == NULL ) {
         printf("[Main] Initialize Failed!\r\n");    /* Create thread of ProfiBUS_DP to Net              */
     }
+    profiler_name(tid, "dp2net");
     osDelay(10);
     osThreadSetPriority(osThreadGetId(), osPriorityNormal);
 
@@ -132,8 +178,14 @@ static void thread_dp2net(void const *arg)
 {
     struct sockaddr_in  addr;
     int                 sock;
-    static uint8_t      buff[256 + 16];
+    static uint8_t      buff[TUNNEL_UDP_HDR_LEN + 256 + 16];
+    uint8_t            *frame = &buff[TUNNEL_UDP_HDR_LEN];
     int                 recv;
+    uint32_t            stamp;
+    uint32_t            seq;
+    const DP_FILTER_ACT *act = NULL;
+    int                 diag;
+    int                 idx;
 
     (void)arg;
     osDelay(5000);
@@ -153,26 +205,144 @@ static void thread_dp2net(void const *arg)
     } else {
         printf("UDP Port: %d\r\n", PORT_DP2NET);
     }
+    dp2net_mcast(sock);                                 // Multicast group instead of broadcast
     addr.sin_family      = PF_INET;
     addr.sin_port        = htons(PORT_NET2DP);
     addr.sin_addr.s_addr = INADDR_NONE;
 
     for(; ;)
-    {
-        if( (recv = PBDP_Recv(buff)) <= 0 ) {
-            continue;                                   // ProfiBUS_DP Recv Failed
+    {                                                   // Wake up for the replay of the backlog
+        if( (recv = PBDP_RecvWait(frame, backlog_wait())) > 0 ) {
+            stamp = bsp_timestamp();
+            latency_response(frame, recv, stamp);       // Response of the request timed
+            METRICS_INC(dp_rx_frames);  METRICS_ADD(dp_rx_bytes, recv);  // ProfiBUS_DP Recv Statistic information
+            act   = dp_filter_match(frame, recv);       // Filter and routing rules
+            dp_filter_count(act);
+            procimg_frame(frame, recv, stamp);          // Inputs of the process image
+            if( livelist_frame(frame, recv) ) {
+                recv = 0;                               // Response to the scan, not forwarded
+            } else if( dpv1_frame(frame, recv) ) {
+                recv = 0;                               // Response to the acyclic service
+            } else if( (diag = dp_diag_frame(frame, recv)) >= 0 ) {
+                recv = diag;                            // Slave_Diag, only the change event forwarded
+            }
         }
-        g_statistic[0] += 1;  g_statistic[1] += recv;   // ProfiBUS_DP Recv Statistic information
-
-        if( !eth_linkstatus_get() ) {
-            continue;                                   // Network_IP ETH LinkDown
+        if( (recv > 0) && DP_FILTER_PASS(act) ) {
+            if( act->act == DP_FILTER_FWD ) {
+                seq = g_sequence++;                     // Gateway-wide sequence number
+                tunnel_dp2net(frame, recv, stamp);      // ProfiBUS_DP Recv to TCP tunnel
+            } else {
+                seq = g_routeseq[act->idx]++;           // Sequence number of the rule
+            }
+            if( !eth_linkstatus_get() ) {               // Network_IP ETH LinkDown, store to backlog
+                if( backlog_push(frame, recv, seq, stamp, act->idx) < 0 ) {
+                    METRICS_INC(drop_link);
+                }
+            } else {
+                dp2net_send(sock, &addr, act, buff, recv, seq, stamp);
+            }
         }
-        addr.sin_addr.s_addr = ~net_mask_local() | net_ipaddr_local();
-        if( recv != sendto(sock, (char*)buff, recv, 0, (struct sockaddr*)&addr, sizeof(addr)) ) {
-            continue;                                   // Network_IP Send Failed
+        latency_done();                                 // Response forwarded or not
+        while( eth_linkstatus_get() && ((recv = backlog_replay(frame, &seq, &stamp, &idx)) > 0) ) {
+            dp2net_send(sock, &addr, dp_filter_get(idx), buff, recv, seq, stamp);
+        }                                               // Replay with the original SEQ, TIMESTAMP and action
+    }
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Join the UDP multicast group of config file, and set TTL of the multicast datagrams.
+***
+***             The group is joined by IGMP, so IGMP snooping switches deliver the datagrams only to the
+***             ports of interested receivers, and thread_net2dp receives the datagrams of the group.
+***
+*** @param[in]  sock    UDP socket of thread_dp2net
+***********************************************************************************************************/
+
+static void dp2net_mcast(int sock)
+{
+    const char         *cfg = cfg_get_mcast();
+    uint8_t             group[4];
+    int                 ttl = cfg_get_mcast_ttl();
+
+    if( !ip4_aton(cfg, group) || (group[0] < 224) || (group[0] > 239) ) {
+        return;                                         // Not a multicast group, broadcast
+    }
+    if( igmp_join(group) != netOK ) {
+        printf("[DP2NET] Join multicast group %s failed, broadcast!\r\n", cfg);
+        return;
+    }
+#ifdef  IP_MULTICAST_TTL
+    setsockopt(sock, IPPROTO_IP, IP_MULTICAST_TTL, (const char*)&ttl, sizeof(ttl));
+#else
+    setsockopt(sock, IPPROTO_IP, IP_TTL,           (const char*)&ttl, sizeof(ttl));
+#endif
+    memcpy(&g_mcast, group, sizeof(g_mcast));
+    printf("[DP2NET] Multicast group: %s, TTL: %d\r\n", cfg, ttl);
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Send a ProfiBUS_DP frame to Net, delta encoded and with the UDP sequence header if enabled.
+***
+*** @param[in]  sock    UDP socket
+*** @param[in]  addr    Address of the UDP socket, multicast group or broadcast to the local subnet
+*** @param[in]  act     Action of filter rules, FWD or ROUTE to the subscriber without delta encoding,
+***                     the frame of the other actions not sent
+*** @param[in]  buff    Buffer of the datagram, DP frame after the TUNNEL_UDP_HDR_LEN bytes header room
+*** @param[in]  len     Length of the DP frame
+*** @param[in]  seq     Sequence number of the DP frame
+*** @param[in]  stamp   Timestamp of the DP frame, ref: bsp_timestamp()
+***********************************************************************************************************/
+
+static void dp2net_send(int sock, struct sockaddr_in *addr, const DP_FILTER_ACT *act,
+                        uint8_t *buff, int len, uint32_t seq, uint32_t stamp)
+{
+    static uint8_t      enc[TUNNEL_UDP_HDR_LEN + DP_DELTA_HDR_LEN + 256 + 16];
+    uint32_t            drop[TUNNEL_DROP_NUM];
+    uint8_t            *out;
+    uint32_t            cyc;
+    int                 olen;
+    int                 rc;
+
+    if( !DP_FILTER_PASS(act) ) {
+        return;                                         // Not forwarded by the action
+    }
+    if( act->act == DP_FILTER_ROUTE ) {
+        addr->sin_port        = act->port;
+        addr->sin_addr.s_addr = act->addr;
+    } else {
+        addr->sin_port        = htons(PORT_NET2DP);
+        addr->sin_addr.s_addr = (g_mcast != 0) ? (g_mcast) : (~net_mask_local() | net_ipaddr_local());
+    }
+    if( g_deltaenc && (act->act != DP_FILTER_ROUTE) ) {
+        len  = dp_delta_encode(&g_delta, &buff[TUNNEL_UDP_HDR_LEN], len, &enc[TUNNEL_UDP_HDR_LEN]);
+        buff = enc;
+    }
+    if( g_seqheader ) {
+        drop[TUNNEL_DROP_LINK] = METRICS_GET(drop_link) + backlog_lost();
+        drop[TUNNEL_DROP_SOCK] = METRICS_GET(drop_sock);
+        drop[TUNNEL_DROP_QUE]  = METRICS_GET(drop_que) + PBDP_GetOverrun();
+        drop[TUNNEL_DROP_NET]  = METRICS_GET(drop_net);
+        tunnel_udp_pack(buff, len, seq, stamp, drop);
+        out = buff;                        olen = TUNNEL_UDP_HDR_LEN + len;
+    } else {
+        out = &buff[TUNNEL_UDP_HDR_LEN];   olen = len;
+    }
+    TRACE_BEGIN(TRACE_SUB_NET, TRACE_NET_TX, olen);
+    cyc = bsp_cycles();
+    rc  = sendto(sock, (char*)out, olen, 0, (struct sockaddr*)addr, sizeof(*addr));
+    METRICS_HIST(lat_sendto, bsp_cycles() - cyc);
+    TRACE_FINISH(TRACE_SUB_NET, TRACE_NET_TX, rc);
+    if( olen != rc ) {
+        if( rc == BSD_ERROR_NOMEMORY ) {
+            METRICS_INC(drop_que);                  // Network_IP Send Failed, no memory
+        } else {
+            METRICS_INC(drop_sock);                 // Network_IP Send Failed
         }
-        g_statistic[2] += 1;  g_statistic[3] += recv;   // Network_IP Send Statistic information
+        return;
     }
+    METRICS_INC(net_tx_frames);  METRICS_ADD(net_tx_bytes, len);  // Network_IP Send Statistic information
 }
 
 
@@ -185,8 +355,15 @@ static void thread_net2dp(void const *arg)
     struct sockaddr_in  addr;
     int                 alen;
     int                 sock;
-    static uint8_t      buff[256 + 16];
+    static uint8_t      buff[TUNNEL_UDP_MAX];
     int                 recv;
+    int                 hlen;
+    int                 len;
+    uint32_t            seq,  last_seq  = 0;
+    uint32_t                  last_addr = 0;
+    uint32_t            stamp;
+    static uint8_t      reply[PROCIMG_REPLY_MAX];
+    static uint8_t      dec[DP_DELTA_FRAME_MAX + 16];
 
     (void)arg;
     osDelay(5000);
@@ -213,19 +390,159 @@ static void thread_net2dp(void const *arg)
         if( (recv = recvfrom(sock, (char*)buff, sizeof(buff), 0, (struct sockaddr*)&addr, &alen)) <= 0) {
             continue;                                   // Network_IP Recv Failed
         }
+        stamp = bsp_timestamp();
         if( (addr.sin_addr.s_addr == net_ipaddr_local()) || (addr.sin_port != htons(PORT_DP2NET)) ) {
             continue;                                   // Network_IP Recv Invalid
         }
+        if( (hlen = tunnel_udp_unpack(buff, recv, &seq)) < 0 ) {
+            METRICS_INC(drop_net);
+            continue;                                   // Network_IP Recv Invalid header
+        }
+        if( hlen > 0 ) {                                // Sequence gap of the same host
+            if( (last_addr == addr.sin_addr.s_addr) && ((seq - last_seq - 1) < 0x8000) ) {
+                METRICS_ADD(drop_net, seq - last_seq - 1);
+            }
+            last_addr = addr.sin_addr.s_addr;
+            last_seq  = seq;
+        }
+        if( ((recv - hlen) == 1) && (buff[hlen] == DP_DELTA_REQ) ) {
+            dp_delta_request(&g_delta);                 // Request of FULL records from the host
+            dp_diag_request();
+            continue;
+        }
+        if( ((recv - hlen) >= 1) && (buff[hlen] == PROCIMG_REQ) ) {
+            if( (len = procimg_read(&buff[hlen], recv - hlen, reply, sizeof(reply))) > 0 ) {
+                sendto(sock, (char*)reply, len, 0, (struct sockaddr*)&addr, sizeof(addr));
+            }                                           // Process image to the host only
+            continue;
+        }
         if( !eth_linkstatus_get() ) {
+            METRICS_INC(drop_net);
             continue;                                   // Network_IP ETH LinkDown
         }
-        g_statistic[4] += 1;  g_statistic[5] += recv;   // Network_IP Recv Statistic information
-
-        if( recv != PBDP_Send(buff, recv) ) {
+        if( ((recv - hlen) >= 2) && (buff[hlen] == TUNNEL_BATCH) ) {
+            len = net2dp_batch(&buff[hlen], recv - hlen, reply);
+            sendto(sock, (char*)reply, len, 0, (struct sockaddr*)&addr, sizeof(addr));
+            continue;                                   // One reply for the batch
+        }
+        if( ((recv - hlen) >= 1) && ((buff[hlen] == DP_DELTA_FULL) || (buff[hlen] == DP_DELTA_XOR)) ) {
+            if( (recv - hlen) > (DP_DELTA_HDR_LEN + (int)sizeof(dec)) ) {
+                METRICS_INC(drop_net);
+                continue;                               // Network_IP Recv Invalid record
+            }
+            if( g_peer != addr.sin_addr.s_addr ) {      // Record of a peer gateway with DELTA = Y
+                dp_delta_init(&g_peerdelta, 0);         //   decoded for one peer at a time
+                g_peer = addr.sin_addr.s_addr;
+            }
+            if( (len = dp_delta_decode(&g_peerdelta, &buff[hlen], recv - hlen, dec)) <= 0 ) {
+                METRICS_INC(drop_net);
+                continue;                               // Reference lost, waiting for FULL record
+            }
+            memcpy(&buff[hlen], dec, len);
+            recv = hlen + len;
+        }
+        recv -= hlen;
+        METRICS_INC(net_rx_frames);  METRICS_ADD(net_rx_bytes, recv);  // Network_IP Recv Statistic information
+        TRACE(TRACE_SUB_NET, TRACE_NET_RX, recv);
+
+        latency_request(&buff[hlen], recv, stamp);      // Time the request through the bridge
+        if( recv != PBDP_Send(&buff[hlen], recv) ) {
+            latency_cancel();
+            METRICS_INC(drop_net);
+            TRACE(TRACE_SUB_NET, TRACE_NET_DROP, recv);
             continue;                                   // ProfiBUS_DP Send Failed
         }
-        g_statistic[6] += 1;  g_statistic[7] += recv;   // ProfiBUS_DP Send Statistic information
+        latency_sent();                                 // Sent and replied, the response is the next frame
+        METRICS_INC(dp_tx_frames);  METRICS_ADD(dp_tx_bytes, recv);  // ProfiBUS_DP Send Statistic information
+    }
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Send a batch of DP frames back-to-back, ref: TUNNEL_BATCH.
+***
+*** @param[in]  buff    Batch datagram, without the UDP datagram header
+*** @param[in]  len     Length of the batch datagram
+*** @param[out] reply   Reply to the host, (3 + TUNNEL_BATCH_MAX) bytes
+***
+*** @return     Length of the reply.
+***********************************************************************************************************/
+
+static int net2dp_batch(const uint8_t *buff, int len, uint8_t *reply)
+{
+    int     num, sent, pos, flen, ret, i;
+
+    num      = buff[1];
+    reply[0] = TUNNEL_BATCH;
+    reply[1] = 0;
+    reply[2] = 0;
+    for(pos = 2, i = 0;  (i < num) && (pos < len);  i++) {
+        pos += 1 + buff[pos];                           // LEN and DP frame
+    }
+    if( (num == 0) || (num > TUNNEL_BATCH_MAX) || (i != num) || (pos != len) ) {
+        METRICS_INC(drop_net);
+        return( 3 );                                    // Batch not well formed
+    }
+
+    for(sent = 0, pos = 2, i = 0;  i < num;  i++, pos += 1 + flen) {
+        flen = buff[pos];
+        METRICS_INC(net_rx_frames);  METRICS_ADD(net_rx_bytes, flen);  // Network_IP Recv Statistic information
+        TRACE(TRACE_SUB_NET, TRACE_NET_RX, flen);
+        if( (ret = PBDP_Send(&buff[pos + 1], flen)) != flen ) {
+            METRICS_INC(drop_net);                  // ProfiBUS_DP Send Failed
+            TRACE(TRACE_SUB_NET, TRACE_NET_DROP, flen);
+            reply[3 + i] = (uint8_t)((ret < 0) ? (ret) : (-1));
+            continue;
+        }
+        METRICS_INC(dp_tx_frames);  METRICS_ADD(dp_tx_bytes, flen);  // ProfiBUS_DP Send Statistic information
+        reply[3 + i] = 0;
+        sent++;
+    }
+    reply[1] = (uint8_t)num;
+    reply[2] = (uint8_t)sent;
+    return( 3 + num );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Status of the bridge, the reply of BUSMON_DP to the status port, ref: busmon.h.
+***
+*** @param[out] buff    Output buffer
+*** @param[in]  size    Size of the output buffer
+***
+*** @return     Chars written.
+***********************************************************************************************************/
+
+int bridge_statc(char *buff, int size)
+{
+    int     n;
+
+    n  = bridge_crlf(buff, size, dp_delta_statc(&g_delta, buff, size));
+    n += bridge_crlf(&buff[n], size - n, dp_diag_statc(&buff[n], size - n));
+    n += bridge_crlf(&buff[n], size - n, dpv1_statc(&buff[n], size - n));
+    n += bridge_crlf(&buff[n], size - n, procimg_statc(&buff[n], size - n));
+    n += bridge_crlf(&buff[n], size - n, PBDP_SlotStatc(&buff[n], size - n));
+    return( n );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      End a line of the status with "\r\n" if room.
+***
+*** @return     Chars of the line, (0)Nothing written.
+***********************************************************************************************************/
+
+static int bridge_crlf(char *buff, int size, int n)
+{
+    if( n <= 0 ) {
+        return( 0 );
+    }
+    if( n < (size - 2) ) {
+        buff[n++] = '\r';
+        buff[n++] = '\n';
+        buff[n]   = '\0';
     }
+    return( n );
 }
 
 
@@ -0,0 +1,209 @@
+/**********************************************************************************************************/
+/** @file     metrics.c
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    Registry of the gateway metrics, counters, gauges and histograms defined at compile time.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************/
+
+#include    <stdint.h>
+#include    <stdio.h>
+#include    <string.h>
+
+#include    "stm32f4xx.h"               /* __LDREXW(), __STREXW(), PRIMASK    */
+#include    "metrics.h"
+
+
+/**********************************************************************************************************/
+/** @addtogroup METRICS
+*** @{
+*** @addtogroup METRICS_Pravate
+*** @{
+*** @addtogroup                 METRICS_Private_Macros
+*** @{
+***********************************************************************************************************/
+
+#define METRICS_X_DESC(type, name, help)    { #name, help, METRICS_TYPE_##type, METRIC_##name },
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 METRICS_Private_Variables
+*** @{
+***********************************************************************************************************/
+
+volatile uint32_t           g_Metrics[METRICS_SLOT_NUM];            /* Slots of all the metrics     */
+
+static const METRICS_DESC   g_MetricsDesc[METRICS_NUM] = {          /* Descriptors of the metrics   */
+    METRICS_TABLE(METRICS_X_DESC)
+};
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 METRICS_Private_Functions
+*** @{
+***********************************************************************************************************/
+/** @brief      Add to a slot lock-free, may be called in the interrupts.
+***
+*** @param[in]  slot    Slot of the metric, METRIC_name
+*** @param[in]  n       Value to add
+***********************************************************************************************************/
+
+void metrics_add(int slot, uint32_t n)
+{
+    uint32_t    v;
+
+    do {
+        v = __LDREXW(&g_Metrics[slot]);
+    } while( __STREXW(v + n, &g_Metrics[slot]) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Add a value to a histogram lock-free, may be called in the interrupts.
+***
+*** @param[in]  slot    First slot of the histogram, METRIC_name
+*** @param[in]  v       Value to add
+***********************************************************************************************************/
+
+void metrics_hist(int slot, uint32_t v)
+{
+    uint32_t    x;
+    int         bin;
+
+    for(bin = 0, x = v;  (x != 0) && (bin < (METRICS_HIST_BINS - 1));  x >>= 1) {
+        bin++;
+    }
+    metrics_add(slot + bin, 1);
+    metrics_add(slot + METRICS_HIST_BINS, v);           // Sum of the values
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Take a snapshot of all the slots, consistent at an instant.
+***
+*** @param[out] snap    Snapshot of the slots
+***********************************************************************************************************/
+
+void metrics_snapshot(uint32_t snap[METRICS_SLOT_NUM])
+{
+    uint32_t    primask = __get_PRIMASK();
+    int         i;
+
+    __disable_irq();                                    // METRICS_SLOT_NUM words copied only
+    for(i = 0;  i < METRICS_SLOT_NUM;  i++) {
+        snap[i] = g_Metrics[i];
+    }
+    __set_PRIMASK(primask);
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Reset the slots of a metric.
+***
+*** @param[in]  idx     Index of the metric, 0 ~ (METRICS_NUM - 1), (< 0)All the metrics
+***********************************************************************************************************/
+
+void metrics_reset(int idx)
+{
+    const METRICS_DESC *desc;
+    uint32_t            primask = __get_PRIMASK();
+    int                 i, n;
+
+    if( idx >= METRICS_NUM ) {
+        return;
+    }
+    __disable_irq();
+    for(i = (idx < 0) ? (0) : (idx);  i < ((idx < 0) ? (METRICS_NUM) : (idx + 1));  i++) {
+        desc = &g_MetricsDesc[i];
+        for(n = 0;  n < ((desc->type == METRICS_TYPE_HIST) ? (METRICS_SLOTS_HIST) : (1));  n++) {
+            g_Metrics[desc->slot + n] = 0;
+        }
+    }
+    __set_PRIMASK(primask);
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Get the descriptor of a metric.
+***
+*** @param[in]  idx     Index of the metric, 0 ~ (METRICS_NUM - 1)
+***
+*** @return     Descriptor of the metric, NULL for no such metric.
+***********************************************************************************************************/
+
+const METRICS_DESC* metrics_desc(int idx)
+{
+    return( ((idx < 0) || (idx >= METRICS_NUM)) ? (NULL) : (&g_MetricsDesc[idx]) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Get all the metrics, "name value", or "name count/sum [bins]" of a histogram, the bins up to
+***             the last one not empty.
+***
+*** @param[out] buff    Output statistic information string
+*** @param[in]  size    size of buff(in bytes)
+*** @param[out] snap    Snapshot of the slots, of the caller: too large for the default thread stack
+***
+*** @return     (< 0)Error. (other)number of output char, not counting the terminating null char
+***********************************************************************************************************/
+
+int metrics_statc(char *buff, int size, uint32_t snap[METRICS_SLOT_NUM])
+{
+    const METRICS_DESC *desc;
+    uint32_t            cnt;
+    int                 i, b, n, m, k, last;
+
+    if( (buff == NULL) || (size <= 0) || (snap == NULL) )  { return( 0 ); }
+
+    metrics_snapshot(snap);
+    n = snprintf(buff, size, "Metrics");
+    for(i = 0;  (i < METRICS_NUM) && (n >= 0) && (n < size);  i++) {
+        desc = &g_MetricsDesc[i];
+        if( desc->type == METRICS_TYPE_HIST ) {
+            for(cnt = 0, last = 0, b = 0;  b < METRICS_HIST_BINS;  b++) {
+                cnt  += snap[desc->slot + b];
+                last  = (snap[desc->slot + b] != 0) ? (b) : (last);
+            }
+            m = snprintf( &buff[n], size - n, "%s %s %u/%u(Count/Sum) [", (i == 0) ? (":") : (","),
+                          desc->name, cnt, snap[desc->slot + METRICS_HIST_BINS] );
+            for(b = 0;  (b <= last) && (m >= 0) && ((n + m) < size);  b++) {
+                k  = snprintf(&buff[n + m], size - n - m, (b == 0) ? ("%u") : (" %u"), snap[desc->slot + b]);
+                m  = (k < 0) ? (k) : (m + k);
+            }
+            if( (m >= 0) && ((n + m) < size) ) {
+                k  = snprintf(&buff[n + m], size - n - m, "]");
+                m  = (k < 0) ? (k) : (m + k);
+            }
+        } else {
+            m = snprintf( &buff[n], size - n, "%s %s %u", (i == 0) ? (":") : (","),
+                          desc->name, snap[desc->slot] );
+        }
+        if( m < 0 ) /******************/ { break;              }
+        n += m;
+    }
+    if( (n >= 0) && (n < size) ) {
+        if( (m = snprintf(&buff[n], size - n, "\r\n")) > 0 ) { n += m; }
+    }
+    if( n < 0 ) /**********************/ { return( n );        }
+    if( n >= size ) /******************/ { return( size - 1 ); }
+    return( n );
+}
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+*** @}
+***********************************************************************************************************/
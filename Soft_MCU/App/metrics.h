@@ -0,0 +1,150 @@
+/**********************************************************************************************************/
+/** @file     metrics.h
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    Registry of the gateway metrics, counters, gauges and histograms defined at compile time.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************/
+#ifndef __METRICS_H___20261018_223105
+#define __METRICS_H___20261018_223105
+#ifdef  __cplusplus
+extern  "C"
+{
+#endif
+/**********************************************************************************************************/
+/** @addtogroup METRICS
+*** @{
+*** @addtogroup                 METRICS_Exported_Constants
+*** @{
+***********************************************************************************************************/
+
+/*  Table of the metrics, X(TYPE, name, help), a metric is added by a line of the table only:
+ *
+ *  COUNTER   --- monotonic counter, METRICS_INC()/METRICS_ADD(), 1 slot.
+ *  GAUGE     --- value of the present state, METRICS_SET(), 1 slot.
+ *  HIST      --- histogram, METRICS_HIST(), bin 0 for 0, bin n for [2^(n-1), 2^n), the last bin for all
+ *                the larger values, and the sum of the values, (METRICS_HIST_BINS + 1) slots.
+ *
+ *  All the slots are uint32_t, wrap around, updated lock-free from the interrupts and the threads.
+ *  The latency histograms lat_xxx are in the cycles of the core clock, ref: bsp_cycles().
+ */
+#define METRICS_TABLE(X)                                                                                    \
+    X(COUNTER,  dp_rx_frames,       "Frames received from ProfiBUS_DP")                                     \
+    X(COUNTER,  dp_rx_bytes,        "Bytes of the frames received from ProfiBUS_DP")                        \
+    X(COUNTER,  dp_tx_frames,       "Frames sent to ProfiBUS_DP")                                           \
+    X(COUNTER,  dp_tx_bytes,        "Bytes of the frames sent to ProfiBUS_DP")                              \
+    X(COUNTER,  net_rx_frames,      "Frames received from the network")                                     \
+    X(COUNTER,  net_rx_bytes,       "Bytes of the frames received from the network")                        \
+    X(COUNTER,  net_tx_frames,      "Frames sent to the network")                                           \
+    X(COUNTER,  net_tx_bytes,       "Bytes of the frames sent to the network")                              \
+    X(COUNTER,  drop_link,          "Frames dropped, ETH link down and the backlog full")                   \
+    X(COUNTER,  drop_sock,          "Frames dropped, socket send failed")                                   \
+    X(COUNTER,  drop_que,           "Frames dropped, out of network memory")                                \
+    X(COUNTER,  drop_net,           "Frames from the network dropped or not sent to ProfiBUS_DP")           \
+    X(COUNTER,  uart_rx_chars,      "UART chars received")                                                  \
+    X(COUNTER,  uart_tx_chars,      "UART chars sent")                                                      \
+    X(COUNTER,  uart_err_events,    "UART error events")                                                    \
+    X(COUNTER,  uart_err_pe,        "UART parity errors")                                                   \
+    X(COUNTER,  uart_err_fe,        "UART framing errors")                                                  \
+    X(COUNTER,  uart_err_ne,        "UART noise errors")                                                    \
+    X(COUNTER,  uart_err_ore,       "UART overrun errors")                                                  \
+    X(COUNTER,  uart_rx_overruns,   "Chars lost, receive queue full")                                       \
+    X(COUNTER,  uart_rx_ovr_frames, "Frames with chars lost, receive queue full")                           \
+    X(COUNTER,  uart_tx_checks,     "Chars sent not read back the same")                                    \
+    X(COUNTER,  http_queries,       "HTTP GET requests with a query string")                                \
+    X(COUNTER,  http_scripts,       "HTTP CGI script lines generated")                                      \
+    X(HIST,     lat_dp_wakeup,      "Cycles from rx_sem released by the ISR to PBDP_Recv() returned")       \
+    X(HIST,     lat_dp_txq,         "Cycles of PBDP_Send() waiting for the transmitter of other threads")   \
+    X(HIST,     lat_dp_send,        "Cycles of PBDP_Send() waiting for the UART events in osSignalWait()")  \
+    X(HIST,     lat_sendto,         "Cycles of sendto() of the frames to the network")                      \
+    X(HIST,     lat_recvfrom,       "Cycles of non-blocking recvfrom() returned a datagram")                \
+    X(HIST,     lat_prom,           "Cycles of a metrics.cgx script call, ref: PROM_BUDGET_US")
+
+#define METRICS_TYPE_COUNTER    0                   /* Type of metric: counter                  */
+#define METRICS_TYPE_GAUGE      1                   /* Type of metric: gauge                    */
+#define METRICS_TYPE_HIST       2                   /* Type of metric: histogram                */
+
+#define METRICS_HIST_BINS   24                      /* Bins of a histogram, 2^22 cycles = 25ms  */
+
+#define METRICS_SLOTS_COUNTER   1
+#define METRICS_SLOTS_GAUGE     1
+#define METRICS_SLOTS_HIST      (METRICS_HIST_BINS + 1)
+
+#define METRICS_X_SLOT(type, name, help)    METRIC_##name, METRIC_##name##_LAST = METRIC_##name + METRICS_SLOTS_##type - 1,
+#define METRICS_X_NUM(type, name, help)     + 1
+
+enum {              /*------------- Slot of the metrics, METRIC_name ------------------------------*/
+    METRICS_TABLE(METRICS_X_SLOT)
+    METRICS_SLOT_NUM                        /* Number of slots                  */
+};
+#define METRICS_NUM         (0 METRICS_TABLE(METRICS_X_NUM))    /* Number of metrics            */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 METRICS_Exported_Types
+*** @{
+***********************************************************************************************************/
+
+typedef struct {    /*------------- Descriptor of a metric ----------------------------------------*/
+    const char                 *name;       /* Name of the metric               */
+    const char                 *help;       /* Description of the metric        */
+    uint16_t                    type;       /* METRICS_TYPE_xxx                 */
+    uint16_t                    slot;       /* First slot of the metric         */
+} METRICS_DESC;
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 METRICS_Exported_Macros
+*** @{
+***********************************************************************************************************/
+
+#define METRICS_INC(name)       metrics_add(METRIC_##name, 1)
+#define METRICS_ADD(name, n)    metrics_add(METRIC_##name, (n))
+#define METRICS_SET(name, v)    (g_Metrics[METRIC_##name] = (v))
+#define METRICS_GET(name)       (g_Metrics[METRIC_##name])
+#define METRICS_HIST(name, v)   metrics_hist(METRIC_##name, (v))
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 METRICS_Exported_Variables
+*** @{
+***********************************************************************************************************/
+
+extern volatile uint32_t    g_Metrics[METRICS_SLOT_NUM];
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 METRICS_Exported_Functions
+*** @{
+***********************************************************************************************************/
+
+extern void                 metrics_add(int slot, uint32_t n);
+extern void                 metrics_hist(int slot, uint32_t v);
+extern void                 metrics_snapshot(uint32_t snap[METRICS_SLOT_NUM]);
+extern void                 metrics_reset(int idx);
+extern const METRICS_DESC*  metrics_desc(int idx);
+extern int                  metrics_statc(char *buff, int size, uint32_t snap[METRICS_SLOT_NUM]);
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+*****/
+#ifdef  __cplusplus
+}
+#endif
+#endif
+/**********************************************************************************************************/
@@ -18,9 +18,15 @@
 #include    <stdio.h>
 #include    <stdlib.h>
 #include    <string.h>
+#include    "cmsis_os.h"
 #include    "rl_net.h"
 #include    "net_user.h"
 #include    "cfg.h"
+#include    "ProfiBUS_DP.h"
+#include    "busmon.h"
+#include    "metrics.h"
+#include    "profiler.h"
+#include    "prom.h"
 
 
 /**********************************************************************************************************/
@@ -37,7 +43,12 @@
 uint32_t cgi_script (const char *env, char *buf, uint32_t buflen, uint32_t *pcgi)
 {
     uint32_t    len = 0;
+    uint32_t    cnt;
+    BUSMON_WIN  win;
+    PROFILER_THREAD thr;
+    int         i, age;
 
+    METRICS_INC(http_scripts);
     // Analyze a 'c' script line starting position 2
     switch( env[0] ) {
     case 'a' :              // Network parameters from 'setting.cgi'
@@ -71,12 +82,75 @@ uint32_t cgi_script (const char *env, char *buf, uint32_t buflen, uint32_t *pcgi
             break;
         }
         break;
+
+    case 'b' :              // Bus analytics from 'bus.cgi'
+        switch( env[2] ) {
+        case 'w':           // --- Write rows of one-second windows, (*pcgi) is the age of window
+            while( ((len + 160) < buflen) && busmon_window(*pcgi, &win) ) {
+                len += sprintf( buf + len, &env[4], *pcgi + 1, win.frames,
+                                ((win.busy + win.idle) == 0) ? 0 : ((win.busy * 100) / (win.busy + win.idle)),
+                                win.busy, win.trr[0].avg, win.trr[0].max );
+                (*pcgi)++;
+            }
+            if( busmon_window(*pcgi, &win) ) {
+                len |= (1u << 31);  // Hi bit is a repeat flag
+            }
+            break;
+        case 'h':           // --- Write the lower bound(bits) of gap bins
+            for(i = 0;  (i < PBDP_GAP_BINS) && ((len + 40) < buflen);  i++) {
+                len += sprintf(buf + len, &env[4], i * PBDP_GetBusStat()->gap_w);
+            }
+            break;
+        case 'g':           // --- Write the gap histogram of all windows
+            for(i = 0;  (i < PBDP_GAP_BINS) && ((len + 40) < buflen);  i++) {
+                for(cnt = 0, age = 0;  busmon_window(age, &win);  age++) {
+                    cnt += win.gap[i];
+                }
+                len += sprintf(buf + len, &env[4], cnt);
+            }
+            break;
+        }
+        break;
+
+    case 'p' :              // Thread profile from 'threads.cgi'
+        switch( env[2] ) {
+        case 't':           // --- Write rows of the threads, (*pcgi) is the row
+            while( ((len + 200) < buflen) && profiler_thread(*pcgi, &thr) ) {
+                if( thr.size != 0 ) {
+                    len += sprintf( buf + len, &env[4], thr.tid, thr.name, thr.prio, thr.load / 10, thr.load % 10,
+                                    thr.size, thr.used, thr.peak, (thr.peak * 100) / thr.size );
+                }
+                (*pcgi)++;
+            }
+            if( profiler_thread(*pcgi, &thr) ) {
+                len |= (1u << 31);  // Hi bit is a repeat flag
+            }
+            break;
+        }
+        break;
+
+    case 'm' :              // Prometheus metrics from 'metrics.cgx', (*pcgi) is the line
+        len = prom_write(buf, buflen, pcgi, http_get_session());
+        if( *pcgi != PROM_POS_END ) {
+            len |= (1u << 31);      // Hi bit is a repeat flag
+        }
+        break;
     }
 
     return( len );
 }
 
 
+/**********************************************************************************************************/
+/** @brief      Content type of the cgx files, the Prometheus text format of 'metrics.cgx'.
+***********************************************************************************************************/
+
+const char* cgx_content_type(void)
+{
+    return( "text/plain; version=0.0.4" );
+}
+
+
 /**********************************************************************************************************/
 /** @brief      Process query string received by GET request.
 ***********************************************************************************************************/
@@ -85,6 +159,7 @@ void cgi_process_query(const char *qstr)
 {
     char   *var = malloc(40 * sizeof(char));
 
+    METRICS_INC(http_queries);
     do{
         qstr = http_get_env_var(qstr, var, 40 * sizeof(char));  // Loop through all the parameters
         if( var[0] != 0 ) {
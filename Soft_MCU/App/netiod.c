@@ -17,10 +17,14 @@
 
 #include    <stdint.h>
 #include    <stdio.h>
+#include    <string.h>
 #include    <assert.h>
 #include    "cmsis_os.h"            /* CMSIS RTOS definitions               */
 #include    "rl_net.h"              /* Network definitions                  */
+#include    "board.h"
 #include    "netiod.h"
+#include    "metrics.h"
+#include    "profiler.h"
 
 
 /**********************************************************************************************************/
@@ -35,11 +39,18 @@
 #define DEFAULTPORT     0x494F      /* "IO"                                 */
 #define TMAXSIZE        (1 * 1024)  /* buff size                            */
 #define INTERVAL        6           /* timeout of seconds                   */
+#define UDP_TIME_MAX    60000       /* Max length of a S2C run(ms)          */
+#define NETIO_SESSION_NUM   3       /* Number of TCP sessions               */
+#define NETIO_PEER_NUM      4       /* Number of UDP peers                  */
+#define NETIO_SIG_CLIENT    0x01    /* Signal of a client to the session    */
 
 #define CMD_QUIT        0
 #define CMD_C2S         1
 #define CMD_S2C         2
 #define CMD_RES         3
+#define CMD_C2S_UDP     4
+#define CMD_S2C_UDP     5
+#define CMD_PING        6
 #define CTLSIZE         sizeof(CONTROL)
 
 
@@ -69,6 +80,57 @@ typedef struct {
     uint32_t    data;
 } CONTROL;
 
+typedef struct {    /*------------- Counters of a UDP run or a ping run -------------------------------*/
+    uint32_t    count;              /* Datagrams received or sent           */
+    uint32_t    seq;                /* Last SEQ + 1 received, or failed     */
+    uint32_t    bytes;              /* Bytes of the datagrams counted       */
+    uint32_t    first;              /* bsp_timestamp() of the first datagram*/
+    uint32_t    last;               /* bsp_timestamp() of the last datagram */
+    uint32_t    idle;               /* bsp_idletime() of the first datagram */
+    uint32_t    idle_last;          /* bsp_idletime() of the last datagram  */
+    uint32_t    pings;              /* Pings echoed                         */
+    uint32_t    min;                /* Min service time of a ping(us)       */
+    uint32_t    max;                /* Max service time of a ping(us)       */
+    uint32_t    hist[NETIO_HIST_BINS];  /* Histogram of service time of pings   */
+} UDP_RUN;
+
+typedef struct {    /*------------- TCP session -------------------------------------------------------
+                    -- (sock) to the client by NetioD_TCP, to (-1) by the session thread -------------*/
+    volatile int    sock;           /* Client socket, (-1)Free              */
+    osThreadId      thread;         /* Thread of the session                */
+    uint32_t        addr;           /* IP address of the client             */
+    uint16_t        port;           /* Port of the client                   */
+    uint16_t        cmd;            /* Last command                         */
+    uint32_t        start;          /* os_time of the client accepted       */
+    struct {
+        uint32_t    runs;           /* Commands of the client               */
+        uint32_t    c2s;            /* Bytes received                       */
+        uint32_t    s2c;            /* Bytes sent                           */
+        uint32_t    pings;          /* Pings echoed                         */
+    } stat;
+    UDP_RUN         run;            /* Ping run                             */
+} NETIO_SESSION;
+
+typedef struct {    /*------------- UDP peer ----------------------------------------------------------*/
+    uint32_t        addr;           /* IP address of the peer, (0)Not used  */
+    uint16_t        port;           /* Port of the peer, network byte order */
+    uint8_t         s2c;            /* In a S2C run                         */
+    uint8_t         rsv;            /* Reserved                             */
+    uint32_t        seen;           /* os_time of the last datagram         */
+    uint32_t        datagrams;      /* Datagrams received from the peer     */
+    uint32_t        size;           /* S2C: length of a data datagram       */
+    uint32_t        rate;           /* S2C: datagrams per second            */
+    uint32_t        time;           /* S2C: length of the run(us)           */
+    uint32_t        next;           /* S2C: SEQ of the next datagram        */
+    UDP_RUN         run;            /* Counters of the run                  */
+} NETIO_PEER;
+
+typedef struct {    /*------------- Counters of the server --------------------------------------------*/
+    uint32_t        accepted;       /* TCP clients accepted                 */
+    uint32_t        closed;         /* TCP sessions closed                  */
+    uint32_t        rejected;       /* TCP clients or UDP peers rejected    */
+} NETIO_STAT;
+
 
 /**********************************************************************************************************/
 /** @}
@@ -76,7 +138,14 @@ typedef struct {
 *** @{
 ***********************************************************************************************************/
 
-static char  cBuffer[TMAXSIZE] __attribute__((aligned(256)));   /* Send & Recv buffer                   */
+extern volatile uint32_t    os_time;    // only for Keil RTX
+
+static char  cBuffer[NETIO_SESSION_NUM][TMAXSIZE] __attribute__((aligned(256)));   /* Send & Recv buffer  */
+static uint32_t uBuffer[NETIO_UDP_MAX / 4];                     /* Recv buffer of UDP mode              */
+static uint32_t sBuffer[NETIO_UDP_MAX / 4];                     /* Send buffer of UDP mode              */
+static NETIO_SESSION    g_Session[NETIO_SESSION_NUM];           /* TCP sessions                         */
+static NETIO_PEER       g_Peer[NETIO_PEER_NUM];                 /* UDP peers                            */
+static NETIO_STAT       g_Netio;                                /* Counters of the server               */
 
 /**********************************************************************************************************/
 /** @}
@@ -85,6 +154,11 @@ static char  cBuffer[TMAXSIZE] __attribute__((aligned(256)));   /* Send & Recv b
 ***********************************************************************************************************/
 
 static void NetioD_TCP(void const *arg);
+static void NetioD_Session(void const *arg);
+static void NetioD_UDP(void const *arg);
+static void NetioD_Stamp(uint32_t *buff, uint32_t rx);
+static void NetioD_Ping(UDP_RUN *run, uint32_t len, uint32_t rx);
+static int  NetioD_Result(const UDP_RUN *run, uint32_t *buff);
 
 /**********************************************************************************************************/
 /** @}
@@ -96,28 +170,37 @@ static void NetioD_TCP(void const *arg);
 
 void netiod_init( void )
 {
-    static osThreadDef(NetioD_TCP, osPriorityAboveNormal, 1, 0);
+    static osThreadDef(NetioD_TCP, osPriorityBelowNormal, 1, 0);
+    static osThreadDef(NetioD_Session, osPriorityBelowNormal, NETIO_SESSION_NUM, 0);   /* Bulk, below the bridge */
+    static osThreadDef(NetioD_UDP, osPriorityBelowNormal, 1, 0);    /* Polls in S2C, below the bridge */
     osThreadId  threadID;
+    int         i;
 
+    for(i = 0;  i < NETIO_SESSION_NUM;  i++) {
+        g_Session[i].sock   = -1;
+        g_Session[i].thread = osThreadCreate(osThread(NetioD_Session), &g_Session[i]);
+        assert(g_Session[i].thread != NULL);
+        profiler_name(g_Session[i].thread, "netio-sess");
+    }
     threadID = osThreadCreate(osThread(NetioD_TCP), NULL);
-    assert(threadID != NULL);  (void)threadID;
+    assert(threadID != NULL);  profiler_name(threadID, "netio-tcp");
+    threadID = osThreadCreate(osThread(NetioD_UDP), NULL);
+    assert(threadID != NULL);  profiler_name(threadID, "netio-udp");
 }
 
 
 /**********************************************************************************************************/
-/** @brief      NetIO Server function
+/** @brief      NetIO Server function, accepts the clients to the free sessions.
 ***********************************************************************************************************/
 
 static void NetioD_TCP(void const *arg)
 {
-    CONTROL             ctl;
     struct sockaddr_in  addr;
+    int                 alen;
     int                 server, client;
-    uint32_t            nByte;
-    uint32_t            nData;
-    int                 rc;
-    uint32_t            ed;
+    int                 i;
 
+    (void)arg;
     osDelay(5000);
     printf("[NetIO] Server start, ");
     if( (server = socket(AF_INET, SOCK_STREAM, 0)) < 0 ) {
@@ -132,7 +215,7 @@ static void NetioD_TCP(void const *arg)
         closesocket(server);
         return;
     }
-    if( listen(server, 2) != 0 ) {
+    if( listen(server, NETIO_SESSION_NUM) != 0 ) {
         printf("listen failed!\r\n");
         closesocket(server);
         return;
@@ -142,7 +225,47 @@ static void NetioD_TCP(void const *arg)
 
     for(;;)
     {
-        if( (client = accept(server, NULL, NULL)) < 0 )   continue;
+        alen = sizeof(addr);
+        if( (client = accept(server, (struct sockaddr *)&addr, &alen)) < 0 )   continue;
+
+        for(i = 0;  (i < NETIO_SESSION_NUM) && (g_Session[i].sock >= 0);  i++)  ;
+        if( i >= NETIO_SESSION_NUM ) {
+            g_Netio.rejected++;                         /* no free session                      */
+            closesocket(client);
+            continue;
+        }
+        memset(&g_Session[i].stat, 0, sizeof(g_Session[i].stat));
+        g_Session[i].addr  = addr.sin_addr.s_addr;
+        g_Session[i].port  = ntohs(addr.sin_port);
+        g_Session[i].start = os_time;
+        g_Session[i].sock  = client;
+        g_Netio.accepted++;
+        osSignalSet(g_Session[i].thread, NETIO_SIG_CLIENT);
+    }
+}
+
+
+/**********************************************************************************************************/
+/** @brief      NetIO Server function of a TCP session
+***
+*** @param[in]  arg     Session, ref: g_Session
+***********************************************************************************************************/
+
+static void NetioD_Session(void const *arg)
+{
+    NETIO_SESSION      *ses = (NETIO_SESSION*)arg;
+    char               *buf = cBuffer[ses - g_Session];
+    CONTROL             ctl;
+    int                 client;
+    uint32_t            nByte;
+    uint32_t            nData;
+    int                 rc;
+    uint32_t            ed;
+
+    for(;;)
+    {
+        osSignalWait(NETIO_SIG_CLIENT, osWaitForever);
+        if( (client = ses->sock) < 0 )  continue;
       //printf("[NetIO] client accepted \r\n");
 
         for(rc = 1;  ;  )
@@ -150,6 +273,8 @@ static void NetioD_TCP(void const *arg)
             if( recv(client, (void*)&ctl, CTLSIZE, 0) != CTLSIZE )  break;
             ctl.cmd  = ntohl(ctl.cmd);
             ctl.data = ntohl(ctl.data);
+            ses->cmd = ctl.cmd;
+            ses->stat.runs++;
 
             if( ctl.cmd == CMD_C2S )
             {
@@ -158,9 +283,10 @@ static void NetioD_TCP(void const *arg)
                 {
                     for(nByte = 0;  nByte < ctl.data;  nByte += rc)
                     {
-                        rc = recv(client, cBuffer, min(TMAXSIZE, ctl.data - nByte), 0);
+                        rc = recv(client, buf, min(TMAXSIZE, ctl.data - nByte), 0);
                         if( rc <= 0 )  break;
-                        if( (nByte == 0) && (cBuffer[0] != 0) )  ed = 0;
+                        if( (nByte == 0) && (buf[0] != 0) )  ed = 0;
+                        ses->stat.c2s += rc;
                     }
                     if( rc <= 0 )   break;
                 }
@@ -168,36 +294,425 @@ static void NetioD_TCP(void const *arg)
             }
             else if( ctl.cmd == CMD_S2C )
             {
-                extern volatile uint32_t    os_time;        // only for Keil RTX
                 extern const    uint32_t    os_clockrate;   // only for Keil RTX
               //printf("[NetIO] CMD_S2C start: %lu \r\n", ctl.data);
                 for(nData = 0, ed = os_time;  (os_time - ed) < (INTERVAL * os_clockrate);  nData += ctl.data)
                 {
-                    for(cBuffer[0] = 0, nByte = 0;  nByte < ctl.data;  nByte += rc)
+                    for(buf[0] = 0, nByte = 0;  nByte < ctl.data;  nByte += rc)
                     {
-                        rc = send(client, cBuffer, min(TMAXSIZE, ctl.data - nByte), 0);
+                        rc = send(client, buf, min(TMAXSIZE, ctl.data - nByte), 0);
                         if( rc <= 0 )  break;
+                        ses->stat.s2c += rc;
                     }
                     if( rc <= 0 )  break;
                 }
                 {
-                    for(cBuffer[0] = 1, nByte = 0;  nByte < ctl.data;  nByte += rc)
+                    for(buf[0] = 1, nByte = 0;  nByte < ctl.data;  nByte += rc)
                     {
-                        rc = send(client, cBuffer, min(TMAXSIZE, ctl.data - nByte), 0);
+                        rc = send(client, buf, min(TMAXSIZE, ctl.data - nByte), 0);
                         if( rc <= 0 )  break;
+                        ses->stat.s2c += rc;
                     }
                 }
               //printf("[NetIO] CMD_S2C end: %lu \r\n", nData + ctl.data);
             }
+            else if( (ctl.cmd == CMD_PING) && (ctl.data >= NETIO_PING_LEN) && (ctl.data <= TMAXSIZE) )
+            {
+                for(memset(&ses->run, 0, sizeof(ses->run)), rc = 1;  rc > 0;  )
+                {
+                    for(nByte = 0;  nByte < ctl.data;  nByte += rc)
+                    {
+                        rc = recv(client, &buf[nByte], ctl.data - nByte, 0);
+                        if( rc <= 0 )  break;
+                    }
+                    if( rc <= 0 )  break;
+                    ed = bsp_timestamp();
+                    if( ntohl(((uint32_t*)buf)[0]) != CMD_PING )  break;     /* end of the ping run */
+
+                    NetioD_Stamp((uint32_t*)buf, ed);
+                    for(nByte = 0;  nByte < ctl.data;  nByte += rc)
+                    {
+                        rc = send(client, &buf[nByte], ctl.data - nByte, 0);
+                        if( rc <= 0 )  break;
+                    }
+                    NetioD_Ping(&ses->run, ctl.data, ed);
+                    ses->stat.pings++;
+                }
+                if( rc > 0 ) {
+                    rc = send(client, buf, NetioD_Result(&ses->run, (uint32_t*)buf), 0);
+                }
+            }
             else  break;    /* quit */
         }
 
         closesocket(client);
-      //printf("[NetIO] client close \r\n");
-        if( rc <= 0 )  break;
+        printf( "[NetIO] Session %d closed, %u(Run) C2S: %u(Byte) S2C: %u(Byte) %u(Ping) %u(s)\r\n"
+              , (int)(ses - g_Session), ses->stat.runs, ses->stat.c2s, ses->stat.s2c, ses->stat.pings
+              , (os_time - ses->start) / 1000
+              );
+        g_Netio.closed++;
+        ses->sock = -1;                                 /* free the session for the next client */
+    }
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Stamp a ping to be echoed, ref: CMD_PING.
+***
+*** @param[in]  buff    Ping, NETIO_PING_LEN bytes at least
+*** @param[in]  rx      bsp_timestamp() of the ping received
+***********************************************************************************************************/
+
+static void NetioD_Stamp(uint32_t *buff, uint32_t rx)
+{
+    buff[2] = htonl(rx);
+    buff[3] = htonl(bsp_timestamp());
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Count a ping echoed, after the echo handed over to the stack.
+***
+*** @param[in]  run     Counters of the ping run
+*** @param[in]  len     Length of the ping
+*** @param[in]  rx      bsp_timestamp() of the ping received
+***********************************************************************************************************/
+
+static void NetioD_Ping(UDP_RUN *run, uint32_t len, uint32_t rx)
+{
+    uint32_t    now = bsp_timestamp();
+    uint32_t    us  = now - rx;
+    int         bin;
+
+    if( run->pings == 0 ) {
+        memset(run, 0, sizeof(*run));
+        run->first = rx;
+        run->idle  = bsp_idletime();
+        run->min   = us;
+    }
+    run->pings    += 1;
+    run->count    += 1;
+    run->seq       = run->count;
+    run->bytes    += len;
+    run->last      = now;
+    run->idle_last = bsp_idletime();
+    run->min       = min(run->min, us);
+    run->max       = max(run->max, us);
+    for(bin = 0;  (us != 0) && (bin < (NETIO_HIST_BINS - 1));  us >>= 1) {
+        bin++;
     }
+    run->hist[bin]++;
+}
 
-    return;
+
+/**********************************************************************************************************/
+/** @brief      Get a percentile of the ping histogram.
+***
+*** @param[in]  run     Counters of the ping run
+*** @param[in]  ppm     Percentile in 1/1000000
+***
+*** @return     Upper bound of the histogram bin(us).
+***********************************************************************************************************/
+
+static uint32_t NetioD_Percentile(const UDP_RUN *run, uint32_t ppm)
+{
+    uint32_t    rank = (uint32_t)(((uint64_t)run->pings * ppm + 999999) / 1000000);
+    uint32_t    sum;
+    int         bin;
+
+    for(sum = 0, bin = 0;  bin < (NETIO_HIST_BINS - 1);  bin++) {
+        if( (sum += run->hist[bin]) >= rank ) {
+            break;
+        }
+    }
+    return( (bin == 0) ? (0) : (min((1u << bin) - 1, run->max)) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Build the result of a run, ref: CMD_RES.
+***
+*** @param[in]  run     Counters of the run
+*** @param[out] buff    Buffer of the result, (11 + NETIO_HIST_BINS) words
+***
+*** @return     Length of the result.
+***********************************************************************************************************/
+
+static int NetioD_Result(const UDP_RUN *run, uint32_t *buff)
+{
+    uint32_t    us   = run->last - run->first;
+    uint32_t    idle = run->idle_last - run->idle;
+    int         n, i;
+
+    buff[0] = htonl(CMD_RES);
+    buff[1] = htonl(run->count);
+    buff[2] = htonl(run->seq);
+    buff[3] = htonl(run->bytes);
+    buff[4] = htonl(us);
+    buff[5] = htonl((us < 1000) ? (0) : (min(idle / (us / 1000), 1000)));
+    n       = 6;
+    if( run->pings != 0 ) {                             // Ping run
+        buff[n++] = htonl(run->min);
+        buff[n++] = htonl(NetioD_Percentile(run, 500000));
+        buff[n++] = htonl(NetioD_Percentile(run, 990000));
+        buff[n++] = htonl(NetioD_Percentile(run, 999000));
+        buff[n++] = htonl(run->max);
+        for(i = 0;  i < NETIO_HIST_BINS;  i++) {
+            buff[n++] = htonl(run->hist[i]);
+        }
+    }
+    return( n * 4 );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Get the UDP peer of a datagram, a new peer replaces the least recent one not in a S2C run.
+***
+*** @param[in]  addr    Address of the peer
+***
+*** @return     UDP peer, NULL if all the peers in a S2C run.
+***********************************************************************************************************/
+
+static NETIO_PEER* NetioD_Peer(const struct sockaddr_in *addr)
+{
+    NETIO_PEER *peer = NULL;
+    int         i;
+
+    for(i = 0;  i < NETIO_PEER_NUM;  i++) {
+        if( (g_Peer[i].addr == addr->sin_addr.s_addr) && (g_Peer[i].port == addr->sin_port) ) {
+            return( &g_Peer[i] );
+        }
+        if( !g_Peer[i].s2c && ((peer == NULL) || ((os_time - g_Peer[i].seen) > (os_time - peer->seen))) ) {
+            peer = &g_Peer[i];
+        }
+    }
+    if( peer != NULL ) {
+        memset(peer, 0, sizeof(*peer));
+        peer->addr = addr->sin_addr.s_addr;
+        peer->port = addr->sin_port;
+    }
+    return( peer );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Handle a datagram from a UDP peer.
+***
+*** @param[in]  sock    UDP socket
+*** @param[in]  addr    Address of the peer
+*** @param[in]  len     Length of the datagram in uBuffer
+*** @param[in]  stamp   bsp_timestamp() of the datagram received
+***********************************************************************************************************/
+
+static void NetioD_Datagram(int sock, struct sockaddr_in *addr, int len, uint32_t stamp)
+{
+    NETIO_PEER *peer;
+    uint32_t    seq = ntohl(uBuffer[1]);
+
+    if( (peer = NetioD_Peer(addr)) == NULL ) {
+        g_Netio.rejected++;                             // All the peers in a S2C run
+        return;
+    }
+    peer->seen = os_time;
+    peer->datagrams++;
+
+    switch( ntohl(uBuffer[0]) ) {
+    case CMD_C2S_UDP:
+        if( (seq == 0) || (peer->run.count == 0) ) {
+            memset(&peer->run, 0, sizeof(peer->run));   // Start of a C2S run
+            peer->run.first = stamp;
+            peer->run.idle  = bsp_idletime();
+        }
+        peer->run.count     += 1;
+        peer->run.bytes     += len;
+        peer->run.seq        = max(peer->run.seq, seq + 1);
+        peer->run.last       = stamp;
+        peer->run.idle_last  = bsp_idletime();
+        break;
+    case CMD_RES:
+        if( !peer->s2c ) {
+            sendto(sock, (char*)uBuffer, NetioD_Result(&peer->run, uBuffer), 0, (struct sockaddr*)addr, sizeof(*addr));
+            memset(&peer->run, 0, sizeof(peer->run));
+        }
+        break;
+    case CMD_PING:
+        if( (len < NETIO_PING_LEN) || peer->s2c ) {
+            break;                                      // Invalid ping
+        }
+        NetioD_Stamp(uBuffer, stamp);
+        sendto(sock, (char*)uBuffer, len, 0, (struct sockaddr*)addr, sizeof(*addr));
+        NetioD_Ping(&peer->run, len, stamp);
+        break;
+    case CMD_S2C_UDP:
+        if( (len < 16) || (seq < NETIO_UDP_HDR_LEN) || (seq > NETIO_UDP_MAX) || peer->s2c ) {
+            break;                                      // Invalid request
+        }
+        memset(&peer->run, 0, sizeof(peer->run));
+        peer->size      = seq;
+        peer->rate      = ntohl(uBuffer[2]);
+        peer->time      = min(ntohl(uBuffer[3]), UDP_TIME_MAX) * 1000;
+        peer->next      = 0;
+        peer->run.first = bsp_timestamp();
+        peer->run.idle  = bsp_idletime();
+        peer->s2c       = 1;                            // Start of a S2C run
+        break;
+    default:
+        break;
+    }
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Send the next data datagram of a S2C run if due, or the result at the end of the run.
+***
+*** @param[in]  sock    UDP socket
+*** @param[in]  peer    UDP peer in a S2C run
+***
+*** @return     (0)Nothing sent, (other)Datagram sent.
+***********************************************************************************************************/
+
+static int NetioD_S2C(int sock, NETIO_PEER *peer)
+{
+    struct sockaddr_in  addr;
+    uint32_t            us = bsp_timestamp() - peer->run.first;
+
+    addr.sin_family      = PF_INET;
+    addr.sin_port        = peer->port;
+    addr.sin_addr.s_addr = peer->addr;
+    if( us >= peer->time ) {
+        peer->run.last      = bsp_timestamp();
+        peer->run.idle_last = bsp_idletime();
+        sendto(sock, (char*)sBuffer, NetioD_Result(&peer->run, sBuffer), 0, (struct sockaddr*)&addr, sizeof(addr));
+        memset(&peer->run, 0, sizeof(peer->run));
+        peer->s2c = 0;                                  // End of the S2C run
+        return( 1 );
+    }
+    if( (peer->rate != 0) && (us < (uint32_t)(((uint64_t)peer->next * 1000000) / peer->rate)) ) {
+        return( 0 );                                    // Ahead of the rate
+    }
+    memset(sBuffer, 0, NETIO_UDP_HDR_LEN);
+    sBuffer[0] = htonl(CMD_S2C_UDP);
+    sBuffer[1] = htonl(peer->next++);
+    if( sendto(sock, (char*)sBuffer, peer->size, 0, (struct sockaddr*)&addr, sizeof(addr)) != (int)peer->size ) {
+        peer->run.seq++;                                // Out of network buffers
+        return( 0 );
+    }
+    peer->run.count += 1;
+    peer->run.bytes += peer->size;
+    return( 1 );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      NetIO Server function of UDP mode, the runs of all the peers interleaved. The socket is polled
+***             while a S2C run is on, so the thread runs below thread_dp2net and thread_net2dp: a run
+***             measures the rate left by the bridge, and never delays it.
+***********************************************************************************************************/
+
+static void NetioD_UDP(void const *arg)
+{
+    struct sockaddr_in  addr;
+    int                 alen;
+    int                 sock;
+    int                 rc;
+    int                 busy, sent, i;
+    uint32_t            stamp, cyc;
+
+    (void)arg;
+    osDelay(5000);
+    printf("[NetIO] UDP Server start, ");
+    if( (sock = socket(AF_INET, SOCK_DGRAM, 0)) < 0 ) {
+        printf("malloc socket failed!\r\n");
+        return;
+    }
+    addr.sin_family      = PF_INET;
+    addr.sin_port        = htons(DEFAULTPORT);
+    addr.sin_addr.s_addr = INADDR_ANY;
+    if( bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0 ) {
+        printf("bind socket failed!\r\n");
+        closesocket(sock);
+        return;
+    } else {
+        printf("UDP Port: %d\r\n", DEFAULTPORT);
+    }
+
+    for(;;)
+    {
+        for(busy = 0, i = 0;  i < NETIO_PEER_NUM;  i++) {
+            busy |= g_Peer[i].s2c;
+        }
+        alen  = sizeof(addr);
+        cyc   = bsp_cycles();
+        rc    = recvfrom(sock, (char*)uBuffer, sizeof(uBuffer), busy ? MSG_DONTWAIT : 0, (struct sockaddr*)&addr, &alen);
+        stamp = bsp_timestamp();
+        if( busy && (rc > 0) ) {
+            METRICS_HIST(lat_recvfrom, bsp_cycles() - cyc);    // Not waiting for the datagram
+        }
+        if( rc >= NETIO_UDP_HDR_LEN ) {
+            NetioD_Datagram(sock, &addr, rc, stamp);
+        }
+        for(sent = 0, i = 0;  i < NETIO_PEER_NUM;  i++) {
+            if( g_Peer[i].s2c ) {
+                sent += NetioD_S2C(sock, &g_Peer[i]);
+            }
+        }
+        if( busy && !sent && (rc < NETIO_UDP_HDR_LEN) ) {
+            osDelay(1);                                 // Ahead of the rate, or out of network buffers
+        }
+    }
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Get statistic information of the NetIO sessions.
+***
+*** @param[out] buff    Output statistic information string
+*** @param[in]  size    size of buff(in bytes)
+***
+*** @return     (< 0)Error. (other)number of output char, not counting the terminating null char
+***********************************************************************************************************/
+
+int netiod_statc(char *buff, int size)
+{
+    const NETIO_SESSION    *ses;
+    const NETIO_PEER       *peer;
+    const uint8_t          *ip;
+    int                     i, n, m;
+
+    if( (buff == NULL) || (size <= 0) )  { return( 0 );        }
+
+    n = snprintf( buff, size, "NetIO: %u(Accepted) %u(Closed) %u(Rejected)",
+                  g_Netio.accepted, g_Netio.closed, g_Netio.rejected );
+    for(i = 0;  (i < NETIO_SESSION_NUM) && (n >= 0) && (n < size);  i++) {
+        ses = &g_Session[i];
+        ip  = (const uint8_t*)&ses->addr;
+        if( ses->sock < 0 ) {
+            continue;                                   // Session free
+        }
+        m = snprintf( &buff[n], size - n, "\r\nTCP[%d] %u.%u.%u.%u:%u CMD %u, %u(Run) C2S %u S2C %u(Byte) %u(Ping) %u(s)",
+                      i, ip[0], ip[1], ip[2], ip[3], ses->port, ses->cmd, ses->stat.runs,
+                      ses->stat.c2s, ses->stat.s2c, ses->stat.pings, (os_time - ses->start) / 1000 );
+        if( m < 0 ) /******************/ { break;              }
+        n += m;
+    }
+    for(i = 0;  (i < NETIO_PEER_NUM) && (n >= 0) && (n < size);  i++) {
+        peer = &g_Peer[i];
+        ip   = (const uint8_t*)&peer->addr;
+        if( peer->addr == 0 ) {
+            continue;                                   // Peer not used
+        }
+        m = snprintf( &buff[n], size - n, "\r\nUDP[%d] %u.%u.%u.%u:%u %s, %u(Datagram) Run: %u(Count) %u(Seq) %u(Byte)",
+                      i, ip[0], ip[1], ip[2], ip[3], ntohs(peer->port), peer->s2c ? "S2C" : "IDLE",
+                      peer->datagrams, peer->run.count, peer->run.seq, peer->run.bytes );
+        if( m < 0 ) /******************/ { break;              }
+        n += m;
+    }
+    if( (n >= 0) && (n < size) ) {
+        if( (m = snprintf(&buff[n], size - n, "\r\n")) > 0 ) { n += m; }
+    }
+    if( n < 0 ) /**********************/ { return( n );        }
+    if( n >= size ) /******************/ { return( size - 1 ); }
+    return( n );
 }
 
 
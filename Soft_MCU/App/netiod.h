@@ -23,11 +23,55 @@ extern  "C"
 /**********************************************************************************************************/
 /** @addtogroup NETIO
 *** @{
+*** @addtogroup                 NETIO_Exported_Constants
+*** @{
+***********************************************************************************************************/
+
+/*  UDP mode on the same port number as the TCP mode, all fields in network byte order:
+ *
+ *      Data:     | CMD | SEQ | payload ... |                     one datagram of SIZE bytes
+ *      C2S:      | CMD_C2S_UDP | SEQ | payload ... |             client to server, SEQ 0 starts a run
+ *      S2C:      | CMD_S2C_UDP | SIZE | RATE | TIME |            request, server sends data for TIME(ms)
+ *      Ping:     | CMD_PING | SEQ | T_RX | T_TX | payload ... |  client to server, echoed with T_RX, T_TX
+ *      Result:   | CMD_RES | COUNT | SEQ | BYTES | US | IDLE |   reply of CMD_RES, or the end of S2C
+ *                | MIN | P50 | P99 | P999 | MAX | HIST(NETIO_HIST_BINS) |  after a ping run only
+ *
+ *  SIZE      --- length of a data datagram, NETIO_UDP_HDR_LEN ~ NETIO_UDP_MAX.
+ *  RATE      --- datagrams per second, (0)As fast as possible.
+ *  COUNT     --- C2S: datagrams received, S2C: datagrams sent.
+ *  SEQ       --- C2S: last SEQ + 1 received (loss = SEQ - COUNT), S2C: datagrams failed to send.
+ *  BYTES     --- bytes of the datagrams counted.
+ *  US        --- microseconds from the first to the last datagram of the run.
+ *  IDLE      --- CPU idle of the gateway during the run, in 1/1000, ref: bsp_idletime().
+ *  T_RX/T_TX --- bsp_timestamp() of the ping received and of the echo sent, the client subtracts
+ *                (T_TX - T_RX) from the round trip time to get the network part.
+ *  MIN ~ MAX --- service time of the gateway, from T_RX to the echo handed over to the stack(us), the
+ *                percentile is the upper bound of the histogram bin.
+ *  HIST      --- bin 0 for 0us, bin n for [2^(n-1), 2^n)us, the last bin for all the longer.
+ *
+ *  A client sends "| CMD_RES | 0 |" after a C2S or ping run, and counts the data datagrams of a S2C
+ *  run until the result datagram.
+ *
+ *  TCP mode "| CMD_PING | SIZE |" in place of CMD_C2S/CMD_S2C starts a ping run of SIZE bytes messages
+ *  in the ping format above, a message other than CMD_PING ends the run and is replied by the result.
+ *
+ *  Up to 3 TCP sessions and 4 UDP peers are served at the same time, the S2C runs of the UDP peers are
+ *  interleaved. A client over the limit is closed at once, ref: netiod_statc().
+ */
+#define NETIO_UDP_HDR_LEN   8                       /* Length of CMD and SEQ                    */
+#define NETIO_UDP_MAX       1472                    /* Max length of a datagram                 */
+#define NETIO_PING_LEN      16                      /* Min length of a ping                     */
+#define NETIO_HIST_BINS     24                      /* Bins of the latency histogram            */
+
+
+/**********************************************************************************************************/
+/** @}
 *** @addtogroup                 NETIO_Exported_Functions
 *** @{
 ***********************************************************************************************************/
 
 extern void  netiod_init(void);
+extern int   netiod_statc(char *buff, int size);
 
 /*****************************  END OF FILE  **************************************************************/
 /** @}
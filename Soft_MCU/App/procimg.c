@@ -0,0 +1,307 @@
+/**********************************************************************************************************/
+/** @file     procimg.c
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    Process image of the slave inputs, consistent snapshot of a bus cycle by a sequence counter.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************/
+
+#include    <stdint.h>
+#include    <stdio.h>
+#include    <string.h>
+
+#include    "cmsis_os.h"                /* CMSIS RTOS definitions             */
+#include    "stm32f4xx.h"               /* __DMB()                            */
+
+#include    "gsd.h"
+#include    "layout.h"
+#include    "procimg.h"
+
+
+/**********************************************************************************************************/
+/** @addtogroup PROCIMG
+*** @{
+*** @addtogroup PROCIMG_Pravate
+*** @{
+*** @addtogroup                 PROCIMG_Private_Constants
+*** @{
+***********************************************************************************************************/
+
+#define PROCIMG_NONE        0xFF                    /* Address not in the image                 */
+#define PROCIMG_RETRY       16                      /* Max retries of a read                    */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 PROCIMG_Private_Types
+*** @{
+***********************************************************************************************************/
+
+typedef struct {    /*------------- Slave in the image ------------------------------------------*/
+    uint16_t                    off;        /* Offset of the inputs in the image*/
+    uint8_t                     len;        /* Length of the inputs             */
+    uint8_t                     dirty;      /* Updated in the current cycle     */
+    uint32_t                    cycle;      /* Cycle of the last update         */
+} PROCIMG_SLOT;
+
+typedef struct {    /*------------- Process image (Run-Time) --------------------------------------
+                    -- written by thread_dp2net only, (img)(slot.cycle)(cycle)(stamp) published
+                    -- under (seq): odd while the writer is publishing -------------------------*/
+    volatile uint32_t           seq;        /* Sequence counter                 */
+    uint32_t                    cycle;      /* Number of completed cycles       */
+    uint32_t                    stamp;      /* Timestamp of the last response of the cycle  */
+    uint32_t                    last;       /* Timestamp of the last response   */
+    uint8_t                     req_da;     /* DA of the last Data_Exchange request */
+    uint8_t                     req_sa;     /* SA of the last Data_Exchange request */
+    uint8_t                     dirty;      /* Number of slaves updated in the current cycle    */
+    uint8_t                     num;        /* Number of slaves in the image    */
+    uint8_t                     idx[128];   /* Slot of the address, PROCIMG_NONE for none   */
+    PROCIMG_SLOT                slot[GSD_SLAVE_MAX];
+    uint32_t                    mismatch;   /* Counter of responses of other length */
+    uint32_t                    retry;      /* Counter of read retries          */
+    uint32_t                    busy;       /* Counter of reads failed          */
+} PROCIMG_INFO;
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 PROCIMG_Private_Variables
+*** @{
+***********************************************************************************************************/
+
+static PROCIMG_INFO         g_Img;
+static uint8_t              g_ImgWork[PROCIMG_IMG_MAX];     /* Inputs of the current cycle  */
+static uint8_t              g_ImgPub[PROCIMG_IMG_MAX];      /* Inputs of the completed cycle*/
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 PROCIMG_Private_Functions
+*** @{
+***********************************************************************************************************/
+/** @brief      Initialize the process image of the slaves in the layout table.
+***********************************************************************************************************/
+
+void procimg_init(void)
+{
+    const GSD_TABLE    *tab = layout_get();
+    uint32_t            off = 0;
+    int                 i;
+
+    memset(&g_Img, 0, sizeof(g_Img));
+    memset(g_Img.idx, PROCIMG_NONE, sizeof(g_Img.idx));
+    g_Img.req_da = PROCIMG_NONE;
+    for(i = 0;  i < tab->slave_num;  i++) {
+        if( (off + tab->slave[i].in_len) > PROCIMG_IMG_MAX ) {
+            printf("[IMAGE] Slave %u not fit in the image!\r\n", tab->slave[i].addr);
+            continue;
+        }
+        g_Img.slot[g_Img.num].off = (uint16_t)off;
+        g_Img.slot[g_Img.num].len = tab->slave[i].in_len;
+        g_Img.idx[tab->slave[i].addr & 0x7F] = g_Img.num++;
+        off += tab->slave[i].in_len;
+    }
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Publish the inputs of the slaves updated in the current cycle.
+***********************************************************************************************************/
+
+static void procimg_publish(void)
+{
+    PROCIMG_SLOT   *slot;
+    int             i;
+
+    g_Img.seq++;                                        // Odd: readers retry
+    __DMB();
+    for(i = 0;  i < g_Img.num;  i++) {
+        slot = &g_Img.slot[i];
+        if( slot->dirty ) {
+            memcpy(&g_ImgPub[slot->off], &g_ImgWork[slot->off], slot->len);
+            slot->cycle = g_Img.cycle + 1;
+            slot->dirty = 0;
+        }
+    }
+    g_Img.cycle++;
+    g_Img.stamp = g_Img.last;
+    __DMB();
+    g_Img.seq++;                                        // Even: the completed cycle
+    g_Img.dirty = 0;
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Take the inputs of Data_Exchange responses, called by thread_dp2net.
+***
+*** @param[in]  buff    Pointer to the DP frame
+*** @param[in]  len     Length  of the DP frame
+*** @param[in]  stamp   Timestamp of the DP frame, ref: bsp_timestamp()
+***********************************************************************************************************/
+
+void procimg_frame(const uint8_t *buff, int len, uint32_t stamp)
+{
+    PROCIMG_SLOT   *slot;
+    const uint8_t  *data;
+    int             da, sa, fc, dlen, idx;
+
+    if( (g_Img.num == 0) || (len <= 0) ) {
+        return;
+    }
+    switch( buff[0] ) {
+    case 0x10:              /* SD1: SD DA SA FC FCS ED          */
+        if( len < 4 ) {  return;  }
+        da = buff[1];  sa = buff[2];  fc = buff[3];  data = NULL;      dlen = 0;
+        break;
+    case 0xA2:              /* SD3: SD DA SA FC DATA(8) FCS ED  */
+        if( len < 12 ) {  return;  }
+        da = buff[1];  sa = buff[2];  fc = buff[3];  data = &buff[4];  dlen = 8;
+        break;
+    case 0x68:              /* SD2: SD LE LEr SD DA SA FC DATA FCS ED   */
+        if( (len < 7) || (len < (buff[1] + 4)) || (buff[1] < 3) ) {  return;  }
+        da = buff[4];  sa = buff[5];  fc = buff[6];  data = &buff[7];  dlen = buff[1] - 3;
+        break;
+    case 0xDC:              /* SD4: token passed, end of the cycle      */
+        if( g_Img.dirty ) {
+            procimg_publish();
+        }
+        return;
+    case 0xE5:              /* SC: response without data                */
+        if( (g_Img.req_da != PROCIMG_NONE) && ((idx = g_Img.idx[g_Img.req_da]) != PROCIMG_NONE) ) {
+            g_Img.slot[idx].dirty = 1;                  // Inputs not changed
+            g_Img.dirty++;
+            g_Img.last = stamp;
+        }
+        g_Img.req_da = PROCIMG_NONE;
+        return;
+    default:
+        return;
+    }
+    if( (da & 0x80) || (sa & 0x80) ) {
+        return;                                         // With SAP, not Data_Exchange
+    }
+    if( fc & 0x40 ) {                                   // Request: a slave polled again ends the cycle
+        if( ((idx = g_Img.idx[da & 0x7F]) != PROCIMG_NONE) && g_Img.slot[idx].dirty ) {
+            procimg_publish();
+        }
+        g_Img.req_da = (uint8_t)(da & 0x7F);
+        g_Img.req_sa = (uint8_t)(sa & 0x7F);
+        return;
+    }
+    if(   (sa != g_Img.req_da) || (da != g_Img.req_sa) || ((idx = g_Img.idx[sa]) == PROCIMG_NONE)
+       || (((fc & 0x0F) != 0x08) && ((fc & 0x0F) != 0x0A)) ) {
+        return;                                         // Not the response with data DL/DH
+    }
+    g_Img.req_da = PROCIMG_NONE;
+    slot = &g_Img.slot[idx];
+    if( dlen != slot->len ) {
+        g_Img.mismatch++;                               // Layout table not matched
+        dlen = (dlen < slot->len) ? (dlen) : (slot->len);
+    }
+    memcpy(&g_ImgWork[slot->off], data, dlen);
+    if( !slot->dirty ) {
+        slot->dirty = 1;
+        g_Img.dirty++;
+    }
+    g_Img.last = stamp;
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Read the inputs of a set of slaves from the same completed cycle.
+***
+*** @param[in]  req     Request of the host, "IMG ADDR ..."
+*** @param[in]  len     Length of the request
+*** @param[out] out     Reply to the host
+*** @param[in]  size    size of out(in bytes), (>= PROCIMG_HDR_LEN)
+***
+*** @return     (< 0)Invalid request or the writer too busy, (other)Length of the reply.
+***********************************************************************************************************/
+
+int procimg_read(const uint8_t *req, int len, uint8_t *out, int size)
+{
+    const PROCIMG_SLOT *slot;
+    uint32_t            seq, cycle, stamp;
+    int                 i, n, num, idx, tries;
+
+    if( (len < 2) || (req[0] != PROCIMG_REQ) || (size < PROCIMG_HDR_LEN) ) {
+        return( -1 );
+    }
+    for(tries = 0;  tries < PROCIMG_RETRY;  tries++) {
+        if( (seq = g_Img.seq) & 1 ) {
+            g_Img.retry++;
+            osThreadYield();                            // Writer publishing, let it finish
+            continue;
+        }
+        __DMB();
+        n = PROCIMG_HDR_LEN;
+        for(num = 0, i = 1;  i < len;  i++, num++) {
+            idx  = (req[i] < 128) ? (g_Img.idx[req[i]]) : (PROCIMG_NONE);
+            slot = (idx != PROCIMG_NONE) ? (&g_Img.slot[idx]) : (NULL);
+            if( (n + 3 + ((slot != NULL) ? slot->len : 0)) > size ) {
+                break;                                  // Reply full
+            }
+            out[n++] = req[i];
+            out[n++] = (slot != NULL) && (slot->cycle == g_Img.cycle);
+            out[n++] = (slot != NULL) ? (slot->len) : (0);
+            if( slot != NULL ) {
+                memcpy(&out[n], &g_ImgPub[slot->off], slot->len);
+                n += slot->len;
+            }
+        }
+        cycle = g_Img.cycle;
+        stamp = g_Img.stamp;
+        __DMB();
+        if( seq == g_Img.seq ) {
+            out[0] = PROCIMG_REQ;
+            out[1] = (uint8_t)num;
+            out[2] = (uint8_t)(cycle >> 24);  out[3] = (uint8_t)(cycle >> 16);
+            out[4] = (uint8_t)(cycle >> 8);   out[5] = (uint8_t)(cycle >> 0);
+            out[6] = (uint8_t)(stamp >> 24);  out[7] = (uint8_t)(stamp >> 16);
+            out[8] = (uint8_t)(stamp >> 8);   out[9] = (uint8_t)(stamp >> 0);
+            return( n );
+        }
+        g_Img.retry++;                                  // Published while reading, read again
+    }
+    g_Img.busy++;
+    return( -1 );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Get statistic information of the process image.
+***
+*** @param[out] buff    Output statistic information string
+*** @param[in]  size    size of buff(in bytes)
+***
+*** @return     (< 0)Error. (other)number of output char, not counting the terminating null char
+***********************************************************************************************************/
+
+int procimg_statc(char *buff, int size)
+{
+    int     n;
+
+    if( (buff == NULL) || (size <= 0) )  { return( 0 );        }
+
+    n = snprintf( buff, size, "Image: %u(Slave) %u(Cycle) %u(Length ERR), Read: %u(Retry) %u(Busy)",
+                  g_Img.num, g_Img.cycle, g_Img.mismatch, g_Img.retry, g_Img.busy );
+    if( n < 0 ) /**********************/ { return( n );        }
+    if( n >= size ) /******************/ { return( size - 1 ); }
+    return( n );
+}
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+*** @}
+***********************************************************************************************************/
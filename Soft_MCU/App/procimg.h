@@ -0,0 +1,70 @@
+/**********************************************************************************************************/
+/** @file     procimg.h
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    Process image of the slave inputs, consistent snapshot of a bus cycle by a sequence counter.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************/
+#ifndef __PROCIMG_H___20261018_214415
+#define __PROCIMG_H___20261018_214415
+#ifdef  __cplusplus
+extern  "C"
+{
+#endif
+/**********************************************************************************************************/
+/** @addtogroup PROCIMG
+*** @{
+*** @addtogroup                 PROCIMG_Exported_Constants
+*** @{
+***********************************************************************************************************/
+
+/*  Inputs of the slaves of the layout table (ref: layout.h) are taken from the Data_Exchange responses
+ *  and published when the bus cycle completes: the master polls a slave again, or passes the token.
+ *  A read returns the inputs of the slaves from the same completed cycle, the bus side never waits
+ *  for the readers. Request from the host, a datagram to PORT_NET2DP or a record of the TCP tunnel:
+ *
+ *      Request:  | IMG(0xF4) | ADDR | ADDR | ...                                                   |
+ *      Reply:    | IMG(0xF4) | NUM | CYCLE(4) | STAMP(4) | { ADDR | FRESH | LEN | DATA(LEN) } ... |
+ *
+ *  NUM       --- number of the slaves in the reply, the slaves not fit in PROCIMG_REPLY_MAX are left.
+ *  CYCLE     --- number of the completed cycle, network byte order.
+ *  STAMP     --- gateway time of the last response of the cycle in microseconds (bsp_timestamp()).
+ *  FRESH     --- (1)Inputs updated in the cycle, (0)Inputs of an earlier cycle or not in the table.
+ *  LEN       --- length of the inputs, (0)Not in the table.
+ */
+#define PROCIMG_REQ         (0xF4)                  /* Record type: process image request/reply */
+#define PROCIMG_HDR_LEN     (1 + 1 + 4 + 4)         /* Length of the reply header               */
+#define PROCIMG_REPLY_MAX   1024                    /* Max length of a reply                    */
+#define PROCIMG_IMG_MAX     4096                    /* Max length of the inputs of all slaves   */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 PROCIMG_Exported_Functions
+*** @{
+***********************************************************************************************************/
+
+extern void procimg_init(void);
+extern void procimg_frame(const uint8_t *buff, int len, uint32_t stamp);
+extern int  procimg_read(const uint8_t *req, int len, uint8_t *out, int size);
+extern int  procimg_statc(char *buff, int size);
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+*****/
+#ifdef  __cplusplus
+}
+#endif
+#endif
+/**********************************************************************************************************/
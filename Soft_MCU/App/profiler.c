@@ -0,0 +1,290 @@
+/**********************************************************************************************************/
+/** @file     profiler.c
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    CPU load and stack high-water of the RTX threads.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************/
+
+#include    <stdint.h>
+#include    <stdio.h>
+#include    <string.h>
+
+#include    "cmsis_os.h"                /* CMSIS RTOS definitions             */
+#include    "stm32f4xx.h"
+#include    "profiler.h"
+
+
+/**********************************************************************************************************/
+/** @addtogroup PROFILER
+*** @{
+*** @addtogroup PROFILER_Pravate
+*** @{
+*** @addtogroup                 PROFILER_Private_Types
+*** @{
+***********************************************************************************************************/
+
+typedef struct PROFILER_TCB {   /*- Task control block of RTX V4.73, the same layout as rt_TypeDef.h -*/
+    uint8_t                     cb_type;    /* Control Block Type               */
+    uint8_t                     state;      /* Task state                       */
+    uint8_t                     prio;       /* Execution priority               */
+    uint8_t                     task_id;    /* Task ID value                    */
+    struct PROFILER_TCB        *p_lnk;      /* Link pointer for ready/sem. wait list    */
+    struct PROFILER_TCB        *p_rlnk;     /* Link pointer for sem./mbx lst backwards  */
+    struct PROFILER_TCB        *p_dlnk;     /* Link pointer for delay list      */
+    struct PROFILER_TCB        *p_blnk;     /* Link pointer for delay list backwards    */
+    uint16_t                    delta_time; /* Time until time out              */
+    uint16_t                    interval_time;  /* Time interval for periodic waits */
+    uint16_t                    events;     /* Event flags                      */
+    uint16_t                    waits;      /* Wait flags                       */
+    void                      **msg;        /* Direct message passing when task waits   */
+    void                       *p_mlnk;     /* Link pointer for mutex owner list*/
+    uint8_t                     prio_base;  /* Base priority                    */
+    uint8_t                     ret_val;    /* Return value upon completion of a wait   */
+    uint8_t                     ret_upd;    /* Updated return value             */
+    uint16_t                    priv_stack; /* Private stack size, 0= system assigned   */
+    uint32_t                    tsk_stack;  /* Current task Stack pointer (R13) */
+    uint32_t                   *stack;      /* Pointer to Task Stack memory block       */
+    void                       *ptask;      /* Task entry address               */
+} PROFILER_TCB;
+
+typedef struct {                /*- Running task of RTX V4.73, os_tsk ---------------------------------*/
+    PROFILER_TCB               *run;        /* Current running task             */
+    PROFILER_TCB               *next;       /* Scheduled task to run            */
+} PROFILER_TSK;
+
+typedef struct {    /*------------- Profile of a row --------------------------------------------------*/
+    PROFILER_TCB               *tcb;        /* TCB of the stack filled, NULL for not seen   */
+    uint32_t                   *stack;      /* Stack memory filled              */
+    uint32_t                    last;       /* Samples at the start of the window       */
+    PROFILER_THREAD             thr;
+} PROFILER_ROW;
+
+typedef struct {    /*------------- Profiler (Run-Time) -------------------------------------------
+                    -- (samples)(idle) by TIM2_IRQHandler, the others by profiler_tick() -------*/
+    volatile uint32_t           samples[PROFILER_THREAD_NUM + 1];   /* Samples by task id       */
+    PROFILER_TCB * volatile     idle;       /* TCB of the idle demon            */
+    PROFILER_ROW                row[PROFILER_THREAD_NUM + 1];
+    osThreadId                  tid[PROFILER_THREAD_NUM];           /* Threads named            */
+    const char                 *name[PROFILER_THREAD_NUM];          /* Names of the threads     */
+} PROFILER_INFO;
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 PROFILER_Private_Variables
+*** @{
+***********************************************************************************************************/
+
+extern PROFILER_TSK         os_tsk;                 /* only for Keil RTX V4, rt_Task.c          */
+extern void                *os_active_TCB[];        /* only for Keil RTX V4, RTX_CM_lib.h       */
+extern uint32_t const       os_stackinfo;
+extern uint16_t const       os_maxtaskrun;
+
+static PROFILER_INFO        g_Profiler;
+static void profiler_tick(void const *arg);                 /* prototype for timer callback     */
+static osTimerDef(profiler_tick, profiler_tick);            /* Timer of the window              */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 PROFILER_Private_Functions
+*** @{
+***********************************************************************************************************/
+/** @brief      Initialize the profiler, after board_init() started TIM2.
+***********************************************************************************************************/
+
+void profiler_init(void)
+{
+    osTimerId   timer;
+
+    g_Profiler.tid[0]  = osThreadGetId();
+    g_Profiler.name[0] = "main";
+
+    WRITE_REG( TIM2->CCR1,     TIM2->CNT + PROFILER_SAMPLE_US); /* Compare channel 1, frozen output     */
+    WRITE_REG( TIM2->SR,       ~TIM_SR_CC1IF);
+    SET_BIT(   TIM2->DIER,     TIM_DIER_CC1IE);                 /* Capture/Compare 1 interrupt enable   */
+    NVIC_SetPriority(TIM2_IRQn, (1u << __NVIC_PRIO_BITS) - 1);  /* Lowest priority, only the threads    */
+    NVIC_EnableIRQ(TIM2_IRQn);
+
+    if(   ((timer = osTimerCreate(osTimer(profiler_tick), osTimerPeriodic, NULL)) == NULL)
+       || (osTimerStart(timer, PROFILER_PERIOD) != osOK) ) {
+        printf("[PROFILER] Initialize Failed!\r\n");
+    }
+    if( os_maxtaskrun > PROFILER_THREAD_NUM ) {         // OS_TASKCNT of RTX_Conf_CM.c raised alone
+        printf("[PROFILER] %u threads, %u profiled!\r\n", os_maxtaskrun, PROFILER_THREAD_NUM);
+    }
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Name a thread in the profile.
+***
+*** @param[in]  tid     Thread ID of osThreadCreate()
+*** @param[in]  name    Name of the thread, a constant string
+***********************************************************************************************************/
+
+void profiler_name(osThreadId tid, const char *name)
+{
+    int     i;
+
+    for(i = 0;  (tid != NULL) && (i < PROFILER_THREAD_NUM);  i++) {
+        if( (g_Profiler.tid[i] == NULL) || (g_Profiler.tid[i] == tid) ) {
+            g_Profiler.name[i] = name;
+            g_Profiler.tid[i]  = tid;
+            break;
+        }
+    }
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Get the profile of a thread.
+***
+*** @param[in]  idx     Row of the profile, (0)Idle demon, (1 ~ PROFILER_THREAD_NUM)RTX task id
+*** @param[out] thr     Profile of the thread, (size == 0) for no such thread
+***
+*** @return     (0)No such row, (other)Succeed.
+***********************************************************************************************************/
+
+int profiler_thread(int idx, PROFILER_THREAD *thr)
+{
+    if( (idx < 0) || (idx > PROFILER_THREAD_NUM) ) {
+        return( 0 );
+    }
+    memcpy(thr, &g_Profiler.row[idx].thr, sizeof(*thr));
+    if( g_Profiler.row[idx].tcb == NULL ) {
+        thr->size = 0;
+    }
+    return( 1 );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Fill the free stack of a thread new in the row, and scan the high-water.
+***
+*** @param[in]  row     Row of the thread
+*** @param[in]  tcb     TCB of the thread in the row, NULL for not used
+*** @param[in]  idx     Row of the profile
+***********************************************************************************************************/
+
+static void profiler_stack(PROFILER_ROW *row, PROFILER_TCB *tcb, int idx)
+{
+    uint32_t   *stk, *sp, *p;
+    uint32_t    words, primask;
+    int         i;
+
+    if( (tcb == NULL) || (tcb->stack == NULL) ) {
+        row->tcb = NULL;
+        return;
+    }
+    stk   = tcb->stack;
+    words = ((tcb->priv_stack != 0) ? (tcb->priv_stack) : (os_stackinfo & 0xFFFF)) / 4;
+
+    if( (row->tcb != tcb) || (row->stack != stk) ) {    // A thread new in the row
+        primask = __get_PRIMASK();
+        __disable_irq();                                // No thread created or deleted meanwhile
+        if( (tcb == ((idx == 0) ? (g_Profiler.idle) : (os_active_TCB[idx - 1]))) && (tcb->stack == stk) ) {
+            sp = (uint32_t*)((tcb == os_tsk.run) ? (__get_PSP()) : (tcb->tsk_stack));
+            for(p = &stk[1];  (p < sp) && (p < &stk[words]);  p++) {
+                *p = PROFILER_STK_FILL;                 // stk[0] is the magic word of OS_STKCHECK
+            }
+        }
+        __set_PRIMASK(primask);
+        row->tcb       = tcb;
+        row->stack     = stk;
+        row->thr.tid   = (uint8_t)idx;
+        row->thr.size  = words * 4;
+    }
+    for(i = 1;  (i < words) && (stk[i] == PROFILER_STK_FILL);  i++) {
+    }
+    sp = (uint32_t*)((tcb == os_tsk.run) ? (__get_PSP()) : (tcb->tsk_stack));
+    row->thr.peak = (words - i) * 4;
+    row->thr.used = ((sp > stk) && (sp <= &stk[words])) ? ((&stk[words] - sp) * 4) : (0);
+    row->thr.prio = tcb->prio;
+
+    for(i = 0;  (i < PROFILER_THREAD_NUM) && (g_Profiler.tid[i] != (osThreadId)tcb);  i++) {
+    }
+    if( i < PROFILER_THREAD_NUM ) {
+        snprintf(row->thr.name, sizeof(row->thr.name), "%s", g_Profiler.name[i]);
+    } else if( idx == 0 ) {
+        snprintf(row->thr.name, sizeof(row->thr.name), "idle");
+    } else if( tcb == os_tsk.run ) {
+        snprintf(row->thr.name, sizeof(row->thr.name), "timer");
+    } else {
+        snprintf(row->thr.name, sizeof(row->thr.name), "0x%08X", (unsigned)tcb->ptask);
+    }
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Timer callback, close the window of the CPU load and scan the stacks.
+***
+*** @param[in]  arg     Not used
+***********************************************************************************************************/
+
+static void profiler_tick(void const *arg)
+{
+    uint32_t    delta[PROFILER_THREAD_NUM + 1];
+    uint32_t    total, n;
+    int         i;
+
+    (void)arg;
+    for(total = 0, i = 0;  i <= PROFILER_THREAD_NUM;  i++) {
+        n        = g_Profiler.samples[i];
+        delta[i] = n - g_Profiler.row[i].last;
+        total   += delta[i];
+        g_Profiler.row[i].last        = n;
+        g_Profiler.row[i].thr.samples = n;
+    }
+    for(i = 0;  i <= PROFILER_THREAD_NUM;  i++) {
+        g_Profiler.row[i].thr.load = (uint16_t)((total == 0) ? (0) : ((delta[i] * 1000) / total));
+        profiler_stack( &g_Profiler.row[i],
+                        (i == 0)              ? (g_Profiler.idle) :
+                        (i <= os_maxtaskrun)  ? ((PROFILER_TCB*)os_active_TCB[i - 1]) : (NULL), i );
+    }
+}
+
+
+/**********************************************************************************************************/
+/** @brief      TIM2 compare channel 1, sample the running thread.
+***********************************************************************************************************/
+
+void TIM2_IRQHandler(void)
+{
+    PROFILER_TCB   *tcb;
+    uint32_t        id;
+
+    if( READ_BIT(TIM2->SR, TIM_SR_CC1IF) ) {
+        WRITE_REG(TIM2->SR, ~TIM_SR_CC1IF);
+        TIM2->CCR1 += PROFILER_SAMPLE_US;
+        if( (int32_t)(TIM2->CCR1 - TIM2->CNT) <= 0 ) {
+            TIM2->CCR1 = TIM2->CNT + PROFILER_SAMPLE_US;  // Sample missed, not wait for 2^32us
+        }
+        if( (tcb = os_tsk.run) != NULL ) {
+            if( ((id = tcb->task_id) == 0) || (id == 0xFF) ) {
+                g_Profiler.idle = tcb;                  // Task id of the idle demon is 255
+                id = 0;
+            }
+            if( id <= PROFILER_THREAD_NUM ) {
+                g_Profiler.samples[id]++;               // Not the threads over PROFILER_THREAD_NUM
+            }
+        }
+    }
+}
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+*** @}
+***********************************************************************************************************/
@@ -0,0 +1,85 @@
+/**********************************************************************************************************/
+/** @file     profiler.h
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    CPU load and stack high-water of the RTX threads.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************/
+#ifndef __PROFILER_H___20261018_231410
+#define __PROFILER_H___20261018_231410
+#ifdef  __cplusplus
+extern  "C"
+{
+#endif
+/**********************************************************************************************************/
+/** @addtogroup PROFILER
+*** @{
+*** @addtogroup                 PROFILER_Exported_Constants
+*** @{
+***********************************************************************************************************/
+
+/*  CPU load: the running thread is sampled every PROFILER_SAMPLE_US by the compare channel 1 of the
+ *  timestamp timer TIM2, at the lowest interrupt priority, so the time of the other interrupts is
+ *  counted to the thread they preempted. The load of a thread is the share of its samples in the
+ *  last PROFILER_PERIOD.
+ *
+ *  Stack high-water: the free part of a thread stack, below the stack pointer, is filled with
+ *  PROFILER_STK_FILL the first time the thread is seen, and scanned every PROFILER_PERIOD. The
+ *  high-water is the deepest use of the stack since then.
+ *
+ *  The row 0 is the idle demon, the rows 1 ~ PROFILER_THREAD_NUM are the threads by the RTX task id.
+ */
+#define PROFILER_SAMPLE_US  100                     /* Sample period of the running thread(us)  */
+#define PROFILER_PERIOD     1000                    /* Window of the CPU load and scan(ms)      */
+#define PROFILER_THREAD_NUM (17 + 1)                /* Max RTX task id, OS_TASKCNT + 1 timer    */
+#define PROFILER_NAME_LEN   12                      /* Max length of a thread name              */
+#define PROFILER_STK_FILL   0xCCCCCCCCu             /* Fill of the free stack                   */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 PROFILER_Exported_Types
+*** @{
+***********************************************************************************************************/
+
+typedef struct {    /*------------- Profile of a thread -------------------------------------------*/
+    uint8_t                     tid;        /* RTX task id, 0 for the idle demon */
+    uint8_t                     prio;       /* RTX priority, 1(osPriorityIdle) ~ 7(osPriorityRealtime) */
+    uint16_t                    load;       /* CPU load in the last window(permille) */
+    uint32_t                    samples;    /* Samples of the thread running    */
+    uint32_t                    size;       /* Stack size(bytes)                */
+    uint32_t                    used;       /* Stack used at the last scan(bytes)   */
+    uint32_t                    peak;       /* Stack high-water(bytes)          */
+    char                        name[PROFILER_NAME_LEN + 1];    /* Name, or the entry address   */
+} PROFILER_THREAD;
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 PROFILER_Exported_Functions
+*** @{
+***********************************************************************************************************/
+
+extern void profiler_init(void);
+extern void profiler_name(osThreadId tid, const char *name);
+extern int  profiler_thread(int idx, PROFILER_THREAD *thr);
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+*****/
+#ifdef  __cplusplus
+}
+#endif
+#endif
+/**********************************************************************************************************/
@@ -0,0 +1,237 @@
+/**********************************************************************************************************/
+/** @file     prom.c
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    Metrics in the Prometheus text format, generated line by line for 'metrics.cgx'.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************/
+
+#include    <stdint.h>
+#include    <stdio.h>
+
+#include    "stm32f4xx.h"               /* SystemCoreClock                    */
+#include    "board.h"
+#include    "cfg.h"
+#include    "metrics.h"
+#include    "ProfiBUS_DP.h"
+#include    "prom.h"
+
+
+/**********************************************************************************************************/
+/** @addtogroup PROM
+*** @{
+*** @addtogroup PROM_Pravate
+*** @{
+*** @addtogroup                 PROM_Private_Constants
+*** @{
+***********************************************************************************************************/
+
+#define PROM_STATION_NUM    3                       /* Families of the per-station counters     */
+
+#define PROM_POS(fam, line) (((uint32_t)(fam) << 8) | (line))  /* Line of a family              */
+#define PROM_POS_FAM(pos)   ((pos) >> 8)
+#define PROM_POS_LINE(pos)  ((pos) & 0xFF)
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 PROM_Private_Types
+*** @{
+***********************************************************************************************************/
+
+typedef struct {    /*------------- Family of the metrics -----------------------------------------*/
+    const char                 *name;       /* Name without PROM_PREFIX         */
+    const char                 *help;       /* Description                      */
+} PROM_FAMILY;
+
+typedef struct {    /*------------- Scrape of a HTTP session (Run-Time) ----------------------------*/
+    int                         stations;   /* Per-station counters enabled     */
+    uint32_t                    snap[METRICS_SLOT_NUM];     /* Registry at the first call       */
+} PROM_INFO;
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 PROM_Private_Variables
+*** @{
+***********************************************************************************************************/
+
+static PROM_INFO            g_Prom[PROM_SESSION_NUM];   /* By (session % PROM_SESSION_NUM)  */
+
+static const char * const   g_PromType[] = { "counter", "gauge", "histogram" };    /* METRICS_TYPE_x  */
+
+static const PROM_FAMILY    g_PromStation[PROM_STATION_NUM] = {
+    { "dp_station_requests",    "Requests with reply sent to the station"               },
+    { "dp_station_retries",     "Requests retried, not replied within slot time"        },
+    { "dp_station_failures",    "Requests not replied after all the retries"            },
+};
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 PROM_Private_Functions
+*** @{
+***********************************************************************************************************/
+/** @brief      Write a line of the per-station counters.
+***
+*** @param[out] buf     Output buffer, PROM_LINE_MAX chars at least
+*** @param[in]  idx     Family of the per-station counters, 0 ~ (PROM_STATION_NUM - 1)
+*** @param[in]  da      Station address
+***
+*** @return     Chars written, (0)Station never requested.
+***********************************************************************************************************/
+
+static int prom_station(char *buf, int idx, int da)
+{
+    const PBDP_SLOT    *slot = PBDP_GetSlot(da);
+    uint32_t            v;
+
+    if( (slot == NULL) || (slot->req == 0) ) {
+        return( 0 );
+    }
+    v = (idx == 0) ? (slot->req) : (idx == 1) ? (slot->retry) : (slot->fail);
+    return( snprintf( buf, PROM_LINE_MAX, PROM_PREFIX "%s_total{station=\"%d\"} %u\n",
+                      g_PromStation[idx].name, da, v ) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Write a line of a histogram.
+***
+*** @param[out] buf     Output buffer, PROM_LINE_MAX chars at least
+*** @param[in]  scrape  Scrape of the session
+*** @param[in]  desc    Descriptor of the histogram
+*** @param[in]  b       Line of the histogram, (0 ~ METRICS_HIST_BINS - 1)Buckets, (METRICS_HIST_BINS)_sum,
+***                     (METRICS_HIST_BINS + 1)_count
+***
+*** @return     Chars written.
+***********************************************************************************************************/
+
+static int prom_hist(char *buf, const PROM_INFO *scrape, const METRICS_DESC *desc, int b)
+{
+    const uint32_t     *bin = &scrape->snap[desc->slot];
+    uint32_t            cnt;
+    int                 i;
+
+    if( b == METRICS_HIST_BINS ) {
+        return( snprintf(buf, PROM_LINE_MAX, PROM_PREFIX "%s_sum %u\n", desc->name, bin[METRICS_HIST_BINS]) );
+    }
+    for(cnt = 0, i = 0;  (i <= b) && (i < METRICS_HIST_BINS);  i++) {
+        cnt += bin[i];                                  // Buckets are cumulative
+    }
+    if( b > METRICS_HIST_BINS ) {
+        return( snprintf(buf, PROM_LINE_MAX, PROM_PREFIX "%s_count %u\n", desc->name, cnt) );
+    }
+    if( b == (METRICS_HIST_BINS - 1) ) {                // The last bin for all the larger values
+        return( snprintf(buf, PROM_LINE_MAX, PROM_PREFIX "%s_bucket{le=\"+Inf\"} %u\n", desc->name, cnt) );
+    }
+    return( snprintf( buf, PROM_LINE_MAX, PROM_PREFIX "%s_bucket{le=\"%u\"} %u\n",
+                      desc->name, (1u << b) - 1, cnt ) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Write a line at the position, and move to the next line.
+***
+*** @param[out] buf     Output buffer, PROM_LINE_MAX chars at least
+*** @param[in]  scrape  Scrape of the session
+*** @param[io]  pos     Position of the line, PROM_POS(family, line)
+***
+*** @return     Chars written, (< 0)All the lines written.
+***********************************************************************************************************/
+
+static int prom_line(char *buf, const PROM_INFO *scrape, uint32_t *pos)
+{
+    const METRICS_DESC *desc = NULL;
+    const char         *name, *help, *type, *sfx;
+    uint32_t            fam  = PROM_POS_FAM(*pos);
+    int                 line = PROM_POS_LINE(*pos);
+
+    if( fam < METRICS_NUM ) {
+        desc = metrics_desc(fam);
+        name = desc->name;
+        help = desc->help;
+        type = g_PromType[desc->type];
+        sfx  = (desc->type == METRICS_TYPE_COUNTER) ? ("_total") : ("");
+    } else if( scrape->stations && (fam < (METRICS_NUM + PROM_STATION_NUM)) ) {
+        name = g_PromStation[fam - METRICS_NUM].name;
+        help = g_PromStation[fam - METRICS_NUM].help;
+        type = g_PromType[METRICS_TYPE_COUNTER];
+        sfx  = "_total";
+    } else {
+        *pos = PROM_POS_END;
+        return( -1 );
+    }
+
+    (*pos)++;
+    if( line == 0 ) {
+        return( snprintf(buf, PROM_LINE_MAX, "# HELP " PROM_PREFIX "%s%s %s\n", name, sfx, help) );
+    }
+    if( line == 1 ) {
+        return( snprintf(buf, PROM_LINE_MAX, "# TYPE " PROM_PREFIX "%s%s %s\n", name, sfx, type) );
+    }
+    if( desc == NULL ) {                                // Line 2 ~ of the stations
+        if( (line - 2) >= (PBDP_STATION_NUM - 1) ) {
+            *pos = PROM_POS(fam + 1, 0);
+        }
+        return( prom_station(buf, fam - METRICS_NUM, line - 2) );
+    }
+    if( desc->type != METRICS_TYPE_HIST ) {
+        *pos = PROM_POS(fam + 1, 0);
+        return( snprintf(buf, PROM_LINE_MAX, PROM_PREFIX "%s%s %u\n", name, sfx, scrape->snap[desc->slot]) );
+    }
+    if( (line - 2) > METRICS_HIST_BINS ) {              // Line 2 ~ of the buckets, _sum and _count
+        *pos = PROM_POS(fam + 1, 0);
+    }
+    return( prom_hist(buf, scrape, desc, line - 2) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Write the lines of the metrics, up to the buffer or PROM_BUDGET_US of CPU time.
+***
+*** @param[out] buf     Output buffer
+*** @param[in]  size    Size of the output buffer
+*** @param[io]  pos     Position of the lines, (0)The first call, (PROM_POS_END)All the lines written
+*** @param[in]  sess    Session of the HTTP server, http_get_session()
+***
+*** @return     Chars written.
+***********************************************************************************************************/
+
+uint32_t prom_write(char *buf, uint32_t size, uint32_t *pos, uint32_t sess)
+{
+    PROM_INFO  *scrape = &g_Prom[sess % PROM_SESSION_NUM];     // Sessions from 0 or 1, distinct
+    uint32_t    start  = bsp_cycles();
+    uint32_t    budget = (SystemCoreClock / 1000000) * PROM_BUDGET_US;
+    uint32_t    len    = 0;
+    int         n;
+
+    if( *pos == 0 ) {
+        metrics_snapshot(scrape->snap);                 // A scrape consistent at an instant
+        scrape->stations = cfg_get_metrics_stations();
+    }
+    while( ((len + PROM_LINE_MAX) < size) && ((bsp_cycles() - start) < budget) ) {
+        if( (n = prom_line(&buf[len], scrape, pos)) < 0 ) {
+            break;
+        }
+        len += (n < PROM_LINE_MAX) ? (n) : (PROM_LINE_MAX - 1);
+    }
+    METRICS_HIST(lat_prom, bsp_cycles() - start);
+    return( len );
+}
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+*** @}
+***********************************************************************************************************/
@@ -0,0 +1,63 @@
+/**********************************************************************************************************/
+/** @file     prom.h
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    Metrics in the Prometheus text format, generated line by line for 'metrics.cgx'.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************/
+#ifndef __PROM_H___20261019_001230
+#define __PROM_H___20261019_001230
+#ifdef  __cplusplus
+extern  "C"
+{
+#endif
+/**********************************************************************************************************/
+/** @addtogroup PROM
+*** @{
+*** @addtogroup                 PROM_Exported_Constants
+*** @{
+***********************************************************************************************************/
+
+/*  The metrics of METRICS_TABLE are named PROM_PREFIX name, "_total" appended to the counters. A
+ *  histogram has the buckets le="2^n - 1" of its bins, le="+Inf", _sum and _count. The per-station
+ *  counters of the slot time supervision are added if "[Metrics] STATIONS" is enabled, the stations
+ *  never requested are left out.
+ *
+ *  A call writes whole lines, up to the buffer or PROM_BUDGET_US of CPU time, the position is kept
+ *  in (*pos) for the next call. The registry is taken at the first call into the snapshot of the
+ *  HTTP session, the lines of a histogram are consistent in a scrape while the other sessions scrape.
+ */
+#define PROM_PREFIX         "pbgw_"                 /* Prefix of the metric names               */
+#define PROM_BUDGET_US      200                     /* Max CPU time of a call(us)               */
+#define PROM_LINE_MAX       160                     /* Max length of a line                     */
+#define PROM_POS_END        0xFFFFFFFFu             /* Position of all the lines written        */
+#define PROM_SESSION_NUM    2                       /* Snapshots, HTTP_SERVER_NUM_SESSIONS      */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 PROM_Exported_Functions
+*** @{
+***********************************************************************************************************/
+
+extern uint32_t prom_write(char *buf, uint32_t size, uint32_t *pos, uint32_t sess);
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+*****/
+#ifdef  __cplusplus
+}
+#endif
+#endif
+/**********************************************************************************************************/
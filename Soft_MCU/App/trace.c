@@ -0,0 +1,448 @@
+/**********************************************************************************************************/
+/** @file     trace.c
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    Binary event trace of the interrupts and threads, dumped or streamed on a TCP port.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************/
+
+#include    <stdint.h>
+#include    <stdio.h>
+#include    <string.h>
+
+#include    "cmsis_os.h"                /* CMSIS RTOS definitions             */
+#include    "rl_net.h"                  /* Network definitions                */
+#include    "stm32f4xx.h"               /* __LDREXW(), __STREXW(), SystemCoreClock */
+
+#include    "board.h"
+#include    "cfg.h"
+#include    "profiler.h"
+#include    "trace.h"
+
+
+/**********************************************************************************************************/
+/** @addtogroup TRACE
+*** @{
+*** @addtogroup TRACE_Pravate
+*** @{
+*** @addtogroup                 TRACE_Private_Constants
+*** @{
+***********************************************************************************************************/
+
+#define TRACE_TX_NUM        64                      /* Records sent at a time                   */
+#define TRACE_RX_LEN        64                      /* Max length of a command line             */
+#define TRACE_POLL_MS       10                      /* Poll period of the commands and STREAM   */
+
+#define TRACE_TRIG_NONE     0                       /* Trigger not armed                        */
+#define TRACE_TRIG_ARMED    1                       /* Waiting for the record of the trigger    */
+#define TRACE_TRIG_FIRED    2                       /* Waiting for the records after trigger    */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 TRACE_Private_Types
+*** @{
+***********************************************************************************************************/
+
+typedef struct {    /*------------- Trace (Run-Time) ----------------------------------------------
+                    -- (head)(done) written by trace_write() only, the others by thread_trace ----*/
+    volatile uint32_t           head;       /* Records reserved(free running)   */
+    volatile uint32_t           done;       /* Records written (free running)   */
+    uint32_t                    mask;       /* Subsystems of the trace          */
+    volatile int                trig;       /* State of the trigger, TRACE_TRIG_x   */
+    uint32_t                    trig_id;    /* Record id of the trigger         */
+    uint32_t                    trig_arg;   /* Record arg of the trigger, masked*/
+    uint32_t                    trig_amask; /* Mask of the record arg           */
+    uint32_t                    trig_post;  /* Records after the trigger        */
+    uint32_t                    stop;       /* (head) to stop the trace at      */
+
+    uint16_t                    port;       /* TCP server port                  */
+    int                         stream;     /* STREAM to the client             */
+    uint32_t                    pos;        /* Next record to the client        */
+    uint32_t                    end;        /* End of the records to DUMP       */
+    uint32_t                    lost;       /* Records overwritten before sent  */
+    int                         rx_len;     /* Length of the command line       */
+} TRACE_INFO;
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 TRACE_Private_Variables
+*** @{
+***********************************************************************************************************/
+
+volatile uint32_t           g_TraceMask;                    /* Subsystems enabled, 0 while stopped  */
+
+static TRACE_INFO           g_Trace;
+static TRACE_REC            g_TraceBuf[TRACE_REC_NUM];      /* Record id 0 for never written    */
+static TRACE_REC            g_TraceTx[TRACE_TX_NUM];
+static char                 g_TraceRx[TRACE_RX_LEN + 1];
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 TRACE_Private_Prototypes
+*** @{
+***********************************************************************************************************/
+
+static void thread_trace(void const *arg);
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 TRACE_Private_Functions
+*** @{
+***********************************************************************************************************/
+/** @brief      Initialize the trace, started if the mask in the config file is not 0.
+***********************************************************************************************************/
+
+void trace_init(void)
+{
+    static osThreadDef(thread_trace, osPriorityBelowNormal, 1, 0);
+    osThreadId  tid = NULL;
+
+    g_Trace.port = cfg_get_trace_port();
+    g_Trace.mask = cfg_get_trace_mask();
+    g_TraceMask  = g_Trace.mask;
+
+    if( (g_Trace.port != 0) && ((tid = osThreadCreate(osThread(thread_trace), NULL)) == NULL) ) {
+        printf("[TRACE] Initialize Failed!\r\n");
+    }
+    profiler_name(tid, "trace");
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Write a record lock-free, may be called in the interrupts, ref: TRACE().
+***
+*** @param[in]  id      (subsystem << 8) | event
+*** @param[in]  arg     Argument of the event, the low 16 bits
+***********************************************************************************************************/
+
+void trace_write(uint32_t id, uint32_t arg)
+{
+    TRACE_REC  *rec;
+    uint32_t    cyc, head, n;
+
+    cyc = bsp_cycles();
+    do {
+        head = __LDREXW(&g_Trace.head);
+    } while( __STREXW(head + 1, &g_Trace.head) );
+    rec      = &g_TraceBuf[head & (TRACE_REC_NUM - 1)];
+    rec->cyc = cyc;
+    rec->id  = (uint16_t)id;
+    rec->arg = (uint16_t)arg;
+    do {
+        n = __LDREXW(&g_Trace.done);
+    } while( __STREXW(n + 1, &g_Trace.done) );
+
+    if( (g_Trace.trig == TRACE_TRIG_ARMED) && (id == g_Trace.trig_id)
+                                           && ((arg & g_Trace.trig_amask & 0xFFFF) == g_Trace.trig_arg) ) {
+        g_Trace.stop = head + 1 + g_Trace.trig_post;
+        g_Trace.trig = TRACE_TRIG_FIRED;
+    }
+    if( (g_Trace.trig == TRACE_TRIG_FIRED) && ((int32_t)(head + 1 - g_Trace.stop) >= 0) ) {
+        g_TraceMask  = 0;                               // Stopped on the trigger
+        g_Trace.trig = TRACE_TRIG_NONE;
+    }
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Read the records from (pos) up to (end), or up to the last written for STREAM, the
+***             records overwritten are counted to (lost).
+***
+*** @param[out] rec     Buffer of the records
+*** @param[in]  num     Max records to read
+*** @param[out] got     Records read, without the records never written
+***
+*** @return     (< 0)Records being written, try later, (0)No more record, (other)Records passed.
+***********************************************************************************************************/
+
+static int trace_read(TRACE_REC *rec, int num, int *got)
+{
+    uint32_t    p, end, done, head, skip;
+    int         m, n, i;
+
+    done = g_Trace.done;
+    head = g_Trace.head;
+    if( head != done ) {
+        return( -1 );                                   // Records reserved but not written yet
+    }
+    p   = g_Trace.pos;
+    end = (g_Trace.stream) ? (head) : (g_Trace.end);
+    if( (head - p) > TRACE_REC_NUM ) {                  // Overwritten before read
+        skip = head - TRACE_REC_NUM;
+        if( (int32_t)(skip - end) > 0 ) {
+            skip = end;                                 // DUMP overwritten up to its end
+        }
+        g_Trace.lost += skip - p;
+        p = skip;
+    }
+    if( (int32_t)(end - p) <= 0 ) {
+        g_Trace.pos = p;
+        return( 0 );
+    }
+    m = ((end - p) < (uint32_t)num) ? (int)(end - p) : (num);
+    for(i = 0;  i < m;  i++) {
+        rec[i] = g_TraceBuf[(p + i) & (TRACE_REC_NUM - 1)];
+    }
+    if( ((head = g_Trace.head) - p) > TRACE_REC_NUM ) { // Overwritten while read
+        skip = head - TRACE_REC_NUM - p;
+        skip = (skip < (uint32_t)m) ? (skip) : ((uint32_t)m);
+        g_Trace.lost += skip;
+    } else {
+        skip = 0;
+    }
+    for(n = 0, i = skip;  i < m;  i++) {
+        if( rec[i].id != 0 ) {                          // Not the records never written
+            rec[n++] = rec[i];
+        }
+    }
+    g_Trace.pos = p + m;
+    *got = n;
+    return( m );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Send to the client.
+***
+*** @return     (< 0)Socket error, (other)Succeed.
+***********************************************************************************************************/
+
+static int trace_send(int client, const void *buff, int len)
+{
+    int     rc, o;
+
+    for(o = 0;  o < len;  o += rc) {
+        if( (rc = send(client, (const char*)buff + o, len - o, 0)) <= 0 ) {
+            return( -1 );
+        }
+    }
+    return( 0 );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Send a record made here, the header of DUMP and STREAM for (id == TRACE_MAGIC).
+***
+*** @return     (< 0)Socket error, (other)Succeed.
+***********************************************************************************************************/
+
+static int trace_mark(int client, uint32_t id, uint32_t arg)
+{
+    uint32_t    hdr[4];
+    TRACE_REC   rec;
+
+    if( id == TRACE_MAGIC ) {
+        hdr[0] = TRACE_MAGIC;
+        hdr[1] = SystemCoreClock;
+        hdr[2] = g_Trace.mask;
+        hdr[3] = 0;
+        return( trace_send(client, hdr, sizeof(hdr)) );
+    }
+    rec.cyc = bsp_cycles();
+    rec.id  = (uint16_t)id;
+    rec.arg = (uint16_t)((arg < 0xFFFF) ? (arg) : (0xFFFF));
+    return( trace_send(client, &rec, sizeof(rec)) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Send the records up to (end) to the client, at most a buffer of records at a time.
+***
+*** @return     (-2)Socket error, (-1)Records being written, try later, (other)Records passed.
+***********************************************************************************************************/
+
+static int trace_records(int client)
+{
+    int     m, n, total;
+
+    for(total = 0;  total < TRACE_REC_NUM;  total += m) {
+        m = trace_read(g_TraceTx, TRACE_TX_NUM, &n);
+        if( g_Trace.lost != 0 ) {
+            if( trace_mark(client, TRACE_ID_LOST, g_Trace.lost) < 0 ) {
+                return( -2 );
+            }
+            g_Trace.lost = 0;
+        }
+        if( m <= 0 ) {
+            return( (m < 0) ? (-1) : (total) );
+        }
+        if( trace_send(client, g_TraceTx, n * sizeof(TRACE_REC)) < 0 ) {
+            return( -2 );
+        }
+    }
+    return( total );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Execute a command line of the client.
+***
+*** @param[in]  client  Client socket
+*** @param[in]  line    Command line, without the line end
+***
+*** @return     (< 0)Socket error, (other)Succeed.
+***********************************************************************************************************/
+
+static int trace_cmd(int client, const char *line)
+{
+    long    id, arg, amask, post;
+    int     rc;
+
+    if( g_Trace.stream ) {                              // Any command ends the STREAM
+        g_Trace.stream = 0;
+        if( trace_mark(client, TRACE_ID_EOF, 0) < 0 ) {
+            return( -1 );
+        }
+    }
+
+    if( sscanf(line, "MASK %li", &arg) == 1 ) {
+        g_Trace.mask = (uint32_t)arg;
+        if( g_TraceMask != 0 ) {
+            g_TraceMask = g_Trace.mask;
+        }
+    } else if( strcmp(line, "START") == 0 ) {
+        g_TraceMask  = g_Trace.mask;
+    } else if( strcmp(line, "STOP") == 0 ) {
+        g_TraceMask  = 0;
+    } else if( sscanf(line, "TRIG %li %li %li %li", &id, &arg, &amask, &post) == 4 ) {
+        g_Trace.trig       = TRACE_TRIG_NONE;
+        g_Trace.trig_id    = (uint32_t)id;
+        g_Trace.trig_arg   = (uint32_t)(arg & amask & 0xFFFF);
+        g_Trace.trig_amask = (uint32_t)amask;
+        g_Trace.trig_post  = (uint32_t)post;
+        g_Trace.trig       = (id < 0) ? (TRACE_TRIG_NONE) : (TRACE_TRIG_ARMED);
+    } else if( (strcmp(line, "DUMP") == 0) || (strcmp(line, "STREAM") == 0) ) {
+        g_Trace.pos    = g_Trace.head - ((line[0] == 'D') ? (TRACE_REC_NUM) : (0));
+        g_Trace.end    = g_Trace.head;
+        g_Trace.lost   = 0;
+        g_Trace.stream = (line[0] == 'S');
+        if( trace_mark(client, TRACE_MAGIC, 0) < 0 ) {
+            return( -1 );
+        }
+        while( !g_Trace.stream && ((int32_t)(g_Trace.end - g_Trace.pos) > 0) ) {
+            if( (rc = trace_records(client)) < -1 ) {
+                return( -1 );
+            } else if( rc == -1 ) {
+                osDelay(1);                             // Waiting for the records being written
+            } else if( rc == 0 ) {
+                break;                                  // No more record up to (end)
+            }
+        }
+        return( g_Trace.stream ? (0) : (trace_mark(client, TRACE_ID_EOF, 0)) );
+    } else {
+        return( trace_send(client, "ERR\r\n", 5) );
+    }
+    return( trace_send(client, "OK\r\n", 4) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Receive the command lines of the client.
+***
+*** @param[in]  client  Client socket
+***
+*** @return     (< 0)Socket error, (other)Succeed.
+***********************************************************************************************************/
+
+static int trace_recv(int client)
+{
+    char   *end;
+    int     rc, len;
+
+    rc = recv(client, &g_TraceRx[g_Trace.rx_len], TRACE_RX_LEN - g_Trace.rx_len, MSG_DONTWAIT);
+    if( rc == BSD_ERROR_WOULDBLOCK ) {
+        return( 0 );                                    // No data received
+    }
+    if( rc <= 0 ) {
+        return( -1 );                                   // Connection closed or error
+    }
+
+    g_Trace.rx_len += rc;
+    g_TraceRx[g_Trace.rx_len] = '\0';
+    while( (end = strchr(g_TraceRx, '\n')) != NULL ) {
+        len  = end - g_TraceRx + 1;
+        *end = '\0';
+        if( (end > g_TraceRx) && (end[-1] == '\r') ) {
+            end[-1] = '\0';
+        }
+        if( trace_cmd(client, g_TraceRx) < 0 ) {
+            return( -1 );
+        }
+        g_Trace.rx_len -= len;
+        memmove(g_TraceRx, &g_TraceRx[len], g_Trace.rx_len + 1);
+    }
+    if( g_Trace.rx_len >= TRACE_RX_LEN ) {
+        g_Trace.rx_len = 0;                             // Line too long, discarded
+        return( trace_send(client, "ERR\r\n", 5) );
+    }
+    return( 0 );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Thread of the trace TCP server
+***********************************************************************************************************/
+
+static void thread_trace(void const *arg)
+{
+    struct sockaddr_in  addr;
+    int                 server, client;
+
+    (void)arg;
+    osDelay(5000);
+
+    printf("[TRACE] Server start, ");
+    if( (server = socket(AF_INET, SOCK_STREAM, 0)) < 0 ) {
+        printf("malloc socket failed!\r\n");
+        return;
+    }
+    addr.sin_family      = PF_INET;
+    addr.sin_port        = htons(g_Trace.port);
+    addr.sin_addr.s_addr = INADDR_ANY;
+    if( bind(server, (struct sockaddr *)&addr, sizeof(addr)) < 0 ) {
+        printf("bind socket failed!\r\n");
+        closesocket(server);
+        return;
+    }
+    if( listen(server, 1) != 0 ) {
+        printf("listen failed!\r\n");
+        closesocket(server);
+        return;
+    } else {
+        printf("TCP Port: %d\r\n", g_Trace.port);
+    }
+
+    for(; ;)
+    {
+        if( (client = accept(server, NULL, NULL)) < 0 ) {
+            continue;
+        }
+        g_Trace.rx_len = 0;
+        g_Trace.stream = 0;
+
+        while( (trace_recv(client) >= 0) && (!g_Trace.stream || (trace_records(client) >= -1)) ) {
+            osDelay(TRACE_POLL_MS);                     // Polling the commands and the STREAM
+        }
+        closesocket(client);
+    }
+}
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+*** @}
+***********************************************************************************************************/
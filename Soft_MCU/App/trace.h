@@ -0,0 +1,124 @@
+/**********************************************************************************************************/
+/** @file     trace.h
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    Binary event trace of the interrupts and threads, dumped or streamed on a TCP port.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************/
+#ifndef __TRACE_H___20261018_235520
+#define __TRACE_H___20261018_235520
+#ifdef  __cplusplus
+extern  "C"
+{
+#endif
+/**********************************************************************************************************/
+/** @addtogroup TRACE
+*** @{
+*** @addtogroup                 TRACE_Exported_Constants
+*** @{
+***********************************************************************************************************/
+
+/*  Record: 8 bytes, little-endian, { uint32 cycles of bsp_cycles(), uint16 id, uint16 arg }.
+ *      id = (subsystem << 8) | event, an event with TRACE_END ends the span of the same event.
+ *
+ *  TCP commands, a line each, replied "OK\r\n" or "ERR\r\n":
+ *      MASK <mask>                     Subsystems enabled, bit (0x1 << TRACE_SUB_x)
+ *      START                           Start the trace with the mask
+ *      STOP                            Stop the trace
+ *      TRIG <id> <arg> <amask> <post>  Stop after <post> records since the record of <id> and
+ *                                      ((arg & amask) == <arg>), "TRIG -1 0 0 0" to disarm
+ *      DUMP                            Records in the buffer, oldest first
+ *      STREAM                          Records new since the command, until the next command
+ *
+ *  DUMP and STREAM are replied in binary: a header of 4 uint32 { TRACE_MAGIC, cycles per second,
+ *  mask, 0 }, the records, and a record of TRACE_ID_EOF. A record of TRACE_ID_LOST stands for the
+ *  records overwritten before sent, (arg) of them. The cycles wrap every 2^32 cycles, the gaps
+ *  between the records are less than that while the bus is polled.
+ *  Host/trace2json converts a DUMP into the Chrome trace JSON.
+ */
+#define TRACE_REC_NUM       1024                    /* Records in the buffer, must be (2 ^ n)   */
+#define TRACE_MAGIC         0x31435254u             /* "TRC1"                                   */
+
+#define TRACE_SUB_UART      0                       /* Interrupts of USART6 and TIM3, ProfiBUS_DP.c */
+#define TRACE_SUB_PBDP      1                       /* ProfiBUS_DP Send and Recv            */
+#define TRACE_SUB_NET       2                       /* Gateway frames to and from the net   */
+#define TRACE_SUB_USER      7                       /* Temporary trace points               */
+
+#define TRACE_UART_PE       1                       /* arg: USART SR                        */
+#define TRACE_UART_FE       2                       /* arg: USART SR                        */
+#define TRACE_UART_NE       3                       /* arg: USART SR                        */
+#define TRACE_UART_ORE      4                       /* arg: USART SR                        */
+#define TRACE_UART_IDLE     5                       /* arg: USART SR                        */
+#define TRACE_UART_TC       6                       /* arg: USART SR                        */
+#define TRACE_UART_TXE      7                       /* arg: USART SR                        */
+#define TRACE_UART_RXNE     8                       /* arg: char received                   */
+#define TRACE_UART_TIM      9                       /* TIM3 bus idle, arg: idle bits       */
+
+#define TRACE_PBDP_SEND     1                       /* Span, arg: length, result at the end */
+#define TRACE_PBDP_RETRY    2                       /* arg: destination address             */
+#define TRACE_PBDP_RECV     3                       /* arg: length of frame received        */
+
+#define TRACE_NET_RX        1                       /* arg: length of datagram received     */
+#define TRACE_NET_TX        2                       /* Span of sendto(), arg: length, result at the end */
+#define TRACE_NET_DROP      3                       /* arg: length of frame dropped         */
+
+#define TRACE_END           0x80u                   /* End of a span                        */
+#define TRACE_ID_LOST       0xFFFFu                 /* Records lost, arg: number of them    */
+#define TRACE_ID_EOF        0xFFFEu                 /* End of DUMP or STREAM                */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 TRACE_Exported_Types
+*** @{
+***********************************************************************************************************/
+
+typedef struct {    /*------------- Record of the trace -------------------------------------------*/
+    uint32_t                    cyc;        /* Cycles, ref: bsp_cycles()        */
+    uint16_t                    id;         /* (subsystem << 8) | event         */
+    uint16_t                    arg;        /* Argument of the event            */
+} TRACE_REC;
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 TRACE_Exported_Macros
+*** @{
+***********************************************************************************************************/
+
+extern volatile uint32_t    g_TraceMask;            /* Subsystems enabled, 0 while stopped      */
+
+#define TRACE(sub, evt, arg)    ( (g_TraceMask & (0x1u << (sub)))                                       \
+                                  ? trace_write(((sub) << 8) | (evt), (uint32_t)(arg)) : (void)0 )
+#define TRACE_BEGIN(sub, evt, arg)  TRACE(sub, evt, arg)
+#define TRACE_FINISH(sub, evt, arg) TRACE(sub, (evt) | TRACE_END, arg)
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 TRACE_Exported_Functions
+*** @{
+***********************************************************************************************************/
+
+extern void trace_init(void);
+extern void trace_write(uint32_t id, uint32_t arg);
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+*****/
+#ifdef  __cplusplus
+}
+#endif
+#endif
+/**********************************************************************************************************/
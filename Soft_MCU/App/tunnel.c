@@ -0,0 +1,461 @@
+/**********************************************************************************************************/
+/** @file     tunnel.c
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    ProfiBUS_DP <-> Net tunnel: TCP server and UDP datagram header.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************/
+
+#include    <stdint.h>
+#include    <stdio.h>
+#include    <string.h>
+#include    <assert.h>
+
+#include    "cmsis_os.h"                /* CMSIS RTOS definitions             */
+#include    "rl_net.h"                  /* Network definitions                */
+
+#include    "board.h"
+#include    "cfg.h"
+#include    "ProfiBUS_DP.h"
+#include    "tunnel.h"
+#include    "dp_delta.h"
+#include    "dp_diag.h"
+#include    "procimg.h"
+#include    "profiler.h"
+
+
+/**********************************************************************************************************/
+/** @addtogroup TUNNEL
+*** @{
+*** @addtogroup TUNNEL_Pravate
+*** @{
+*** @addtogroup                 TUNNEL_Private_Constants
+*** @{
+***********************************************************************************************************/
+
+#define TUNNEL_SIG_FLUSH    (0x1u << 0)                             /* Signal of TX buffer need flush   */
+#define TUNNEL_TX_BUF_LEN   (8 * 1024)                              /* must be (2 ^ n)                  */
+#define TUNNEL_RX_BUF_LEN   (2 * (TUNNEL_HDR_LEN + TUNNEL_FRAME_MAX))
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 TUNNEL_Private_Types
+*** @{
+***********************************************************************************************************/
+
+typedef struct {    /*------------- TCP Tunnel Information (Run-Time) -----------------------------
+                    -- (tx_head) written by thread_dp2net only, (tx_tail) by thread_tunnel only ---*/
+    osThreadId                  tid;        /* Thread of TCP tunnel             */
+    volatile int                client;     /* Client socket, (< 0)No client    */
+    uint16_t                    port;       /* TCP server port                  */
+    uint32_t                    flush_size; /* Flush batching size(Byte)        */
+    uint32_t                    flush_time; /* Flush batching time(ms)          */
+    int                         delta;      /* Delta encoding enable            */
+
+    volatile uint32_t           tx_head;    /* TX buffer head(free running)     */
+    volatile uint32_t           tx_tail;    /* TX buffer tail(free running)     */
+    int                         tx_wait;    /* TX buffer have data to be flush  */
+    uint32_t                    tx_time;    /* os_time of the data to be flush  */
+    int                         rx_len;     /* Length of data in RX buffer      */
+
+    uint32_t                    dp2net_frm; /* Counter of frames to the host    */
+    uint32_t                    dp2net_byte;/* Counter of bytes to the host     */
+    uint32_t                    net2dp_frm; /* Counter of frames to the DP      */
+    uint32_t                    net2dp_byte;/* Counter of bytes to the DP       */
+    uint32_t                    flush_cnt;  /* Counter of TX buffer flush       */
+    uint32_t                    err_ovr;    /* Counter of TX buffer overrun     */
+    uint32_t                    err_send;   /* Counter of DP Send failed        */
+} TUNNEL_INFO;
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 TUNNEL_Private_Variables
+*** @{
+***********************************************************************************************************/
+
+static TUNNEL_INFO          g_Tunnel = { NULL, -1 };
+static volatile uint8_t     g_TunnelTxBuf[TUNNEL_TX_BUF_LEN];
+static uint8_t              g_TunnelRxBuf[TUNNEL_RX_BUF_LEN];
+static uint8_t              g_TunnelEnc[DP_DELTA_HDR_LEN + TUNNEL_FRAME_MAX];
+static uint8_t              g_TunnelImg[TUNNEL_HDR_LEN + PROCIMG_REPLY_MAX];   /* Process image reply  */
+static DP_DELTA_CTX         g_TunnelDelta;                  /* Delta encoder of the TCP tunnel  */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 TUNNEL_Private_Prototypes
+*** @{
+***********************************************************************************************************/
+
+static void thread_tunnel(void const *arg);
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 TUNNEL_Private_Functions
+*** @{
+***********************************************************************************************************/
+/** @brief      Initialize TCP tunnel server, only if enabled in the config file.
+***********************************************************************************************************/
+
+void tunnel_init(void)
+{
+    static osThreadDef(thread_tunnel, osPriorityNormal, 1, 0);
+
+    if( !cfg_get_tcp_tunnel() ) {
+        return;
+    }
+    g_Tunnel.port       = cfg_get_tcp_port();
+    g_Tunnel.flush_size = cfg_get_flush_size();
+    g_Tunnel.flush_time = cfg_get_flush_time();
+    g_Tunnel.delta      = cfg_get_delta();
+    dp_delta_init(&g_TunnelDelta, cfg_get_delta_full());
+    if( g_Tunnel.flush_size > (TUNNEL_TX_BUF_LEN / 2) ) {
+        g_Tunnel.flush_size = TUNNEL_TX_BUF_LEN / 2;
+    }
+
+    if( (g_Tunnel.tid = osThreadCreate(osThread(thread_tunnel), NULL)) == NULL ) {
+        printf("[TUNNEL] Initialize Failed!\r\n");
+    }
+    profiler_name(g_Tunnel.tid, "tunnel");
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Put a received ProfiBUS_DP frame to the TCP tunnel, called by thread of ProfiBUS_DP to Net.
+***
+*** @param[in]  buff    Pointer to the DP frame
+*** @param[in]  len     Length  of the DP frame
+*** @param[in]  stamp   Timestamp of the DP frame, ref: bsp_timestamp()
+***********************************************************************************************************/
+
+void tunnel_dp2net(const uint8_t *buff, int len, uint32_t stamp)
+{
+    uint32_t    head;
+    int         i, empty;
+
+    if( (g_Tunnel.client < 0) || (len <= 0) || (len > TUNNEL_FRAME_MAX) ) {
+        return;                                         // No client or invalid frame
+    }
+    if( g_Tunnel.delta ) {
+        len  = dp_delta_encode(&g_TunnelDelta, buff, len, g_TunnelEnc);
+        buff = g_TunnelEnc;
+    }
+    head  = g_Tunnel.tx_head;
+    empty = (head == g_Tunnel.tx_tail);
+    if( (TUNNEL_TX_BUF_LEN - (head - g_Tunnel.tx_tail)) < (uint32_t)(TUNNEL_HDR_LEN + len) ) {
+        g_Tunnel.err_ovr++;                             // TX buffer overrun
+        dp_delta_request(&g_TunnelDelta);               // The reference of the host is lost
+        return;
+    }
+
+    g_TunnelTxBuf[(head++) % TUNNEL_TX_BUF_LEN] = (uint8_t)(len   >> 8);
+    g_TunnelTxBuf[(head++) % TUNNEL_TX_BUF_LEN] = (uint8_t)(len   >> 0);
+    g_TunnelTxBuf[(head++) % TUNNEL_TX_BUF_LEN] = (uint8_t)(stamp >> 24);
+    g_TunnelTxBuf[(head++) % TUNNEL_TX_BUF_LEN] = (uint8_t)(stamp >> 16);
+    g_TunnelTxBuf[(head++) % TUNNEL_TX_BUF_LEN] = (uint8_t)(stamp >> 8);
+    g_TunnelTxBuf[(head++) % TUNNEL_TX_BUF_LEN] = (uint8_t)(stamp >> 0);
+    for(i = 0;  i < len;  i++) {
+        g_TunnelTxBuf[(head++) % TUNNEL_TX_BUF_LEN] = buff[i];
+    }
+    g_Tunnel.tx_head = head;                            // Record is visible to thread_tunnel now
+    g_Tunnel.dp2net_frm  += 1;
+    g_Tunnel.dp2net_byte += len;
+
+    if( empty || ((head - g_Tunnel.tx_tail) >= g_Tunnel.flush_size) ) {
+        osSignalSet(g_Tunnel.tid, TUNNEL_SIG_FLUSH);    // Batching time started, or batching size reached
+    }
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Pack the UDP datagram header.
+***
+*** @param[out] hdr     Buffer of header, TUNNEL_UDP_HDR_LEN bytes
+*** @param[in]  len     Length of the DP frame after the header
+*** @param[in]  seq     Sequence number of the DP frame
+*** @param[in]  stamp   Timestamp of the DP frame, ref: bsp_timestamp()
+*** @param[in]  drop    Drop counters, TUNNEL_DROP_NUM items
+***********************************************************************************************************/
+
+void tunnel_udp_pack(uint8_t *hdr, int len, uint32_t seq, uint32_t stamp, const uint32_t drop[])
+{
+    int     i;
+
+    hdr[0]  = TUNNEL_UDP_MAGIC;
+    hdr[1]  = TUNNEL_UDP_VER;
+    hdr[2]  = (uint8_t)(len   >> 8);
+    hdr[3]  = (uint8_t)(len   >> 0);
+    hdr[4]  = (uint8_t)(seq   >> 24);
+    hdr[5]  = (uint8_t)(seq   >> 16);
+    hdr[6]  = (uint8_t)(seq   >> 8);
+    hdr[7]  = (uint8_t)(seq   >> 0);
+    hdr[8]  = (uint8_t)(stamp >> 24);
+    hdr[9]  = (uint8_t)(stamp >> 16);
+    hdr[10] = (uint8_t)(stamp >> 8);
+    hdr[11] = (uint8_t)(stamp >> 0);
+    for(i = 0;  i < TUNNEL_DROP_NUM;  i++) {
+        hdr[12 + 2 * i] = (uint8_t)(drop[i] >> 8);
+        hdr[13 + 2 * i] = (uint8_t)(drop[i] >> 0);
+    }
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Unpack the UDP datagram header.
+***
+*** @param[in]  buff    Pointer to the datagram
+*** @param[in]  len     Length  of the datagram
+*** @param[out] seq     Sequence number of the datagram, only valid when return (> 0)
+***
+*** @return     (< 0)Invalid header, (0)No header, (other)Length of header.
+***********************************************************************************************************/
+
+int tunnel_udp_unpack(const uint8_t *buff, int len, uint32_t *seq)
+{
+    if( (len <= 0) || (buff[0] != TUNNEL_UDP_MAGIC) ) {
+        return( 0 );                                    // Raw DP frame without header
+    }
+    if( (len <= TUNNEL_UDP_HDR_LEN) || (buff[1] != TUNNEL_UDP_VER) ) {
+        return( -1 );                                   // Invalid header
+    }
+    if( (len - TUNNEL_UDP_HDR_LEN) != ((buff[2] << 8) | buff[3]) ) {
+        return( -1 );                                   // Length mismatch
+    }
+    *seq = ((uint32_t)buff[4] << 24) | ((uint32_t)buff[5] << 16) | ((uint32_t)buff[6] << 8) | buff[7];
+    return( TUNNEL_UDP_HDR_LEN );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Flush the TX buffer to client, when flush batching size or time reached.
+***
+*** @param[in]  client  Client socket
+*** @param[in]  force   Flush without batching
+***
+*** @return     (< 0)Socket error, (other)Succeed.
+***********************************************************************************************************/
+
+static int tunnel_flush(int client, int force)
+{
+    extern volatile uint32_t    os_time;            // only for Keil RTX
+    uint32_t                    size, tail, n;
+    int                         rc;
+
+    if( (size = g_Tunnel.tx_head - g_Tunnel.tx_tail) == 0 ) {
+        g_Tunnel.tx_wait = 0;
+        return( 0 );                                    // Nothing to flush
+    }
+    if( !g_Tunnel.tx_wait ) {
+        g_Tunnel.tx_wait = 1;
+        g_Tunnel.tx_time = os_time;
+    }
+    if( !force && (size < g_Tunnel.flush_size) && ((os_time - g_Tunnel.tx_time) < g_Tunnel.flush_time) ) {
+        return( 0 );                                    // Waiting for more data
+    }
+
+    while( size > 0 ) {
+        tail = g_Tunnel.tx_tail % TUNNEL_TX_BUF_LEN;
+        n    = (size < (TUNNEL_TX_BUF_LEN - tail)) ? (size) : (TUNNEL_TX_BUF_LEN - tail);
+        if( (rc = send(client, (const char*)&g_TunnelTxBuf[tail], n, 0)) <= 0 ) {
+            return( -1 );                               // Network_IP Send Failed
+        }
+        g_Tunnel.tx_tail += rc;
+        size             -= rc;
+    }
+    g_Tunnel.tx_wait = 0;
+    g_Tunnel.flush_cnt++;
+    return( 0 );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Reply a process image request, after the records buffered, in a record of its own.
+***
+*** @param[in]  client  Client socket
+*** @param[in]  req     Process image request
+*** @param[in]  len     Length of the request
+***
+*** @return     (< 0)Socket error, (other)Succeed.
+***********************************************************************************************************/
+
+static int tunnel_image(int client, const uint8_t *req, int len)
+{
+    uint32_t    stamp = bsp_timestamp();
+    int         n, rc, o;
+
+    if( (len = procimg_read(req, len, &g_TunnelImg[TUNNEL_HDR_LEN], PROCIMG_REPLY_MAX)) <= 0 ) {
+        return( 0 );                                    // Invalid request, no reply
+    }
+    if( tunnel_flush(client, 1) < 0 ) {                 // Records before the reply, up to a record
+        return( -1 );                                   //   boundary, the reply is not interleaved
+    }
+    g_TunnelImg[0] = (uint8_t)(len   >> 8);
+    g_TunnelImg[1] = (uint8_t)(len   >> 0);
+    g_TunnelImg[2] = (uint8_t)(stamp >> 24);
+    g_TunnelImg[3] = (uint8_t)(stamp >> 16);
+    g_TunnelImg[4] = (uint8_t)(stamp >> 8);
+    g_TunnelImg[5] = (uint8_t)(stamp >> 0);
+    for(n = TUNNEL_HDR_LEN + len, o = 0;  o < n;  o += rc) {
+        if( (rc = send(client, (const char*)&g_TunnelImg[o], n - o, 0)) <= 0 ) {
+            return( -1 );
+        }
+    }
+    return( 0 );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Receive records from client, and send the frames to ProfiBUS_DP.
+***
+*** @param[in]  client  Client socket
+***
+*** @return     (< 0)Socket error or stream out of sync, (0)No data received, (other)Bytes received.
+***********************************************************************************************************/
+
+static int tunnel_recv(int client)
+{
+    int     rc, len;
+
+    rc = recv(client, (char*)&g_TunnelRxBuf[g_Tunnel.rx_len], sizeof(g_TunnelRxBuf) - g_Tunnel.rx_len, MSG_DONTWAIT);
+    if( rc == BSD_ERROR_WOULDBLOCK ) {
+        return( 0 );                                    // No data received
+    }
+    if( rc <= 0 ) {
+        return( -1 );                                   // Connection closed or error
+    }
+
+    for(g_Tunnel.rx_len += rc;  g_Tunnel.rx_len >= TUNNEL_HDR_LEN;  g_Tunnel.rx_len -= TUNNEL_HDR_LEN + len)
+    {
+        len = (g_TunnelRxBuf[0] << 8) | g_TunnelRxBuf[1];
+        if( (len <= 0) || (len > TUNNEL_FRAME_MAX) ) {
+            return( -2 );                               // Stream out of sync
+        }
+        if( g_Tunnel.rx_len < (TUNNEL_HDR_LEN + len) ) {
+            break;                                      // Waiting for the rest of record
+        }
+        if( (len == 1) && (g_TunnelRxBuf[TUNNEL_HDR_LEN] == DP_DELTA_REQ) ) {
+            dp_delta_request(&g_TunnelDelta);           // Request of FULL records from the host
+            dp_diag_request();
+        } else if( g_TunnelRxBuf[TUNNEL_HDR_LEN] == PROCIMG_REQ ) {
+            if( tunnel_image(client, &g_TunnelRxBuf[TUNNEL_HDR_LEN], len) < 0 ) {
+                return( -1 );                           // Network_IP Send Failed
+            }
+        } else if( len == PBDP_Send(&g_TunnelRxBuf[TUNNEL_HDR_LEN], len) ) {
+            g_Tunnel.net2dp_frm  += 1;
+            g_Tunnel.net2dp_byte += len;
+        } else {
+            g_Tunnel.err_send++;                        // ProfiBUS_DP Send Failed
+        }
+        memmove(g_TunnelRxBuf, &g_TunnelRxBuf[TUNNEL_HDR_LEN + len], g_Tunnel.rx_len - (TUNNEL_HDR_LEN + len));
+    }
+    return( rc );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Time to wait for the signal of thread_dp2net, up to the flush batching time of the data
+***             buffered, or a flush batching time to poll the client with nothing buffered.
+***
+*** @return     Time(ms), 1 at least.
+***********************************************************************************************************/
+
+static uint32_t tunnel_wait(void)
+{
+    extern volatile uint32_t    os_time;            // only for Keil RTX
+    uint32_t                    past;
+
+    if( !g_Tunnel.tx_wait ) {
+        return( (g_Tunnel.flush_time > 0) ? (g_Tunnel.flush_time) : (1) );
+    }
+    past = os_time - g_Tunnel.tx_time;
+    return( (past < g_Tunnel.flush_time) ? (g_Tunnel.flush_time - past) : (1) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Thread of TCP tunnel server
+***********************************************************************************************************/
+
+static void thread_tunnel(void const *arg)
+{
+    struct sockaddr_in  addr;
+    int                 server, client, rc;
+
+    (void)arg;
+    osDelay(5000);
+
+    printf("[TUNNEL] Server start, ");
+    if( (server = socket(AF_INET, SOCK_STREAM, 0)) < 0 ) {
+        printf("malloc socket failed!\r\n");
+        return;
+    }
+    addr.sin_family      = PF_INET;
+    addr.sin_port        = htons(g_Tunnel.port);
+    addr.sin_addr.s_addr = INADDR_ANY;
+    if( bind(server, (struct sockaddr *)&addr, sizeof(addr)) < 0 ) {
+        printf("bind socket failed!\r\n");
+        closesocket(server);
+        return;
+    }
+    if( listen(server, 1) != 0 ) {
+        printf("listen failed!\r\n");
+        closesocket(server);
+        return;
+    } else {
+        printf("TCP Port: %d\r\n", g_Tunnel.port);
+    }
+
+    for(; ;)
+    {
+        if( (client = accept(server, NULL, NULL)) < 0 ) {
+            continue;
+        }
+#ifdef  TCP_NODELAY                                     /* MDK TCP has no Nagle, batching by flush  */
+        {
+            int     on = 1;
+            setsockopt(client, IPPROTO_TCP, TCP_NODELAY, (const char*)&on, sizeof(on));
+        }
+#endif
+        g_Tunnel.rx_len  = 0;
+        g_Tunnel.tx_wait = 0;
+        g_Tunnel.tx_tail = g_Tunnel.tx_head;            // Discard records of the last client
+        dp_delta_request(&g_TunnelDelta);               // No reference in the new client
+        g_Tunnel.client  = client;                      // Enable record from thread_dp2net
+        printf("[TUNNEL] Client accepted.\r\n");
+
+        while( ((rc = tunnel_recv(client)) >= 0) && (tunnel_flush(client, 0) >= 0) ) {
+            osSignalWait(TUNNEL_SIG_FLUSH, (rc > 0) ? (1) : (tunnel_wait()));   // 1ms while the client sends
+        }
+
+        g_Tunnel.client = -1;
+        closesocket(client);
+        printf( "[TUNNEL] Client closed. DP2NET: %u(Frame) %u(Byte), NET2DP: %u(Frame) %u(Byte), "
+                "Flush: %u, Overrun: %u, DP Send ERR: %u\r\n"
+              , g_Tunnel.dp2net_frm, g_Tunnel.dp2net_byte, g_Tunnel.net2dp_frm, g_Tunnel.net2dp_byte
+              , g_Tunnel.flush_cnt,  g_Tunnel.err_ovr,     g_Tunnel.err_send
+              );
+        if( g_Tunnel.delta ) {
+            dp_delta_statc(&g_TunnelDelta, (char*)g_TunnelRxBuf, sizeof(g_TunnelRxBuf));
+            printf("[TUNNEL] %s\r\n", (char*)g_TunnelRxBuf);
+        }
+    }
+}
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+*** @}
+***********************************************************************************************************/
@@ -0,0 +1,112 @@
+/**********************************************************************************************************/
+/** @file     tunnel.h
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    ProfiBUS_DP <-> Net tunnel: TCP server and UDP datagram header.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************/
+#ifndef __TUNNEL_H___20261018_101530
+#define __TUNNEL_H___20261018_101530
+#ifdef  __cplusplus
+extern  "C"
+{
+#endif
+/**********************************************************************************************************/
+/** @addtogroup TUNNEL
+*** @{
+*** @addtogroup                 TUNNEL_Exported_Constants
+*** @{
+***********************************************************************************************************/
+
+/*  TCP tunnel record, the same format in both directions (network byte order):
+ *
+ *      +---------+---------------+---------------------------+
+ *      | LEN(2)  | TIMESTAMP(4)  | ProfiBUS_DP frame(LEN)    |
+ *      +---------+---------------+---------------------------+
+ *
+ *  LEN       --- length of the DP frame, not counting the record header.
+ *                With delta encoding enabled, the DP frame is replaced by a record of dp_delta.h.
+ *                The reply of a process image request(procimg.h) may be up to PROCIMG_REPLY_MAX.
+ *  TIMESTAMP --- gateway time of the received frame in microseconds (bsp_timestamp()),
+ *                ignored on the records from the host.
+ */
+#define TUNNEL_HDR_LEN      (2 + 4)                 /* Length of the TCP tunnel record header   */
+#define TUNNEL_FRAME_MAX    (256 + 16)              /* Max length of DP frame in a record       */
+
+/*  UDP datagram header, optional in both directions (network byte order):
+ *
+ *      +-------+-----+--------+--------+--------------+------+------+------+------+-----------+
+ *      | MAGIC | VER | LEN(2) | SEQ(4) | TIMESTAMP(4) | LINK | SOCK | QUE  | NET  | DP frame  |
+ *      +-------+-----+--------+--------+--------------+------+------+------+------+-----------+
+ *
+ *  SEQ       --- gateway-wide sequence number of the frames received from ProfiBUS_DP. A frame
+ *                dropped by the gateway still consumes its number, so the host can tell a drop
+ *                on the gateway (drop counters changed) from a loss on the network.
+ *                Only the frames forwarded by the filter rules consume the number, the frames
+ *                routed by a rule have the sequence number of the rule (ref: dp_filter.h).
+ *  LINK(2)   --- counter of frames dropped because of Ethernet LinkDown, not stored or lost in
+ *                the backlog. Frames replayed from the backlog keep their own SEQ, TIMESTAMP and route.
+ *  SOCK(2)   --- counter of frames dropped because of socket error.
+ *  QUE(2)    --- counter of frames dropped because of full queue (ProfiBUS_DP RX queue overrun or
+ *                no memory in TCP/IP stack).
+ *  NET(2)    --- counter of datagrams from the host lost (gap of SEQ) or dropped.
+ *
+ *  A datagram from the host may carry the same header, only MAGIC, VER, LEN and SEQ are used.
+ *  No ProfiBUS_DP frame starts with TUNNEL_UDP_MAGIC, so the header is detected by it.
+ */
+#define TUNNEL_UDP_MAGIC    (0xD7)                  /* Magic of the UDP datagram header         */
+#define TUNNEL_UDP_VER      (0x01)                  /* Version of the UDP datagram header       */
+#define TUNNEL_UDP_HDR_LEN  (1 + 1 + 2 + 4 + 4 + 2 * 4)
+#define TUNNEL_UDP_MAX      1472                    /* Max length of a datagram, one ETH frame  */
+
+/*  Batch datagram from the host to PORT_NET2DP, after the optional UDP datagram header:
+ *
+ *      Request:  | BATCH(0xF5) | N | { LEN | DP frame(LEN) } ... |
+ *      Reply:    | BATCH(0xF5) | N | SENT | RESULT(N)            |
+ *
+ *  The N DP frames are sent back-to-back in order, each after the minimum idle time of the bus, and
+ *  one reply is sent to the host for the batch.
+ *  SENT      --- number of the DP frames sent.
+ *  RESULT    --- (0)Sent, or the error of PBDP_Send() as a signed byte, for each DP frame.
+ *  A batch not well formed is not sent and replied with N = 0.
+ */
+#define TUNNEL_BATCH        (0xF5)                  /* Record type: batch of DP frames          */
+#define TUNNEL_BATCH_MAX    64                      /* Max number of DP frames in a batch       */
+
+#define TUNNEL_DROP_LINK    0                       /* Index of drop counter: ETH LinkDown      */
+#define TUNNEL_DROP_SOCK    1                       /* Index of drop counter: socket error      */
+#define TUNNEL_DROP_QUE     2                       /* Index of drop counter: queue full        */
+#define TUNNEL_DROP_NET     3                       /* Index of drop counter: host datagrams    */
+#define TUNNEL_DROP_NUM     4
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 TUNNEL_Exported_Functions
+*** @{
+***********************************************************************************************************/
+
+extern void tunnel_init(void);
+extern void tunnel_dp2net(const uint8_t *buff, int len, uint32_t stamp);
+extern void tunnel_udp_pack(uint8_t *hdr, int len, uint32_t seq, uint32_t stamp, const uint32_t drop[]);
+extern int  tunnel_udp_unpack(const uint8_t *buff, int len, uint32_t *seq);
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+*****/
+#ifdef  __cplusplus
+}
+#endif
+#endif
+/**********************************************************************************************************/
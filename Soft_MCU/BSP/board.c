@@ -64,6 +64,19 @@ void board_init(void)
     HAL_Init();         // Init STM32 HAL drivers
     stdio_init();       // Init StdIO of Compiler retarget_io
 
+    /*------------------------------------------ Init Timer 2 (Timestamp 1us) ------------------------------*/
+    MODIFY_REG(RCC->APB1ENR,   0                                /* Enable Timer 2 clock                     */
+                           ,   RCC_APB1ENR_TIM2EN);
+    WRITE_REG( TIM2->PSC,      (HAL_RCC_GetPCLK1Freq() * 2 / 1000000) - 1);
+    WRITE_REG( TIM2->ARR,      0xFFFFFFFF);                     /* 32Bit free running counter               */
+    WRITE_REG( TIM2->EGR,      TIM_EGR_UG);                     /* Load the Prescaler value                 */
+    WRITE_REG( TIM2->CR1,      TIM_CR1_CEN);                    /* Counter enable                           */
+
+    /*------------------------------------------ Init DWT cycle counter ------------------------------------*/
+    SET_BIT(   CoreDebug->DEMCR, CoreDebug_DEMCR_TRCENA_Msk);   /* Enable the trace and debug blocks        */
+    WRITE_REG( DWT->CYCCNT,    0);
+    SET_BIT(   DWT->CTRL,      DWT_CTRL_CYCCNTENA_Msk);         /* 32Bit free running cycle counter         */
+
     printf("\r\n[Board] Syetme start...\r\n");
     printf("[Board] System Clock Configed. System Core Clock: %luHz\r\n", (unsigned long)HAL_RCC_GetHCLKFreq());
 }
@@ -91,6 +104,65 @@ int bsp_clear_key(void)
 }
 
 
+/**********************************************************************************************************/
+/** @brief      Free running timestamp
+***
+*** @return     Timestamp in microseconds, wraps around after 2^32us.
+***********************************************************************************************************/
+
+uint32_t bsp_timestamp(void)
+{
+    return( TIM2->CNT );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Free running cycle counter of the CPU, DWT->CYCCNT
+***
+*** @return     Cycles of the core clock, wraps around after 2^32 cycles (25.5s at 168MHz).
+***********************************************************************************************************/
+
+uint32_t bsp_cycles(void)
+{
+    return( DWT->CYCCNT );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Accumulate the idle time, called in the loop of os_idle_demon() only.
+***
+*** Two timestamps of the loop more than BSP_IDLE_GAP apart mean a thread or an interrupt has run in
+*** between, the time is not counted as idle.
+***********************************************************************************************************/
+
+#define BSP_IDLE_GAP    2                               /* Max gap of the idle loop(us)             */
+
+static volatile uint32_t    bsp_idle_us;                /* Idle time(us), wraps around              */
+
+void bsp_idle(void)
+{
+    static uint32_t last;
+    uint32_t        now = TIM2->CNT;
+
+    if( (now - last) <= BSP_IDLE_GAP ) {
+        bsp_idle_us += now - last;
+    }
+    last = now;
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Idle time of the CPU
+***
+*** @return     Idle time in microseconds, wraps around after 2^32us, ref: bsp_timestamp().
+***********************************************************************************************************/
+
+uint32_t bsp_idletime(void)
+{
+    return( bsp_idle_us );
+}
+
+
 /**********************************************************************************************************/
 /** @brief      System Clock Configuration.
 ***********************************************************************************************************/
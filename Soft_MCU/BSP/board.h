@@ -29,6 +29,10 @@ extern  "C"
 
 extern void board_init(void);
 extern int bsp_clear_key(void);
+extern uint32_t bsp_timestamp(void);
+extern uint32_t bsp_cycles(void);
+extern void bsp_idle(void);
+extern uint32_t bsp_idletime(void);
 
 
 /*****************************  END OF FILE  **************************************************************/
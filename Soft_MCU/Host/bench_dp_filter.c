@@ -0,0 +1,206 @@
+/**********************************************************************************************************/
+/** @file     bench_dp_filter.c
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    Host benchmark: dp_filter_match() with 64 rules, the first rule matched checked.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************
+*** Usage: bench_dp_filter [rounds]
+***
+***   RULE1 ~ RULE64 of "[Filter]" are compiled, each for a station and a field more, and the frames of
+***   all the start delimiters are matched: the first rule matched is checked against a linear scan of
+***   the rules, then the time per frame is measured. The time on the host shows the cost does not
+***   depend on the rule matched, it is not the time on the gateway.
+***********************************************************************************************************/
+
+#include    <stdlib.h>
+#include    <stdint.h>
+#include    <stdio.h>
+#include    <string.h>
+#include    <time.h>
+
+#include    "rl_net.h"
+#include    "dp_filter.h"
+#include    "test.h"
+
+
+/**********************************************************************************************************/
+/** @addtogroup BENCH_DP_FILTER
+*** @{
+*** @addtogroup                 BENCH_DP_FILTER_Private_Constants
+*** @{
+***********************************************************************************************************/
+
+#define BENCH_FRAME_NUM     256                     /* Frames matched in a round                */
+#define BENCH_ROUNDS        40000                   /* Default rounds                           */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 BENCH_DP_FILTER_Private_Variables
+*** @{
+***********************************************************************************************************/
+
+static char                 g_Rule[DP_FILTER_RULE_MAX][64];
+static uint8_t              g_Frame[BENCH_FRAME_NUM][16];
+static int                  g_Len[BENCH_FRAME_NUM];
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 BENCH_DP_FILTER_Private_Functions
+*** @{
+***********************************************************************************************************/
+/** @brief      Config file of the rules, ref: cfg.h.
+***********************************************************************************************************/
+
+const char* cfg_get_filter_default(void)
+{
+    return( "COUNT" );
+}
+
+const char* cfg_get_filter_rule(int n)
+{
+    return( ((n >= 1) && (n <= DP_FILTER_RULE_MAX)) ? (g_Rule[n - 1]) : (NULL) );
+}
+
+int ip4_aton(const char *cp, uint8_t *ip4_addr)
+{
+    return( inet_pton(AF_INET, cp, ip4_addr) == 1 );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Rules of the benchmark, the rule n for the station (n % 32 + 2):
+***             SD2 requests with DSAP, SD1 of the high-order FC, SD3 in a range of SA, or SD4 tokens.
+***********************************************************************************************************/
+
+static void bench_rules(void)
+{
+    int     n, da;
+
+    for(n = 0;  n < DP_FILTER_RULE_MAX;  n++) {
+        da = n % 32 + 2;
+        switch( n / 16 ) {
+        case 0:  sprintf(g_Rule[n], "SD=SD2 DA=%d DSAP=61,62 ACT=FWD", da);                  break;
+        case 1:  sprintf(g_Rule[n], "SD=SD1 DA=%d FC=0x40-0x7F ACT=ROUTE:10.0.0.%d", da, n); break;
+        case 2:  sprintf(g_Rule[n], "SD=0xA2 DA=%d SA=1-3 LEN=14 ACT=COUNT", da);            break;
+        default: sprintf(g_Rule[n], "SD=SD4,SC DA=%d ACT=DROP", da);                         break;
+        }
+    }
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Frames of the benchmark, all the start delimiters and stations.
+***********************************************************************************************************/
+
+static void bench_frames(void)
+{
+    int         i, da;
+    uint8_t    *f;
+
+    srand(1);
+    for(i = 0;  i < BENCH_FRAME_NUM;  i++) {
+        f  = g_Frame[i];
+        da = rand() % 40;
+        switch( i % 5 ) {
+        case 0:  f[0] = 0x68;  f[1] = f[2] = 5;  f[3] = 0x68;  f[4] = (uint8_t)(da | 0x80);  f[5] = 0x82;
+                 f[6] = 0x5D;  f[7] = (uint8_t)(60 + rand() % 4);  f[8] = 0x3E;  g_Len[i] = 11;   break;
+        case 1:  f[0] = 0x10;  f[1] = (uint8_t)da;  f[2] = 2;  f[3] = (uint8_t)(rand() & 0x7F);  g_Len[i] = 6;   break;
+        case 2:  f[0] = 0xA2;  f[1] = (uint8_t)da;  f[2] = (uint8_t)(rand() % 5);  f[3] = 8;     g_Len[i] = 14;  break;
+        case 3:  f[0] = 0xDC;  f[1] = (uint8_t)da;  f[2] = 2;                                  g_Len[i] = 3;   break;
+        default: f[0] = 0xE5;                                                                  g_Len[i] = 1;   break;
+        }
+    }
+}
+
+
+/**********************************************************************************************************/
+/** @brief      The first rule matched by a linear scan of the rules, the reference of the lookup.
+***
+*** @return     Index of the rule, DP_FILTER_RULE_MAX for DEFAULT.
+***********************************************************************************************************/
+
+static int bench_linear(const uint8_t *f, int len)
+{
+    int     n, da = -1, sa = -1, fc = -1, dsap = -1;
+
+    switch( f[0] ) {
+    case 0x68:  da = f[4] & 0x7F;  sa = f[5] & 0x7F;  fc = f[6];  dsap = (f[4] & 0x80) ? (f[7] & 0x3F) : (-1);  break;
+    case 0x10:
+    case 0xA2:  da = f[1] & 0x7F;  sa = f[2] & 0x7F;  fc = f[3];                                              break;
+    case 0xDC:  da = f[1] & 0x7F;  sa = f[2] & 0x7F;                                                          break;
+    default:                                                                                                  break;
+    }
+    for(n = 0;  n < DP_FILTER_RULE_MAX;  n++) {
+        if( da != (n % 32 + 2) ) {
+            continue;
+        }
+        switch( n / 16 ) {
+        case 0:  if( (f[0] == 0x68) && ((dsap == 61) || (dsap == 62)) )                 { return( n ); }  break;
+        case 1:  if( (f[0] == 0x10) && (fc >= 0x40) && (fc <= 0x7F) )                   { return( n ); }  break;
+        case 2:  if( (f[0] == 0xA2) && (sa >= 1) && (sa <= 3) && (len == 14) )          { return( n ); }  break;
+        default: if( f[0] == 0xDC )                                                     { return( n ); }  break;
+        }
+    }
+    return( DP_FILTER_RULE_MAX );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Entry of the benchmark.
+***********************************************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    struct timespec     t0, t1;
+    const DP_FILTER_ACT *act;
+    long                rounds = (argc > 1) ? atol(argv[1]) : BENCH_ROUNDS;
+    long                r;
+    uint32_t            sum = 0;
+    int                 i, bad = 0, hit = 0;
+    double              ns;
+
+    bench_rules();
+    bench_frames();
+    dp_filter_init();
+
+    for(i = 0;  i < BENCH_FRAME_NUM;  i++) {
+        act  = dp_filter_match(g_Frame[i], g_Len[i]);
+        bad += (act->idx != bench_linear(g_Frame[i], g_Len[i]));
+        hit += (act->idx != DP_FILTER_RULE_MAX);
+    }
+    TEST_CHECK(bad == 0);
+    TEST_CHECK(hit > (BENCH_FRAME_NUM / 8));
+    TEST_CHECK(dp_filter_get(DP_FILTER_RULE_MAX)->act == DP_FILTER_COUNT);
+    TEST_CHECK(dp_filter_get(16)->act == DP_FILTER_ROUTE);
+    TEST_CHECK(dp_filter_get(-1)->idx == DP_FILTER_RULE_MAX);
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for(r = 0;  r < rounds;  r++) {
+        for(i = 0;  i < BENCH_FRAME_NUM;  i++) {
+            sum += dp_filter_match(g_Frame[i], g_Len[i])->idx;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    ns = ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / ((double)rounds * BENCH_FRAME_NUM);
+    printf( "  %d rules, %d of %d frames matched a rule, %.1f ns/frame on the host (%u)\n",
+            DP_FILTER_RULE_MAX, hit, BENCH_FRAME_NUM, ns, sum & 1 );
+    return( TEST_RESULT() );
+}
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+***********************************************************************************************************/
@@ -0,0 +1,300 @@
+/**********************************************************************************************************/
+/** @file     bench_latency.c
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    Host benchmark: latency of the bridge by stages over the simulated RS485 line.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************
+*** Usage: bench_latency [-b baud] [-s tsdr] [-o cycle] [-n count]
+***
+***   -b baud     Baud rate of the line, 187500 by default
+***   -s tsdr     Tsdr(bits) of the slaves scripted, 11 by default
+***   -o cycle    Cycle(us) of the other master on the line, 2000 by default, 0 for none
+***   -n count    Requests of the host, 2000 by default
+***
+***   ProfiBUS_DP.c and latency.c of the gateway run over sim_rs485.c. The host sends the requests to
+***   thread_net2dp over the loopback UDP one at a time, SD1 replied by SC and SD2 replied by SD2, and
+***   thread_dp2net forwards the frames received back to the host, as in main.c. The other master puts
+***   its own requests and SC on the line while the requests of the gateway wait for the bus, the SC of
+***   them never taken for the responses of the gateway.
+***********************************************************************************************************/
+
+#include    <stdlib.h>
+#include    <stdint.h>
+#include    <stdio.h>
+#include    <string.h>
+#include    <unistd.h>
+#include    <pthread.h>
+#include    <sys/socket.h>
+#include    <sys/time.h>
+#include    <netinet/in.h>
+#include    <arpa/inet.h>
+
+#include    "board.h"
+#include    "ProfiBUS_DP.h"
+#include    "latency.h"
+#include    "sim_rs485.h"
+#include    "test.h"
+
+
+/**********************************************************************************************************/
+/** @addtogroup BENCH_LATENCY
+*** @{
+*** @addtogroup                 BENCH_LATENCY_Private_Constants
+*** @{
+***********************************************************************************************************/
+
+#define BENCH_BAUD          187500                  /* Default baud rate                        */
+#define BENCH_TSDR          11                      /* Default Tsdr(bits) of the slaves         */
+#define BENCH_CYCLE         2000                    /* Default cycle(us) of the other master    */
+#define BENCH_COUNT         2000                    /* Default requests                         */
+
+#define BENCH_GW            2                       /* Address of the gateway                   */
+#define BENCH_SLAVE_FIRST   3                       /* Addresses of the slaves scripted         */
+#define BENCH_SLAVE_LAST    6
+#define BENCH_OTHER         1                       /* Address of the other master              */
+#define BENCH_TIMEOUT       100                     /* Timeout(ms) of a response at the host    */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 BENCH_LATENCY_Private_Variables
+*** @{
+***********************************************************************************************************/
+
+volatile uint32_t           g_TraceMask;            /* Trace stopped, ref: trace.h              */
+
+static int                  g_Net2dp;               /* Socket of thread_net2dp                  */
+static int                  g_Dp2net;               /* Socket of thread_dp2net                  */
+static int                  g_Host;                 /* Socket of the host                       */
+static struct sockaddr_in   g_Net2dpAddr;
+static struct sockaddr_in   g_HostAddr;
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 BENCH_LATENCY_Private_Functions
+*** @{
+***********************************************************************************************************/
+/** @brief      Trace of the gateway, stopped, ref: trace.h.
+***********************************************************************************************************/
+
+void trace_write(uint32_t id, uint32_t arg)
+{
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Socket on a free port of the loopback, the address of the port returned.
+***********************************************************************************************************/
+
+static int bench_socket(struct sockaddr_in *addr)
+{
+    socklen_t   alen = sizeof(*addr);
+    int         sock;
+
+    memset(addr, 0, sizeof(*addr));
+    addr->sin_family      = AF_INET;
+    addr->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if( ((sock = socket(AF_INET, SOCK_DGRAM, 0)) < 0) || (bind(sock, (struct sockaddr *)addr, alen) < 0) ) {
+        perror("socket");
+        exit(1);
+    }
+    getsockname(sock, (struct sockaddr *)addr, &alen);
+    return( sock );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      thread_net2dp of main.c: the request timed and sent to the bus.
+***********************************************************************************************************/
+
+static void* bench_net2dp(void *arg)
+{
+    uint8_t     buff[260];
+    uint32_t    stamp;
+    int         recv;
+
+    for(; ;) {
+        if( (recv = recvfrom(g_Net2dp, buff, sizeof(buff), 0, NULL, NULL)) <= 0 ) {
+            continue;
+        }
+        stamp = bsp_timestamp();
+        latency_request(buff, recv, stamp);
+        if( recv != PBDP_Send(buff, recv) ) {
+            latency_cancel();
+            continue;
+        }
+        latency_sent();
+    }
+    return( arg );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      thread_dp2net of main.c: the frames of the bus forwarded to the host.
+***********************************************************************************************************/
+
+static void* bench_dp2net(void *arg)
+{
+    uint8_t     frame[260];
+    uint32_t    stamp;
+    int         recv;
+
+    for(; ;) {
+        if( (recv = PBDP_RecvWait(frame, 100)) > 0 ) {
+            stamp = bsp_timestamp();
+            latency_response(frame, recv, stamp);
+            sendto(g_Dp2net, frame, recv, 0, (struct sockaddr *)&g_HostAddr, sizeof(g_HostAddr));
+        }
+        latency_done();
+    }
+    return( arg );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Request n of the host: SD1 SRD low, or SD2 SRD high of 8 bytes, to a slave scripted.
+***
+*** @return     Length of the request.
+***********************************************************************************************************/
+
+static int bench_request(uint8_t *f, int n)
+{
+    uint8_t     da = (uint8_t)(BENCH_SLAVE_FIRST + n % (BENCH_SLAVE_LAST - BENCH_SLAVE_FIRST + 1));
+    uint8_t     fcs;
+    int         i;
+
+    if( n & 1 ) {
+        f[0] = 0x10;  f[1] = da;  f[2] = BENCH_GW;  f[3] = 0x4C;
+        f[4] = (uint8_t)(f[1] + f[2] + f[3]);  f[5] = 0x16;
+        return( 6 );
+    }
+    f[0] = 0x68;  f[1] = f[2] = 3 + 8;  f[3] = 0x68;  f[4] = da;  f[5] = BENCH_GW;  f[6] = 0x5D;
+    for(i = 0;  i < 8;  i++) {
+        f[7 + i] = (uint8_t)(n + i);
+    }
+    for(fcs = 0, i = 4;  i < (4 + f[1]);  i++) {
+        fcs += f[i];
+    }
+    f[4 + f[1]] = fcs;  f[5 + f[1]] = 0x16;
+    return( f[1] + 6 );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      The response of a request at the host, the frames of the other master skipped.
+***
+*** @return     (0)Timeout, (1)Response received.
+***********************************************************************************************************/
+
+static int bench_response(const uint8_t *req)
+{
+    static int  other = 0;                              // Last frame a request of the other master
+    uint8_t     buff[260];
+    int         ok;
+
+    while( recv(g_Host, buff, sizeof(buff), 0) > 0 ) {
+        if( req[0] == 0x10 ) {
+            ok = (buff[0] == 0xE5) && !other;           // SC, not the one to the other master
+        } else {
+            ok = (buff[0] == 0x68) && ((buff[4] & 0x7F) == BENCH_GW);
+        }
+        other = (buff[0] == 0x10) && ((buff[2] & 0x7F) == BENCH_OTHER);
+        if( ok ) {
+            return( 1 );
+        }
+    }
+    return( 0 );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Entry of the benchmark.
+***********************************************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    SIM_RS485_CFG       cfg;
+    SIM_RS485_STAT      stat;
+    LATENCY_STAGE       tsdr;
+    struct sockaddr_in  addr;
+    struct timeval      tv;
+    pthread_t           tid;
+    uint8_t             req[260];
+    char                buff[512];
+    uint32_t            baud = BENCH_BAUD, expect, timed = 0, skip = 0;
+    int                 opt, count = BENCH_COUNT, n, len, lost = 0;
+
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.tsdr   = BENCH_TSDR;
+    cfg.first  = BENCH_SLAVE_FIRST;
+    cfg.last   = BENCH_SLAVE_LAST;
+    cfg.other  = BENCH_OTHER;
+    cfg.period = BENCH_CYCLE;
+    while( (opt = getopt(argc, argv, "b:s:o:n:")) != -1 ) {
+        switch( opt ) {
+        case 'b':  baud       = strtoul(optarg, NULL, 0);   break;
+        case 's':  cfg.tsdr   = strtoul(optarg, NULL, 0);   break;
+        case 'o':  cfg.period = strtoul(optarg, NULL, 0);   break;
+        case 'n':  count      = atoi(optarg);               break;
+        default:
+            printf("Usage: %s [-b baud] [-s tsdr] [-o cycle] [-n count]\n", argv[0]);
+            return( 1 );
+        }
+    }
+    cfg.other = (cfg.period != 0) ? (BENCH_OTHER) : (0);
+    sim_rs485_config(&cfg);
+    PBDP_Init(baud);
+
+    g_Net2dp = bench_socket(&g_Net2dpAddr);
+    g_Dp2net = bench_socket(&addr);
+    g_Host   = bench_socket(&g_HostAddr);
+    tv.tv_sec  = 0;
+    tv.tv_usec = BENCH_TIMEOUT * 1000;
+    setsockopt(g_Host, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    pthread_create(&tid, NULL, bench_net2dp, NULL);
+    pthread_create(&tid, NULL, bench_dp2net, NULL);
+
+    for(n = 0;  n < count;  n++) {
+        len = bench_request(req, n);
+        sendto(g_Host, req, len, 0, (struct sockaddr *)&g_Net2dpAddr, sizeof(g_Net2dpAddr));
+        lost += !bench_response(req);
+    }
+    usleep(10000);                                      // The last response forwarded
+
+    sim_rs485_stat(&stat);
+    latency_stage(LATENCY_TSDR, &tsdr);
+    latency_statc(buff, sizeof(buff));
+    expect = (cfg.tsdr + 11) * 1000000u / baud;         // Tsdr and the first char of the response
+    printf( "  %u baud, Tsdr %u bits, other master every %u us\n", baud, cfg.tsdr, cfg.period );
+    printf( "  Line: %u chars, %u requests of the gateway, %u responses, %u requests of the other master\n",
+            stat.chars, stat.req, stat.resp, stat.other );
+    printf( "  Host: %d requests, %d lost\n", count, lost );
+    printf( "  %s", buff );
+    printf( "  Tsdr stage %u us expected on the line, callbacks late by the wakeup on the host\n", expect );
+
+    TEST_CHECK(stat.req >= (uint32_t)(count - count / 20));
+    TEST_CHECK(lost <= (count / 20));
+    TEST_CHECK(sscanf(buff, "Latency: %u(Request) %u(Skip)", &timed, &skip) == 2);
+    TEST_CHECK(timed >= (uint32_t)(count / 2));         // Not timed while the last one is forwarded
+    TEST_CHECK(skip  <= (uint32_t)(count / 20));        // Timed and matched to the response
+    TEST_CHECK((cfg.period == 0) || (stat.other > 0));
+    TEST_CHECK((tsdr.cnt > 0) && ((tsdr.sum / tsdr.cnt) >= (expect / 2)));
+    return( TEST_RESULT() );
+}
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+***********************************************************************************************************/
@@ -0,0 +1,370 @@
+/**********************************************************************************************************/
+/** @file     netio_ping.c
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    Host tool: client of the NetIO ping mode, round trip latency with the percentiles.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************
+*** Usage: netio_ping [-p port] [-T] [-l size] [-r pps] [-n count] gateway
+***
+***   Pings of "-l" bytes (16 ~ 1472 for UDP, 16 ~ 1024 for TCP "-T"), "-r" per second or back to back
+***   with "-r 0", ref: CMD_PING in netiod.h. Reported in microseconds, min/median/p99/p99.9/max and the
+***   log2 histogram, of:
+***     RTT      -- round trip time measured here, a UDP ping not echoed within 1 s is lost.
+***     Network  -- RTT without the time in the gateway (T_TX - T_RX of the echo).
+***     Gateway  -- service time of the gateway, from its result of the run.
+***   Run it with the DP bridge busy and idle to see the bus load in the latency of the network.
+***********************************************************************************************************/
+
+#include    <stdlib.h>
+#include    <stdint.h>
+#include    <stdio.h>
+#include    <string.h>
+#include    <unistd.h>
+#include    <poll.h>
+#include    <time.h>
+#include    <netdb.h>
+#include    <arpa/inet.h>
+#include    <netinet/in.h>
+#include    <netinet/tcp.h>
+#include    <sys/socket.h>
+
+#include    "netiod.h"
+
+
+/**********************************************************************************************************/
+/** @addtogroup NETIO_PING
+*** @{
+*** @addtogroup                 NETIO_PING_Private_Constants
+*** @{
+***********************************************************************************************************/
+
+#define NETIO_PORT          0x494F                  /* "IO", DEFAULTPORT of netiod.c            */
+#define CMD_QUIT            0                       /* Commands of netiod.c                     */
+#define CMD_RES             3
+#define CMD_PING            6
+#define PING_TCP_MAX        1024                    /* TMAXSIZE of netiod.c                     */
+#define PING_WAIT           1000                    /* Wait for the echo(ms)                    */
+#define PING_BINS           24                      /* Bins of the histogram, as NETIO_HIST_BINS*/
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 NETIO_PING_Private_Types
+*** @{
+***********************************************************************************************************/
+
+typedef struct {    /*------------- Samples of a latency --------------------------------------------*/
+    uint32_t                   *us;         /* Samples(us)                      */
+    uint32_t                    num;        /* Number of samples                */
+} PING_LAT;
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 NETIO_PING_Private_Variables
+*** @{
+***********************************************************************************************************/
+
+static uint32_t             g_Buf[NETIO_UDP_MAX / 4];
+static uint32_t             g_Rx[NETIO_UDP_MAX / 4];
+static PING_LAT             g_Rtt;
+static PING_LAT             g_Net;
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 NETIO_PING_Private_Functions
+*** @{
+***********************************************************************************************************/
+/** @brief      Monotonic time in microseconds.
+***********************************************************************************************************/
+
+static uint64_t ping_now(void)
+{
+    struct timespec     ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return( (uint64_t)ts.tv_sec * 1000000u + ts.tv_nsec / 1000 );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Sleep until a time, ref: ping_now().
+***********************************************************************************************************/
+
+static void ping_until(uint64_t us)
+{
+    struct timespec     ts;
+
+    ts.tv_sec  = (time_t)(us / 1000000u);
+    ts.tv_nsec = (long)(us % 1000000u) * 1000;
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Receive exactly len bytes of the TCP session.
+***
+*** @return     (0)Closed or error, (other)Succeed.
+***********************************************************************************************************/
+
+static int ping_recv_all(int sock, void *buf, int len)
+{
+    int     n, rc;
+
+    for(n = 0;  n < len;  n += rc) {
+        if( (rc = (int)recv(sock, (char*)buf + n, len - n, 0)) <= 0 ) {
+            return( 0 );
+        }
+    }
+    return( 1 );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Receive the echo of a ping.
+***
+*** @param[in]  sock    Socket connected to the gateway
+*** @param[in]  tcp     (0)UDP, (other)TCP
+*** @param[in]  size    Length of the ping
+*** @param[in]  seq     SEQ of the ping
+***
+*** @return     (0)Lost, (other)Echo received in g_Rx.
+***********************************************************************************************************/
+
+static int ping_echo(int sock, int tcp, int size, uint32_t seq)
+{
+    struct pollfd   fds;
+    uint64_t        end = ping_now() + PING_WAIT * 1000u, now;
+    int             len;
+
+    if( tcp ) {
+        return( ping_recv_all(sock, g_Rx, size) && (ntohl(g_Rx[1]) == seq) );
+    }
+    fds.fd     = sock;
+    fds.events = POLLIN;
+    while( (now = ping_now()) < end ) {
+        if( poll(&fds, 1, (int)((end - now) / 1000) + 1) <= 0 ) {
+            continue;
+        }
+        len = (int)recv(sock, g_Rx, sizeof(g_Rx), 0);
+        if( (len == size) && (ntohl(g_Rx[0]) == CMD_PING) && (ntohl(g_Rx[1]) == seq) ) {
+            return( 1 );
+        }                                               // Echo of a ping lost before, skipped
+    }
+    return( 0 );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Sort the samples of a latency.
+***********************************************************************************************************/
+
+static int ping_cmp(const void *a, const void *b)
+{
+    uint32_t    x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+
+    return( (x > y) - (x < y) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Print the percentiles and the log2 histogram of a latency.
+***********************************************************************************************************/
+
+static void ping_print(const char *tag, PING_LAT *lat)
+{
+    uint32_t    hist[PING_BINS], us;
+    int         i, bin;
+
+    if( lat->num == 0 ) {
+        printf("  %-8s no samples\n", tag);
+        return;
+    }
+    qsort(lat->us, lat->num, sizeof(lat->us[0]), ping_cmp);
+    printf( "  %-8s min %u, median %u, p99 %u, p99.9 %u, max %u (us)\n", tag, lat->us[0],
+            lat->us[(lat->num - 1) / 2], lat->us[(uint32_t)((lat->num - 1) * 0.99)],
+            lat->us[(uint32_t)((lat->num - 1) * 0.999)], lat->us[lat->num - 1] );
+
+    memset(hist, 0, sizeof(hist));
+    for(i = 0;  i < (int)lat->num;  i++) {
+        for(us = lat->us[i], bin = 0;  (us != 0) && (bin < (PING_BINS - 1));  us >>= 1) {
+            bin++;
+        }
+        hist[bin]++;
+    }
+    for(bin = 0;  bin < PING_BINS;  bin++) {
+        if( hist[bin] != 0 ) {
+            printf( "    [%7u, %7u) %9u %6.2f%%\n", (bin == 0) ? 0 : (1u << (bin - 1)), 1u << bin,
+                    hist[bin], hist[bin] * 100.0 / lat->num );
+        }
+    }
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Print the result of the run from the gateway, its service time of the pings.
+***
+*** @param[in]  res     Result, (11 + NETIO_HIST_BINS) words in network byte order
+***********************************************************************************************************/
+
+static void ping_result(const uint32_t *res)
+{
+    uint32_t    count = ntohl(res[1]), idle = ntohl(res[5]), n;
+    int         bin;
+
+    printf( "  Gateway  min %u, median %u, p99 %u, p99.9 %u, max %u (us, upper bound of the bin), idle %u.%u%%\n",
+            ntohl(res[6]), ntohl(res[7]), ntohl(res[8]), ntohl(res[9]), ntohl(res[10]), idle / 10, idle % 10 );
+    for(bin = 0;  bin < NETIO_HIST_BINS;  bin++) {
+        if( (n = ntohl(res[11 + bin])) != 0 ) {
+            printf( "    [%7u, %7u) %9u %6.2f%%\n", (bin == 0) ? 0 : (1u << (bin - 1)), 1u << bin,
+                    n, (count == 0) ? 0.0 : (n * 100.0 / count) );
+        }
+    }
+}
+
+
+/**********************************************************************************************************/
+/** @brief      End the run, get and print the result of the gateway.
+***********************************************************************************************************/
+
+static void ping_end(int sock, int tcp, int size)
+{
+    struct pollfd   fds;
+    int             len, i;
+
+    memset(g_Buf, 0, size);
+    g_Buf[0] = htonl(CMD_RES);
+    if( tcp ) {                                         // A message other than CMD_PING ends the run
+        send(sock, g_Buf, size, 0);
+        if( ping_recv_all(sock, g_Rx, 24) && ((ntohl(g_Rx[1]) == 0) || ping_recv_all(sock, &g_Rx[6], 116)) ) {
+            if( ntohl(g_Rx[1]) != 0 ) {
+                ping_result(g_Rx);
+            }
+        }
+        g_Buf[0] = htonl(CMD_QUIT);
+        g_Buf[1] = 0;
+        send(sock, g_Buf, 8, 0);
+        return;
+    }
+    fds.fd     = sock;
+    fds.events = POLLIN;
+    for(i = 0;  i < 3;  i++) {
+        send(sock, g_Buf, NETIO_UDP_HDR_LEN, 0);
+        while( poll(&fds, 1, PING_WAIT) > 0 ) {
+            len = (int)recv(sock, g_Rx, sizeof(g_Rx), 0);
+            if( (len >= (11 + NETIO_HIST_BINS) * 4) && (ntohl(g_Rx[0]) == CMD_RES) ) {
+                ping_result(g_Rx);
+                return;
+            }
+        }
+    }
+    printf("  Gateway  no result\n");
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Entry of the tool.
+***********************************************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    struct addrinfo     hint, *ai;
+    uint64_t            start, t0, rtt;
+    uint32_t            seq, gw, lost = 0;
+    char                port[16];
+    int                 tcp = 0, size = 64, pps = 100, count = 1000, opt, sock, one = 1;
+
+    snprintf(port, sizeof(port), "%d", NETIO_PORT);
+    while( (opt = getopt(argc, argv, "p:Tl:r:n:")) != -1 ) {
+        switch( opt ) {
+        case 'p':   snprintf(port, sizeof(port), "%s", optarg);     break;
+        case 'T':   tcp   = 1;                                      break;
+        case 'l':   size  = atoi(optarg);                           break;
+        case 'r':   pps   = atoi(optarg);                           break;
+        case 'n':   count = atoi(optarg);                           break;
+        default:    optind = argc + 1;                              break;
+        }
+    }
+    if(   (optind != (argc - 1)) || (count <= 0) || (size < NETIO_PING_LEN)
+       || (size > (tcp ? PING_TCP_MAX : NETIO_UDP_MAX)) ) {
+        fprintf(stderr, "Usage: %s [-p port] [-T] [-l size] [-r pps] [-n count] gateway\n", argv[0]);
+        return( 2 );
+    }
+    memset(&hint, 0, sizeof(hint));
+    hint.ai_family   = AF_INET;
+    hint.ai_socktype = tcp ? SOCK_STREAM : SOCK_DGRAM;
+    if( getaddrinfo(argv[optind], port, &hint, &ai) != 0 ) {
+        fprintf(stderr, "%s: unknown host\n", argv[optind]);
+        return( 2 );
+    }
+    if(   ((sock = socket(AF_INET, hint.ai_socktype, 0)) < 0)
+       || (connect(sock, ai->ai_addr, ai->ai_addrlen) < 0) ) {
+        perror(argv[optind]);
+        return( 2 );
+    }
+    freeaddrinfo(ai);
+    g_Rtt.us = malloc(count * sizeof(uint32_t));
+    g_Net.us = malloc(count * sizeof(uint32_t));
+    if( (g_Rtt.us == NULL) || (g_Net.us == NULL) ) {
+        return( 2 );
+    }
+    if( tcp ) {                                         // "| CMD_PING | SIZE |" starts the run
+        setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        g_Buf[0] = htonl(CMD_PING);
+        g_Buf[1] = htonl((uint32_t)size);
+        send(sock, g_Buf, 8, 0);
+    }
+
+    memset(g_Buf, 0, sizeof(g_Buf));
+    g_Buf[0] = htonl(CMD_PING);
+    start    = ping_now();
+    for(seq = 0;  seq < (uint32_t)count;  seq++) {
+        if( pps != 0 ) {
+            ping_until(start + ((uint64_t)seq * 1000000u) / pps);
+        }
+        g_Buf[1] = htonl(seq);
+        t0 = ping_now();
+        if( send(sock, g_Buf, size, 0) != size ) {
+            lost++;
+            continue;
+        }
+        if( !ping_echo(sock, tcp, size, seq) ) {
+            if( tcp ) {
+                fprintf(stderr, "TCP session closed at ping %u\n", seq);
+                return( 1 );
+            }
+            lost++;
+            continue;
+        }
+        rtt = ping_now() - t0;
+        gw  = ntohl(g_Rx[3]) - ntohl(g_Rx[2]);          // T_TX - T_RX
+        g_Rtt.us[g_Rtt.num++] = (uint32_t)rtt;
+        g_Net.us[g_Net.num++] = (rtt > gw) ? (uint32_t)(rtt - gw) : 0;
+    }
+
+    printf( "NetIO ping %s:%s over %s, %d bytes, %d pps%s: %u echoed, %u lost, %.1f s\n", argv[optind], port,
+            tcp ? "TCP" : "UDP", size, pps, pps ? "" : " (back to back)", g_Rtt.num, lost,
+            (ping_now() - start) / 1e6 );
+    ping_print("RTT", &g_Rtt);
+    ping_print("Network", &g_Net);
+    ping_end(sock, tcp, size);
+    close(sock);
+    return( 0 );
+}
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+***********************************************************************************************************/
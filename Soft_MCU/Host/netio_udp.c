@@ -0,0 +1,331 @@
+/**********************************************************************************************************/
+/** @file     netio_udp.c
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    Host tool: client of the NetIO UDP mode, packet rate, loss and CPU idle of the gateway.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************
+*** Usage: netio_udp [-p port] [-m c2s|s2c|both] [-l size,size,...] [-r pps] [-t sec] gateway
+***
+***   A run per datagram size and direction, ref: the UDP mode in netiod.h. The sizes are the lengths of
+***   the datagrams, with the 8 bytes of CMD and SEQ, 8,16,64,128,260 by default as the DP frames. "-r 0"
+***   sends as fast as possible. For each run:
+***     C2S  -- sent by this host, received and lost at the gateway (SEQ - COUNT), gateway pps.
+***     S2C  -- sent by the gateway, failed to send there (out of network buffers), received and lost
+***             here by the gap of SEQ, received pps.
+***   and the CPU idle of the gateway during the run.
+***********************************************************************************************************/
+
+#include    <stdlib.h>
+#include    <stdint.h>
+#include    <stdio.h>
+#include    <string.h>
+#include    <errno.h>
+#include    <unistd.h>
+#include    <poll.h>
+#include    <time.h>
+#include    <netdb.h>
+#include    <arpa/inet.h>
+#include    <netinet/in.h>
+#include    <sys/socket.h>
+
+#include    "netiod.h"
+
+
+/**********************************************************************************************************/
+/** @addtogroup NETIO_UDP
+*** @{
+*** @addtogroup                 NETIO_UDP_Private_Constants
+*** @{
+***********************************************************************************************************/
+
+#define NETIO_PORT          0x494F                  /* "IO", DEFAULTPORT of netiod.c            */
+#define CMD_RES             3                       /* Commands of netiod.c                     */
+#define CMD_C2S_UDP         4
+#define CMD_S2C_UDP         5
+#define UDP_SIZES           "8,16,64,128,260"       /* Default sizes, as the DP frames          */
+#define UDP_RES_WAIT        1000                    /* Wait for the result(ms)                  */
+#define UDP_RES_TRY         3                       /* Requests of the result                   */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 NETIO_UDP_Private_Types
+*** @{
+***********************************************************************************************************/
+
+typedef struct {    /*------------- Result of a run, ref: CMD_RES -----------------------------------*/
+    uint32_t                    count;      /* C2S: received, S2C: sent         */
+    uint32_t                    seq;        /* C2S: last SEQ + 1, S2C: failed   */
+    uint32_t                    bytes;      /* Bytes of the datagrams counted   */
+    uint32_t                    us;         /* First to last datagram(us)       */
+    uint32_t                    idle;       /* CPU idle of the gateway, 1/1000  */
+} UDP_RES;
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 NETIO_UDP_Private_Variables
+*** @{
+***********************************************************************************************************/
+
+static uint32_t             g_Buf[NETIO_UDP_MAX / 4];
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 NETIO_UDP_Private_Functions
+*** @{
+***********************************************************************************************************/
+/** @brief      Monotonic time in microseconds.
+***********************************************************************************************************/
+
+static uint64_t udp_now(void)
+{
+    struct timespec     ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return( (uint64_t)ts.tv_sec * 1000000u + ts.tv_nsec / 1000 );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Sleep until a time, ref: udp_now().
+***********************************************************************************************************/
+
+static void udp_until(uint64_t us)
+{
+    struct timespec     ts;
+
+    ts.tv_sec  = (time_t)(us / 1000000u);
+    ts.tv_nsec = (long)(us % 1000000u) * 1000;
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Receive a datagram of the gateway.
+***
+*** @param[in]  sock    UDP socket connected to the gateway
+*** @param[in]  ms      Timeout(ms)
+***
+*** @return     (<= 0)Timeout, (other)Length of the datagram in g_Buf.
+***********************************************************************************************************/
+
+static int udp_recv(int sock, int ms)
+{
+    struct pollfd   fds;
+
+    fds.fd     = sock;
+    fds.events = POLLIN;
+    if( poll(&fds, 1, ms) <= 0 ) {
+        return( 0 );
+    }
+    return( (int)recv(sock, g_Buf, sizeof(g_Buf), 0) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Take the result of a run from g_Buf.
+***
+*** @return     (0)Not a result, (other)Succeed.
+***********************************************************************************************************/
+
+static int udp_result(int len, UDP_RES *res)
+{
+    if( (len < 24) || (ntohl(g_Buf[0]) != CMD_RES) ) {
+        return( 0 );
+    }
+    res->count = ntohl(g_Buf[1]);
+    res->seq   = ntohl(g_Buf[2]);
+    res->bytes = ntohl(g_Buf[3]);
+    res->us    = ntohl(g_Buf[4]);
+    res->idle  = ntohl(g_Buf[5]);
+    return( 1 );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      C2S run: send the datagrams, then request the result.
+***
+*** @return     (0)No result, (other)Succeed.
+***********************************************************************************************************/
+
+static int udp_c2s(int sock, int size, int pps, int secs)
+{
+    UDP_RES     res;
+    uint64_t    start, end, sent = 0, nobuf = 0;
+    int         i, len;
+
+    memset(g_Buf, 0, sizeof(g_Buf));
+    g_Buf[0] = htonl(CMD_C2S_UDP);
+    start    = udp_now();
+    end      = start + (uint64_t)secs * 1000000u;
+    while( udp_now() < end ) {
+        if( pps != 0 ) {
+            udp_until(start + (sent * 1000000u) / pps);
+        }
+        g_Buf[1] = htonl((uint32_t)sent);
+        if( send(sock, g_Buf, size, 0) == size ) {
+            sent++;
+        } else if( (errno == ENOBUFS) || (errno == EAGAIN) ) {
+            nobuf++;                                    // The SEQ not used, not a loss
+        } else {
+            perror("send");
+            return( 0 );
+        }
+    }
+    end = udp_now();
+    usleep(100000);                                     // The last datagrams counted first
+
+    for(i = 0;  i < UDP_RES_TRY;  i++) {
+        g_Buf[0] = htonl(CMD_RES);
+        g_Buf[1] = 0;
+        send(sock, g_Buf, NETIO_UDP_HDR_LEN, 0);
+        while( (len = udp_recv(sock, UDP_RES_WAIT)) > 0 ) {
+            if( udp_result(len, &res) ) {
+                break;
+            }
+        }
+        if( len > 0 ) {
+            break;
+        }
+    }
+    if( i == UDP_RES_TRY ) {
+        printf("  C2S %4d bytes: no result from the gateway\n", size);
+        return( 0 );
+    }
+    printf( "  C2S %4d bytes: sent %9.0f pps (%llu ENOBUFS), gateway %9.0f pps, lost %u/%u (%.3f%%), idle %u.%u%%\n",
+            size, sent * 1e6 / (end - start), (unsigned long long)nobuf,
+            (res.us == 0) ? 0.0 : (res.count * 1e6 / res.us), res.seq - res.count, res.seq,
+            (res.seq == 0) ? 0.0 : ((res.seq - res.count) * 100.0 / res.seq), res.idle / 10, res.idle % 10 );
+    return( 1 );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      S2C run: request the datagrams, count them until the result.
+***
+*** @return     (0)No result, (other)Succeed.
+***********************************************************************************************************/
+
+static int udp_s2c(int sock, int size, int pps, int secs)
+{
+    UDP_RES     res;
+    uint64_t    first = 0, last = 0, now, end;
+    uint32_t    seq, next = 0, recvd = 0, gap = 0;
+    int         len;
+
+    g_Buf[0] = htonl(CMD_S2C_UDP);
+    g_Buf[1] = htonl((uint32_t)size);
+    g_Buf[2] = htonl((uint32_t)pps);
+    g_Buf[3] = htonl((uint32_t)secs * 1000);
+    send(sock, g_Buf, 16, 0);
+
+    end = udp_now() + (uint64_t)secs * 1000000u + UDP_RES_WAIT * 1000u * UDP_RES_TRY;
+    for(; ;) {
+        if( (now = udp_now()) >= end ) {
+            printf("  S2C %4d bytes: no result from the gateway, %u received\n", size, recvd);
+            return( 0 );
+        }
+        if( (len = udp_recv(sock, (int)((end - now) / 1000) + 1)) < NETIO_UDP_HDR_LEN ) {
+            continue;
+        }
+        if( udp_result(len, &res) ) {
+            break;
+        }
+        if( ntohl(g_Buf[0]) != CMD_S2C_UDP ) {
+            continue;
+        }
+        seq = ntohl(g_Buf[1]);
+        if( (seq - next) < 0x7FFFFFFFu ) {
+            gap  += seq - next;                         // Lost, or reordered and counted twice
+            next  = seq + 1;
+        }
+        last = udp_now();
+        if( recvd++ == 0 ) {
+            first = last;
+        }
+    }
+    printf( "  S2C %4d bytes: gateway sent %9.0f pps (%u failed), received %9.0f pps, lost %u/%u (%.3f%%, gap %u), idle %u.%u%%\n",
+            size, (res.us == 0) ? 0.0 : (res.count * 1e6 / res.us), res.seq,
+            (last == first) ? 0.0 : ((recvd - 1) * 1e6 / (last - first)),
+            (res.count > recvd) ? (res.count - recvd) : 0, res.count,
+            (res.count == 0) ? 0.0 : (((res.count > recvd) ? (res.count - recvd) : 0) * 100.0 / res.count),
+            gap, res.idle / 10, res.idle % 10 );
+    return( 1 );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Entry of the tool.
+***********************************************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    struct addrinfo     hint, *ai;
+    const char         *mode = "both", *sizes = UDP_SIZES, *p;
+    char                port[16];
+    int                 pps = 0, secs = 5, opt, sock, size, fail = 0;
+
+    snprintf(port, sizeof(port), "%d", NETIO_PORT);
+    while( (opt = getopt(argc, argv, "p:m:l:r:t:")) != -1 ) {
+        switch( opt ) {
+        case 'p':   snprintf(port, sizeof(port), "%s", optarg);     break;
+        case 'm':   mode  = optarg;                                 break;
+        case 'l':   sizes = optarg;                                 break;
+        case 'r':   pps   = atoi(optarg);                           break;
+        case 't':   secs  = atoi(optarg);                           break;
+        default:    optind = argc + 1;                              break;
+        }
+    }
+    if( optind != (argc - 1) ) {
+        fprintf(stderr, "Usage: %s [-p port] [-m c2s|s2c|both] [-l size,size,...] [-r pps] [-t sec] gateway\n",
+                argv[0]);
+        return( 2 );
+    }
+    memset(&hint, 0, sizeof(hint));
+    hint.ai_family   = AF_INET;
+    hint.ai_socktype = SOCK_DGRAM;
+    if( getaddrinfo(argv[optind], port, &hint, &ai) != 0 ) {
+        fprintf(stderr, "%s: unknown host\n", argv[optind]);
+        return( 2 );
+    }
+    if( ((sock = socket(AF_INET, SOCK_DGRAM, 0)) < 0) || (connect(sock, ai->ai_addr, ai->ai_addrlen) < 0) ) {
+        perror(argv[optind]);
+        return( 2 );
+    }
+    freeaddrinfo(ai);
+
+    printf("NetIO UDP %s:%s, %s pps, %d s per run\n", argv[optind], port, pps ? "limited" : "max", secs);
+    for(p = sizes;  *p != '\0';  p += (*p == ',')) {
+        size = (int)strtol(p, (char**)&p, 10);
+        if( (size < NETIO_UDP_HDR_LEN) || (size > NETIO_UDP_MAX) ) {
+            fprintf(stderr, "  size %d out of %d ~ %d\n", size, NETIO_UDP_HDR_LEN, NETIO_UDP_MAX);
+            return( 2 );
+        }
+        if( strcmp(mode, "s2c") != 0 ) {
+            fail += !udp_c2s(sock, size, pps, secs);
+        }
+        if( strcmp(mode, "c2s") != 0 ) {
+            fail += !udp_s2c(sock, size, pps, secs);
+        }
+    }
+    close(sock);
+    return( fail ? 1 : 0 );
+}
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+***********************************************************************************************************/
@@ -0,0 +1,281 @@
+/**********************************************************************************************************/
+/** @file     pbgw_mcast.c
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    Host tool: fan-out of the multicast DP traffic at a switch port, the acceptance test of MCAST.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************
+*** Usage: pbgw_mcast -i ifname -g group [-p port] [-t sec] [-n] [-e gateways] [-m max_pps]
+***
+***   Counts the datagrams of the group arriving at the port of the switch, per gateway, from a raw
+***   socket in all-multicast mode, so the datagrams the switch delivers are counted whether this host
+***   joined the group or not (root or CAP_NET_RAW needed).
+***
+***   Acceptance test of "[Tunnel] MCAST", with the gateways sending to the group on one VLAN:
+***     1. On a port of a receiver: "pbgw_mcast -i eth0 -g 239.1.2.3 -e 12", the group joined by IGMP,
+***        passed if all the 12 gateways are received and no datagram lost by the gap of SEQ
+***        ("[Tunnel] SEQ_HDR = Y" for the loss).
+***     2. On another port at the same time: "pbgw_mcast -i eth0 -g 239.1.2.3 -n -m 1", the group not
+***        joined, passed if no more than 1 datagram/s of the group is delivered to the port: the
+***        switch does not flood the group. With broadcast (MCAST = 0.0.0.0) every port gets all.
+***   The exit code is 0 if passed.
+***********************************************************************************************************/
+
+#include    <stdlib.h>
+#include    <stdint.h>
+#include    <stdio.h>
+#include    <string.h>
+#include    <unistd.h>
+#include    <poll.h>
+#include    <time.h>
+#include    <arpa/inet.h>
+#include    <net/if.h>
+#include    <netinet/in.h>
+#include    <netinet/ip.h>
+#include    <netinet/udp.h>
+#include    <linux/if_ether.h>
+#include    <linux/if_packet.h>
+#include    <sys/socket.h>
+
+#include    "tunnel.h"
+
+
+/**********************************************************************************************************/
+/** @addtogroup PBGW_MCAST
+*** @{
+*** @addtogroup                 PBGW_MCAST_Private_Constants
+*** @{
+***********************************************************************************************************/
+
+#define MCAST_UDP_PORT      18355                   /* PORT_NET2DP                              */
+#define MCAST_GW_MAX        64                      /* Max gateways counted                     */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 PBGW_MCAST_Private_Types
+*** @{
+***********************************************************************************************************/
+
+typedef struct {    /*------------- Datagrams of a gateway ----------------------------------------*/
+    uint32_t                    addr;       /* IP address, network byte order   */
+    uint64_t                    dgrams;     /* Datagrams received               */
+    uint64_t                    bytes;      /* Bytes of UDP payload             */
+    uint64_t                    lost;       /* Datagrams lost, gap of SEQ       */
+    int                         seq_ok;     /* (seq) valid                      */
+    uint32_t                    seq;        /* Next SEQ expected                */
+} MCAST_GW;
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 PBGW_MCAST_Private_Variables
+*** @{
+***********************************************************************************************************/
+
+static MCAST_GW             g_Gw[MCAST_GW_MAX];
+static int                  g_GwNum;
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 PBGW_MCAST_Private_Functions
+*** @{
+***********************************************************************************************************/
+/** @brief      Monotonic time in microseconds.
+***********************************************************************************************************/
+
+static uint64_t mcast_now(void)
+{
+    struct timespec     ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return( (uint64_t)ts.tv_sec * 1000000u + ts.tv_nsec / 1000 );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Count a datagram of the group.
+***
+*** @param[in]  src     Source IP address, network byte order
+*** @param[in]  data    UDP payload
+*** @param[in]  len     Length of UDP payload
+***********************************************************************************************************/
+
+static void mcast_count(uint32_t src, const uint8_t *data, int len)
+{
+    MCAST_GW   *gw;
+    uint32_t    seq;
+    int         i;
+
+    for(i = 0;  (i < g_GwNum) && (g_Gw[i].addr != src);  i++) {
+    }
+    if( i == g_GwNum ) {
+        if( g_GwNum == MCAST_GW_MAX ) {
+            return;
+        }
+        g_GwNum++;
+        g_Gw[i].addr = src;
+    }
+    gw = &g_Gw[i];
+    gw->dgrams++;
+    gw->bytes += len;
+    if( (len < TUNNEL_UDP_HDR_LEN) || (data[0] != TUNNEL_UDP_MAGIC) ) {
+        return;                                         // Without the sequence header
+    }
+    seq = ((uint32_t)data[4] << 24) | ((uint32_t)data[5] << 16) | ((uint32_t)data[6] << 8) | data[7];
+    if( gw->seq_ok && ((seq - gw->seq) - 1u) < 0x7FFFFFFFu ) {
+        gw->lost += seq - gw->seq;                      // Older SEQ are the replayed backlog
+    }
+    gw->seq_ok = 1;
+    gw->seq    = seq + 1;
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Receive the frames of the port, and count the UDP datagrams to the group.
+***********************************************************************************************************/
+
+static void mcast_recv(int sock, uint32_t group, uint16_t port)
+{
+    uint8_t             buf[2048];
+    const struct iphdr  *ip  = (const struct iphdr*)buf;
+    const struct udphdr *udp;
+    struct sockaddr_ll  from;
+    socklen_t           flen;
+    int                 len, hl;
+
+    for(; ;) {
+        flen = sizeof(from);
+        if( (len = recvfrom(sock, buf, sizeof(buf), MSG_DONTWAIT, (struct sockaddr*)&from, &flen)) <= 0 ) {
+            break;
+        }
+        hl = ip->ihl * 4;
+        if(   (from.sll_pkttype == PACKET_OUTGOING)     // Sent by this host
+           || (len < (hl + (int)sizeof(*udp))) || (ip->version != 4) || (ip->protocol != IPPROTO_UDP)
+           || (ip->daddr != group) || (ntohs(ip->frag_off) & 0x1FFF) ) {
+            continue;
+        }
+        udp = (const struct udphdr*)&buf[hl];
+        if( ntohs(udp->dest) == port ) {
+            mcast_count(ip->saddr, &buf[hl + sizeof(*udp)], len - hl - (int)sizeof(*udp));
+        }
+    }
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Entry of the tool.
+***********************************************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    struct sockaddr_ll  ll;
+    struct sockaddr_in  local;
+    struct packet_mreq  allmulti;
+    struct ip_mreqn     mreq;
+    struct pollfd       fds;
+    const char         *ifname = NULL, *group = NULL;
+    int                 secs = 10, port = MCAST_UDP_PORT, join = 1, expect = 0, max_pps = 1;
+    int                 raw, udp = -1, opt, i, pass;
+    uint64_t            start, sum = 0, lost = 0;
+    double              span;
+    uint32_t            gaddr;
+
+    while( (opt = getopt(argc, argv, "i:g:p:t:ne:m:")) != -1 ) {
+        switch( opt ) {
+        case 'i':   ifname  = optarg;           break;
+        case 'g':   group   = optarg;           break;
+        case 'p':   port    = atoi(optarg);     break;
+        case 't':   secs    = atoi(optarg);     break;
+        case 'n':   join    = 0;                break;
+        case 'e':   expect  = atoi(optarg);     break;
+        case 'm':   max_pps = atoi(optarg);     break;
+        default:    ifname  = NULL;             break;
+        }
+    }
+    if( (ifname == NULL) || (group == NULL) || (inet_pton(AF_INET, group, &gaddr) != 1) ) {
+        fprintf(stderr, "Usage: %s -i ifname -g group [-p port] [-t sec] [-n] [-e gateways] [-m max_pps]\n",
+                argv[0]);
+        return( 2 );
+    }
+
+    if( (raw = socket(AF_PACKET, SOCK_DGRAM, htons(ETH_P_IP))) < 0 ) {
+        perror("raw socket (root needed)");
+        return( 2 );
+    }
+    memset(&ll, 0, sizeof(ll));
+    ll.sll_family   = AF_PACKET;
+    ll.sll_protocol = htons(ETH_P_IP);
+    ll.sll_ifindex  = if_nametoindex(ifname);
+    if( (ll.sll_ifindex == 0) || (bind(raw, (struct sockaddr*)&ll, sizeof(ll)) < 0) ) {
+        perror(ifname);
+        return( 2 );
+    }
+    memset(&allmulti, 0, sizeof(allmulti));             // All the groups the switch delivers
+    allmulti.mr_ifindex = ll.sll_ifindex;
+    allmulti.mr_type    = PACKET_MR_ALLMULTI;
+    setsockopt(raw, SOL_PACKET, PACKET_ADD_MEMBERSHIP, &allmulti, sizeof(allmulti));
+
+    if( join ) {                                        // IGMP membership report of the group
+        udp = socket(AF_INET, SOCK_DGRAM, 0);
+        memset(&local, 0, sizeof(local));
+        local.sin_family = AF_INET;
+        local.sin_port   = htons(port);
+        bind(udp, (struct sockaddr*)&local, sizeof(local));
+        memset(&mreq, 0, sizeof(mreq));
+        mreq.imr_multiaddr.s_addr = gaddr;
+        mreq.imr_ifindex          = ll.sll_ifindex;
+        if( setsockopt(udp, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0 ) {
+            perror("join group");
+            return( 2 );
+        }
+    }
+
+    fds.fd     = raw;
+    fds.events = POLLIN;
+    start      = mcast_now();
+    while( (mcast_now() - start) < (uint64_t)secs * 1000000u ) {
+        poll(&fds, 1, 100);
+        mcast_recv(raw, gaddr, (uint16_t)port);
+        if( udp >= 0 ) {
+            while( recv(udp, &opt, sizeof(opt), MSG_DONTWAIT) > 0 ) {
+            }                                           // Only the membership, counted from the raw socket
+        }
+    }
+    span = (mcast_now() - start) / 1e6;
+
+    printf("Group %s:%d on %s, %s, %.1f s\n", group, port, ifname, join ? "joined" : "not joined", span);
+    for(i = 0;  i < g_GwNum;  i++) {
+        local.sin_addr.s_addr = g_Gw[i].addr;
+        printf( "  %-15s %9.1f dgram/s %9.1f kB/s lost %llu\n", inet_ntoa(local.sin_addr),
+                g_Gw[i].dgrams / span, g_Gw[i].bytes / span / 1000, (unsigned long long)g_Gw[i].lost );
+        sum  += g_Gw[i].dgrams;
+        lost += g_Gw[i].lost;
+    }
+    if( join ) {
+        pass = (g_GwNum >= expect) && (lost == 0);
+        printf("Gateways: %d, expected: %d, lost: %llu -- %s\n", g_GwNum, expect, (unsigned long long)lost,
+               pass ? "PASS" : "FAIL");
+    } else {
+        pass = ((sum / span) <= max_pps);
+        printf("Delivered without membership: %.1f dgram/s, max: %d -- %s\n", sum / span, max_pps,
+               pass ? "PASS" : "FAIL");
+    }
+    return( pass ? 0 : 1 );
+}
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+***********************************************************************************************************/
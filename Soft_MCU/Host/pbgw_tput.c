@@ -0,0 +1,329 @@
+/**********************************************************************************************************/
+/** @file     pbgw_tput.c
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    Host tool: throughput of the TCP tunnel against the UDP path, measured at the same time.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************
+*** Usage: pbgw_tput [-t sec] [-T tcp_port] [-p udp_port] [-g group] [-f hexframe -r pps [-m udp|tcp]] gateway
+***
+***   Every frame forwarded by thread_dp2net goes to the UDP path and to the TCP tunnel, so both are
+***   received at the same time and compared per second: frames, bytes and, with "[Tunnel] SEQ_HDR = Y",
+***   the frames lost on the UDP path by the gap of SEQ. The TCP tunnel is lossless, its frames lost are
+***   the overruns of the gateway, ref: the console of the gateway.
+***
+***   The bus traffic is generated by the master, or by this tool: "-f" a DP request sent "-r" times per
+***   second to PORT_NET2DP ("-m udp", default) or as records of the TCP tunnel ("-m tcp"). The ceiling of
+***   a path is the rate where its frames stop following the requests.
+***********************************************************************************************************/
+
+#include    <stdlib.h>
+#include    <stdint.h>
+#include    <stdio.h>
+#include    <string.h>
+#include    <errno.h>
+#include    <unistd.h>
+#include    <poll.h>
+#include    <time.h>
+#include    <arpa/inet.h>
+#include    <netinet/in.h>
+#include    <netinet/tcp.h>
+#include    <sys/socket.h>
+
+#include    "tunnel.h"
+
+
+/**********************************************************************************************************/
+/** @addtogroup PBGW_TPUT
+*** @{
+*** @addtogroup                 PBGW_TPUT_Private_Constants
+*** @{
+***********************************************************************************************************/
+
+#define TPUT_TCP_PORT       18356                   /* [Tunnel] TCP_PORT                        */
+#define TPUT_UDP_PORT       18355                   /* PORT_NET2DP                              */
+#define TPUT_RX_LEN         (64 * 1024)
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 PBGW_TPUT_Private_Types
+*** @{
+***********************************************************************************************************/
+
+typedef struct {    /*------------- Counters of a path --------------------------------------------*/
+    uint64_t                    frames;     /* Frames received                  */
+    uint64_t                    bytes;      /* Bytes of DP frames received      */
+    uint64_t                    lost;       /* Frames lost, gap of SEQ          */
+    uint64_t                    reads;      /* Reads of the socket, TCP flushes */
+} TPUT_CNT;
+
+typedef struct {    /*------------- Path of the DP frames -----------------------------------------*/
+    int                         sock;
+    int                         seq_ok;     /* (seq) valid                      */
+    uint32_t                    seq;        /* Next SEQ expected                */
+    uint32_t                    rx_len;     /* Bytes in (rx) of TCP             */
+    uint8_t                     rx[TPUT_RX_LEN];
+    TPUT_CNT                    sum;        /* Since the start                  */
+    TPUT_CNT                    sec;        /* Of the current second            */
+} TPUT_PATH;
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 PBGW_TPUT_Private_Variables
+*** @{
+***********************************************************************************************************/
+
+static TPUT_PATH            g_Udp;
+static TPUT_PATH            g_Tcp;
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 PBGW_TPUT_Private_Functions
+*** @{
+***********************************************************************************************************/
+/** @brief      Monotonic time in microseconds.
+***********************************************************************************************************/
+
+static uint64_t tput_now(void)
+{
+    struct timespec     ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return( (uint64_t)ts.tv_sec * 1000000u + ts.tv_nsec / 1000 );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Count a frame of a path.
+***********************************************************************************************************/
+
+static void tput_count(TPUT_PATH *path, int len)
+{
+    path->sum.frames++;   path->sum.bytes += len;
+    path->sec.frames++;   path->sec.bytes += len;
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Receive the datagrams of the UDP path, SEQ checked if the header is present.
+***********************************************************************************************************/
+
+static void tput_udp(TPUT_PATH *path)
+{
+    uint8_t     *buf = path->rx;
+    uint32_t     seq, gap;
+    int          len;
+
+    while( (len = recv(path->sock, buf, TUNNEL_UDP_MAX, MSG_DONTWAIT)) > 0 ) {
+        path->sum.reads++;   path->sec.reads++;
+        if( (len < TUNNEL_UDP_HDR_LEN) || (buf[0] != TUNNEL_UDP_MAGIC) ) {
+            tput_count(path, len);                      // Without the header
+            continue;
+        }
+        seq = ((uint32_t)buf[4] << 24) | ((uint32_t)buf[5] << 16) | ((uint32_t)buf[6] << 8) | buf[7];
+        if( path->seq_ok && (seq != path->seq) ) {
+            gap = seq - path->seq;
+            if( gap < 0x80000000u ) {                   // Older SEQ are the replayed backlog
+                path->sum.lost += gap;   path->sec.lost += gap;
+            }
+        }
+        path->seq_ok = 1;
+        path->seq    = seq + 1;
+        tput_count(path, len - TUNNEL_UDP_HDR_LEN);
+    }
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Receive the records of the TCP tunnel.
+***
+*** @return     (< 0)Connection closed, (other)Succeed.
+***********************************************************************************************************/
+
+static int tput_tcp(TPUT_PATH *path)
+{
+    uint32_t     pos, rec;
+    int          len;
+
+    len = recv(path->sock, &path->rx[path->rx_len], sizeof(path->rx) - path->rx_len, MSG_DONTWAIT);
+    if( len == 0 ) {
+        return( -1 );
+    }
+    if( len < 0 ) {
+        return( ((errno == EAGAIN) || (errno == EWOULDBLOCK)) ? (0) : (-1) );
+    }
+    path->sum.reads++;   path->sec.reads++;
+    path->rx_len += len;
+    for(pos = 0;  (path->rx_len - pos) >= TUNNEL_HDR_LEN;  pos += rec) {
+        rec = TUNNEL_HDR_LEN + (((uint32_t)path->rx[pos] << 8) | path->rx[pos + 1]);
+        if( (path->rx_len - pos) < rec ) {
+            break;
+        }
+        tput_count(path, rec - TUNNEL_HDR_LEN);
+    }
+    memmove(path->rx, &path->rx[pos], path->rx_len - pos);
+    path->rx_len -= pos;
+    return( 0 );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Print the counters of the paths.
+***********************************************************************************************************/
+
+static void tput_print(const char *tag, const TPUT_CNT *udp, const TPUT_CNT *tcp, double sec)
+{
+    printf( "%-6s UDP %8.0f fps %9.1f kB/s lost %-6llu | TCP %8.0f fps %9.1f kB/s %6.1f frames/flush\n", tag,
+            udp->frames / sec, udp->bytes / sec / 1000, (unsigned long long)udp->lost,
+            tcp->frames / sec, tcp->bytes / sec / 1000, tcp->reads ? ((double)tcp->frames / tcp->reads) : 0.0 );
+    fflush(stdout);
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Parse a hex string "68 05 05 68 ..." into bytes.
+***
+*** @return     Bytes parsed.
+***********************************************************************************************************/
+
+static int tput_hex(const char *str, uint8_t *buf, int size)
+{
+    char        *end;
+    int          n;
+
+    for(n = 0;  (n < size) && *str;  n++) {
+        buf[n] = (uint8_t)strtoul(str, &end, 16);
+        if( end == str ) {
+            break;
+        }
+        str = end;
+    }
+    return( n );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Entry of the tool.
+***********************************************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    struct sockaddr_in  gw, local;
+    struct ip_mreq      mreq;
+    struct pollfd       fds[2];
+    uint8_t             req[TUNNEL_HDR_LEN + TUNNEL_FRAME_MAX];
+    int                 req_len = 0, tcp_load = 0;
+    int                 secs = 10, tcp_port = TPUT_TCP_PORT, udp_port = TPUT_UDP_PORT, pps = 0;
+    const char         *group = NULL;
+    uint64_t            start, tick, next_req, now;
+    int                 opt, on = 1, n;
+
+    while( (opt = getopt(argc, argv, "t:T:p:g:f:r:m:")) != -1 ) {
+        switch( opt ) {
+        case 't':   secs     = atoi(optarg);                                            break;
+        case 'T':   tcp_port = atoi(optarg);                                            break;
+        case 'p':   udp_port = atoi(optarg);                                            break;
+        case 'g':   group    = optarg;                                                  break;
+        case 'f':   req_len  = tput_hex(optarg, &req[TUNNEL_HDR_LEN], TUNNEL_FRAME_MAX); break;
+        case 'r':   pps      = atoi(optarg);                                            break;
+        case 'm':   tcp_load = (strcmp(optarg, "tcp") == 0);                            break;
+        default:    optind   = argc + 1;                                                break;
+        }
+    }
+    if( optind != (argc - 1) ) {
+        fprintf(stderr, "Usage: %s [-t sec] [-T tcp_port] [-p udp_port] [-g group] "
+                        "[-f hexframe -r pps [-m udp|tcp]] gateway\n", argv[0]);
+        return( 2 );
+    }
+    memset(&gw, 0, sizeof(gw));
+    gw.sin_family = AF_INET;
+    if( inet_pton(AF_INET, argv[optind], &gw.sin_addr) != 1 ) {
+        fprintf(stderr, "Bad gateway address: %s\n", argv[optind]);
+        return( 2 );
+    }
+
+    g_Udp.sock = socket(AF_INET, SOCK_DGRAM, 0);        // UDP path, broadcast or multicast group
+    setsockopt(g_Udp.sock, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    memset(&local, 0, sizeof(local));
+    local.sin_family      = AF_INET;
+    local.sin_port        = htons(udp_port);
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    if( bind(g_Udp.sock, (struct sockaddr*)&local, sizeof(local)) < 0 ) {
+        perror("bind UDP");
+        return( 1 );
+    }
+    if( group != NULL ) {
+        mreq.imr_multiaddr.s_addr = inet_addr(group);
+        mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+        if( setsockopt(g_Udp.sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0 ) {
+            perror("join group");
+            return( 1 );
+        }
+    }
+
+    g_Tcp.sock  = socket(AF_INET, SOCK_STREAM, 0);      // TCP tunnel
+    gw.sin_port = htons(tcp_port);
+    if( connect(g_Tcp.sock, (struct sockaddr*)&gw, sizeof(gw)) < 0 ) {
+        perror("connect TCP tunnel");
+        return( 1 );
+    }
+    setsockopt(g_Tcp.sock, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    gw.sin_port = htons(udp_port);
+
+    req[0] = (uint8_t)(req_len >> 8);                   // Record of the TCP tunnel, TIMESTAMP ignored
+    req[1] = (uint8_t)(req_len);
+    memset(&req[2], 0, 4);
+    fds[0].fd = g_Udp.sock;   fds[0].events = POLLIN;
+    fds[1].fd = g_Tcp.sock;   fds[1].events = POLLIN;
+    start = tick = next_req = tput_now();
+    for(now = start;  (now - start) < (uint64_t)secs * 1000000u;  now = tput_now()) {
+        if( (req_len > 0) && (pps > 0) && (now >= next_req) ) {
+            if( tcp_load ) {
+                n = send(g_Tcp.sock, req, TUNNEL_HDR_LEN + req_len, 0);
+            } else {
+                n = sendto(g_Udp.sock, &req[TUNNEL_HDR_LEN], req_len, 0, (struct sockaddr*)&gw, sizeof(gw));
+            }
+            if( n < 0 ) {
+                perror("send");
+            }
+            next_req += 1000000u / pps;
+        }
+        poll(fds, 2, (req_len && pps) ? ((next_req > now) ? (int)((next_req - now) / 1000) : 0) : 100);
+        tput_udp(&g_Udp);
+        if( tput_tcp(&g_Tcp) < 0 ) {
+            fprintf(stderr, "TCP tunnel closed by the gateway\n");
+            break;
+        }
+        if( (now - tick) >= 1000000u ) {
+            tput_print("1s", &g_Udp.sec, &g_Tcp.sec, (now - tick) / 1e6);
+            memset(&g_Udp.sec, 0, sizeof(g_Udp.sec));
+            memset(&g_Tcp.sec, 0, sizeof(g_Tcp.sec));
+            tick = now;
+        }
+    }
+    tput_print("Total", &g_Udp.sum, &g_Tcp.sum, (tput_now() - start) / 1e6);
+    if( g_Udp.sum.frames > 0 ) {
+        printf("TCP/UDP frames: %.3f\n", (double)g_Tcp.sum.frames / g_Udp.sum.frames);
+    }
+    close(g_Tcp.sock);
+    close(g_Udp.sock);
+    return( 0 );
+}
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+***********************************************************************************************************/
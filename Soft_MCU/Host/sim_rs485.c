@@ -0,0 +1,457 @@
+/**********************************************************************************************************/
+/** @file     sim_rs485.c
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    Simulated RS485 line of the host: the UART driver of ProfiBUS_DP.c, the slaves scripted and
+***           the traffic of another master.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************
+***   ProfiBUS_DP.c is built with PBDP_UART_SIM, the driver half of USART6 and TIM3 replaced by this file.
+***   A thread of the line takes the place of the interrupts: the chars are paced at the baud rate by
+***   CLOCK_MONOTONIC and given to the UART callbacks, the echo of the chars sent as well, then the IDLE
+***   events every char of idle time, or at the end of the bits of PBDP_UART_IdleWait(), as TIM3 does.
+***   PBDP_UART_DsIRQ() and __disable_irq() take the IRQ lock held by the thread of the line.
+***
+***   The slaves of the addresses scripted answer the requests with reply after Tsdr bits: SC to SD1,
+***   and SD2 of the data of the request to SD2. The other master sends a SD1 request to the first slave
+***   every cycle, after two chars of idle time, before the gateway is allowed to send after Tid1. The
+***   timing is the one of the line, the callbacks are late by the wakeup of the thread on the host.
+***********************************************************************************************************/
+
+#define     _GNU_SOURCE                 /* PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP */
+#include    <stdlib.h>
+#include    <stdint.h>
+#include    <stdio.h>
+#include    <string.h>
+#include    <pthread.h>
+#include    <time.h>
+#include    <sys/prctl.h>
+
+#include    "cmsis_os.h"
+#include    "stm32f4xx.h"
+#include    "board.h"
+#include    "ProfiBUS_DP.h"
+#include    "sim_rs485.h"
+
+
+/**********************************************************************************************************/
+/** @addtogroup SIM_RS485
+*** @{
+*** @addtogroup SIM_RS485_Pravate
+*** @{
+*** @addtogroup                 SIM_RS485_Private_Constants
+*** @{
+***********************************************************************************************************/
+
+#define SIM_EVENT_IDLE      (0x1u << 1)             /* ref: PBDP_EVENT_xxx of ProfiBUS_DP.c     */
+#define SIM_EVENT_CPLT      (0x1u << 2)
+
+#define SIM_CHAR_BITS       11                      /* Bits of a UART char                      */
+#define SIM_FRAME_NUM       4                       /* Frames of the slaves waiting for the line*/
+#define SIM_NEVER           UINT64_MAX              /* No event                                 */
+
+#define SIM_FROM_GW         0                       /* Char of the gateway                      */
+#define SIM_FROM_SLAVE      1                       /* Char of a slave                          */
+#define SIM_FROM_OTHER      2                       /* Char of the other master                 */
+
+#define SIM_FC_SRD_LOW      0x4C                    /* FC of the other master, SRD low          */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 SIM_RS485_Private_Types
+*** @{
+***********************************************************************************************************/
+
+typedef struct {    /*------------- Frame waiting for the line --------------------------------------------*/
+    uint64_t                    start;      /* Time(ns) of the first char       */
+    int                         from;       /* SIM_FROM_xxx                     */
+    int                         len;
+    int                         pos;        /* Next char to the line            */
+    uint8_t                     data[260];
+} SIM_FRAME;
+
+typedef struct {    /*------------- Line (Run-Time), with the IRQ lock held ------------------------------*/
+    uint32_t                    baud;
+    uint64_t                    now;        /* Time(ns) of the event            */
+    uint64_t                    last;       /* End of the last char             */
+    uint64_t                    end;        /* End of the char on the line, SIM_NEVER for none  */
+    uint64_t                    idle;       /* Next IDLE event, SIM_NEVER while a char on the line  */
+    uint64_t                    wait;       /* End of the bits of PBDP_UART_IdleWait(), (0)None */
+    uint64_t                    other;      /* Next cycle of the other master   */
+    int                         ch;         /* Char on the line                 */
+    int                         from;       /* SIM_FROM_xxx of the char         */
+    int                         txe;        /* TXE interrupt enabled            */
+    int                         den;        /* RS485 DE-Pin of the gateway      */
+    int                         req_len;    /* Chars of the request of a master */
+    uint8_t                     req[260];
+    SIM_FRAME                   out[SIM_FRAME_NUM];
+    uint32_t                    out_head;
+    uint32_t                    out_tail;
+    SIM_RS485_CFG               cfg;
+    SIM_RS485_STAT              stat;
+} SIM_LINE;
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 SIM_RS485_Private_Variables
+*** @{
+***********************************************************************************************************/
+
+uint32_t                    SystemCoreClock = 168000000;
+
+static pthread_mutex_t      g_SimIrq = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+static __thread uint32_t    g_SimMask;              /* PRIMASK of the thread                    */
+static SIM_LINE             g_Sim;
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 SIM_RS485_Private_Functions
+*** @{
+***********************************************************************************************************/
+/** @brief      Time(ns) of CLOCK_MONOTONIC, the time of the bits on the line and the bits of idle time.
+***********************************************************************************************************/
+
+static uint64_t sim_ns(void)
+{
+    struct timespec     ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return( (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec );
+}
+
+static uint64_t sim_bits(uint32_t bits)
+{
+    return( (uint64_t)bits * 1000000000u / g_Sim.baud );
+}
+
+static uint32_t sim_idle_bits(void)
+{
+    return( (uint32_t)(((g_Sim.now - g_Sim.last) * g_Sim.baud + 500000000u) / 1000000000u) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Timestamps of the board, ref: board.h.
+***********************************************************************************************************/
+
+uint32_t bsp_timestamp(void)
+{
+    return( (uint32_t)(sim_ns() / 1000) );
+}
+
+uint32_t bsp_cycles(void)
+{
+    return( (uint32_t)(sim_ns() * (SystemCoreClock / 1000000) / 1000) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      IRQ lock: the interrupts masked by __disable_irq() and PBDP_UART_DsIRQ().
+***********************************************************************************************************/
+
+uint32_t sim_irq_primask(void)
+{
+    return( g_SimMask );
+}
+
+void sim_irq_disable(void)
+{
+    if( !g_SimMask ) {
+        pthread_mutex_lock(&g_SimIrq);
+        g_SimMask = 1;
+    }
+}
+
+void sim_irq_restore(uint32_t primask)
+{
+    if( g_SimMask && !primask ) {
+        g_SimMask = 0;
+        pthread_mutex_unlock(&g_SimIrq);
+    }
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Start a char on the line.
+***********************************************************************************************************/
+
+static void sim_char_start(int ch, int from)
+{
+    if( g_Sim.now > g_Sim.last ) {
+        g_Sim.req_len = 0;                              // Idle before, a frame starts
+    }
+    g_Sim.ch   = ch;
+    g_Sim.from = from;
+    g_Sim.end  = g_Sim.now + sim_bits(SIM_CHAR_BITS);
+    g_Sim.idle = SIM_NEVER;                             // Edge on the line, no idle time
+    g_Sim.wait = 0;
+    g_Sim.stat.chars++;
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Next char of the gateway, the TXE interrupt.
+***********************************************************************************************************/
+
+static void sim_gw_char(void)
+{
+    int     ch;
+
+    if( (ch = PBDP_UART_SendCB()) >= 0 ) {
+        sim_char_start(ch & 0xFF, SIM_FROM_GW);
+    } else {
+        PBDP_UART_EventCB(SIM_EVENT_CPLT);              // Transmission complete
+    }
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Response of a slave scripted to the request of a master, after Tsdr bits.
+***********************************************************************************************************/
+
+static void sim_slave_request(int from)
+{
+    const uint8_t  *req = g_Sim.req;
+    SIM_FRAME      *f;
+    int             da, fc, i;
+    uint8_t         fcs;
+
+    switch( req[0] ) {
+    case 0x10:  da = req[1] & 0x7F;  fc = req[3];  break;
+    case 0x68:  da = req[4] & 0x7F;  fc = req[6];  break;
+    default:    return;                                 // SD3 with no reply, SD4, SC
+    }
+    if( !(fc & 0x40) || ((fc & 0x4F) == 0x44) || ((fc & 0x4F) == 0x46) || (da == 127) ) {
+        return;                                         // Not a request with reply
+    }
+    if( (da < g_Sim.cfg.first) || (da > g_Sim.cfg.last) ) {
+        return;                                         // No such slave
+    }
+    if( (g_Sim.out_head - g_Sim.out_tail) >= SIM_FRAME_NUM ) {
+        return;
+    }
+    f = &g_Sim.out[g_Sim.out_head % SIM_FRAME_NUM];
+    f->start = g_Sim.last + sim_bits(g_Sim.cfg.tsdr);
+    f->from  = SIM_FROM_SLAVE;
+    f->pos   = 0;
+    if( req[0] == 0x10 ) {
+        f->data[0] = 0xE5;                              // SC
+        f->len     = 1;
+    } else {
+        memcpy(f->data, req, req[1] + 6);               // SD2 of the data of the request
+        f->data[4] = req[5];
+        f->data[5] = req[4];
+        f->data[6] = 0x08;                              // Response, data low
+        if( (req[4] & 0x80) && (req[5] & 0x80) ) {
+            f->data[7] = req[8];                        // SAPs swapped
+            f->data[8] = req[7];
+        }
+        for(fcs = 0, i = 4;  i < (req[1] + 4);  i++) {
+            fcs += f->data[i];
+        }
+        f->data[req[1] + 4] = fcs;
+        f->len = req[1] + 6;
+    }
+    g_Sim.out_head++;
+    g_Sim.stat.req  += (from == SIM_FROM_GW);
+    g_Sim.stat.resp += 1;
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Char of a master seen by the slaves, the request assembled by the SD and the length.
+***********************************************************************************************************/
+
+static void sim_slave_char(int ch, int from)
+{
+    int     need;
+
+    if( (g_Sim.req_len == 0) && (ch != 0x10) && (ch != 0x68) && (ch != 0xA2) && (ch != 0xDC) ) {
+        return;
+    }
+    if( g_Sim.req_len < (int)sizeof(g_Sim.req) ) {
+        g_Sim.req[g_Sim.req_len++] = (uint8_t)ch;
+    }
+    switch( g_Sim.req[0] ) {
+    case 0x10:  need = 6;                                               break;
+    case 0x68:  need = (g_Sim.req_len >= 2) ? (g_Sim.req[1] + 6) : (0); break;
+    case 0xA2:  need = 14;                                              break;
+    default:    need = 3;                                               break;
+    }
+    if( need && (g_Sim.req_len >= need) ) {
+        sim_slave_request(from);
+        g_Sim.req_len = 0;
+    }
+}
+
+
+/**********************************************************************************************************/
+/** @brief      End of the char on the line: RXNE, then TXE of the next char if the gateway is sending.
+***********************************************************************************************************/
+
+static void sim_char_end(void)
+{
+    int     ch = g_Sim.ch, from = g_Sim.from;
+
+    g_Sim.last = g_Sim.end;
+    g_Sim.end  = SIM_NEVER;
+    g_Sim.idle = g_Sim.last + sim_bits(SIM_CHAR_BITS); // USART IDLE after a char of idle time
+    PBDP_UART_RecvCB(ch);
+    if( from != SIM_FROM_SLAVE ) {
+        sim_slave_char(ch, from);
+    }
+    if( (from == SIM_FROM_GW) && g_Sim.txe ) {
+        sim_gw_char();                                  // Back to back
+    }
+}
+
+
+/**********************************************************************************************************/
+/** @brief      IDLE event: USART IDLE or TIM3 update, the other master started after two chars of idle.
+***********************************************************************************************************/
+
+static void sim_idle(void)
+{
+    SIM_FRAME  *f;
+    uint8_t     da = g_Sim.cfg.first, sa = g_Sim.cfg.other;
+
+    PBDP_UART_EventCB(SIM_EVENT_IDLE);
+    if( g_Sim.txe ) {
+        sim_gw_char();                                  // Transmit started after the idle bits
+        return;
+    }
+    if(    g_Sim.cfg.other && !g_Sim.den && (g_Sim.now >= g_Sim.other) && (g_Sim.out_head == g_Sim.out_tail)
+        && (sim_idle_bits() >= (2 * SIM_CHAR_BITS)) ) {
+        f = &g_Sim.out[g_Sim.out_head++ % SIM_FRAME_NUM];
+        f->start   = g_Sim.now;                         // SD1 request, SRD low
+        f->from    = SIM_FROM_OTHER;
+        f->pos     = 0;
+        f->data[0] = 0x10;  f->data[1] = da;  f->data[2] = sa;  f->data[3] = SIM_FC_SRD_LOW;
+        f->data[4] = (uint8_t)(da + sa + SIM_FC_SRD_LOW);  f->data[5] = 0x16;
+        f->len     = 6;
+        g_Sim.other = g_Sim.now + (uint64_t)g_Sim.cfg.period * 1000;
+        g_Sim.stat.other++;
+    }
+    g_Sim.idle = (g_Sim.wait > g_Sim.now) ? (g_Sim.wait) : (g_Sim.now + sim_bits(SIM_CHAR_BITS));
+    g_Sim.wait = 0;
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Thread of the line, in place of the USART6 and TIM3 interrupts.
+***********************************************************************************************************/
+
+static void* sim_line(void *arg)
+{
+    struct timespec     ts;
+    SIM_FRAME          *f;
+    uint64_t            t, out;
+
+    prctl(PR_SET_TIMERSLACK, 1);                        // Wakeup on time, not grouped by the kernel
+    pthread_mutex_lock(&g_SimIrq);
+    for(;;) {
+        out = SIM_NEVER;
+        if( (g_Sim.end == SIM_NEVER) && (g_Sim.out_head != g_Sim.out_tail) ) {
+            f   = &g_Sim.out[g_Sim.out_tail % SIM_FRAME_NUM];
+            out = ((f->pos == 0) && (f->start > g_Sim.last)) ? (f->start) : (g_Sim.last);
+        }
+        t = (g_Sim.end != SIM_NEVER) ? (g_Sim.end) : ((g_Sim.idle <= out) ? (g_Sim.idle) : (out));
+        pthread_mutex_unlock(&g_SimIrq);
+        ts.tv_sec  = t / 1000000000u;
+        ts.tv_nsec = t % 1000000000u;
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+        pthread_mutex_lock(&g_SimIrq);
+
+        g_Sim.now = t;
+        if( t == g_Sim.end ) {
+            sim_char_end();
+        } else if( t == g_Sim.idle ) {
+            sim_idle();
+        } else {
+            f = &g_Sim.out[g_Sim.out_tail % SIM_FRAME_NUM];
+            sim_char_start(f->data[f->pos++], f->from);
+            if( f->pos >= f->len ) {
+                g_Sim.out_tail++;
+            }
+        }
+    }
+    return( arg );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      UART driver of ProfiBUS_DP.c, ref: ProfiBUS_DP.h.
+***********************************************************************************************************/
+
+void PBDP_UART_Init(uint32_t BaudRate)
+{
+    pthread_t   tid;
+
+    g_Sim.baud  = BaudRate;
+    g_Sim.now   = g_Sim.last = sim_ns();
+    g_Sim.end   = SIM_NEVER;
+    g_Sim.idle  = g_Sim.now + sim_bits(SIM_CHAR_BITS);
+    g_Sim.other = g_Sim.now;
+    if( pthread_create(&tid, NULL, sim_line, NULL) == 0 ) {
+        pthread_detach(tid);
+    }
+}
+
+int PBDP_UART_IdleWait(uint32_t bits)
+{
+    uint32_t    idle = sim_idle_bits();
+
+    if( idle >= bits ) {
+        return( 0 );
+    }
+    g_Sim.wait = g_Sim.last + sim_bits(bits);           // IDLE event at the end of the bits
+    return( bits - idle );
+}
+
+void PBDP_UART_EnDEN(void)  {  g_Sim.den = 1;  }
+void PBDP_UART_DsDEN(void)  {  g_Sim.den = 0;  }
+void PBDP_UART_EnTXE(void)  {  g_Sim.txe = 1;  }
+void PBDP_UART_DsTXE(void)  {  g_Sim.txe = 0;  }
+void PBDP_UART_EnIRQ(void)  {  pthread_mutex_unlock(&g_SimIrq);  }
+void PBDP_UART_DsIRQ(void)  {  pthread_mutex_lock(&g_SimIrq);    }
+
+
+/**********************************************************************************************************/
+/** @brief      Script of the line, set before PBDP_Init().
+***********************************************************************************************************/
+
+void sim_rs485_config(const SIM_RS485_CFG *cfg)
+{
+    memcpy(&g_Sim.cfg, cfg, sizeof(g_Sim.cfg));
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Counters of the line.
+***********************************************************************************************************/
+
+void sim_rs485_stat(SIM_RS485_STAT *stat)
+{
+    pthread_mutex_lock(&g_SimIrq);
+    memcpy(stat, &g_Sim.stat, sizeof(*stat));
+    pthread_mutex_unlock(&g_SimIrq);
+}
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+*** @}
+***********************************************************************************************************/
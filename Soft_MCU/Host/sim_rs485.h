@@ -0,0 +1,66 @@
+/**********************************************************************************************************/
+/** @file     sim_rs485.h
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    Simulated RS485 line of the host: the UART driver of ProfiBUS_DP.c, the slaves scripted and
+***           the traffic of another master.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************/
+#ifndef __SIM_RS485_H___20261018_221500
+#define __SIM_RS485_H___20261018_221500
+#ifdef  __cplusplus
+extern  "C"
+{
+#endif
+/**********************************************************************************************************/
+/** @addtogroup SIM_RS485
+*** @{
+*** @addtogroup                 SIM_RS485_Exported_Types
+*** @{
+***********************************************************************************************************/
+
+typedef struct {    /*------------- Script of the line, set before PBDP_Init() ----------------------------*/
+    uint32_t                    tsdr;       /* Tsdr(bits) of the slaves         */
+    uint8_t                     first;      /* First address of the slaves      */
+    uint8_t                     last;       /* Last  address of the slaves      */
+    uint8_t                     other;      /* Address of the other master, (0)None */
+    uint8_t                     rsv;        /* Reserved                         */
+    uint32_t                    period;     /* Cycle(us) of the other master    */
+} SIM_RS485_CFG;
+
+typedef struct {    /*------------- Counters of the line ----------------------------------------------*/
+    uint32_t                    chars;      /* Chars on the line                */
+    uint32_t                    req;        /* Requests of the gateway to the slaves    */
+    uint32_t                    resp;       /* Responses of the slaves          */
+    uint32_t                    other;      /* Requests of the other master     */
+} SIM_RS485_STAT;
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 SIM_RS485_Exported_Functions
+*** @{
+***********************************************************************************************************/
+
+extern void sim_rs485_config(const SIM_RS485_CFG *cfg);
+extern void sim_rs485_stat(SIM_RS485_STAT *stat);
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+*****/
+#ifdef  __cplusplus
+}
+#endif
+#endif
+/**********************************************************************************************************/
@@ -0,0 +1,259 @@
+/**********************************************************************************************************/
+/** @file     cmsis_os.c
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    Host stub of the CMSIS-RTOS API used by the modules under test, over the POSIX threads.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************
+***   The signal flags are kept by a control block of the calling thread, created on the first use, so
+***   the threads of the host are created by pthread_create(). The mutexes are recursive as of RTX, the
+***   timeouts are of CLOCK_MONOTONIC.
+***********************************************************************************************************/
+
+#include    <stdlib.h>
+#include    <stdint.h>
+#include    <errno.h>
+#include    <pthread.h>
+#include    <time.h>
+
+#include    "cmsis_os.h"
+
+
+/**********************************************************************************************************/
+/** @addtogroup CMSIS_OS_STUB
+*** @{
+*** @addtogroup                 CMSIS_OS_STUB_Private_Types
+*** @{
+***********************************************************************************************************/
+
+struct os_thread_cb {   /*--------- Signal flags of a thread ------------------------------------------*/
+    pthread_mutex_t             mut;
+    pthread_cond_t              cond;
+    int32_t                     signals;
+};
+
+struct os_mutex_cb {    /*--------- Recursive mutex -----------------------------------------------------*/
+    pthread_mutex_t             mut;
+};
+
+struct os_semaphore_cb {/*--------- Counting semaphore --------------------------------------------------*/
+    pthread_mutex_t             mut;
+    pthread_cond_t              cond;
+    int32_t                     count;
+};
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 CMSIS_OS_STUB_Private_Variables
+*** @{
+***********************************************************************************************************/
+
+static __thread struct os_thread_cb    *g_OsSelf;   /* Control block of the calling thread      */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 CMSIS_OS_STUB_Private_Functions
+*** @{
+***********************************************************************************************************/
+/** @brief      Condition variable of CLOCK_MONOTONIC.
+***********************************************************************************************************/
+
+static void os_cond_init(pthread_cond_t *cond)
+{
+    pthread_condattr_t  attr;
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Wait for a condition variable, (millisec) from now.
+***
+*** @return     (0)Signaled, (ETIMEDOUT)Timeout.
+***********************************************************************************************************/
+
+static int os_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mut, uint32_t millisec)
+{
+    struct timespec     ts;
+
+    if( millisec == osWaitForever ) {
+        return( pthread_cond_wait(cond, mut) );
+    }
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ts.tv_sec  += millisec / 1000;
+    ts.tv_nsec += (long)(millisec % 1000) * 1000000L;
+    if( ts.tv_nsec >= 1000000000L ) {
+        ts.tv_sec  += 1;
+        ts.tv_nsec -= 1000000000L;
+    }
+    return( pthread_cond_timedwait(cond, mut, &ts) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Thread ID of the calling thread, its control block created on the first call.
+***********************************************************************************************************/
+
+osThreadId osThreadGetId(void)
+{
+    if( g_OsSelf == NULL ) {
+        g_OsSelf = calloc(1, sizeof(*g_OsSelf));
+        pthread_mutex_init(&g_OsSelf->mut, NULL);
+        os_cond_init(&g_OsSelf->cond);
+    }
+    return( g_OsSelf );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Signal flags of a thread, set, cleared and waited for.
+***********************************************************************************************************/
+
+int32_t osSignalSet(osThreadId thread_id, int32_t signals)
+{
+    int32_t     prev;
+
+    pthread_mutex_lock(&thread_id->mut);
+    prev = thread_id->signals;
+    thread_id->signals |= signals;
+    pthread_cond_broadcast(&thread_id->cond);
+    pthread_mutex_unlock(&thread_id->mut);
+    return( prev );
+}
+
+int32_t osSignalClear(osThreadId thread_id, int32_t signals)
+{
+    int32_t     prev;
+
+    pthread_mutex_lock(&thread_id->mut);
+    prev = thread_id->signals;
+    thread_id->signals &= ~signals;
+    pthread_mutex_unlock(&thread_id->mut);
+    return( prev );
+}
+
+osEvent osSignalWait(int32_t signals, uint32_t millisec)
+{
+    osThreadId  self = osThreadGetId();
+    osEvent     evt;
+
+    pthread_mutex_lock(&self->mut);
+    while( (signals == 0) ? (self->signals == 0) : ((self->signals & signals) != signals) ) {
+        if( (millisec == 0) || (os_cond_wait(&self->cond, &self->mut, millisec) == ETIMEDOUT) ) {
+            break;
+        }
+    }
+    if( (signals == 0) ? (self->signals != 0) : ((self->signals & signals) == signals) ) {
+        evt.status        = osEventSignal;
+        evt.value.signals = (signals == 0) ? (self->signals) : (signals);
+        self->signals    &= ~evt.value.signals;
+    } else {
+        evt.status        = osEventTimeout;
+        evt.value.signals = 0;
+    }
+    pthread_mutex_unlock(&self->mut);
+    return( evt );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Mutexes, recursive.
+***********************************************************************************************************/
+
+osMutexId osMutexCreate(const osMutexDef_t *mutex_def)
+{
+    osMutexId           mutex = calloc(1, sizeof(*mutex));
+    pthread_mutexattr_t attr;
+
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&mutex->mut, &attr);
+    pthread_mutexattr_destroy(&attr);
+    return( mutex );
+}
+
+osStatus osMutexWait(osMutexId mutex_id, uint32_t millisec)
+{
+    return( (pthread_mutex_lock(&mutex_id->mut) == 0) ? (osOK) : (osErrorOS) );
+}
+
+osStatus osMutexRelease(osMutexId mutex_id)
+{
+    return( (pthread_mutex_unlock(&mutex_id->mut) == 0) ? (osOK) : (osErrorResource) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Semaphores, osSemaphoreWait() returns the tokens available before taken, or 0 if timeout.
+***********************************************************************************************************/
+
+osSemaphoreId osSemaphoreCreate(const osSemaphoreDef_t *semaphore_def, int32_t count)
+{
+    osSemaphoreId   sem = calloc(1, sizeof(*sem));
+
+    pthread_mutex_init(&sem->mut, NULL);
+    os_cond_init(&sem->cond);
+    sem->count = count;
+    return( sem );
+}
+
+int32_t osSemaphoreWait(osSemaphoreId semaphore_id, uint32_t millisec)
+{
+    int32_t     count = 0;
+
+    pthread_mutex_lock(&semaphore_id->mut);
+    while( semaphore_id->count == 0 ) {
+        if( (millisec == 0) || (os_cond_wait(&semaphore_id->cond, &semaphore_id->mut, millisec) == ETIMEDOUT) ) {
+            break;
+        }
+    }
+    if( semaphore_id->count > 0 ) {
+        count = semaphore_id->count--;
+    }
+    pthread_mutex_unlock(&semaphore_id->mut);
+    return( count );
+}
+
+osStatus osSemaphoreRelease(osSemaphoreId semaphore_id)
+{
+    pthread_mutex_lock(&semaphore_id->mut);
+    semaphore_id->count++;
+    pthread_cond_signal(&semaphore_id->cond);
+    pthread_mutex_unlock(&semaphore_id->mut);
+    return( osOK );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Delay of the calling thread.
+***********************************************************************************************************/
+
+osStatus osDelay(uint32_t millisec)
+{
+    struct timespec     ts;
+
+    ts.tv_sec  = millisec / 1000;
+    ts.tv_nsec = (long)(millisec % 1000) * 1000000L;
+    nanosleep(&ts, NULL);
+    return( osEventTimeout );
+}
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+***********************************************************************************************************/
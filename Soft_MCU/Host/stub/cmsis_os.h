@@ -0,0 +1,64 @@
+/**********************************************************************************************************/
+/** @file     cmsis_os.h
+*** @brief    Host stub of the CMSIS-RTOS API used by the modules under test, over the POSIX threads.
+***********************************************************************************************************/
+#ifndef __CMSIS_OS_H___HOST_STUB
+#define __CMSIS_OS_H___HOST_STUB
+
+#include    <stdint.h>
+
+typedef enum {
+    osOK                    = 0,
+    osEventSignal           = 0x08,
+    osEventTimeout          = 0x40,
+    osErrorResource         = 0x81,
+    osErrorOS               = 0xFF
+} osStatus;
+
+typedef enum {
+    osPriorityIdle          = -3,
+    osPriorityLow           = -2,
+    osPriorityBelowNormal   = -1,
+    osPriorityNormal        =  0,
+    osPriorityAboveNormal   = +1,
+    osPriorityHigh          = +2,
+    osPriorityRealtime      = +3
+} osPriority;
+
+typedef struct os_thread_cb    *osThreadId;
+typedef struct os_mutex_cb     *osMutexId;
+typedef struct os_semaphore_cb *osSemaphoreId;
+
+typedef struct { int dummy; }   osMutexDef_t;
+typedef struct { int dummy; }   osSemaphoreDef_t;
+
+typedef struct {
+    osStatus                    status;
+    union {
+        uint32_t                v;
+        void                   *p;
+        int32_t                 signals;
+    }                           value;
+} osEvent;
+
+#define osWaitForever           0xFFFFFFFFu
+
+#define osMutexDef(name)        const osMutexDef_t      os_mutex_def_##name     = { 0 }
+#define osMutex(name)           (&os_mutex_def_##name)
+#define osSemaphoreDef(name)    const osSemaphoreDef_t  os_semaphore_def_##name = { 0 }
+#define osSemaphore(name)       (&os_semaphore_def_##name)
+
+extern osThreadId       osThreadGetId(void);
+extern int32_t          osSignalSet(osThreadId thread_id, int32_t signals);
+extern int32_t          osSignalClear(osThreadId thread_id, int32_t signals);
+extern osEvent          osSignalWait(int32_t signals, uint32_t millisec);
+extern osMutexId        osMutexCreate(const osMutexDef_t *mutex_def);
+extern osStatus         osMutexWait(osMutexId mutex_id, uint32_t millisec);
+extern osStatus         osMutexRelease(osMutexId mutex_id);
+extern osSemaphoreId    osSemaphoreCreate(const osSemaphoreDef_t *semaphore_def, int32_t count);
+extern int32_t          osSemaphoreWait(osSemaphoreId semaphore_id, uint32_t millisec);
+extern osStatus         osSemaphoreRelease(osSemaphoreId semaphore_id);
+extern osStatus         osDelay(uint32_t millisec);
+
+#endif
+/**********************************************************************************************************/
@@ -0,0 +1,14 @@
+/**********************************************************************************************************/
+/** @file     rl_net.h
+*** @brief    Host stub of the RL-TCPnet definitions used by the modules under test.
+***********************************************************************************************************/
+#ifndef __RL_NET_H___HOST_STUB
+#define __RL_NET_H___HOST_STUB
+
+#include    <stdint.h>
+#include    <arpa/inet.h>
+
+extern int  ip4_aton(const char *cp, uint8_t *ip4_addr);
+
+#endif
+/**********************************************************************************************************/
@@ -0,0 +1,34 @@
+/**********************************************************************************************************/
+/** @file     stm32f4xx.h
+*** @brief    Host stub of the Cortex-M intrinsics used by the modules under test, the interrupts of the
+***           simulated UART masked by the IRQ lock of sim_rs485.c.
+***********************************************************************************************************/
+#ifndef __STM32F4XX_H___HOST_STUB
+#define __STM32F4XX_H___HOST_STUB
+
+#include    <stdint.h>
+
+extern uint32_t             SystemCoreClock;
+
+extern uint32_t             sim_irq_primask(void);
+extern void                 sim_irq_disable(void);
+extern void                 sim_irq_restore(uint32_t primask);
+
+static __thread uint32_t    g_StubExclusive;        /* Value of the last __LDREXW()             */
+
+static inline uint32_t __LDREXW(volatile uint32_t *addr)
+{
+    return( g_StubExclusive = *addr );
+}
+
+static inline uint32_t __STREXW(uint32_t value, volatile uint32_t *addr)
+{
+    return( !__sync_bool_compare_and_swap(addr, g_StubExclusive, value) );
+}
+
+#define __get_PRIMASK()     sim_irq_primask()
+#define __disable_irq()     sim_irq_disable()
+#define __set_PRIMASK(x)    sim_irq_restore(x)
+
+#endif
+/**********************************************************************************************************/
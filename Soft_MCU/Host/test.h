@@ -0,0 +1,46 @@
+/**********************************************************************************************************/
+/** @file     test.h
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    Checks of the host tests, a failed check printed and counted.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************/
+#ifndef __TEST_H___20261019_101500
+#define __TEST_H___20261019_101500
+#ifdef  __cplusplus
+extern  "C"
+{
+#endif
+/**********************************************************************************************************/
+/** @addtogroup TEST
+*** @{
+*** @addtogroup                 TEST_Exported_Macros
+*** @{
+***********************************************************************************************************/
+
+static int                  g_TestFail;             /* Checks failed                            */
+static int                  g_TestPass;             /* Checks passed                            */
+
+#define TEST_CHECK(expr)    ( (expr) ? (void)g_TestPass++                                               \
+                                     : (void)(g_TestFail++, printf("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #expr)) )
+#define TEST_RESULT()       ( printf("  %d checks passed, %d failed\n", g_TestPass, g_TestFail), (g_TestFail != 0) )
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+*****/
+#ifdef  __cplusplus
+}
+#endif
+#endif
+/**********************************************************************************************************/
@@ -0,0 +1,280 @@
+/**********************************************************************************************************/
+/** @file     test_dp_delta.c
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    Host test: round trip of the delta encoding over the sample capture of the bus.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************
+*** Usage: test_dp_delta [capture]
+***
+***   The capture is the hex dump of the bus, "ProfiBUS-DP数据实例.txt" at the root of the repository by
+***   default. The frames are split by the start delimiter and checked (LE, FCS, ED), then passed through
+***   dp_delta_encode() and dp_delta_decode() as thread_dp2net and the peer thread_net2dp do.
+***********************************************************************************************************/
+
+#include    <stdlib.h>
+#include    <stdint.h>
+#include    <stdio.h>
+#include    <string.h>
+#include    <ctype.h>
+
+#include    "dp_delta.h"
+#include    "test.h"
+
+
+/**********************************************************************************************************/
+/** @addtogroup TEST_DP_DELTA
+*** @{
+*** @addtogroup                 TEST_DP_DELTA_Private_Constants
+*** @{
+***********************************************************************************************************/
+
+#define CAPTURE_FILE        "../../ProfiBUS-DP\xE6\x95\xB0\xE6\x8D\xAE\xE5\xAE\x9E\xE4\xBE\x8B.txt"
+#define CAPTURE_MAX         8192                    /* Max bytes of the capture                 */
+#define FRAME_NUM_MAX       2048                    /* Max frames of the capture                */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 TEST_DP_DELTA_Private_Types
+*** @{
+***********************************************************************************************************/
+
+typedef struct {    /*------------- Frame of the capture -------------------------------------------*/
+    const uint8_t              *data;
+    int                         len;
+} CAP_FRAME;
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 TEST_DP_DELTA_Private_Variables
+*** @{
+***********************************************************************************************************/
+
+static uint8_t              g_Cap[CAPTURE_MAX];
+static CAP_FRAME            g_Frame[FRAME_NUM_MAX];
+static int                  g_FrameNum;
+static DP_DELTA_CTX         g_Enc;
+static DP_DELTA_CTX         g_Dec;
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 TEST_DP_DELTA_Private_Functions
+*** @{
+***********************************************************************************************************/
+/** @brief      Read the hex bytes of the capture, the words not of two hex digits skipped.
+***
+*** @return     Bytes read, (< 0)File not found.
+***********************************************************************************************************/
+
+static int cap_read(const char *path)
+{
+    FILE       *fp;
+    char        word[64];
+    int         n = 0;
+
+    if( (fp = fopen(path, "r")) == NULL ) {
+        return( -1 );
+    }
+    while( (n < CAPTURE_MAX) && (fscanf(fp, "%63s", word) == 1) ) {
+        if( (strlen(word) == 2) && isxdigit((unsigned char)word[0]) && isxdigit((unsigned char)word[1]) ) {
+            g_Cap[n++] = (uint8_t)strtoul(word, NULL, 16);
+        }
+    }
+    fclose(fp);
+    return( n );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Length of the frame at the start delimiter, checked by LE, FCS and ED.
+***
+*** @return     Length of the frame, (0)Not a valid frame.
+***********************************************************************************************************/
+
+static int cap_frame(const uint8_t *p, int rest)
+{
+    int         len, fcs_at, fcs_from, i;
+    uint8_t     fcs;
+
+    switch( p[0] ) {
+    case 0xE5:  return( 1 );                            // SC
+    case 0xDC:  return( (rest >= 3) ? (3) : (0) );      // SD4
+    case 0x10:  len = 6;   fcs_from = 1;  break;        // SD1
+    case 0xA2:  len = 14;  fcs_from = 1;  break;        // SD3
+    case 0x68:                                          // SD2
+        if( (rest < 4) || (p[1] != p[2]) || (p[3] != 0x68) ) {
+            return( 0 );
+        }
+        len = p[1] + 6;  fcs_from = 4;
+        break;
+    default:    return( 0 );
+    }
+    if( (rest < len) || (p[len - 1] != 0x16) ) {
+        return( 0 );
+    }
+    fcs_at = len - 2;
+    for(fcs = 0, i = fcs_from;  i < fcs_at;  i++) {
+        fcs += p[i];
+    }
+    return( (fcs == p[fcs_at]) ? (len) : (0) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Split the capture into the frames, the bytes not of a valid frame skipped.
+***
+*** @return     Bytes skipped.
+***********************************************************************************************************/
+
+static int cap_split(int size)
+{
+    int         pos, len, skip = 0;
+
+    for(pos = 0;  (pos < size) && (g_FrameNum < FRAME_NUM_MAX);  pos += len) {
+        if( (len = cap_frame(&g_Cap[pos], size - pos)) == 0 ) {
+            len = 1;
+            skip++;
+            continue;
+        }
+        g_Frame[g_FrameNum].data = &g_Cap[pos];
+        g_Frame[g_FrameNum].len  = len;
+        g_FrameNum++;
+    }
+    return( skip );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Round trip of all the frames, every record decoded.
+***********************************************************************************************************/
+
+static void test_roundtrip(void)
+{
+    uint8_t     rec[DP_DELTA_HDR_LEN + DP_DELTA_FRAME_MAX + 16];
+    uint8_t     out[DP_DELTA_FRAME_MAX + 16];
+    int         i, rlen, olen, bad = 0;
+
+    dp_delta_init(&g_Enc, 100);
+    dp_delta_init(&g_Dec, 0);
+    for(i = 0;  i < g_FrameNum;  i++) {
+        rlen = dp_delta_encode(&g_Enc, g_Frame[i].data, g_Frame[i].len, rec);
+        olen = dp_delta_decode(&g_Dec, rec, rlen, out);
+        if( (olen != g_Frame[i].len) || memcmp(out, g_Frame[i].data, olen) ) {
+            bad++;
+        }
+    }
+    TEST_CHECK(bad == 0);
+    TEST_CHECK(g_Dec.err == 0);
+    TEST_CHECK(g_Enc.delta > 0);                        // The cyclic exchange is delta encoded
+    TEST_CHECK(g_Enc.wire_bytes < g_Enc.raw_bytes);
+    printf( "  %d frames, %u FULL, %u XOR, %u -> %u bytes\n",
+            g_FrameNum, g_Enc.full, g_Enc.delta, g_Enc.raw_bytes, g_Enc.wire_bytes );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Records lost: no frame decoded wrong, and the slots recovered by the FULL records.
+***********************************************************************************************************/
+
+static void test_loss(void)
+{
+    uint8_t     rec[DP_DELTA_HDR_LEN + DP_DELTA_FRAME_MAX + 16];
+    uint8_t     out[DP_DELTA_FRAME_MAX + 16];
+    int         i, rlen, olen, bad = 0, ok = 0, wait = 0;
+
+    dp_delta_init(&g_Enc, 8);
+    dp_delta_init(&g_Dec, 0);
+    for(i = 0;  i < g_FrameNum;  i++) {
+        rlen = dp_delta_encode(&g_Enc, g_Frame[i].data, g_Frame[i].len, rec);
+        if( (i % 37) == 5 ) {
+            continue;                                   // Lost on the network
+        }
+        if( (olen = dp_delta_decode(&g_Dec, rec, rlen, out)) < 0 ) {
+            wait++;
+        } else if( (olen != g_Frame[i].len) || memcmp(out, g_Frame[i].data, olen) ) {
+            bad++;
+        } else if( i > (g_FrameNum / 2) ) {
+            ok++;
+        }
+    }
+    TEST_CHECK(bad  == 0);
+    TEST_CHECK(wait >  0);
+    TEST_CHECK(ok   >  0);
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Decoder reset, as thread_net2dp does on a change of the peer, and the FULL request.
+***********************************************************************************************************/
+
+static void test_reset(void)
+{
+    uint8_t     rec[DP_DELTA_HDR_LEN + DP_DELTA_FRAME_MAX + 16];
+    uint8_t     out[DP_DELTA_FRAME_MAX + 16];
+    int         i, rlen, olen, bad = 0, ok = 0, wait = 0;
+
+    dp_delta_init(&g_Enc, 0);                           // FULL records only on request
+    dp_delta_init(&g_Dec, 0);
+    for(i = 0;  i < g_FrameNum;  i++) {
+        if( i == (g_FrameNum / 3) ) {
+            dp_delta_init(&g_Dec, 0);                   // Another peer, then this one again
+        }
+        if( i == (2 * g_FrameNum / 3) ) {
+            dp_delta_request(&g_Enc);
+        }
+        rlen = dp_delta_encode(&g_Enc, g_Frame[i].data, g_Frame[i].len, rec);
+        if( (olen = dp_delta_decode(&g_Dec, rec, rlen, out)) < 0 ) {
+            TEST_CHECK((i >= (g_FrameNum / 3)) && (i < (2 * g_FrameNum / 3)));
+            wait++;
+        } else if( (olen != g_Frame[i].len) || memcmp(out, g_Frame[i].data, olen) ) {
+            bad++;
+        } else {
+            ok++;
+        }
+    }
+    TEST_CHECK(bad  == 0);
+    TEST_CHECK(wait >  0);
+    TEST_CHECK(ok   >  0);
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Entry of the test.
+***********************************************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    const char *path = (argc > 1) ? (argv[1]) : (CAPTURE_FILE);
+    int         size, skip;
+
+    if( (size = cap_read(path)) <= 0 ) {
+        printf("Capture %s not found\n", path);
+        return( 1 );
+    }
+    skip = cap_split(size);
+    printf("  %s: %d bytes, %d frames, %d bytes skipped\n", path, size, g_FrameNum, skip);
+    TEST_CHECK(g_FrameNum > 100);
+
+    test_roundtrip();
+    test_loss();
+    test_reset();
+    return( TEST_RESULT() );
+}
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+***********************************************************************************************************/
@@ -0,0 +1,238 @@
+/**********************************************************************************************************/
+/** @file     test_gsd.c
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    Host test: GSD file parser and slave layout compiler over the fixture GSD files.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************
+*** Usage: test_gsd [dir]
+***
+***   The fixture GSD files are in "gsd/" by default: identifiers in the compact and the special format,
+***   continuation lines and comments, the consistency bit, and the invalid files with the line of the
+***   error. The layout table is compiled from the fixtures as "[Layout] SLAVEn" rules.
+***********************************************************************************************************/
+
+#include    <stdlib.h>
+#include    <stdint.h>
+#include    <stdio.h>
+#include    <string.h>
+
+#include    "gsd.h"
+#include    "test.h"
+
+
+/**********************************************************************************************************/
+/** @addtogroup TEST_GSD
+*** @{
+*** @addtogroup                 TEST_GSD_Private_Constants
+*** @{
+***********************************************************************************************************/
+
+#define FIXTURE_DIR         "gsd"                   /* Fixture GSD files                        */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 TEST_GSD_Private_Variables
+*** @{
+***********************************************************************************************************/
+
+static const char          *g_Dir = FIXTURE_DIR;
+static GSD_FILE             g_Gsd;
+static GSD_TABLE            g_Tab;
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 TEST_GSD_Private_Functions
+*** @{
+***********************************************************************************************************/
+/** @brief      Parse a fixture GSD file.
+***
+*** @return     Result of gsd_parse(), (-100)File not found.
+***********************************************************************************************************/
+
+static int fixture_parse(const char *name)
+{
+    char        path[256];
+    FILE       *fp;
+    int         ret;
+
+    snprintf(path, sizeof(path), "%s/%s", g_Dir, name);
+    if( (fp = fopen(path, "r")) == NULL ) {
+        printf("  Fixture %s not found\n", path);
+        return( -100 );
+    }
+    ret = gsd_parse(fp, &g_Gsd);
+    fclose(fp);
+    return( ret );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Add a slave of a fixture GSD file to the table, "ADDR DIR/FILE MODULES".
+***********************************************************************************************************/
+
+static int fixture_add(int addr, const char *name, const char *mods)
+{
+    char        rule[256];
+
+    snprintf(rule, sizeof(rule), "%d %s/%s %s", addr, g_Dir, name, mods);
+    return( gsd_table_add(&g_Tab, rule, &g_Gsd) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Check the I/O lengths and the consistency of a "Module".
+***********************************************************************************************************/
+
+static int mod_is(int k, int in, int out, int cons)
+{
+    const GSD_FILE_MOD *m = &g_Gsd.mod[k - 1];
+
+    return( (k <= g_Gsd.mod_num) && (m->in_len == in) && (m->out_len == out) && (m->cons == cons) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Identifiers in the compact format: IO, length, word and consistency bits.
+***********************************************************************************************************/
+
+static void test_compact(void)
+{
+    TEST_CHECK(fixture_parse("compact.gsd") == 8);
+    TEST_CHECK(g_Gsd.ident == 0x1234);
+    TEST_CHECK(g_Gsd.line  == 0);
+    TEST_CHECK(mod_is(1,  1,  0, 0));
+    TEST_CHECK(mod_is(2,  0,  1, 0));
+    TEST_CHECK(mod_is(3,  8,  0, 0));                   // Words
+    TEST_CHECK(mod_is(4,  2,  2, 0));                   // Inputs and outputs
+    TEST_CHECK(mod_is(5,  0,  4, 1));                   // Consistent
+    TEST_CHECK(mod_is(6,  0,  0, 0));                   // Empty slot
+    TEST_CHECK(mod_is(7,  4,  4, 0));                   // Identifiers summed
+    TEST_CHECK(mod_is(8, 32,  0, 0));
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Identifiers in the special format: length bytes, manufacturer data, mixed with compact.
+***********************************************************************************************************/
+
+static void test_special(void)
+{
+    TEST_CHECK(fixture_parse("special.gsd") == 6);
+    TEST_CHECK(g_Gsd.ident == 0x5678);
+    TEST_CHECK(mod_is(1,  4,  0, 1));                   // Consistency of the length byte
+    TEST_CHECK(mod_is(2,  0,  4, 0));
+    TEST_CHECK(mod_is(3, 16,  8, 0));                   // Output length byte first
+    TEST_CHECK(mod_is(4,  2,  0, 0));                   // Manufacturer data skipped
+    TEST_CHECK(mod_is(5,  1,  2, 0));
+    TEST_CHECK(mod_is(6,  0,  0, 0));
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Continuation lines, ";" comments out of the quotes only, keywords in any case, CR LF.
+***********************************************************************************************************/
+
+static void test_continuation(void)
+{
+    TEST_CHECK(fixture_parse("continuation.gsd") == 3);
+    TEST_CHECK(g_Gsd.ident == 0x0ABC);
+    TEST_CHECK(mod_is(1, 16,  0, 0));
+    TEST_CHECK(mod_is(2,  0,  1, 0));
+    TEST_CHECK(mod_is(3,  8,  4, 1));
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Invalid files: the line of the first error.
+***********************************************************************************************************/
+
+static void test_invalid(void)
+{
+    TEST_CHECK(fixture_parse("bad_special.gsd") < 0);
+    TEST_CHECK(g_Gsd.line == 5);
+    TEST_CHECK(fixture_parse("bad_length.gsd") < 0);
+    TEST_CHECK(g_Gsd.line == 4);
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Layout table: offsets, consistency groups per slave, errors and the sealed table.
+***********************************************************************************************************/
+
+static void test_table(void)
+{
+    const GSD_SLAVE    *s;
+    const GSD_MODULE   *m;
+
+    gsd_table_init(&g_Tab);
+    TEST_CHECK(fixture_add(3, "compact.gsd", "3,5,4,5") == 0);
+    TEST_CHECK(fixture_add(7, "special.gsd", "1 2 3") == 0);
+    TEST_CHECK(g_Tab.slave_num == 2);
+    TEST_CHECK(g_Tab.mod_num   == 7);
+
+    TEST_CHECK((s = gsd_table_slave(&g_Tab, 3)) != NULL);
+    TEST_CHECK((s->ident == 0x1234) && (s->mod_num == 4) && (s->mod_first == 0));
+    TEST_CHECK((s->in_len == 10) && (s->out_len == 10));
+    m = &g_Tab.mod[s->mod_first];
+    TEST_CHECK((m[0].in_off == 0) && (m[0].in_len == 8) && (m[0].group == GSD_GROUP_NONE));
+    TEST_CHECK((m[1].out_off == 0) && (m[1].out_len == 4) && (m[1].group == 0));
+    TEST_CHECK((m[2].in_off == 8) && (m[2].out_off == 4) && (m[2].group == GSD_GROUP_NONE));
+    TEST_CHECK((m[3].out_off == 6) && (m[3].group == 1));
+
+    TEST_CHECK((s = gsd_table_slave(&g_Tab, 7)) != NULL);
+    TEST_CHECK((s->in_len == 20) && (s->out_len == 12) && (s->mod_first == 4));
+    m = &g_Tab.mod[s->mod_first];
+    TEST_CHECK((m[0].group == 0) && (m[1].group == GSD_GROUP_NONE));    // Groups of the slave
+    TEST_CHECK((m[2].in_off == 4) && (m[2].out_off == 4));
+
+    TEST_CHECK(fixture_add(3,  "compact.gsd", "1") == -1);         // Slave added already
+    TEST_CHECK(fixture_add(9,  "missing.gsd", "1") == -2);
+    TEST_CHECK(fixture_add(9,  "bad_special.gsd", "1") == -3);
+    TEST_CHECK(fixture_add(9,  "compact.gsd", "1,9") == -4);
+    TEST_CHECK(fixture_add(9,  "compact.gsd", "0") == -4);
+    TEST_CHECK(fixture_add(9,  "compact.gsd", "8,8,8,8,8,8,8,8") == -6);
+    TEST_CHECK(gsd_table_slave(&g_Tab, 9) == NULL);
+    TEST_CHECK((g_Tab.slave_num == 2) && (g_Tab.mod_num == 7));     // Nothing left of the failures
+
+    gsd_table_seal(&g_Tab, 0x1001);
+    TEST_CHECK(gsd_table_check(&g_Tab, 0x1001));
+    TEST_CHECK(!gsd_table_check(&g_Tab, 0x1002));
+    g_Tab.mod[1].out_len++;
+    TEST_CHECK(!gsd_table_check(&g_Tab, 0x1001));
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Entry of the test.
+***********************************************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    if( argc > 1 ) {
+        g_Dir = argv[1];
+    }
+    test_compact();
+    test_special();
+    test_continuation();
+    test_invalid();
+    test_table();
+    return( TEST_RESULT() );
+}
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+***********************************************************************************************************/
@@ -0,0 +1,262 @@
+/**********************************************************************************************************/
+/** @file     trace2json.c
+*** @author   Linghu
+*** @version  V1.0.0
+*** @date     2026-10-18
+*** @brief    Host tool: the DUMP of the event trace converted into the Chrome trace JSON.
+***********************************************************************************************************
+*** @par Last Commit:
+***      \$Author$ \n
+***      \$Date$ \n
+***      \$Rev$ \n
+***      \$URL$ \n
+***
+*** @par Change Logs:
+***      2026-10-18 -- Linghu -- the first version
+***********************************************************************************************************
+*** Usage: trace2json [-p port] [-o file] gateway
+***        trace2json -f dump [-o file]
+***
+***   -p port     TCP port of the trace, "[TRACE] PORT" of config.sys, 18359 by default
+***   -f dump     DUMP saved before, "-" for stdin, instead of "DUMP" sent to the gateway
+***   -o file     JSON written to the file, stdout by default
+***
+***   The records of trace.h are put on the timeline in microseconds since the first record, the cycles
+***   unwrapped and divided by the cycles per second of the header. A thread a subsystem; the spans of
+***   TRACE_BEGIN()/TRACE_FINISH() are the "B"/"E" events, the others the instant events, with the arg.
+***   An end of span without its begin, overwritten in the buffer, is put as an instant event. Load the
+***   file into chrome://tracing or ui.perfetto.dev.
+***********************************************************************************************************/
+
+#include    <stdlib.h>
+#include    <stdint.h>
+#include    <stdio.h>
+#include    <string.h>
+#include    <unistd.h>
+#include    <netdb.h>
+#include    <arpa/inet.h>
+#include    <netinet/in.h>
+#include    <sys/socket.h>
+
+#include    "trace.h"
+
+
+/**********************************************************************************************************/
+/** @addtogroup TRACE2JSON
+*** @{
+*** @addtogroup                 TRACE2JSON_Private_Constants
+*** @{
+***********************************************************************************************************/
+
+#define TRACE_PORT          18359                   /* Default "[TRACE] PORT" of cfg.c          */
+#define TRACE_SUB_NUM       8                       /* Subsystems named                         */
+#define TRACE_EVT_NUM       10                      /* Events named of a subsystem              */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 TRACE2JSON_Private_Variables
+*** @{
+***********************************************************************************************************/
+
+static const char          *g_SubName[TRACE_SUB_NUM] = {
+    "UART", "PBDP", "NET", NULL, NULL, NULL, NULL, "USER"
+};
+
+static const char          *g_EvtName[TRACE_SUB_NUM][TRACE_EVT_NUM] = {
+    { NULL, "PE", "FE", "NE", "ORE", "IDLE", "TC", "TXE", "RXNE", "TIM" },
+    { NULL, "Send", "Retry", "Recv" },
+    { NULL, "Rx", "Tx", "Drop" },
+};
+
+static const uint32_t       g_Span[TRACE_SUB_NUM] = {   /* Events of the spans, bit (0x1 << evt)   */
+    0, (0x1u << TRACE_PBDP_SEND), (0x1u << TRACE_NET_TX), 0, 0, 0, 0, 0
+};
+
+static uint16_t             g_Open[0x100][0x80];    /* Spans begun and not ended, by id         */
+
+
+/**********************************************************************************************************/
+/** @}
+*** @addtogroup                 TRACE2JSON_Private_Functions
+*** @{
+***********************************************************************************************************/
+/** @brief      Read a little-endian uint32 of the DUMP.
+***********************************************************************************************************/
+
+static uint32_t trace_le32(const uint8_t *p)
+{
+    return( (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24) );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Name of an event, "S<sub>.E<evt>" for those not in the tables.
+***********************************************************************************************************/
+
+static const char* trace_name(uint32_t sub, uint32_t evt, char *buff, int size)
+{
+    if( (sub < TRACE_SUB_NUM) && (evt < TRACE_EVT_NUM) && (g_EvtName[sub][evt] != NULL) ) {
+        return( g_EvtName[sub][evt] );
+    }
+    snprintf(buff, size, "S%u.E%u", sub, evt);
+    return( buff );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Open the DUMP of the gateway: "DUMP" sent to the trace port.
+***
+*** @return     (NULL)Failed, (other)Stream of the DUMP.
+***********************************************************************************************************/
+
+static FILE* trace_open(const char *host, const char *port)
+{
+    struct addrinfo     hint, *ai;
+    int                 sock;
+
+    memset(&hint, 0, sizeof(hint));
+    hint.ai_family   = AF_INET;
+    hint.ai_socktype = SOCK_STREAM;
+    if( getaddrinfo(host, port, &hint, &ai) != 0 ) {
+        fprintf(stderr, "%s: unknown host\n", host);
+        return( NULL );
+    }
+    if(   ((sock = socket(AF_INET, SOCK_STREAM, 0)) < 0)
+       || (connect(sock, ai->ai_addr, ai->ai_addrlen) < 0)
+       || (send(sock, "DUMP\r\n", 6, 0) != 6) ) {
+        perror(host);
+        freeaddrinfo(ai);
+        return( NULL );
+    }
+    freeaddrinfo(ai);
+    return( fdopen(sock, "rb") );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Convert the DUMP into the JSON.
+***
+*** @return     (0)Succeed, (1)Not a DUMP, (2)DUMP truncated before TRACE_ID_EOF.
+***********************************************************************************************************/
+
+static int trace_convert(FILE *in, FILE *out)
+{
+    uint8_t     rec[sizeof(TRACE_REC)], hdr[16];
+    uint64_t    cyc = 0;
+    uint32_t    hz, last = 0, id, arg, sub, evt, n, num = 0, lost = 0;
+    const char *ph;
+    char        name[16];
+    int         first = 1, rc = 2;
+
+    if( (fread(hdr, sizeof(hdr), 1, in) != 1) || (trace_le32(hdr) != TRACE_MAGIC) ) {
+        fprintf(stderr, "Not a DUMP of the trace\n");
+        return( 1 );
+    }
+    if( (hz = trace_le32(hdr + 4)) == 0 ) {
+        hz = 1;
+    }
+    fprintf(out, "{\"otherData\":{\"hz\":%u,\"mask\":\"0x%X\"},\n\"traceEvents\":[\n", hz, trace_le32(hdr + 8));
+    for(n = 0;  n < TRACE_SUB_NUM;  n++) {
+        if( g_SubName[n] != NULL ) {
+            fprintf(out, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}},\n",
+                    n, g_SubName[n]);
+        }
+    }
+
+    while( fread(rec, sizeof(rec), 1, in) == 1 ) {
+        id  = rec[4] | (rec[5] << 8);
+        arg = rec[6] | (rec[7] << 8);
+        if( id == TRACE_ID_EOF ) {
+            rc = 0;
+            break;
+        }
+        if( id == TRACE_ID_LOST ) {                     // Stamped when sent, put at the last record
+            fprintf(out, "{\"name\":\"Lost\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":%.3f,"
+                         "\"args\":{\"records\":%u}},\n", cyc * 1e6 / hz, arg);
+            lost += arg;
+            continue;
+        }
+        if( first ) {
+            last  = trace_le32(rec);
+            first = 0;
+        }
+        cyc += (uint32_t)(trace_le32(rec) - last);      // Unwrapped, gaps less than 2^32 cycles
+        last = trace_le32(rec);
+        sub = id >> 8;
+        evt = id & ~TRACE_END & 0xFF;
+        ph  = "i";
+        if( (id & TRACE_END) && (g_Open[sub][evt] > 0) ) {
+            g_Open[sub][evt]--;
+            ph = "E";
+        } else if( !(id & TRACE_END) && (sub < TRACE_SUB_NUM) && (evt < 32) && (g_Span[sub] & (0x1u << evt)) ) {
+            g_Open[sub][evt]++;
+            ph = "B";
+        }
+        fprintf(out, "{\"name\":\"%s%s\",\"ph\":\"%s\",%s\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"args\":{\"arg\":%u}},\n",
+                trace_name(sub, evt, name, sizeof(name)), ((id & TRACE_END) && (ph[0] == 'i')) ? (" end") : (""),
+                ph, (ph[0] == 'i') ? ("\"s\":\"t\",") : (""), sub, cyc * 1e6 / hz, arg);
+        num++;
+    }
+
+    fprintf(out, "{\"name\":\"Dump\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":%.3f,"
+                 "\"args\":{\"records\":%u,\"lost\":%u,\"complete\":%s}}\n]}\n",
+                 cyc * 1e6 / hz, num, lost, (rc == 0) ? ("true") : ("false"));
+    fprintf(stderr, "%u records, %u lost, %.3f ms%s\n", num, lost, cyc * 1e3 / hz,
+            (rc == 0) ? ("") : (", truncated before the end of DUMP"));
+    return( rc );
+}
+
+
+/**********************************************************************************************************/
+/** @brief      Entry of the tool.
+***********************************************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    const char *dump = NULL, *file = NULL;
+    FILE       *in, *out = stdout;
+    char        port[16];
+    int         opt, rc;
+
+    snprintf(port, sizeof(port), "%d", TRACE_PORT);
+    while( (opt = getopt(argc, argv, "p:f:o:")) != -1 ) {
+        switch( opt ) {
+        case 'p':   snprintf(port, sizeof(port), "%s", optarg);     break;
+        case 'f':   dump = optarg;                                  break;
+        case 'o':   file = optarg;                                  break;
+        default:    optind = argc + 1;                              break;
+        }
+    }
+    if( (dump != NULL) ? (optind != argc) : (optind != (argc - 1)) ) {
+        fprintf(stderr, "Usage: %s [-p port] [-o file] gateway\n"
+                        "       %s -f dump [-o file]\n", argv[0], argv[0]);
+        return( 2 );
+    }
+    if( dump == NULL ) {
+        in = trace_open(argv[optind], port);
+    } else if( strcmp(dump, "-") == 0 ) {
+        in = stdin;
+    } else if( (in = fopen(dump, "rb")) == NULL ) {
+        perror(dump);
+    }
+    if( in == NULL ) {
+        return( 2 );
+    }
+    if( (file != NULL) && ((out = fopen(file, "w")) == NULL) ) {
+        perror(file);
+        return( 2 );
+    }
+    rc = trace_convert(in, out);
+    fclose(in);
+    if( out != stdout ) {
+        fclose(out);
+    }
+    return( rc );
+}
+
+
+/*****************************  END OF FILE  **************************************************************/
+/** @}
+*** @}
+***********************************************************************************************************/
@@ -48,7 +48,7 @@
 //   <i> Defines max. number of threads that will run at the same time.
 //   <i> Default: 6
 #ifndef OS_TASKCNT
- #define OS_TASKCNT     8
+ #define OS_TASKCNT     17                       // PROFILER_THREAD_NUM of profiler.h with it
 #endif
 
 //   <o>Default Thread stack size [bytes] <64-4096:8><#/4>
@@ -215,8 +215,11 @@ void os_idle_demon (void) {
   /* The idle demon is a system thread, running when no other thread is      */
   /* ready to run.                                                           */
 
+  extern void bsp_idle(void);
+
   for (;;) {
     /* HERE: include optional user code to be executed when no thread runs.*/
+    bsp_idle();                         /* Idle time of the CPU, ref: bsp_idletime() */
   }
 }
 
@@ -0,0 +1,34 @@
+t <html><head><title>Bus Analytics</title>
+t <meta http-equiv="refresh" content="5"></head>
+i pg_header.inc
+t <h2 align=center><br>ProfiBUS-DP Bus Analytics</h2>
+t <p><font size="2">One-second windows of the bus load, newest first. The <b>Gap</b> is the
+t  histogram of request to response gap in bit times, the last bin for no response within slot time.
+t  The same data is replied to any datagram on the <b>UDP status port</b>.</font></p>
+t <center>
+t <table border=0 width=99%><font size="3">
+t <tr bgcolor=#aaccff>
+t  <th width=16%>Window</th>
+t  <th width=16%>Frames</th>
+t  <th width=16%>Busy</th>
+t  <th width=16%>Busy bits</th>
+t  <th width=18% bgcolor=#aacc00>TRR Avg(us)</th>
+t  <th width=18% bgcolor=#aacc00>TRR Max(us)</th>
+t </tr>
+c b w <tr align="center"><td>-%us</td><td>%u</td><td>%u%%</td><td>%u</td><td>%u</td><td>%u</td></tr>
+t </font></table>
+t <table border=0 width=99%><font size="3">
+t <tr bgcolor=#aaccff><th>Gap</th>
+c b h <th>%u</th>
+t </tr><tr align="center"><td>Frames</td>
+c b g <td>%u</td>
+t </tr></font></table>
+t <form action=bus.cgi method=post name=form1>
+t  <table width=660>
+t  <tr><td align="center">
+t  <input type=button value="Refresh" onclick="location='/bus.cgi'">
+t  </td></tr></table>
+t  </center>
+t </form>
+i pg_footer.inc
+. End of script must be closed with period.
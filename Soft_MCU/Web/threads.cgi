@@ -0,0 +1,30 @@
+t <html><head><title>Threads</title>
+t <meta http-equiv="refresh" content="5"></head>
+i pg_header.inc
+t <h2 align=center><br>Threads</h2>
+t <p><font size="2">CPU load of the threads in the last second, sampled every 100us, and the
+t  stack use. <b>Peak</b> is the high-water of the stack since the thread was first seen, a thread
+t  near 100% needs a larger stack. <b>Prio</b> is the RTX priority, 4 for osPriorityNormal.</font></p>
+t <center>
+t <table border=0 width=99%><font size="3">
+t <tr bgcolor=#aaccff>
+t  <th width=8%>Id</th>
+t  <th width=20%>Thread</th>
+t  <th width=8%>Prio</th>
+t  <th width=12%>CPU</th>
+t  <th width=13% bgcolor=#aacc00>Stack</th>
+t  <th width=13% bgcolor=#aacc00>Used</th>
+t  <th width=13% bgcolor=#aacc00>Peak</th>
+t  <th width=13% bgcolor=#aacc00>Peak%</th>
+t </tr>
+c p t <tr align="center"><td>%u</td><td>%s</td><td>%u</td><td>%u.%u%%</td><td>%u</td><td>%u</td><td>%u</td><td>%u%%</td></tr>
+t </font></table>
+t <form action=threads.cgi method=post name=form1>
+t  <table width=660>
+t  <tr><td align="center">
+t  <input type=button value="Refresh" onclick="location='/threads.cgi'">
+t  </td></tr></table>
+t  </center>
+t </form>
+i pg_footer.inc
+. End of script must be closed with period.